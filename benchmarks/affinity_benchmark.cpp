@@ -0,0 +1,225 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <asio/experimental/parallel_group.hpp>
+#include <fmt/core.h>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <jsonrpc/endpoint/metrics.hpp>
+#include <jsonrpc/endpoint/rpc_server.hpp>
+#include <jsonrpc/endpoint/worker_pool.hpp>
+#include <jsonrpc/transport/pipe_acceptor.hpp>
+#include <jsonrpc/transport/pipe_transport.hpp>
+#include <spdlog/spdlog.h>
+
+using jsonrpc::endpoint::LatencyHistogram;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::RpcServer;
+using jsonrpc::endpoint::ServerOptions;
+using jsonrpc::endpoint::WorkerPool;
+using jsonrpc::endpoint::WorkerPoolOptions;
+using jsonrpc::transport::PipeAcceptor;
+using jsonrpc::transport::PipeTransport;
+using Json = nlohmann::json;
+
+/**
+ * @brief Session affinity against a shared multi-threaded io_context
+ *
+ * Many clients each keep one call in flight against an RpcServer over unix
+ * sockets. The handler walks a table kept per thread, which stays warm in
+ * a core's cache only while the threads stay on their cores.
+ *
+ * The shared server runs every session on one io_context run by all the
+ * threads, where reads, handlers and writes land on whichever thread is
+ * free. The pinned server places each session on a WorkerPool worker
+ * pinned to a CPU. Both report throughput and round trip percentiles; run
+ * under `perf stat -e cache-misses,context-switches` to see the caches.
+ *
+ * Usage: affinity_benchmark [threads] [clients] [calls] [table_kb]
+ */
+
+namespace {
+
+struct Config {
+  int threads = 4;
+  int clients = 64;
+  int calls = 2000;
+  std::size_t table_kb = 64;
+};
+
+enum class Mode { kShared, kPinned };
+
+struct Result {
+  double calls_per_second = 0.0;
+  jsonrpc::endpoint::LatencySnapshot latency;
+};
+
+auto RunClient(
+    asio::any_io_executor executor, std::string socket_path,
+    const Config& config, LatencyHistogram& latency) -> asio::awaitable<void> {
+  jsonrpc::endpoint::EndpointOptions options;
+  options.request_timeout = std::nullopt;
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor, std::make_unique<PipeTransport>(executor, socket_path),
+      options);
+  if (!client) {
+    spdlog::error("Client failed to start: {}", client.error().Message());
+    co_return;
+  }
+  const Json params = {{"table_kb", config.table_kb}};
+  for (int i = 0; i < config.calls; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = co_await (*client)->SendMethodCall("touch", params);
+    latency.Record(std::chrono::steady_clock::now() - start);
+    if (!result) {
+      spdlog::error("Call failed: {}", result.error().Message());
+    }
+  }
+  co_await (*client)->Shutdown();
+}
+
+auto RunRound(Mode mode, const Config& config) -> Result {
+  const std::string socket_path =
+      "/tmp/jsonrpc_affinity_benchmark_" +
+      std::to_string(static_cast<int>(mode));
+
+  // The pinned server only accepts on this context; the shared one runs
+  // everything on it
+  asio::io_context server_io;
+  std::shared_ptr<WorkerPool> workers;
+  ServerOptions options;
+  if (mode == Mode::kPinned) {
+    workers = std::make_shared<WorkerPool>(WorkerPoolOptions{
+        .threads = static_cast<std::size_t>(config.threads),
+        .pin_threads = true});
+    options.workers = workers;
+  }
+  auto server = std::make_unique<RpcServer>(
+      server_io.get_executor(),
+      std::make_unique<PipeAcceptor>(server_io.get_executor(), socket_path),
+      options);
+
+  // Stands in for state handlers keep hot, such as a document cache
+  server->RegisterMethodCall(
+      "touch", [](std::optional<Json> params) -> asio::awaitable<Json> {
+        thread_local std::vector<std::uint64_t> table;
+        const auto size = params->at("table_kb").get<std::size_t>() * 128;
+        if (table.size() != size) {
+          table.assign(size, 1);
+        }
+        std::uint64_t sum = 0;
+        for (auto& value : table) {
+          sum += ++value;
+        }
+        co_return sum;
+      });
+
+  std::atomic<bool> started{false};
+  asio::co_spawn(
+      server_io,
+      [&server, &started]() -> asio::awaitable<void> {
+        if (!co_await server->Start()) {
+          spdlog::error("Server failed to start");
+        }
+        started = true;
+      },
+      asio::detached);
+  auto work_guard = asio::make_work_guard(server_io);
+  const int server_threads = mode == Mode::kShared ? config.threads : 1;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < server_threads; ++i) {
+    threads.emplace_back([&server_io] { server_io.run(); });
+  }
+  while (!started) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  asio::io_context client_io;
+  LatencyHistogram latency;
+  using ClientOp = decltype(asio::co_spawn(
+      client_io, RunClient(client_io.get_executor(), socket_path, config,
+                           latency),
+      asio::deferred));
+  std::vector<ClientOp> clients;
+  for (int i = 0; i < config.clients; ++i) {
+    clients.push_back(asio::co_spawn(
+        client_io,
+        RunClient(client_io.get_executor(), socket_path, config, latency),
+        asio::deferred));
+  }
+  const auto start = std::chrono::steady_clock::now();
+  asio::co_spawn(
+      client_io,
+      asio::experimental::make_parallel_group(std::move(clients))
+          .async_wait(asio::experimental::wait_for_all(), asio::deferred),
+      asio::detached);
+  client_io.run();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::atomic<bool> stopped{false};
+  asio::co_spawn(
+      server_io,
+      [&server, &stopped]() -> asio::awaitable<void> {
+        co_await server->Shutdown();
+        stopped = true;
+      },
+      asio::detached);
+  while (!stopped) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  work_guard.reset();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  server.reset();
+  if (workers) {
+    workers->Stop();
+  }
+
+  const auto total = static_cast<double>(config.clients) * config.calls;
+  return Result{
+      .calls_per_second =
+          total / std::chrono::duration<double>(elapsed).count(),
+      .latency = latency.Snapshot()};
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  spdlog::set_level(spdlog::level::warn);
+
+  Config config;
+  if (argc > 1) {
+    config.threads = std::atoi(argv[1]);
+  }
+  if (argc > 2) {
+    config.clients = std::atoi(argv[2]);
+  }
+  if (argc > 3) {
+    config.calls = std::atoi(argv[3]);
+  }
+  if (argc > 4) {
+    config.table_kb = static_cast<std::size_t>(std::atoi(argv[4]));
+  }
+
+  fmt::print(
+      "{} server threads, {} clients x {} calls, {} KB touched per call\n",
+      config.threads, config.clients, config.calls, config.table_kb);
+  fmt::print(
+      "{:>8} {:>12} {:>10} {:>10} {:>10}\n", "server", "calls/s", "p50 us",
+      "p99 us", "max us");
+  for (auto mode : {Mode::kShared, Mode::kPinned}) {
+    auto result = RunRound(mode, config);
+    fmt::print(
+        "{:>8} {:>12.0f} {:>10} {:>10} {:>10}\n",
+        mode == Mode::kShared ? "shared" : "pinned", result.calls_per_second,
+        result.latency.Percentile(0.5).count(),
+        result.latency.Percentile(0.99).count(), result.latency.max.count());
+  }
+  return 0;
+}
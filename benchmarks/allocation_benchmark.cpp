@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <fmt/core.h>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <jsonrpc/transport/framed_pipe_transport.hpp>
+#include <spdlog/spdlog.h>
+
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::transport::FramedPipeTransport;
+using Json = nlohmann::json;
+
+/**
+ * @brief Heap allocations per round trip
+ *
+ * A client and a server in this process exchange calls one at a time over a
+ * framed unix socket. Every operator new in the process is counted, so each
+ * figure covers both ends of the call: encoding, framing, the transports,
+ * dispatch and the coroutine frames asio could not recycle. Calls made
+ * before the measurement warm up the pools and caches, so what is left is
+ * the steady-state cost.
+ *
+ * Usage: allocation_benchmark [calls]
+ */
+
+namespace {
+
+std::atomic<std::size_t> allocation_count{0};
+
+struct Round {
+  std::string name;
+  Json params;
+};
+
+// Built outside the coroutine; GCC mishandles braced json initializers in
+// coroutine frames
+auto MakeRounds() -> std::vector<Round> {
+  std::vector<Round> rounds;
+  rounds.push_back({.name = "no params", .params = nullptr});
+  rounds.push_back(
+      {.name = "small object",
+       .params = {{"uri", "file:///src/main.cpp"}, {"line", 42}}});
+  rounds.push_back(
+      {.name = "1 KiB string", .params = {{"text", std::string(1024, 'x')}}});
+  return rounds;
+}
+
+auto RunRounds(
+    asio::any_io_executor executor, std::string socket_path, int calls)
+    -> asio::awaitable<void> {
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor, std::make_unique<FramedPipeTransport>(
+                    executor, socket_path, false));
+  if (!client) {
+    spdlog::error("Client failed to start: {}", client.error().Message());
+    co_return;
+  }
+
+  const auto rounds = MakeRounds();
+  fmt::print("{:<14} {:>16}\n", "params", "allocs/call");
+  for (const auto& round : rounds) {
+    auto call = [&]() -> asio::awaitable<void> {
+      auto params = round.params.is_null() ? std::optional<Json>()
+                                           : std::optional<Json>(round.params);
+      auto result = co_await (*client)->SendMethodCall("echo", params);
+      if (!result) {
+        spdlog::error("Call failed: {}", result.error().Message());
+      }
+    };
+
+    for (int i = 0; i < calls / 10 + 1; ++i) {
+      co_await call();
+    }
+    auto before = allocation_count.load();
+    for (int i = 0; i < calls; ++i) {
+      co_await call();
+    }
+    auto allocations = allocation_count.load() - before;
+    fmt::print(
+        "{:<14} {:>16.1f}\n", round.name,
+        static_cast<double>(allocations) / calls);
+  }
+
+  co_await (*client)->Shutdown();
+}
+
+}  // namespace
+
+// Counts every allocation in the process; the matching deletes stay free
+auto operator new(std::size_t size) -> void* {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+
+auto main(int argc, char** argv) -> int {
+  spdlog::set_level(spdlog::level::warn);
+
+  int calls = 10000;
+  if (argc > 1) {
+    calls = std::atoi(argv[1]);
+  }
+  const std::string socket_path = "/tmp/jsonrpc_allocation_benchmark";
+
+  asio::io_context server_io;
+  auto server = std::make_unique<RpcEndpoint>(
+      server_io.get_executor(),
+      std::make_unique<FramedPipeTransport>(
+          server_io.get_executor(), socket_path, true));
+  server->RegisterMethodCall(
+      "echo", [](std::optional<Json> params) -> asio::awaitable<Json> {
+        co_return params ? std::move(*params) : Json();
+      });
+
+  // Start() completes once the client has connected
+  asio::co_spawn(server_io, server->Start(), asio::detached);
+  auto work_guard = asio::make_work_guard(server_io);
+  std::thread server_thread([&server_io] { server_io.run(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  asio::io_context client_io;
+  asio::co_spawn(
+      client_io, RunRounds(client_io.get_executor(), socket_path, calls),
+      asio::detached);
+  client_io.run();
+
+  asio::co_spawn(server_io, server->Shutdown(), asio::detached);
+  work_guard.reset();
+  server_thread.join();
+  return 0;
+}
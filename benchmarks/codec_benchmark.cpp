@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+#include <jsonrpc/endpoint/json_codec.hpp>
+#include <jsonrpc/endpoint/request.hpp>
+#include <jsonrpc/endpoint/response.hpp>
+#include <jsonrpc/transport/message_encoding.hpp>
+#include <jsonrpc/transport/message_framer.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::ActiveJsonBackend;
+using jsonrpc::endpoint::EncodeMessage;
+using jsonrpc::endpoint::JsonBackend;
+using jsonrpc::endpoint::ParseJson;
+using jsonrpc::endpoint::Request;
+using jsonrpc::endpoint::Response;
+using jsonrpc::transport::MessageEncoding;
+using jsonrpc::transport::MessageFramer;
+using Json = nlohmann::json;
+
+/**
+ * @brief Throughput of the pieces every message passes through
+ *
+ * Content-Length framing by body size, parsing large messages with the
+ * build's JSON backend against nlohmann, the conversions between parsed
+ * JSON and the request and response types, and writing CBOR and
+ * MessagePack messages from the DOM against the detour through JSON text.
+ */
+
+namespace {
+
+auto MakeBody(std::size_t size) -> std::string {
+  return std::string(size, 'x');
+}
+
+void BM_FramerFrame(benchmark::State& state) {
+  const auto body = MakeBody(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto framed = MessageFramer::Frame(body);
+    benchmark::DoNotOptimize(framed);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FramerFrame)->RangeMultiplier(8)->Range(64, 1 << 20);
+
+void BM_FramerDeframe(benchmark::State& state) {
+  const auto framed =
+      MessageFramer::Frame(MakeBody(static_cast<std::size_t>(state.range(0))));
+  MessageFramer framer;
+  for (auto _ : state) {
+    auto result = framer.TryDeframe(framed);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FramerDeframe)->RangeMultiplier(8)->Range(64, 1 << 20);
+
+// Feeds the frame in read-sized chunks, as a socket would deliver it
+void BM_FramerDeframeChunked(benchmark::State& state) {
+  constexpr std::size_t kChunkSize = 4096;
+  const auto framed =
+      MessageFramer::Frame(MakeBody(static_cast<std::size_t>(state.range(0))));
+  MessageFramer framer;
+  for (auto _ : state) {
+    MessageFramer::DeframeResult result;
+    for (std::size_t end = kChunkSize; !result.complete; end += kChunkSize) {
+      result = framer.TryDeframe(
+          std::string_view(framed).substr(0, std::min(end, framed.size())));
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FramerDeframeChunked)->RangeMultiplier(8)->Range(4096, 1 << 20);
+
+auto MakeRequestJson() -> Json {
+  return {
+      {"jsonrpc", "2.0"},
+      {"method", "textDocument/hover"},
+      {"params",
+       {{"textDocument", {{"uri", "file:///src/main.cpp"}}},
+        {"position", {{"line", 42}, {"character", 7}}}}},
+      {"id", 1}};
+}
+
+void BM_RequestFromJson(benchmark::State& state) {
+  const auto message = MakeRequestJson();
+  for (auto _ : state) {
+    auto request = Request::FromJson(message);
+    benchmark::DoNotOptimize(request);
+  }
+}
+BENCHMARK(BM_RequestFromJson);
+
+// The dispatcher's path: params are moved out of a freshly parsed message
+void BM_RequestFromParsedJson(benchmark::State& state) {
+  const auto text = MakeRequestJson().dump();
+  for (auto _ : state) {
+    auto request = Request::FromJson(Json::parse(text));
+    benchmark::DoNotOptimize(request);
+  }
+}
+BENCHMARK(BM_RequestFromParsedJson);
+
+void BM_ResponseToJson(benchmark::State& state) {
+  const Json result = {{"contents", std::string(256, 'x')}, {"line", 42}};
+  const auto response = Response::CreateSuccess(result, 1);
+  for (auto _ : state) {
+    auto json = response.ToJson();
+    benchmark::DoNotOptimize(json);
+  }
+}
+BENCHMARK(BM_ResponseToJson);
+
+void BM_ResponseDump(benchmark::State& state) {
+  const Json result = {{"contents", std::string(256, 'x')}, {"line", 42}};
+  const auto response = Response::CreateSuccess(result, 1);
+  for (auto _ : state) {
+    auto text = response.Dump();
+    benchmark::DoNotOptimize(text);
+  }
+}
+BENCHMARK(BM_ResponseDump);
+
+// What the dispatcher does for every call: wrap the handler's result and
+// write the response
+void BM_ResponseCreateAndDump(benchmark::State& state) {
+  const Json result = {{"contents", "hover text"}, {"line", 42}};
+  for (auto _ : state) {
+    auto text = Response::CreateSuccess(result, 1).Dump();
+    benchmark::DoNotOptimize(text);
+  }
+}
+BENCHMARK(BM_ResponseCreateAndDump);
+
+void BM_RequestDump(benchmark::State& state) {
+  const auto request = Request::FromJson(MakeRequestJson());
+  for (auto _ : state) {
+    auto text = request->Dump();
+    benchmark::DoNotOptimize(text);
+  }
+}
+BENCHMARK(BM_RequestDump);
+
+// A result of many members, sized by the benchmark argument in KB
+auto MakeLargeResult(std::int64_t kilobytes) -> Json {
+  Json result = Json::object();
+  for (std::int64_t i = 0; i < kilobytes * 8; ++i) {
+    result["item" + std::to_string(i)] = {
+        {"name", std::string(96, 'x')}, {"value", i}};
+  }
+  return result;
+}
+
+// A request carrying the large result as params, as text off the wire
+auto MakeLargeRequestText(std::int64_t kilobytes) -> std::string {
+  auto request = MakeRequestJson();
+  request["params"] = MakeLargeResult(kilobytes);
+  return request.dump();
+}
+
+// The build's backend; compare with BM_NlohmannParse in a simdjson build
+void BM_ParseJson(benchmark::State& state) {
+  const auto text = MakeLargeRequestText(state.range(0));
+  state.SetLabel(
+      ActiveJsonBackend() == JsonBackend::kSimdjson ? "simdjson" : "nlohmann");
+  for (auto _ : state) {
+    auto json = ParseJson(text);
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) *
+      static_cast<std::int64_t>(text.size()));
+}
+BENCHMARK(BM_ParseJson)->RangeMultiplier(8)->Range(1, 512);
+
+void BM_NlohmannParse(benchmark::State& state) {
+  const auto text = MakeLargeRequestText(state.range(0));
+  for (auto _ : state) {
+    auto json = Json::parse(text);
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) *
+      static_cast<std::int64_t>(text.size()));
+}
+BENCHMARK(BM_NlohmannParse)->RangeMultiplier(8)->Range(1, 512);
+
+// How binary responses used to be sent: written as JSON text, parsed back
+// and encoded
+template <MessageEncoding kEncoding>
+void BM_ResponseEncodeViaText(benchmark::State& state) {
+  const auto response =
+      Response::CreateSuccess(MakeLargeResult(state.range(0)), 1);
+  for (auto _ : state) {
+    auto encoded = EncodeMessage(ParseJson(response.Dump()), kEncoding);
+    benchmark::DoNotOptimize(encoded);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) * state.range(0) * 1024);
+}
+BENCHMARK_TEMPLATE(BM_ResponseEncodeViaText, MessageEncoding::kCbor)
+    ->RangeMultiplier(8)
+    ->Range(1, 512);
+BENCHMARK_TEMPLATE(BM_ResponseEncodeViaText, MessageEncoding::kMsgpack)
+    ->RangeMultiplier(8)
+    ->Range(1, 512);
+
+// The envelope written directly around the result's DOM
+template <MessageEncoding kEncoding>
+void BM_ResponseEncode(benchmark::State& state) {
+  const auto response =
+      Response::CreateSuccess(MakeLargeResult(state.range(0)), 1);
+  for (auto _ : state) {
+    auto encoded = response.Encode(kEncoding);
+    benchmark::DoNotOptimize(encoded);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations()) * state.range(0) * 1024);
+}
+BENCHMARK_TEMPLATE(BM_ResponseEncode, MessageEncoding::kCbor)
+    ->RangeMultiplier(8)
+    ->Range(1, 512);
+BENCHMARK_TEMPLATE(BM_ResponseEncode, MessageEncoding::kMsgpack)
+    ->RangeMultiplier(8)
+    ->Range(1, 512);
+
+template <MessageEncoding kEncoding>
+void BM_RequestEncode(benchmark::State& state) {
+  const auto request = Request::FromJson(MakeRequestJson());
+  for (auto _ : state) {
+    auto encoded = request->Encode(kEncoding);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+BENCHMARK_TEMPLATE(BM_RequestEncode, MessageEncoding::kCbor);
+
+template <MessageEncoding kEncoding>
+void BM_RequestEncodeViaText(benchmark::State& state) {
+  const auto request = Request::FromJson(MakeRequestJson());
+  for (auto _ : state) {
+    auto encoded = EncodeMessage(ParseJson(request->Dump()), kEncoding);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+BENCHMARK_TEMPLATE(BM_RequestEncodeViaText, MessageEncoding::kCbor);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <benchmark/benchmark.h>
+#include <jsonrpc/endpoint/dispatcher.hpp>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "../tests/common/mock_transport.hpp"
+
+using jsonrpc::endpoint::Dispatcher;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::test::MockTransport;
+using Json = nlohmann::json;
+
+/**
+ * @brief Cost of dispatching without any I/O
+ *
+ * Dispatcher::DispatchRequest for single requests and batches, and a full
+ * server round trip through RpcEndpoint over the MockTransport, which hands
+ * messages over in memory. Everything runs on one io_context thread, so the
+ * figures are the library's own CPU cost per call.
+ */
+
+namespace {
+
+auto EchoHandler(std::optional<Json>&& params) -> asio::awaitable<Json> {
+  co_return params ? std::move(*params) : Json();
+}
+
+auto MakeRequest(int id) -> std::string {
+  return R"({"jsonrpc":"2.0","method":"echo","params":{"line":42},"id":)" +
+         std::to_string(id) + "}";
+}
+
+auto MakeBatch(std::size_t size) -> std::string {
+  std::string batch = "[";
+  for (std::size_t i = 0; i < size; ++i) {
+    if (i > 0) {
+      batch += ',';
+    }
+    batch += MakeRequest(static_cast<int>(i));
+  }
+  return batch + "]";
+}
+
+// Runs the benchmark loop inside a coroutine on a single-threaded io_context
+template <typename Body>
+void RunOnIoContext(benchmark::State& state, Body body) {
+  spdlog::set_level(spdlog::level::warn);
+  asio::io_context io_ctx;
+  asio::co_spawn(
+      io_ctx,
+      [&state, &body, executor = io_ctx.get_executor()]() {
+        return body(state, executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+void BM_DispatchSingle(benchmark::State& state) {
+  RunOnIoContext(
+      state,
+      [](benchmark::State& state,
+         asio::any_io_executor executor) -> asio::awaitable<void> {
+        Dispatcher dispatcher(executor);
+        dispatcher.RegisterMethodCall("echo", EchoHandler);
+        const auto request = MakeRequest(1);
+        for (auto _ : state) {
+          auto response = co_await dispatcher.DispatchRequest(request);
+          benchmark::DoNotOptimize(response);
+        }
+      });
+}
+BENCHMARK(BM_DispatchSingle);
+
+void BM_DispatchBatch(benchmark::State& state) {
+  const auto size = static_cast<std::size_t>(state.range(0));
+  RunOnIoContext(
+      state,
+      [size](benchmark::State& state,
+             asio::any_io_executor executor) -> asio::awaitable<void> {
+        Dispatcher dispatcher(executor);
+        dispatcher.RegisterMethodCall("echo", EchoHandler);
+        const auto batch = MakeBatch(size);
+        for (auto _ : state) {
+          auto response = co_await dispatcher.DispatchRequest(batch);
+          benchmark::DoNotOptimize(response);
+        }
+        state.SetItemsProcessed(
+            static_cast<std::int64_t>(state.iterations() * size));
+      });
+}
+BENCHMARK(BM_DispatchBatch)->RangeMultiplier(4)->Range(1, 64);
+
+// Injects a request and yields until the endpoint has answered it
+void BM_MockRoundTrip(benchmark::State& state) {
+  RunOnIoContext(
+      state,
+      [](benchmark::State& state,
+         asio::any_io_executor executor) -> asio::awaitable<void> {
+        auto transport = std::make_unique<MockTransport>(executor);
+        auto& mock = *transport;
+        auto server =
+            std::make_unique<RpcEndpoint>(executor, std::move(transport));
+        server->RegisterMethodCall("echo", EchoHandler);
+        if (!co_await server->Start()) {
+          state.SkipWithError("Endpoint failed to start");
+          co_return;
+        }
+
+        const auto request = MakeRequest(1);
+        for (auto _ : state) {
+          mock.ClearSentRequests();
+          mock.SetMessage(request);
+          while (mock.GetSentRequests().empty()) {
+            co_await asio::post(executor, asio::use_awaitable);
+          }
+        }
+        state.SetItemsProcessed(state.iterations());
+        co_await server->Shutdown();
+        co_await server->WaitForHandlers();
+      });
+}
+BENCHMARK(BM_MockRoundTrip);
+
+}  // namespace
+
+BENCHMARK_MAIN();
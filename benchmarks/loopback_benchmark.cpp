@@ -0,0 +1,279 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <asio/experimental/parallel_group.hpp>
+#include <benchmark/benchmark.h>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <jsonrpc/endpoint/metrics.hpp>
+#include <jsonrpc/endpoint/rpc_server.hpp>
+#include <jsonrpc/transport/framed_pipe_transport.hpp>
+#include <jsonrpc/transport/io_backend.hpp>
+#include <jsonrpc/transport/pipe_acceptor.hpp>
+#include <jsonrpc/transport/pipe_transport.hpp>
+#include <jsonrpc/transport/socket_acceptor.hpp>
+#include <jsonrpc/transport/socket_transport.hpp>
+#include <spdlog/spdlog.h>
+
+using jsonrpc::endpoint::LatencyHistogram;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::RpcServer;
+using jsonrpc::endpoint::ServerOptions;
+using jsonrpc::transport::Framing;
+using jsonrpc::transport::TransportOptions;
+using Json = nlohmann::json;
+
+/**
+ * @brief Round trips through real sockets on this machine
+ *
+ * A server on its own thread echoes calls back over a unix socket, a framed
+ * unix socket or TCP on 127.0.0.1. The round trip benchmarks make one call at
+ * a time and report the p50 and p99 latency next to the mean. The load
+ * generator runs N clients at once over TCP, each with one call in flight,
+ * and reports their combined throughput. Its largest run needs about 20k
+ * descriptors, so raise ulimit -n first.
+ *
+ * Every result is labelled with the I/O backend of the build; compare a
+ * default build with one configured with JSONRPC_WITH_IO_URING.
+ *
+ * Wall clock time is used throughout, since most of the work happens on the
+ * server thread.
+ */
+
+namespace {
+
+enum class Loopback { kPipe, kFramedPipe, kSocket };
+
+constexpr std::size_t kMaxClients = 10240;
+
+// Both ends of the TCP benchmarks use Content-Length framing, so concurrent
+// messages can never run together
+auto SocketOptions() -> TransportOptions {
+  TransportOptions options;
+  options.framing = Framing::kContentLength;
+  return options;
+}
+
+/**
+ * @brief An echo server running on a thread of its own
+ */
+class LoopbackServer {
+ public:
+  explicit LoopbackServer(Loopback kind)
+      : kind_(kind),
+        socket_path_(
+            "/tmp/jsonrpc_loopback_benchmark_" +
+            std::to_string(static_cast<int>(kind))),
+        work_guard_(asio::make_work_guard(io_)) {
+    std::unique_ptr<jsonrpc::transport::Acceptor> acceptor;
+    jsonrpc::transport::SocketAcceptor* socket_acceptor = nullptr;
+    switch (kind_) {
+      case Loopback::kPipe:
+        acceptor = std::make_unique<jsonrpc::transport::PipeAcceptor>(
+            io_.get_executor(), socket_path_);
+        break;
+      case Loopback::kFramedPipe:
+        acceptor = std::make_unique<jsonrpc::transport::FramedPipeAcceptor>(
+            io_.get_executor(), socket_path_);
+        break;
+      case Loopback::kSocket: {
+        auto socket = std::make_unique<jsonrpc::transport::SocketAcceptor>(
+            io_.get_executor(), "127.0.0.1", 0, SocketOptions());
+        socket_acceptor = socket.get();
+        acceptor = std::move(socket);
+        break;
+      }
+    }
+
+    ServerOptions options;
+    options.max_connections = kMaxClients;
+    server_ = std::make_unique<RpcServer>(
+        io_.get_executor(), std::move(acceptor), options);
+    server_->RegisterMethodCall(
+        "echo", [](std::optional<Json>&& params) -> asio::awaitable<Json> {
+          co_return params ? std::move(*params) : Json();
+        });
+
+    // Runs the io_context here until the acceptor listens
+    bool started = false;
+    asio::co_spawn(
+        io_, server_->Start(),
+        [&started](std::exception_ptr, auto) { started = true; });
+    while (!started) {
+      io_.run_one();
+    }
+    if (socket_acceptor != nullptr) {
+      port_ = socket_acceptor->LocalPort();
+    }
+    thread_ = std::thread([this] { io_.run(); });
+  }
+
+  LoopbackServer(const LoopbackServer&) = delete;
+  LoopbackServer(LoopbackServer&&) = delete;
+  auto operator=(const LoopbackServer&) -> LoopbackServer& = delete;
+  auto operator=(LoopbackServer&&) -> LoopbackServer& = delete;
+
+  ~LoopbackServer() {
+    asio::co_spawn(io_, server_->Shutdown(), asio::detached);
+    work_guard_.reset();
+    thread_.join();
+  }
+
+  /// A client transport for this server, to be started by the endpoint
+  auto Connect(asio::any_io_executor executor) const
+      -> std::unique_ptr<jsonrpc::transport::Transport> {
+    switch (kind_) {
+      case Loopback::kPipe:
+        return std::make_unique<jsonrpc::transport::PipeTransport>(
+            executor, socket_path_);
+      case Loopback::kFramedPipe:
+        return std::make_unique<jsonrpc::transport::FramedPipeTransport>(
+            executor, socket_path_, false);
+      case Loopback::kSocket:
+        break;
+    }
+    return std::make_unique<jsonrpc::transport::SocketTransport>(
+        executor, "127.0.0.1", port_, false, SocketOptions());
+  }
+
+ private:
+  Loopback kind_;
+  std::string socket_path_;
+  uint16_t port_ = 0;
+  asio::io_context io_;
+  asio::executor_work_guard<asio::io_context::executor_type> work_guard_;
+  std::unique_ptr<RpcServer> server_;
+  std::thread thread_;
+};
+
+auto MakeParams() -> Json {
+  return {{"uri", "file:///src/main.cpp"}, {"line", 42}};
+}
+
+// One echo call timed into the histogram
+auto TimedCall(
+    RpcEndpoint& client, const Json& params, LatencyHistogram& latency)
+    -> asio::awaitable<bool> {
+  const auto start = std::chrono::steady_clock::now();
+  auto result = co_await client.SendMethodCall("echo", params);
+  latency.Record(std::chrono::steady_clock::now() - start);
+  co_return result.has_value();
+}
+
+void ReportLatency(benchmark::State& state, const LatencyHistogram& latency) {
+  state.SetLabel(std::string(
+      jsonrpc::transport::IoBackendName(jsonrpc::transport::kIoBackend)));
+  const auto snapshot = latency.Snapshot();
+  state.counters["p50_us"] =
+      static_cast<double>(snapshot.Percentile(0.5).count());
+  state.counters["p99_us"] =
+      static_cast<double>(snapshot.Percentile(0.99).count());
+}
+
+void BM_LoopbackRoundTrip(benchmark::State& state, Loopback kind) {
+  spdlog::set_level(spdlog::level::warn);
+  LoopbackServer server(kind);
+  LatencyHistogram latency;
+
+  asio::io_context io_ctx;
+  auto run = [&]() -> asio::awaitable<void> {
+    auto executor = co_await asio::this_coro::executor;
+    auto client =
+        co_await RpcEndpoint::CreateClient(executor, server.Connect(executor));
+    if (!client) {
+      state.SkipWithError("Client failed to connect");
+      co_return;
+    }
+    const auto params = MakeParams();
+    for (auto _ : state) {
+      if (!co_await TimedCall(**client, params, latency)) {
+        state.SkipWithError("Call failed");
+        break;
+      }
+    }
+    co_await (*client)->Shutdown();
+  };
+  asio::co_spawn(io_ctx, run, asio::detached);
+  io_ctx.run();
+
+  state.SetItemsProcessed(state.iterations());
+  ReportLatency(state, latency);
+}
+BENCHMARK_CAPTURE(BM_LoopbackRoundTrip, pipe, Loopback::kPipe)->UseRealTime();
+BENCHMARK_CAPTURE(BM_LoopbackRoundTrip, framed_pipe, Loopback::kFramedPipe)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_LoopbackRoundTrip, socket, Loopback::kSocket)
+    ->UseRealTime();
+
+/**
+ * Load generator: every iteration, each of N clients makes kCallsPerRound
+ * calls back to back, all clients at the same time.
+ */
+void BM_LoadGenerator(benchmark::State& state) {
+  constexpr int kCallsPerRound = 100;
+  spdlog::set_level(spdlog::level::warn);
+  const auto client_count = static_cast<std::size_t>(state.range(0));
+  LoopbackServer server(Loopback::kSocket);
+  LatencyHistogram latency;
+
+  asio::io_context io_ctx;
+  auto run = [&]() -> asio::awaitable<void> {
+    auto executor = co_await asio::this_coro::executor;
+    std::vector<std::unique_ptr<RpcEndpoint>> clients;
+    for (std::size_t i = 0; i < client_count; ++i) {
+      auto client = co_await RpcEndpoint::CreateClient(
+          executor, server.Connect(executor));
+      if (!client) {
+        state.SkipWithError("Client failed to connect; raise ulimit -n");
+        co_return;
+      }
+      clients.push_back(std::move(*client));
+    }
+
+    const auto params = MakeParams();
+    auto round = [&](RpcEndpoint& client) -> asio::awaitable<void> {
+      for (int i = 0; i < kCallsPerRound; ++i) {
+        co_await TimedCall(client, params, latency);
+      }
+    };
+    using RoundOp = decltype(asio::co_spawn(
+        executor, round(*clients.front()), asio::deferred));
+
+    for (auto _ : state) {
+      std::vector<RoundOp> rounds;
+      rounds.reserve(clients.size());
+      for (auto& client : clients) {
+        rounds.push_back(
+            asio::co_spawn(executor, round(*client), asio::deferred));
+      }
+      co_await asio::experimental::make_parallel_group(std::move(rounds))
+          .async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
+    }
+
+    for (auto& client : clients) {
+      co_await client->Shutdown();
+    }
+  };
+  asio::co_spawn(io_ctx, run, asio::detached);
+  io_ctx.run();
+
+  state.SetItemsProcessed(
+      static_cast<std::int64_t>(state.iterations()) * kCallsPerRound *
+      static_cast<std::int64_t>(client_count));
+  ReportLatency(state, latency);
+}
+BENCHMARK(BM_LoadGenerator)
+    ->ArgName("clients")
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->Arg(kMaxClients)
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <asio/experimental/parallel_group.hpp>
+#include <fmt/core.h>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <jsonrpc/transport/pipe_transport.hpp>
+#include <spdlog/spdlog.h>
+
+using jsonrpc::endpoint::EndpointOptions;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::transport::PipeTransport;
+using Json = nlohmann::json;
+
+/**
+ * @brief Handler thread scaling benchmark
+ *
+ * One client keeps a fixed number of calls in flight against one server over
+ * a unix socket. Each call burns a fixed amount of CPU in the handler. The
+ * server's I/O runs on a single thread while handlers run on a thread_pool,
+ * so throughput should grow close to linearly with the pool size until the
+ * I/O thread saturates.
+ *
+ * Usage: threading_benchmark [max_threads] [calls] [work_us] [in_flight]
+ */
+
+namespace {
+
+struct Config {
+  int max_threads = 16;
+  int calls = 20000;
+  std::chrono::microseconds work{200};
+  int in_flight = 128;
+};
+
+// Spins instead of sleeping so the handler really occupies its thread
+void BurnCpu(std::chrono::microseconds duration) {
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+auto RunClient(
+    asio::any_io_executor executor, std::string socket_path,
+    const Config& config) -> asio::awaitable<std::chrono::nanoseconds> {
+  EndpointOptions options;
+  options.request_timeout = std::nullopt;
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor, std::make_unique<PipeTransport>(executor, socket_path),
+      options);
+  if (!client) {
+    spdlog::error("Client failed to start: {}", client.error().Message());
+    co_return std::chrono::nanoseconds{0};
+  }
+
+  std::atomic<int> next{0};
+  auto worker = [&]() -> asio::awaitable<void> {
+    while (next++ < config.calls) {
+      auto result = co_await (*client)->SendMethodCall("work");
+      if (!result) {
+        spdlog::error("Call failed: {}", result.error().Message());
+      }
+    }
+  };
+
+  using WorkerOp = decltype(asio::co_spawn(executor, worker, asio::deferred));
+  std::vector<WorkerOp> workers;
+  for (int i = 0; i < config.in_flight; ++i) {
+    workers.push_back(asio::co_spawn(executor, worker, asio::deferred));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  co_await asio::experimental::make_parallel_group(std::move(workers))
+      .async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  co_await (*client)->Shutdown();
+  co_return elapsed;
+}
+
+// Returns the throughput in calls per second
+auto RunRound(int threads, const Config& config) -> double {
+  const std::string socket_path =
+      "/tmp/jsonrpc_threading_benchmark_" + std::to_string(threads);
+
+  asio::io_context server_io;
+  asio::thread_pool handler_pool(threads);
+
+  EndpointOptions server_options;
+  server_options.handler_executor = handler_pool.get_executor();
+  auto server = std::make_unique<RpcEndpoint>(
+      server_io.get_executor(),
+      std::make_unique<PipeTransport>(
+          server_io.get_executor(), socket_path, true),
+      server_options);
+  server->RegisterMethodCall(
+      "work",
+      [work = config.work](std::optional<Json>) -> asio::awaitable<Json> {
+        BurnCpu(work);
+        co_return true;
+      });
+
+  // Start() completes once the client has connected
+  asio::co_spawn(server_io, server->Start(), asio::detached);
+  auto work_guard = asio::make_work_guard(server_io);
+  std::thread server_thread([&server_io] { server_io.run(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  asio::io_context client_io;
+  std::chrono::nanoseconds elapsed{0};
+  asio::co_spawn(
+      client_io, RunClient(client_io.get_executor(), socket_path, config),
+      [&elapsed](std::exception_ptr eptr, std::chrono::nanoseconds result) {
+        if (!eptr) {
+          elapsed = result;
+        }
+      });
+  client_io.run();
+
+  asio::co_spawn(server_io, server->Shutdown(), asio::detached);
+  work_guard.reset();
+  server_thread.join();
+  handler_pool.join();
+
+  if (elapsed.count() == 0) {
+    return 0.0;
+  }
+  return config.calls / std::chrono::duration<double>(elapsed).count();
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  spdlog::set_level(spdlog::level::warn);
+
+  Config config;
+  if (argc > 1) {
+    config.max_threads = std::atoi(argv[1]);
+  }
+  if (argc > 2) {
+    config.calls = std::atoi(argv[2]);
+  }
+  if (argc > 3) {
+    config.work = std::chrono::microseconds(std::atoi(argv[3]));
+  }
+  if (argc > 4) {
+    config.in_flight = std::atoi(argv[4]);
+  }
+
+  fmt::print(
+      "{} calls, {} us of handler work each, {} in flight\n", config.calls,
+      config.work.count(), config.in_flight);
+  fmt::print(
+      "{:>8} {:>12} {:>8} {:>10}\n", "threads", "calls/s", "speedup",
+      "efficiency");
+
+  double baseline = 0.0;
+  for (int threads = 1; threads <= config.max_threads; threads *= 2) {
+    auto throughput = RunRound(threads, config);
+    if (threads == 1) {
+      baseline = throughput;
+    }
+    auto speedup = baseline > 0 ? throughput / baseline : 0.0;
+    fmt::print(
+        "{:>8} {:>12.0f} {:>8.2f} {:>9.0f}%\n", threads, throughput, speedup,
+        100.0 * speedup / threads);
+  }
+
+  return 0;
+}
@@ -0,0 +1,292 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <thread>
+#include <utility>
+
+#include <asio.hpp>
+#include <fmt/core.h>
+#include <jsonrpc/endpoint/endpoint.hpp>
+#include <jsonrpc/endpoint/traffic_replay.hpp>
+#include <jsonrpc/transport/framed_pipe_transport.hpp>
+#include <jsonrpc/transport/pipe_transport.hpp>
+#include <jsonrpc/transport/socket_transport.hpp>
+#include <spdlog/spdlog.h>
+
+using jsonrpc::endpoint::ReplayOptions;
+using jsonrpc::endpoint::ReplayReport;
+using jsonrpc::endpoint::ResourceCounters;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::TrafficReplay;
+using jsonrpc::transport::FramedPipeTransport;
+using jsonrpc::transport::PipeTransport;
+using jsonrpc::transport::SocketTransport;
+using jsonrpc::transport::Transport;
+using Json = nlohmann::json;
+
+/**
+ * @brief Replays recorded traffic into a server and reports what it cost
+ *
+ * Reads a capture written by TrafficCapture, or any JSONL file of JSON-RPC
+ * messages, and sends its calls and notifications to a server over a unix
+ * socket or TCP, as fast as the in-flight limit allows, at a fixed rate or
+ * at the recorded pace. Reports throughput and latency percentiles per
+ * method, with heap allocations and CPU time of this process. Both are
+ * split by method only with --in-flight 1, where each message has the
+ * process to itself; otherwise the totals are averaged over all messages.
+ *
+ * --echo serves the capture's methods in this process as well, answering
+ * each call with its params, to measure the library on its own. The CPU
+ * and allocation figures then cover both ends.
+ *
+ * Usage: traffic_replay CAPTURE [--pipe PATH | --tcp HOST:PORT] [--framed]
+ *   [--rate N | --recorded [--speed X]] [--in-flight N] [--loops N] [--echo]
+ */
+
+namespace {
+
+std::atomic<std::uint64_t> allocation_count{0};
+
+struct Config {
+  std::string capture;
+  std::string socket_path = "/tmp/jsonrpc_traffic_replay";
+  std::optional<std::string> host;
+  std::uint16_t port = 0;
+  bool framed = false;
+  bool echo = false;
+  ReplayOptions replay{};
+};
+
+constexpr std::string_view kUsage =
+    "Usage: traffic_replay CAPTURE [--pipe PATH | --tcp HOST:PORT] "
+    "[--framed]\n"
+    "  [--rate N | --recorded [--speed X]] [--in-flight N] [--loops N] "
+    "[--echo]\n";
+
+auto ParseArgs(int argc, char** argv) -> std::optional<Config> {
+  Config config;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--pipe" && has_value) {
+      config.socket_path = argv[++i];
+    } else if (arg == "--tcp" && has_value) {
+      const std::string_view address = argv[++i];
+      const auto colon = address.rfind(':');
+      if (colon == std::string_view::npos) {
+        return std::nullopt;
+      }
+      config.host = std::string(address.substr(0, colon));
+      config.port = static_cast<std::uint16_t>(
+          std::atoi(std::string(address.substr(colon + 1)).c_str()));
+    } else if (arg == "--framed") {
+      config.framed = true;
+    } else if (arg == "--echo") {
+      config.echo = true;
+    } else if (arg == "--rate" && has_value) {
+      config.replay.rate = std::atof(argv[++i]);
+    } else if (arg == "--recorded") {
+      config.replay.recorded_timing = true;
+    } else if (arg == "--speed" && has_value) {
+      config.replay.speed = std::atof(argv[++i]);
+    } else if (arg == "--in-flight" && has_value) {
+      config.replay.max_in_flight =
+          static_cast<std::size_t>(std::atoi(argv[++i]));
+    } else if (arg == "--loops" && has_value) {
+      config.replay.loops = static_cast<std::size_t>(std::atoi(argv[++i]));
+    } else if (!arg.starts_with("--") && config.capture.empty()) {
+      config.capture = std::string(arg);
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (config.capture.empty()) {
+    return std::nullopt;
+  }
+  return config;
+}
+
+auto MakeTransport(
+    asio::any_io_executor executor, const Config& config, bool is_server)
+    -> std::unique_ptr<Transport> {
+  if (config.host) {
+    return std::make_unique<SocketTransport>(
+        executor, *config.host, config.port, is_server);
+  }
+  if (config.framed) {
+    return std::make_unique<FramedPipeTransport>(
+        executor, config.socket_path, is_server);
+  }
+  return std::make_unique<PipeTransport>(
+      executor, config.socket_path, is_server);
+}
+
+auto ReadCounters() -> ResourceCounters {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  const auto cpu = std::chrono::seconds(usage.ru_utime.tv_sec) +
+                   std::chrono::microseconds(usage.ru_utime.tv_usec) +
+                   std::chrono::seconds(usage.ru_stime.tv_sec) +
+                   std::chrono::microseconds(usage.ru_stime.tv_usec);
+  return ResourceCounters{
+      .allocations = allocation_count.load(std::memory_order_relaxed),
+      .cpu = std::chrono::duration_cast<std::chrono::microseconds>(cpu)};
+}
+
+// Answers every method of the capture with its params
+void RegisterEcho(RpcEndpoint& server, const TrafficReplay& replay) {
+  std::set<std::string> calls;
+  std::set<std::string> notifications;
+  for (const auto& captured : replay.Messages()) {
+    const auto& method =
+        captured.message["method"].get_ref<const std::string&>();
+    (captured.message.contains("id") ? calls : notifications).insert(method);
+  }
+  for (const auto& method : calls) {
+    server.RegisterMethodCall(
+        method, [](std::optional<Json> params) -> asio::awaitable<Json> {
+          co_return params ? std::move(*params) : Json();
+        });
+  }
+  for (const auto& method : notifications) {
+    server.RegisterNotification(
+        method, [](std::optional<Json>) -> asio::awaitable<void> {
+          co_return;
+        });
+  }
+}
+
+auto RunReplay(
+    asio::any_io_executor executor, const Config& config,
+    const TrafficReplay& replay, ReplayReport& report)
+    -> asio::awaitable<void> {
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor, MakeTransport(executor, config, false));
+  if (!client) {
+    spdlog::error("Client failed to start: {}", client.error().Message());
+    co_return;
+  }
+  report = co_await replay.Run(**client, config.replay);
+  co_await (*client)->Shutdown();
+}
+
+auto PerMessage(std::optional<ResourceCounters> resources, std::uint64_t sent)
+    -> std::pair<std::string, std::string> {
+  if (!resources || sent == 0) {
+    return {"-", "-"};
+  }
+  const auto count = static_cast<double>(sent);
+  const auto allocations = static_cast<double>(resources->allocations);
+  const auto cpu = static_cast<double>(resources->cpu.count());
+  return {
+      fmt::format("{:.1f}", allocations / count),
+      fmt::format("{:.1f}", cpu / count)};
+}
+
+void PrintReport(const ReplayReport& report) {
+  fmt::print(
+      "{:<28} {:>8} {:>7} {:>10} {:>8} {:>8} {:>8} {:>11} {:>11}\n", "method",
+      "sent", "errors", "msgs/s", "p50 us", "p99 us", "max us", "allocs/msg",
+      "cpu us/msg");
+  for (const auto& [name, method] : report.methods) {
+    const auto [allocations, cpu] = PerMessage(method.resources, method.sent);
+    fmt::print(
+        "{:<28} {:>8} {:>7} {:>10.0f} {:>8} {:>8} {:>8} {:>11} {:>11}\n",
+        name, method.sent, method.errors, report.Throughput(method.sent),
+        method.latency.Percentile(0.5).count(),
+        method.latency.Percentile(0.99).count(), method.latency.max.count(),
+        allocations, cpu);
+  }
+  const auto [allocations, cpu] = PerMessage(report.resources, report.sent);
+  fmt::print(
+      "{:<28} {:>8} {:>7} {:>10.0f} {:>8} {:>8} {:>8} {:>11} {:>11}\n",
+      "total", report.sent, report.errors, report.Throughput(report.sent), "",
+      "", "", allocations, cpu);
+}
+
+}  // namespace
+
+// Counts every allocation in the process; the matching deletes stay free
+auto operator new(std::size_t size) -> void* {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+
+auto main(int argc, char** argv) -> int {
+  spdlog::set_level(spdlog::level::warn);
+
+  auto config = ParseArgs(argc, argv);
+  if (!config) {
+    fmt::print(stderr, "{}", kUsage);
+    return 1;
+  }
+  auto replay = TrafficReplay::LoadFile(config->capture);
+  if (!replay) {
+    fmt::print(stderr, "{}\n", replay.error().Message());
+    return 1;
+  }
+  config->replay.counters = ReadCounters;
+  fmt::print(
+      "{} messages per loop, {} lines or messages skipped\n", replay->Size(),
+      replay->Skipped());
+
+  asio::io_context server_io;
+  std::unique_ptr<RpcEndpoint> server;
+  std::thread server_thread;
+  auto work_guard = asio::make_work_guard(server_io);
+  if (config->echo) {
+    server = std::make_unique<RpcEndpoint>(
+        server_io.get_executor(),
+        MakeTransport(server_io.get_executor(), *config, true));
+    RegisterEcho(*server, *replay);
+    std::atomic<bool> listening{false};
+    asio::co_spawn(
+        server_io,
+        [&server, &listening]() -> asio::awaitable<void> {
+          if (!co_await server->Listen()) {
+            spdlog::error("Server failed to listen");
+          }
+          listening = true;
+          // Completes once the client has connected
+          co_await server->Start();
+        },
+        asio::detached);
+    server_thread = std::thread([&server_io] { server_io.run(); });
+    while (!listening) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  asio::io_context client_io;
+  ReplayReport report;
+  asio::co_spawn(
+      client_io, RunReplay(client_io.get_executor(), *config, *replay, report),
+      asio::detached);
+  client_io.run();
+  PrintReport(report);
+
+  if (server) {
+    asio::co_spawn(server_io, server->Shutdown(), asio::detached);
+    work_guard.reset();
+    server_thread.join();
+  }
+  return 0;
+}
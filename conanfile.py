@@ -34,21 +34,44 @@ class JsonRpcRecipe(ConanFile):
     ]
 
     test_requires = [
-        "catch2/3.8.0"
+        "catch2/3.8.0",
+        "benchmark/1.9.1"
     ]
 
     # Define options for building examples and tests
     options = {
         "build_examples": [True, False],
-        "build_tests": [True, False]
+        "build_tests": [True, False],
+        "json_backend": ["nlohmann", "simdjson"],
+        "with_zstd": [True, False],
+        "with_lz4": [True, False],
+        "with_io_uring": [True, False],
+        "asio_frame_cache_size": ["ANY"]
     }
     default_options = {
         "build_examples": False,
-        "build_tests": False
+        "build_tests": False,
+        "json_backend": "nlohmann",
+        "with_zstd": False,
+        "with_lz4": False,
+        "with_io_uring": False,
+        "asio_frame_cache_size": "8"
     }
 
     exports_sources = "CMakeLists.txt", "src/*", "include/*", "LICENSE", "README.md"
 
+    def requirements(self):
+        """ Add the optional JSON parser backend, compression codecs and
+        io_uring """
+        if self.options.json_backend == "simdjson":
+            self.requires("simdjson/3.10.1")
+        if self.options.with_zstd:
+            self.requires("zstd/1.5.6")
+        if self.options.with_lz4:
+            self.requires("lz4/1.9.4")
+        if self.options.with_io_uring:
+            self.requires("liburing/2.6")
+
     def layout(self):
         """ Define the layout of the project """
         cmake_layout(self)
@@ -62,6 +85,13 @@ class JsonRpcRecipe(ConanFile):
         tc.cache_variables["USE_CONAN"] = "ON"
         tc.cache_variables["BUILD_EXAMPLES"] = self.options.build_examples
         tc.cache_variables["BUILD_TESTS"] = self.options.build_tests
+        tc.cache_variables["JSONRPC_JSON_BACKEND"] = str(self.options.json_backend)
+        tc.cache_variables["JSONRPC_WITH_ZSTD"] = bool(self.options.with_zstd)
+        tc.cache_variables["JSONRPC_WITH_LZ4"] = bool(self.options.with_lz4)
+        tc.cache_variables["JSONRPC_WITH_IO_URING"] = bool(
+            self.options.with_io_uring)
+        tc.cache_variables["JSONRPC_ASIO_FRAME_CACHE_SIZE"] = str(
+            self.options.asio_frame_cache_size)
         tc.generator = "Ninja"
         tc.generate()
 
@@ -80,5 +110,13 @@ class JsonRpcRecipe(ConanFile):
         """ Define package information for consumers """
         self.cpp_info.libs = ["jsonrpc"]
 
+        # Every user of asio has to see the same cache size as the library
+        self.cpp_info.defines = [
+            f"ASIO_RECYCLING_ALLOCATOR_CACHE_SIZE={self.options.asio_frame_cache_size}"
+        ]
+        # And the same reactor
+        if self.options.with_io_uring:
+            self.cpp_info.defines += ["ASIO_HAS_IO_URING", "ASIO_DISABLE_EPOLL"]
+
         # Set the package as installable with pkgconfig
         self.cpp_info.set_property("pkg_config_name", "jsonrpc")
@@ -12,8 +12,8 @@ import * as vscode from "vscode";
  * LSP Client Example for VS Code Extension
  *
  * This is a simple demonstration of a Language Server Protocol (LSP) client
- * implementation for VS Code. It connects to our C++ LSP server using pipe
- * transport and demonstrates basic language server capabilities.
+ * implementation for VS Code. It launches our C++ LSP server over stdio and
+ * demonstrates basic language server capabilities.
  */
 
 let client: LanguageClient;
@@ -59,11 +59,11 @@ export function activate(context: ExtensionContext) {
   const serverOptions: ServerOptions = {
     run: {
       command: serverPath,
-      transport: TransportKind.pipe,
+      transport: TransportKind.stdio,
     },
     debug: {
       command: serverPath,
-      transport: TransportKind.pipe,
+      transport: TransportKind.stdio,
     },
   };
 
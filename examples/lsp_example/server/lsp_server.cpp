@@ -1,10 +1,12 @@
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <asio.hpp>
 #include <jsonrpc/endpoint/endpoint.hpp>
 #include <jsonrpc/transport/framed_pipe_transport.hpp>
+#include <jsonrpc/transport/stdio_transport.hpp>
 #include <nlohmann/json.hpp>
 #include <spdlog/sinks/ostream_sink.h>
 #include <spdlog/spdlog.h>
@@ -12,20 +14,29 @@
 using Json = nlohmann::json;
 using jsonrpc::endpoint::RpcEndpoint;
 using jsonrpc::transport::FramedPipeTransport;
+using jsonrpc::transport::StdioTransport;
+using jsonrpc::transport::Transport;
 
 /**
- * @brief LSP Server Example using Framed Pipe Transport
+ * @brief LSP Server Example over stdio or a framed pipe
  *
- * This is a simple demonstration of a JSON-RPC server using framed pipe
- * transport. While this example shows the full flexibility of the library,
- * production applications might benefit from helper functions to reduce
- * boilerplate.
+ * This is a simple demonstration of a JSON-RPC server the way editors
+ * launch language servers: with --stdio it talks over stdin and stdout,
+ * with --pipe=<name> over a framed Unix domain socket. While this example
+ * shows the full flexibility of the library, production applications might
+ * benefit from helper functions to reduce boilerplate.
  */
 
-auto ParsePipeArguments(const std::vector<std::string>& args) -> std::string {
+// Returns the pipe name, or nullopt for stdio
+auto ParseTransportArguments(const std::vector<std::string>& args)
+    -> std::optional<std::string> {
   const std::string pipe_prefix = "--pipe=";
+  if (args.size() >= 2 && args[1] == "--stdio") {
+    return std::nullopt;
+  }
   if (args.size() < 2 || !args[1].starts_with(pipe_prefix)) {
-    throw std::invalid_argument("Usage: <executable> --pipe=<pipe name>");
+    throw std::invalid_argument(
+        "Usage: <executable> --stdio | --pipe=<pipe name>");
   }
   return args[1].substr(pipe_prefix.length());
 }
@@ -86,11 +97,17 @@ void RegisterLSPHandlers(std::shared_ptr<RpcEndpoint> server) {
 }
 
 // Main server logic encapsulated in a function
-auto RunLSPServer(asio::any_io_executor executor, std::string pipe_name)
+auto RunLSPServer(
+    asio::any_io_executor executor, std::optional<std::string> pipe_name)
     -> asio::awaitable<void> {
   // Step 1: Create transport
-  auto transport =
-      std::make_unique<FramedPipeTransport>(executor, pipe_name, false);
+  std::unique_ptr<Transport> transport;
+  if (pipe_name) {
+    transport =
+        std::make_unique<FramedPipeTransport>(executor, *pipe_name, false);
+  } else {
+    transport = std::make_unique<StdioTransport>(executor);
+  }
 
   // Step 2: Create RPC endpoint
   auto server = std::make_shared<RpcEndpoint>(executor, std::move(transport));
@@ -120,9 +137,9 @@ auto HandleError(std::exception_ptr eptr) -> void {
 }
 
 auto main(int argc, char* argv[]) -> int {
-  // Step 1: Setup logging
-  auto cout_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(std::cout);
-  auto logger = std::make_shared<spdlog::logger>("server", cout_sink);
+  // Step 1: Setup logging; stdout may carry the protocol
+  auto cerr_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(std::cerr);
+  auto logger = std::make_shared<spdlog::logger>("server", cerr_sink);
   logger->set_pattern("[%n] [%l] %v");
   spdlog::set_default_logger(logger);
   spdlog::set_level(spdlog::level::debug);
@@ -130,8 +147,9 @@ auto main(int argc, char* argv[]) -> int {
 
   // Step 2: Parse command line arguments
   const std::vector<std::string> args(argv, argv + argc);
-  const std::string pipe_name = ParsePipeArguments(args);
-  spdlog::debug("LspExample starting server on pipe: {}", pipe_name);
+  const auto pipe_name = ParseTransportArguments(args);
+  spdlog::debug(
+      "LspExample starting server on {}", pipe_name.value_or("stdio"));
 
   // Step 3: Create an io_context for asio operations
   asio::io_context io_context;
@@ -26,15 +26,14 @@ auto RunClient(asio::any_io_executor executor) -> asio::awaitable<void> {
   auto client_result =
       co_await RpcEndpoint::CreateClient(executor, std::move(transport));
   auto client = std::move(client_result.value());
+  jsonrpc::endpoint::ServiceClient<CalculatorService, RpcEndpoint> calculator(
+      *client);
 
   // Call "add" method with typed params and result
   AddParams add_params{.a = 10.0, .b = 5.0};
 
-  // Send the method call with typed params and receive typed result
-  // Note how we specify the parameter and result types in the template
-  // arguments
-  auto add_result =
-      co_await client->SendMethodCall<AddParams, Result>("add", add_params);
+  // The service definition fixes the method name and the types
+  auto add_result = co_await calculator.Call<AddMethod>(add_params);
 
   // Access the result using the typed struct
   spdlog::info(
@@ -43,8 +42,7 @@ auto RunClient(asio::any_io_executor executor) -> asio::awaitable<void> {
 
   // Call "divide" method with typed params and result
   DivideParams div_params{.a = 10.0, .b = 2.0};
-  auto div_result = co_await client->SendMethodCall<DivideParams, Result>(
-      "divide", div_params);
+  auto div_result = co_await calculator.Call<DivideMethod>(div_params);
 
   spdlog::info(
       "Divide result: {} / {} = {}", div_params.a, div_params.b,
@@ -35,18 +35,9 @@ auto RunServer(asio::any_io_executor executor, std::string socket_path)
   // Create RPC endpoint
   auto server = std::make_shared<RpcEndpoint>(executor, std::move(transport));
 
-  // Register TYPED method calls using template methods
-  // Note how we specify the parameter and result types in the template
-  // arguments
-  server->RegisterMethodCall<AddParams, Result>(
-      "add", [](AddParams params) -> asio::awaitable<Result> {
-        return TypedCalculator::Add(std::move(params));
-      });
-
-  server->RegisterMethodCall<DivideParams, Result>(
-      "divide", [](DivideParams params) -> asio::awaitable<Result> {
-        return TypedCalculator::Divide(std::move(params));
-      });
+  // Register every method of the typed service at once
+  jsonrpc::endpoint::RegisterService<CalculatorService>(
+      *server, std::make_shared<TypedCalculator>());
 
   // Register stop notification with untyped (JSON) parameter
   server->RegisterNotification("stop", [server](std::optional<nlohmann::json>) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <asio/awaitable.hpp>
+#include <jsonrpc/endpoint/service.hpp>
 #include <nlohmann/json.hpp>
 
 // Simple parameter structs
@@ -19,23 +20,6 @@ struct Result {
   double value;
 };
 
-// Calculator implementation with typed methods
-class TypedCalculator {
- public:
-  // Typed method for addition
-  static auto Add(AddParams params) -> asio::awaitable<Result> {
-    co_return Result{params.a + params.b};
-  }
-
-  // Typed method for division
-  static auto Divide(DivideParams params) -> asio::awaitable<Result> {
-    if (params.b == 0) {
-      throw std::runtime_error("Division by zero");
-    }
-    co_return Result{params.a / params.b};
-  }
-};
-
 // Free functions for JSON serialization
 void to_json(nlohmann::json& j, const AddParams& params) {
   j = nlohmann::json{{"a", params.a}, {"b", params.b}};
@@ -62,3 +46,26 @@ void to_json(nlohmann::json& j, const Result& result) {
 void from_json(const nlohmann::json& j, Result& result) {
   j.at("value").get_to(result.value);
 }
+
+// The calculator's methods, shared by the server and the client
+using AddMethod = jsonrpc::endpoint::MethodCall<"add", AddParams, Result>;
+using DivideMethod =
+    jsonrpc::endpoint::MethodCall<"divide", DivideParams, Result>;
+using CalculatorService = jsonrpc::endpoint::Service<AddMethod, DivideMethod>;
+
+// Calculator implementation, one Handle overload per method
+class TypedCalculator {
+ public:
+  static auto Handle(AddMethod /*method*/, AddParams params)
+      -> asio::awaitable<Result> {
+    co_return Result{params.a + params.b};
+  }
+
+  static auto Handle(DivideMethod /*method*/, DivideParams params)
+      -> asio::awaitable<Result> {
+    if (params.b == 0) {
+      throw std::runtime_error("Division by zero");
+    }
+    co_return Result{params.a / params.b};
+  }
+};
@@ -1,63 +1,440 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <expected>
 #include <functional>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <asio.hpp>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
+#include "jsonrpc/endpoint/lazy_params.hpp"
+#include "jsonrpc/endpoint/metrics.hpp"
 #include "jsonrpc/endpoint/request.hpp"
 #include "jsonrpc/endpoint/response.hpp"
+#include "jsonrpc/endpoint/result_cache.hpp"
+#include "jsonrpc/endpoint/result_stream.hpp"
+#include "jsonrpc/endpoint/types.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
 
 namespace jsonrpc::endpoint {
 
+struct DispatcherOptions {
+  /// Batches with more elements are rejected with an invalid request error
+  std::size_t max_batch_size = kDefaultMaxBatchSize;
+
+  /// Maximum number of elements of one batch that run at the same time. Zero
+  /// runs every element concurrently.
+  std::size_t max_batch_concurrency = kDefaultMaxBatchConcurrency;
+
+  /// Notification that cancels a running method call of the same peer, named
+  /// by the "id" in its params. Empty turns cancellation off and saves the
+  /// bookkeeping per call.
+  std::string cancel_method = std::string(kCancelRequestMethod);
+
+  /// Results the cache of idempotent methods holds, across all methods
+  std::size_t result_cache_capacity = kDefaultResultCacheCapacity;
+
+  /// Independent parts of the result cache, each behind its own strand
+  std::size_t result_cache_shards = kDefaultResultCacheShards;
+
+  /// Independent parts of the table of calls cancel_method can name, each
+  /// behind its own strand
+  std::size_t running_call_shards = kDefaultRunningCallShards;
+};
+
+/// How a method's handler is scheduled relative to its other calls
+enum class HandlerExecution {
+  /// Calls run in parallel on the handler executor
+  kConcurrent,
+  /// Calls run one at a time, in the order they reach the dispatcher
+  kSerial,
+};
+
+/**
+ * @brief How bursts of one notification method fold into fewer handler runs
+ *
+ * The first notification of a key opens a window; the ones that arrive
+ * before it closes fold into its params, and the handler then runs once with
+ * the result. The window is not extended by later arrivals, so a steady
+ * stream still reaches the handler every window. Only notifications are
+ * coalesced; the calls metric still counts every message.
+ */
+struct CoalesceOptions {
+  /// How long the first notification of a key waits. Zero turns it off.
+  std::chrono::milliseconds window{0};
+
+  /// Groups notifications, e.g. by document; without one, all of the
+  /// method's notifications share a group. Lazy handlers' params are raw.
+  std::function<std::string(const std::optional<nlohmann::json>&)> key;
+
+  /// Folds newer params into the pending ones; without one the newest win
+  std::function<std::optional<nlohmann::json>(
+      std::optional<nlohmann::json> pending,
+      std::optional<nlohmann::json> newer)>
+      merge;
+};
+
+struct HandlerOptions {
+  HandlerExecution execution = HandlerExecution::kConcurrent;
+
+  /// Applies to notification handlers only
+  CoalesceOptions coalesce{};
+
+  /// Marks a method call idempotent: calls with equal params are answered
+  /// from the dispatcher's result cache for this long, and concurrent ones
+  /// share one handler run. Zero never caches; milliseconds::max() keeps
+  /// results until evicted or invalidated. Serial methods answer hits in
+  /// turn with their other calls. Ignored by streaming methods.
+  std::chrono::milliseconds cache_ttl{0};
+
+  /// Send queue class of the method's responses and streamed parts
+  transport::MessagePriority priority =
+      transport::MessagePriority::kInteractive;
+};
+
 class Dispatcher {
  public:
+  // Params are passed as an rvalue so handlers taking them by value receive
+  // the parsed message's params without a copy
   using MethodCallHandler = std::function<asio::awaitable<nlohmann::json>(
-      const std::optional<nlohmann::json>&)>;
-  using NotificationHandler = std::function<asio::awaitable<void>(
-      const std::optional<nlohmann::json>&)>;
+      std::optional<nlohmann::json>&&)>;
+  using NotificationHandler =
+      std::function<asio::awaitable<void>(std::optional<nlohmann::json>&&)>;
+
+  // Handlers that decode the params they need from the raw text themselves
+  using LazyMethodCallHandler =
+      std::function<asio::awaitable<nlohmann::json>(LazyParams)>;
+  using LazyNotificationHandler =
+      std::function<asio::awaitable<void>(LazyParams)>;
+
+  // Handlers that write their result in parts; the call is answered once the
+  // handler returns
+  using StreamingMethodCallHandler = std::function<asio::awaitable<void>(
+      std::optional<nlohmann::json>&&, ResultStream&)>;
+
+  /// Connection a message came in on. Keeps equal request ids of different
+  /// peers apart when several endpoints share one dispatcher.
+  using PeerId = std::uint64_t;
+
+  using Clock = std::chrono::steady_clock;
 
   explicit Dispatcher(
       asio::any_io_executor executor,
       std::shared_ptr<spdlog::logger> logger = nullptr);
 
+  Dispatcher(
+      asio::any_io_executor executor, DispatcherOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
   Dispatcher(const Dispatcher&) = delete;
   Dispatcher(Dispatcher&&) = delete;
   auto operator=(const Dispatcher&) -> Dispatcher& = delete;
   auto operator=(Dispatcher&&) -> Dispatcher& = delete;
   virtual ~Dispatcher() = default;
 
-  auto Logger() -> std::shared_ptr<spdlog::logger> {
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
     return logger_;
   }
 
   void RegisterMethodCall(
-      const std::string& method, const MethodCallHandler& handler);
+      const std::string& method, const MethodCallHandler& handler,
+      HandlerOptions options = {});
 
   void RegisterNotification(
-      const std::string& method, const NotificationHandler& handler);
+      const std::string& method, const NotificationHandler& handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call whose params are left as JSON text
+   *
+   * Messages parsed by the endpoint or DispatchRequest() skip building the
+   * params DOM for this method; the handler decodes what it reads through
+   * LazyParams.
+   */
+  void RegisterLazyMethodCall(
+      const std::string& method, LazyMethodCallHandler handler,
+      HandlerOptions options = {});
+
+  /// Notification counterpart of RegisterLazyMethodCall()
+  void RegisterLazyNotification(
+      const std::string& method, LazyNotificationHandler handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call that writes its result in parts
+   *
+   * Callers that set a partialResultToken in the params get the parts as
+   * $/progress notifications while the handler runs, sent through the
+   * sender passed to DispatchJson(). Without one, the response carries all
+   * parts as one array.
+   */
+  void RegisterStreamingMethodCall(
+      const std::string& method, StreamingMethodCallHandler handler,
+      HandlerOptions options = {});
+
+  /// Whether messages for the method should be parsed without their params
+  [[nodiscard]] auto WantsLazyParams(std::string_view method) const -> bool;
 
-  auto DispatchRequest(std::string request)
+  /// Whether any lazy handler is registered, so parsing can skip the check
+  [[nodiscard]] auto HasLazyHandlers() const -> bool {
+    return has_lazy_handlers_.load(std::memory_order_relaxed);
+  }
+
+  /// Hands out a fresh id for a connection served by this dispatcher
+  auto NewPeerId() -> PeerId {
+    return next_peer_id_++;
+  }
+
+  [[nodiscard]] auto CancelMethod() const -> const std::string& {
+    return options_.cancel_method;
+  }
+
+  /**
+   * @brief Drop the cached results of an idempotent method
+   *
+   * Call once the data the method reads has changed. Calls of it that are
+   * running when this is called do not store their results.
+   */
+  auto InvalidateCache(std::string_view method) -> asio::awaitable<void> {
+    co_await result_cache_.Invalidate(method);
+  }
+
+  /// Drop the cached results of every method
+  auto ClearCache() -> asio::awaitable<void> {
+    co_await result_cache_.Clear();
+  }
+
+  /**
+   * @brief Snapshot of the calls each registered method has served
+   *
+   * Like registration, not synchronized with RegisterMethodCall() and
+   * RegisterNotification(); safe while messages are being dispatched.
+   */
+  [[nodiscard]] auto GetMetrics() const -> DispatcherMetrics;
+
+  /// The handler executor, which runs handlers of parallel methods
+  [[nodiscard]] auto GetExecutor() const -> const asio::any_io_executor& {
+    return executor_;
+  }
+
+  /**
+   * @brief The executor a parsed message should be dispatched from
+   *
+   * Messages for serial methods map to that method's strand. Spawning their
+   * dispatch onto it in receive order makes the handlers run in receive
+   * order, even when the handler executor has many threads. Everything else
+   * maps to the handler executor.
+   */
+  [[nodiscard]] auto ExecutorFor(const nlohmann::json& message) const
+      -> asio::any_io_executor;
+
+  /**
+   * @brief The send queue class of the answers to a parsed message
+   *
+   * The priority the message's method was registered with. Batches and
+   * unknown methods are interactive.
+   */
+  [[nodiscard]] auto PriorityFor(const nlohmann::json& message) const
+      -> transport::MessagePriority;
+
+  auto DispatchRequest(std::string request, PeerId peer = 0)
+      -> asio::awaitable<std::optional<std::string>>;
+
+  /**
+   * @brief Dispatch a message that has already been parsed
+   *
+   * Params are moved out of the message and into the handler. Method calls
+   * run with a cancellation slot that the peer's cancel notification for
+   * their id emits on; a handler that fails after that is answered with
+   * kRequestCancelled.
+   *
+   * @param request A single request object or a batch array
+   * @param peer The connection the message came in on
+   * @param received_at When the message was read, for the queue latency
+   * metric; defaults to now
+   * @param sender Reaches the peer for streamed results; without one they
+   * are collected into the response
+   * @param handler_executor Runs the handlers of parallel methods instead of
+   * the handler executor, such as the thread the caller is pinned to.
+   * Serial methods stay on their strands.
+   * @param encoding What the response is written in; binary encodings are
+   * written from the results' DOM without going through JSON text
+   * @return The serialized response, or std::nullopt for notifications
+   */
+  auto DispatchJson(
+      nlohmann::json request, PeerId peer = 0,
+      std::optional<Clock::time_point> received_at = std::nullopt,
+      ResultStream::Sender sender = nullptr,
+      std::optional<asio::any_io_executor> handler_executor = std::nullopt,
+      transport::MessageEncoding encoding = transport::MessageEncoding::kJson)
       -> asio::awaitable<std::optional<std::string>>;
 
+  /**
+   * @brief Dispatch a single request, moving its params into the handler
+   *
+   * @return The response, or std::nullopt for notifications
+   */
+  auto DispatchRequest(Request request, PeerId peer = 0)
+      -> asio::awaitable<std::optional<Response>>;
+
  private:
-  auto DispatchSingleRequest(Request request)
+  // Strand and single token shared by all calls of one serial method
+  struct SerialLane;
+
+  // Notifications of a coalesced method waiting for their window to close
+  struct Coalescer;
+
+  // Everything registered under one method name. Routes are immutable once
+  // published, so a call holds its route instead of copying the handler, and
+  // re-registering a method does not disturb calls already in flight.
+  struct Route {
+    MethodCallHandler method_call;
+    // Set instead of method_call by RegisterStreamingMethodCall()
+    std::shared_ptr<StreamingMethodCallHandler> streaming_call;
+    NotificationHandler notification;
+    std::shared_ptr<SerialLane> lane;
+    // Set when the notification handler coalesces bursts
+    std::shared_ptr<Coalescer> coalescer;
+    transport::MessagePriority priority =
+        transport::MessagePriority::kInteractive;
+    // Non-zero for idempotent method calls
+    std::chrono::milliseconds cache_ttl{0};
+    // Carried over when the method is registered again
+    std::shared_ptr<MethodMetrics> metrics;
+    // Set by the lazy registrations, whose handlers take raw params
+    bool lazy_params = false;
+  };
+
+  // Lets the route table be searched with a std::string_view
+  struct MethodHash {
+    using is_transparent = void;
+
+    auto operator()(std::string_view method) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(method);
+    }
+  };
+
+  using RouteTable = std::unordered_map<
+      std::string, std::shared_ptr<const Route>, MethodHash, std::equal_to<>>;
+
+  // A method call whose handler has not returned yet. Its slot is
+  // connected, emitted on and released on its own strand, over the executor
+  // the call was dispatched on, so calls never wait on each other.
+  struct RunningCall {
+    explicit RunningCall(const asio::any_io_executor& executor)
+        : strand(asio::make_strand(executor)) {
+    }
+
+    // Emits the cancellation on the call's strand, unless it already
+    // returned or was cancelled
+    static void Cancel(std::shared_ptr<RunningCall> running);
+
+    asio::strand<asio::any_io_executor> strand;
+    asio::cancellation_signal signal;
+    bool cancelled = false;
+    bool done = false;
+  };
+
+  using RunningKey = std::pair<PeerId, RequestId>;
+
+  // Part of the calls a cancel notification can name, picked by the key's
+  // hash. Only inserts, erases and lookups run on the strand, each posted on
+  // its own, and the posts keep the shard alive.
+  struct RunningShard {
+    explicit RunningShard(const asio::any_io_executor& executor)
+        : strand(asio::make_strand(executor)) {
+    }
+
+    asio::strand<asio::any_io_executor> strand;
+    std::map<RunningKey, std::shared_ptr<RunningCall>> calls;
+    // Cancels that reached the shard before their call, oldest first
+    std::deque<RunningKey> early_cancels;
+  };
+
+  // Publishes a copy of the method's route with the change applied
+  template <typename Update>
+  void UpdateRoute(const std::string& method, Update&& update);
+
+  void SetExecution(Route& route, const HandlerOptions& options);
+
+  void SetCoalescing(Route& route, const CoalesceOptions& options);
+
+  [[nodiscard]] auto FindRoute(std::string_view method) const
+      -> std::shared_ptr<const Route>;
+
+  [[nodiscard]] auto RunningShardFor(const RunningKey& key) const
+      -> const std::shared_ptr<RunningShard>&;
+
+  // Handlers of parallel methods run on handler_executor
+  auto DispatchSingleRequest(
+      Request request, PeerId peer, Clock::time_point received_at,
+      const ResultStream::Sender& sender,
+      const asio::any_io_executor& handler_executor)
       -> asio::awaitable<std::optional<Response>>;
 
-  auto DispatchBatchRequest(std::vector<Request> requests)
+  auto DispatchBatchRequest(
+      std::vector<Request> requests, PeerId peer,
+      Clock::time_point received_at, const ResultStream::Sender& sender,
+      const asio::any_io_executor& handler_executor)
       -> asio::awaitable<std::vector<Response>>;
 
-  std::unordered_map<std::string, MethodCallHandler> method_handlers_;
+  // Runs a method call handler under the key a cancel notification names.
+  // Returns std::nullopt when the handler failed after being cancelled.
+  template <typename Call>
+  auto RunCancellable(
+      RunningKey key, asio::any_io_executor executor, Call call)
+      -> asio::awaitable<std::optional<nlohmann::json>>;
 
-  std::unordered_map<std::string, NotificationHandler> notification_handlers_;
+  // Runs the notification handler on the route's executor, in turn with
+  // the method's other calls when it is serial, and completes once it
+  // returns. Static so the coalescing window can outlive the dispatcher.
+  static auto RunNotification(
+      std::shared_ptr<spdlog::logger> logger, asio::any_io_executor executor,
+      std::shared_ptr<const Route> route,
+      std::optional<nlohmann::json> params, Clock::time_point received_at)
+      -> asio::awaitable<void>;
+
+  // Folds a notification into the pending one of its key, or makes it the
+  // pending one and runs the handler once the window closes, on the
+  // executor of the notification that opened the window
+  static auto Coalesce(
+      std::shared_ptr<spdlog::logger> logger, asio::any_io_executor executor,
+      std::shared_ptr<const Route> route,
+      std::optional<nlohmann::json> params, Clock::time_point received_at)
+      -> asio::awaitable<void>;
+
+  // Emits the cancellation of the peer's call named in the params, without
+  // waiting for it
+  void CancelRunning(PeerId peer, const std::optional<nlohmann::json>& params);
+
+  RouteTable routes_;
+
+  DispatcherOptions options_;
 
   asio::any_io_executor executor_;
 
+  std::vector<std::shared_ptr<RunningShard>> running_;
+
+  ResultCache result_cache_;
+
+  std::atomic<PeerId> next_peer_id_{1};
+
+  std::atomic<bool> has_lazy_handlers_{false};
+
+  std::atomic<std::uint64_t> unknown_method_calls_{0};
+
   std::shared_ptr<spdlog::logger> logger_;
 };
 
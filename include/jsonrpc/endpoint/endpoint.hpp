@@ -1,40 +1,195 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <asio.hpp>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
 #include "jsonrpc/endpoint/dispatcher.hpp"
+#include "jsonrpc/endpoint/envelope.hpp"
+#include "jsonrpc/endpoint/json_writer.hpp"
 #include "jsonrpc/endpoint/jsonrpc_traits.hpp"
+#include "jsonrpc/endpoint/metrics.hpp"
 #include "jsonrpc/endpoint/pending_request.hpp"
+#include "jsonrpc/endpoint/pending_request_table.hpp"
 #include "jsonrpc/endpoint/response.hpp"
+#include "jsonrpc/endpoint/timer_wheel.hpp"
+#include "jsonrpc/endpoint/traffic_capture.hpp"
 #include "jsonrpc/endpoint/typed_handlers.hpp"
+#include "jsonrpc/endpoint/types.hpp"
 #include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/utils/logging.hpp"
 
 namespace jsonrpc::endpoint {
 
 using jsonrpc::error::Ok;
 using jsonrpc::error::RpcError;
 
+/**
+ * @brief Coalescing of outgoing calls into batch frames
+ *
+ * Calls and notifications sent within window of the first queued one, or
+ * until max_entries are queued, go out as one JSON-RPC batch. Keep
+ * max_entries within the peer's batch size limit.
+ */
+struct AutoBatchOptions {
+  bool enabled = false;
+  std::chrono::microseconds window = kDefaultAutoBatchWindow;
+  std::size_t max_entries = kDefaultAutoBatchMaxEntries;
+};
+
+/**
+ * @brief One element of a batch sent with RpcEndpoint::SendBatch
+ */
+struct BatchEntry {
+  std::string method;
+  std::optional<nlohmann::json> params{};
+  /// Notifications get no response; their result is null
+  bool is_notification = false;
+};
+
+/**
+ * @brief Running handlers on the thread that reads their messages
+ *
+ * With an endpoint executor that belongs to a single-threaded io_context,
+ * such as a WorkerPool's, a connection's reads, handlers and writes then
+ * stay on one core. Serial methods keep running on their strands.
+ */
+struct HandlerAffinity {
+  /// Run handlers of parallel methods on the endpoint's executor instead of
+  /// the handler executor
+  bool enabled = false;
+
+  /// Handlers in flight on the thread past which new ones go to the handler
+  /// executor, whose other threads take them on. Zero never spills.
+  std::size_t spill_threshold = 0;
+
+  /// Handlers in flight on the thread, shared by the endpoints that run
+  /// there. Without one the endpoint counts only its own.
+  std::shared_ptr<std::atomic<std::size_t>> load{};
+};
+
+/**
+ * @brief Tunables for an RpcEndpoint
+ */
+struct EndpointOptions {
+  /// Timeout for method calls sent without an explicit deadline. A nullopt
+  /// value waits for the response forever.
+  std::optional<std::chrono::milliseconds> request_timeout =
+      kDefaultRequestTimeout;
+
+  /// Resolution of the wheel that expires outstanding method calls
+  std::chrono::milliseconds timeout_tick = kDefaultTimeoutTick;
+
+  /// Number of slots in the wheel that expires outstanding method calls
+  std::size_t timeout_wheel_slots = kDefaultTimeoutWheelSlots;
+
+  /// Maximum number of outstanding method calls, rounded up to a power of
+  /// two. Further calls fail until earlier ones complete. Slots are
+  /// allocated as ids reach them, up to about 24 bytes each.
+  std::size_t max_pending_requests = kDefaultMaxPendingRequests;
+
+  /// Limits applied to incoming requests
+  DispatcherOptions dispatcher{};
+
+  /// Executor that runs method and notification handlers, typically a
+  /// thread_pool's. Defaults to the endpoint's executor. The message loop
+  /// keeps its own strand either way, so slow handlers never hold up reads.
+  std::optional<asio::any_io_executor> handler_executor{};
+
+  /// Most handlers the message loop runs at once, notification handlers
+  /// included. Once reached, the loop stops reading until one returns, so a
+  /// flooding peer is held back by the transport's flow control. Zero, the
+  /// default, does not limit. Coalesced notifications only count until they
+  /// join their window. Handlers that wait for answers from the same peer
+  /// need a limit above the number of such calls in flight, since answers
+  /// cannot be read while the loop waits.
+  std::size_t max_in_flight_handlers = 0;
+
+  /// Keeps handlers on the endpoint's executor, see HandlerAffinity
+  HandlerAffinity handler_affinity{};
+
+  /// First delay before retrying a failed receive while the transport stays
+  /// connected. The delay doubles with every further failure in a row, up to
+  /// max_receive_retry_delay, and resets after a successful receive.
+  std::chrono::milliseconds receive_retry_delay = kDefaultReceiveRetryDelay;
+  std::chrono::milliseconds max_receive_retry_delay =
+      kDefaultMaxReceiveRetryDelay;
+
+  /// Opt-in coalescing of SendMethodCall and SendNotification into batches.
+  /// While enabled, SendNotification returns once the notification is queued.
+  AutoBatchOptions auto_batch{};
+
+  /// Message encodings this endpoint accepts, most preferred first. A client
+  /// that lists one besides JSON negotiates it with the server on connect;
+  /// only framed transports can carry binary encodings.
+  std::vector<transport::MessageEncoding> encodings{
+      transport::MessageEncoding::kJson};
+
+  /// Notification methods where only the latest value matters. A queued
+  /// notification of such a method that the transport has not written yet
+  /// is replaced by the next one instead of both being sent; these bypass
+  /// auto batching.
+  std::vector<std::string> latest_wins_notifications{};
+
+  /// Receives a snapshot of GetMetrics() every metrics_interval while the
+  /// endpoint runs, e.g. to push it to a collector. Runs on the endpoint's
+  /// strand, so it should hand the snapshot off rather than block.
+  MetricsExporter metrics_exporter{};
+  std::chrono::milliseconds metrics_interval = kDefaultMetricsInterval;
+
+  /// Records the messages this endpoint receives and sends, sampled as the
+  /// capture's options say, for replay with TrafficReplay
+  std::shared_ptr<TrafficCapture> capture{};
+};
+
 class RpcEndpoint {
  public:
+  using Clock = std::chrono::steady_clock;
+
   explicit RpcEndpoint(
       asio::any_io_executor executor,
       std::unique_ptr<transport::Transport> transport,
       std::shared_ptr<spdlog::logger> logger = nullptr);
 
+  RpcEndpoint(
+      asio::any_io_executor executor,
+      std::unique_ptr<transport::Transport> transport, EndpointOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Construct an endpoint that serves an existing dispatcher
+   *
+   * Lets many endpoints, such as the sessions of an RpcServer, share one set
+   * of registered handlers. options.dispatcher and options.handler_executor
+   * are ignored since the dispatcher is already built.
+   */
+  RpcEndpoint(
+      asio::any_io_executor executor,
+      std::unique_ptr<transport::Transport> transport,
+      std::shared_ptr<Dispatcher> dispatcher, EndpointOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
   static auto CreateClient(
       asio::any_io_executor executor,
       std::unique_ptr<transport::Transport> transport)
       -> asio::awaitable<std::expected<std::unique_ptr<RpcEndpoint>, RpcError>>;
 
+  static auto CreateClient(
+      asio::any_io_executor executor,
+      std::unique_ptr<transport::Transport> transport, EndpointOptions options)
+      -> asio::awaitable<std::expected<std::unique_ptr<RpcEndpoint>, RpcError>>;
+
   RpcEndpoint(const RpcEndpoint &) = delete;
   RpcEndpoint(RpcEndpoint &&) = delete;
   auto operator=(const RpcEndpoint &) -> RpcEndpoint & = delete;
@@ -42,46 +197,151 @@ class RpcEndpoint {
 
   ~RpcEndpoint() = default;
 
+  /**
+   * @brief Wait until the transport can take a peer, without waiting for one
+   *
+   * A server endpoint is ready for clients once this returns, while its
+   * Start() still waits for the first of them, so readiness can be reported
+   * first.
+   */
+  auto Listen() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  /**
+   * @brief Start the transport and the message loop
+   *
+   * Once started, the endpoint must be shut down before it is destroyed.
+   */
   auto Start() -> asio::awaitable<std::expected<void, RpcError>>;
 
+  /**
+   * @brief Wait until the message loop ends
+   *
+   * The loop ends on Shutdown() or when the peer closes the connection, in
+   * which case outstanding method calls fail with kTransportError.
+   */
   auto WaitForShutdown() -> asio::awaitable<std::expected<void, RpcError>>;
 
   auto Shutdown() -> asio::awaitable<std::expected<void, RpcError>>;
 
+  /**
+   * @brief Wait until every handler started by the message loop returns
+   *
+   * Shutdown() does not wait for handlers, since a handler may be the one
+   * calling it. Await this after Shutdown() before destroying an endpoint
+   * whose handlers may still be running. Covers notification handlers too,
+   * except coalesced ones whose window has not closed yet.
+   */
+  auto WaitForHandlers() -> asio::awaitable<void>;
+
   [[nodiscard]] auto IsRunning() const -> bool {
     return is_running_.load();
   }
 
-  auto Logger() -> std::shared_ptr<spdlog::logger> {
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
     return logger_;
   }
 
+  /// Sends a method call that expires after the endpoint's request timeout
   auto SendMethodCall(
       std::string method, std::optional<nlohmann::json> params = std::nullopt)
       -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
 
+  /// Sends a method call that fails with kTimeoutError at the given deadline
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      Clock::time_point deadline)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  /// Sends a method call that fails with kTimeoutError after the timeout
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      std::chrono::milliseconds timeout)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  /**
+   * @brief Sends a method call in the given send queue class
+   *
+   * Bulk calls are written after interactive messages queued with them and
+   * bypass auto batching. The call expires after the request timeout.
+   */
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      transport::MessagePriority priority)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
   template <typename ParamsType, typename ResultType>
   auto SendMethodCall(std::string method, ParamsType params)
       -> asio::awaitable<std::expected<ResultType, RpcError>>
-    requires(
-        ToJson<ParamsType> && NotJsonLike<ParamsType> && FromJson<ResultType>);
+    requires(SendableParams<ParamsType> && FromJson<ResultType>);
+
+  template <typename ParamsType, typename ResultType>
+  auto SendMethodCall(
+      std::string method, ParamsType params, Clock::time_point deadline)
+      -> asio::awaitable<std::expected<ResultType, RpcError>>
+    requires(SendableParams<ParamsType> && FromJson<ResultType>);
+
+  /// Receives each part of a streamed result, on the endpoint's strand
+  using PartialResultHandler = std::function<void(nlohmann::json)>;
+
+  /**
+   * @brief Send a method call whose result arrives in parts
+   *
+   * Adds a partialResultToken to the params, which must be an object or
+   * empty, so a streaming handler sends each part as a $/progress
+   * notification; on_partial gets the parts in order before the call
+   * completes. The returned result holds whatever the peer did not stream,
+   * which is everything when it does not stream at all.
+   */
+  auto SendStreamingMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      PartialResultHandler on_partial)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
 
   auto SendNotification(
       std::string method, std::optional<nlohmann::json> params = std::nullopt)
       -> asio::awaitable<std::expected<void, RpcError>>;
 
+  /**
+   * @brief Sends a notification in the given send queue class
+   *
+   * Pass kBulk for traffic such as logs or diagnostics, so responses and
+   * interactive calls overtake it in the transport's send queue. Bulk
+   * notifications bypass auto batching.
+   */
+  auto SendNotification(
+      std::string method, std::optional<nlohmann::json> params,
+      transport::MessagePriority priority)
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  /**
+   * @brief Send several calls and notifications as one batch frame
+   *
+   * Method calls expire at the deadline, or after the endpoint's request
+   * timeout when none is given.
+   *
+   * @return One result per entry, in entry order, or an error if the batch
+   * could not be sent
+   */
+  auto SendBatch(
+      std::vector<BatchEntry> entries,
+      std::optional<Clock::time_point> deadline = std::nullopt)
+      -> asio::awaitable<std::expected<
+          std::vector<std::expected<nlohmann::json, RpcError>>, RpcError>>;
+
   template <typename ParamsType>
   auto SendNotification(std::string method, ParamsType params)
       -> asio::awaitable<std::expected<void, RpcError>>
-    requires(ToJson<ParamsType> && NotJsonLike<ParamsType>);
+    requires(SendableParams<ParamsType>);
 
   void RegisterMethodCall(
-      std::string method, typename Dispatcher::MethodCallHandler handler);
+      std::string method, typename Dispatcher::MethodCallHandler handler,
+      HandlerOptions options = {});
 
   template <typename ParamsType, typename ResultType>
   void RegisterMethodCall(
       std::string method,
-      std::function<asio::awaitable<ResultType>(ParamsType)> handler)
+      std::function<asio::awaitable<ResultType>(ParamsType)> handler,
+      HandlerOptions options = {})
     requires(FromJson<ParamsType> && ToJson<ResultType>);
 
   template <typename ParamsType, typename ResultType, typename ErrorType>
@@ -89,36 +349,246 @@ class RpcEndpoint {
       std::string method,
       std::function<
           asio::awaitable<std::expected<ResultType, ErrorType>>(ParamsType)>
-          handler)
+          handler,
+      HandlerOptions options = {})
     requires(FromJson<ParamsType> && ToJson<ResultType> && ToJson<ErrorType>);
 
   void RegisterNotification(
-      std::string method, typename Dispatcher::NotificationHandler handler);
+      std::string method, typename Dispatcher::NotificationHandler handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call that decodes its params on demand
+   *
+   * The params reach the handler as JSON text behind LazyParams, so a
+   * handler that only reads a field or two of a large message never builds
+   * the rest. Only JSON messages skip the params DOM.
+   */
+  void RegisterLazyMethodCall(
+      std::string method, typename Dispatcher::LazyMethodCallHandler handler,
+      HandlerOptions options = {});
+
+  /// Notification counterpart of RegisterLazyMethodCall()
+  void RegisterLazyNotification(
+      std::string method, typename Dispatcher::LazyNotificationHandler handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call that writes its result in parts
+   *
+   * Parts reach callers that sent a partialResultToken as $/progress
+   * notifications while the handler runs; other callers get them all in
+   * the response.
+   */
+  void RegisterStreamingMethodCall(
+      std::string method,
+      typename Dispatcher::StreamingMethodCallHandler handler,
+      HandlerOptions options = {});
 
   template <typename ParamsType, typename ErrorType>
   void RegisterNotification(
       std::string method,
       std::function<asio::awaitable<std::expected<void, ErrorType>>(ParamsType)>
-          handler)
+          handler,
+      HandlerOptions options = {})
     requires(FromJson<ParamsType> && HasMessageMethod<ErrorType>);
 
   [[nodiscard]] auto HasPendingRequests() const -> bool;
 
+  /// Number of method calls waiting for a response
+  [[nodiscard]] auto PendingRequestCount() const -> std::size_t {
+    return pending_requests_.Size();
+  }
+
+  /// Whether the endpoint runs and its transport still reaches the peer
+  [[nodiscard]] auto IsConnected() const -> bool {
+    return is_running_.load() && transport_->IsConnected();
+  }
+
+  /// Whether a handler started by the message loop is still running
+  [[nodiscard]] auto HasActiveHandlers() const -> bool {
+    return active_handlers_.load() > 0;
+  }
+
+  /// Time of the last message sent or received
+  [[nodiscard]] auto LastActivity() const -> Clock::time_point;
+
+  [[nodiscard]] auto GetReceiveErrorStats() const -> ReceiveErrorStats {
+    return {
+        .transient = transient_receive_errors_.load(),
+        .terminal = terminal_receive_errors_.load()};
+  }
+
+  /**
+   * @brief Snapshot of the endpoint's traffic, queues and per-method calls
+   *
+   * Method metrics come from the dispatcher, so endpoints sharing one report
+   * the calls of all of them. FormatPrometheus() renders the snapshot for a
+   * scrape endpoint.
+   */
+  auto GetMetrics() -> asio::awaitable<EndpointMetrics>;
+
+  /**
+   * @brief Agree with the peer on the encoding for later messages
+   *
+   * Offers the encodings in options.encodings that the transport supports.
+   * Returns JSON without a round trip when that is the only one, and leaves
+   * the encoding unchanged if the call fails.
+   */
+  auto NegotiateEncoding()
+      -> asio::awaitable<std::expected<transport::MessageEncoding, RpcError>>;
+
+  /// Encoding of outgoing messages
+  [[nodiscard]] auto Encoding() const -> transport::MessageEncoding {
+    return encoding_.load();
+  }
+
  private:
   void StartMessageProcessing();
 
-  auto ProcessMessagesLoop(asio::cancellation_slot slot)
+  auto ProcessMessagesLoop() -> asio::awaitable<void>;
+
+  // Hands a snapshot to options_.metrics_exporter every interval until
+  // Shutdown()
+  auto ExportMetricsLoop() -> asio::awaitable<void>;
+
+  // Resumes on endpoint_strand_ once the message loop has ended
+  auto WaitForMessageLoop() -> asio::awaitable<void>;
+
+  // Returns once another handler may start or the endpoint stops
+  auto WaitForHandlerSlot() -> asio::awaitable<void>;
+
+  // Sleeps before retrying a receive; Shutdown() cuts the sleep short
+  auto WaitBeforeRetry(std::chrono::milliseconds delay)
       -> asio::awaitable<void>;
 
-  auto HandleMessage(std::string message)
+  // Counts a handler out on endpoint_strand_ and wakes whoever waits on it
+  void FinishHandler();
+
+  void TouchActivity();
+
+  // Whether a handler bound for executor runs on executor_ instead; counts
+  // it into the thread's load if so
+  auto PinsHandler(const asio::any_io_executor &executor) -> bool;
+
+  // Whether the next message in this direction goes to options_.capture
+  auto Captures(CaptureDirection direction) const -> bool {
+    return options_.capture && options_.capture->ShouldRecord(direction);
+  }
+
+  auto HandleMessage(
+      nlohmann::json message, Clock::time_point received_at,
+      std::optional<asio::any_io_executor> handler_executor = std::nullopt)
       -> asio::awaitable<std::expected<void, RpcError>>;
 
-  auto HandleResponse(Response response)
+  // Hands a $/progress part to the streaming call it belongs to. Runs on
+  // the message loop so parts keep their order ahead of the response.
+  auto HandlePartialResult(nlohmann::json &message) -> bool;
+
+  // Hands a response object to the call waiting on its ID, moving the
+  // message instead of building a Response
+  auto HandleResponse(nlohmann::json response)
       -> asio::awaitable<std::expected<void, RpcError>>;
 
-  auto GetNextRequestId() -> int64_t {
-    return next_request_id_++;
-  }
+  // Answers a peer's kNegotiateEncodingMethod call
+  auto HandleNegotiateEncoding(const nlohmann::json &message)
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  // Sends serialized JSON, transcoded to the negotiated encoding
+  auto SendToTransport(std::string message, transport::SendHints hints = {})
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  // Sends a message written in the given encoding; JSON text is transcoded
+  // when the link negotiated a binary one
+  auto SendToTransport(
+      std::string message, transport::MessageEncoding encoding,
+      transport::SendHints hints = {})
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  // What requests are written in: the negotiated encoding, or JSON while
+  // auto batching joins their text into frames
+  [[nodiscard]] auto RequestEncoding() const -> transport::MessageEncoding;
+
+  // Checks the endpoint runs, then registers a call under a fresh id
+  auto BeginCall(std::optional<Clock::time_point> deadline)
+      -> std::expected<std::pair<int64_t, std::shared_ptr<PendingRequest>>,
+                       RpcError>;
+
+  // Sends the serialized call registered by BeginCall and awaits its answer
+  auto FinishCall(
+      int64_t request_id, std::shared_ptr<PendingRequest> pending_request,
+      std::string message, transport::MessageEncoding encoding,
+      transport::MessagePriority priority =
+          transport::MessagePriority::kInteractive)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  auto SendEncodedNotification(
+      std::string message, transport::MessageEncoding encoding,
+      transport::SendHints hints = {})
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  // Queue hints for a notification: its priority, and its method as the
+  // replace key when the method is in options_.latest_wins_notifications
+  [[nodiscard]] auto NotificationHints(
+      std::string_view method,
+      transport::MessagePriority priority =
+          transport::MessagePriority::kInteractive) const
+      -> transport::SendHints;
+
+  // Writes a request envelope around params without building a DOM
+  template <WireWritable ParamsType>
+  static auto EncodeRequest(
+      std::string_view method, const ParamsType &params,
+      std::optional<int64_t> id) -> std::string;
+
+  // Registers a method call and schedules its deadline
+  auto RegisterCall(std::optional<Clock::time_point> deadline)
+      -> std::optional<std::pair<int64_t, std::shared_ptr<PendingRequest>>>;
+
+  // Removes a call from the table and its deadline from the wheel
+  auto TakeCall(int64_t id) -> std::shared_ptr<PendingRequest>;
+
+  // Turns a completed call into its result or error
+  static auto ToResult(
+      const PendingRequest &request, nlohmann::json completion)
+      -> std::expected<nlohmann::json, RpcError>;
+
+  // Sends a serialized message, through the batcher when auto batching is on
+  // and the message is interactive, not replaceable and JSON
+  auto Transmit(
+      std::string message, transport::MessageEncoding encoding,
+      std::optional<int64_t> id, transport::SendHints hints = {})
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+  // Queues a message for the next batch frame; runs on endpoint_strand_
+  auto EnqueueForBatch(std::string message, std::optional<int64_t> id)
+      -> asio::awaitable<void>;
+
+  // Sends the queued messages as one frame; runs on endpoint_strand_
+  auto FlushBatch() -> asio::awaitable<void>;
+
+  auto SendMethodCallImpl(
+      std::string method, std::optional<nlohmann::json> params,
+      std::optional<Clock::time_point> deadline,
+      transport::MessagePriority priority =
+          transport::MessagePriority::kInteractive)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  template <typename ParamsType, typename ResultType>
+  auto SendTypedMethodCall(
+      std::string method, ParamsType params,
+      std::optional<Clock::time_point> deadline)
+      -> asio::awaitable<std::expected<ResultType, RpcError>>;
+
+  void ExpireRequest(int64_t id);
+
+  // Tells the peer to stop working on a call nobody waits for anymore
+  void SendCancelRequest(int64_t id);
+
+  [[nodiscard]] auto DefaultDeadline() const
+      -> std::optional<Clock::time_point>;
+
+  EndpointOptions options_;
 
   std::shared_ptr<spdlog::logger> logger_;
 
@@ -126,49 +596,160 @@ class RpcEndpoint {
 
   std::unique_ptr<transport::Transport> transport_;
 
-  Dispatcher dispatcher_;
+  // Shared with other endpoints when one was passed in
+  std::shared_ptr<Dispatcher> dispatcher_;
+
+  // Scopes this connection's request ids in a shared dispatcher
+  Dispatcher::PeerId peer_id_;
 
-  std::unordered_map<int64_t, std::shared_ptr<PendingRequest>>
-      pending_requests_;
+  // Outstanding method calls; safe to use from any thread
+  PendingRequestTable pending_requests_;
 
   std::atomic<bool> is_running_{false};
 
+  std::atomic<transport::MessageEncoding> encoding_{
+      transport::MessageEncoding::kJson};
+
   asio::strand<asio::any_io_executor> endpoint_strand_;
 
-  std::atomic<int64_t> next_request_id_{0};
+  // Expires outstanding method calls; only touched on endpoint_strand_
+  TimerWheel timeout_wheel_;
+
+  // Steady clock ticks, so any thread can update it
+  std::atomic<Clock::rep> last_activity_;
+
+  // Handlers spawned by the message loop that have not returned yet
+  std::atomic<std::size_t> active_handlers_{0};
 
-  asio::cancellation_signal cancel_signal_;
+  // Handlers on executor_'s thread when handler affinity is enabled
+  std::shared_ptr<std::atomic<std::size_t>> handler_load_;
 
-  asio::awaitable<void> message_loop_;
+  std::atomic<std::uint64_t> spilled_handlers_{0};
+
+  std::atomic<std::size_t> transient_receive_errors_{0};
+  std::atomic<std::size_t> terminal_receive_errors_{0};
+
+  std::atomic<std::uint64_t> messages_received_{0};
+  std::atomic<std::uint64_t> messages_sent_{0};
+  std::atomic<std::uint64_t> bytes_received_{0};
+  std::atomic<std::uint64_t> bytes_sent_{0};
+
+  // Cleared on endpoint_strand_ once ExportMetricsLoop() has returned
+  std::atomic<bool> exporting_metrics_{false};
+
+  // Only touched on endpoint_strand_
+  bool loop_finished_ = false;
+  bool waiting_for_handler_slot_ = false;
+
+  // Never expires; cancelled on endpoint_strand_ to wake the waiters when
+  // the loop ends or the last handler returns
+  asio::steady_timer state_changed_;
+
+  // Backoff between failed receives, only touched on endpoint_strand_
+  asio::steady_timer retry_timer_;
+
+  // Paces ExportMetricsLoop(), only touched on endpoint_strand_
+  asio::steady_timer metrics_timer_;
+
+  // Streaming calls by the token of their parts, only touched on
+  // endpoint_strand_
+  std::unordered_map<int64_t, PartialResultHandler> partial_results_;
+  // Size of partial_results_, read by the message loop to hop to the strand
+  // only while a streaming call is outstanding
+  std::atomic<std::size_t> streaming_calls_{0};
+
+  // Auto batching state, only touched on endpoint_strand_
+  std::vector<std::string> batch_messages_;
+  std::vector<int64_t> batch_call_ids_;
+  asio::steady_timer batch_timer_;
+  bool batch_timer_armed_ = false;
 };
 
 template <typename ParamsType, typename ResultType>
 auto RpcEndpoint::SendMethodCall(std::string method, ParamsType params)
     -> asio::awaitable<std::expected<ResultType, RpcError>>
-  requires(
-      ToJson<ParamsType> && NotJsonLike<ParamsType> && FromJson<ResultType>)
+  requires(SendableParams<ParamsType> && FromJson<ResultType>)
 {
-  nlohmann::json json_params;
-  try {
-    json_params = params;
-  } catch (const nlohmann::json::exception &ex) {
-    logger_->error(
-        "RpcEndpoint failed to convert parameters to JSON: {}", ex.what());
-    co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientSerializationError,
-        "RpcEndpoint failed to convert parameters to JSON: " +
-            std::string(ex.what()));
+  co_return co_await SendTypedMethodCall<ParamsType, ResultType>(
+      std::move(method), std::move(params), DefaultDeadline());
+}
+
+template <typename ParamsType, typename ResultType>
+auto RpcEndpoint::SendMethodCall(
+    std::string method, ParamsType params, Clock::time_point deadline)
+    -> asio::awaitable<std::expected<ResultType, RpcError>>
+  requires(SendableParams<ParamsType> && FromJson<ResultType>)
+{
+  co_return co_await SendTypedMethodCall<ParamsType, ResultType>(
+      std::move(method), std::move(params), deadline);
+}
+
+template <WireWritable ParamsType>
+auto RpcEndpoint::EncodeRequest(
+    std::string_view method, const ParamsType &params,
+    std::optional<int64_t> id) -> std::string {
+  // The envelope comes from constant fragments; only the id, method and
+  // params are written per call
+  std::string text;
+  text.reserve(kRequestEnvelopeSize + method.size() + 2);
+  if (id) {
+    text += kEnvelopeIdOpen;
+    AppendRequestId(text, *id);
+    text += kEnvelopeVersion;
+  } else {
+    text += kEnvelopeVersionOpen;
   }
+  text += kEnvelopeMethodKey;
+  AppendJsonString(text, method);
+  text += kEnvelopeParamsKey;
+  JsonWriter writer(std::move(text));
+  writer.Value(params);
+  text = writer.Take();
+  text += '}';
+  return text;
+}
 
-  auto result = co_await RpcEndpoint::SendMethodCall(method, json_params);
+template <typename ParamsType, typename ResultType>
+auto RpcEndpoint::SendTypedMethodCall(
+    std::string method, ParamsType params,
+    std::optional<Clock::time_point> deadline)
+    -> asio::awaitable<std::expected<ResultType, RpcError>> {
+  std::expected<nlohmann::json, RpcError> result;
+  if constexpr (WireWritable<ParamsType>) {
+    auto call = BeginCall(deadline);
+    if (!call) {
+      co_return std::unexpected(call.error());
+    }
+    auto [request_id, pending_request] = std::move(*call);
+    result = co_await FinishCall(
+        request_id, std::move(pending_request),
+        EncodeRequest(method, params, request_id),
+        transport::MessageEncoding::kJson);
+  } else {
+    nlohmann::json json_params;
+    try {
+      json_params = params;
+    } catch (const nlohmann::json::exception &ex) {
+      JSONRPC_LOG_ERROR(
+          logger_, "RpcEndpoint failed to convert parameters to JSON: {}",
+          ex.what());
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kClientSerializationError,
+          "RpcEndpoint failed to convert parameters to JSON: " +
+              std::string(ex.what()));
+    }
+    result = co_await SendMethodCallImpl(
+        std::move(method), std::move(json_params), deadline);
+  }
   if (!result) {
-    co_return result;
+    co_return std::unexpected(result.error());
   }
 
   try {
     co_return result->template get<ResultType>();
   } catch (const nlohmann::json::exception &ex) {
-    logger_->error("RpcEndpoint failed to convert result: {}", ex.what());
+    JSONRPC_LOG_ERROR(
+        logger_, "RpcEndpoint failed to convert result: {}", ex.what());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kClientDeserializationError,
         "RpcEndpoint failed to convert result: " + std::string(ex.what()));
@@ -178,32 +759,35 @@ auto RpcEndpoint::SendMethodCall(std::string method, ParamsType params)
 template <typename ParamsType>
 auto RpcEndpoint::SendNotification(std::string method, ParamsType params)
     -> asio::awaitable<std::expected<void, RpcError>>
-  requires(ToJson<ParamsType> && NotJsonLike<ParamsType>)
+  requires(SendableParams<ParamsType>)
 {
-  nlohmann::json json_params;
-  try {
-    json_params = params;
-  } catch (const nlohmann::json::exception &ex) {
-    logger_->error(
-        "RpcEndpoint failed to convert notification parameters: {}", ex.what());
-    co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientSerializationError,
-        "RpcEndpoint failed to convert notification parameters: " +
-            std::string(ex.what()));
+  if constexpr (WireWritable<ParamsType>) {
+    co_return co_await SendEncodedNotification(
+        EncodeRequest(method, params, std::nullopt),
+        transport::MessageEncoding::kJson, NotificationHints(method));
+  } else {
+    nlohmann::json json_params;
+    try {
+      json_params = params;
+    } catch (const nlohmann::json::exception &ex) {
+      JSONRPC_LOG_ERROR(
+          logger_, "RpcEndpoint failed to convert notification parameters: {}",
+          ex.what());
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kClientSerializationError,
+          "RpcEndpoint failed to convert notification parameters: " +
+              std::string(ex.what()));
+    }
+
+    co_return co_await RpcEndpoint::SendNotification(method, json_params);
   }
-
-  auto result = co_await RpcEndpoint::SendNotification(method, json_params);
-  if (!result) {
-    co_return result;
-  }
-
-  co_return Ok();
 }
 
 template <typename ParamsType, typename ResultType>
 void RpcEndpoint::RegisterMethodCall(
     std::string method,
-    std::function<asio::awaitable<ResultType>(ParamsType)> handler)
+    std::function<asio::awaitable<ResultType>(ParamsType)> handler,
+    HandlerOptions options)
   requires(FromJson<ParamsType> && ToJson<ResultType>)
 {
   // Create a handler object and store its function object
@@ -219,7 +803,10 @@ void RpcEndpoint::RegisterMethodCall(
   RegisterMethodCall(
       method,
       [handler = std::move(typed_handler)](
-          std::optional<nlohmann::json> params) { return (*handler)(params); });
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
 }
 
 template <typename ParamsType, typename ResultType, typename ErrorType>
@@ -227,7 +814,8 @@ void RpcEndpoint::RegisterMethodCall(
     std::string method,
     std::function<
         asio::awaitable<std::expected<ResultType, ErrorType>>(ParamsType)>
-        handler)
+        handler,
+    HandlerOptions options)
   requires(FromJson<ParamsType> && ToJson<ResultType> && ToJson<ErrorType>)
 {
   auto typed_handler =
@@ -237,14 +825,18 @@ void RpcEndpoint::RegisterMethodCall(
   RegisterMethodCall(
       method,
       [handler = std::move(typed_handler)](
-          std::optional<nlohmann::json> params) { return (*handler)(params); });
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
 }
 
 template <typename ParamsType, typename ErrorType>
 void RpcEndpoint::RegisterNotification(
     std::string method,
     std::function<asio::awaitable<std::expected<void, ErrorType>>(ParamsType)>
-        handler)
+        handler,
+    HandlerOptions options)
   requires(FromJson<ParamsType> && HasMessageMethod<ErrorType>)
 {
   // Create a handler object and store its function object
@@ -259,7 +851,10 @@ void RpcEndpoint::RegisterNotification(
   RegisterNotification(
       method,
       [handler = std::move(typed_handler)](
-          std::optional<nlohmann::json> params) { return (*handler)(params); });
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
 }
 
 }  // namespace jsonrpc::endpoint
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/types.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
+
+namespace jsonrpc::endpoint {
+
+// Fragments that requests and responses are written from. Members follow
+// the order nlohmann::json sorts them in, so a message written from these
+// reads the same as its DOM serialized.
+
+/// Opens a message with an id; the id itself follows
+constexpr std::string_view kEnvelopeIdOpen = R"({"id":)";
+
+/// Opens a notification, or a success response without an id
+constexpr std::string_view kEnvelopeVersionOpen = R"({"jsonrpc":"2.0")";
+
+/// Opens an error response; the error object follows
+constexpr std::string_view kEnvelopeErrorOpen = R"({"error":)";
+
+constexpr std::string_view kEnvelopeIdKey = R"(,"id":)";
+
+constexpr std::string_view kEnvelopeVersion = R"(,"jsonrpc":"2.0")";
+
+constexpr std::string_view kEnvelopeMethodKey = R"(,"method":)";
+
+constexpr std::string_view kEnvelopeParamsKey = R"(,"params":)";
+
+constexpr std::string_view kEnvelopeResultKey = R"(,"result":)";
+
+/// Envelope bytes of a request apart from its method, id and params
+constexpr std::size_t kRequestEnvelopeSize = kEnvelopeIdOpen.size() +
+                                             kEnvelopeVersion.size() +
+                                             kEnvelopeMethodKey.size() +
+                                             kEnvelopeParamsKey.size() + 1;
+
+/// Append an id's digits, or the id as a quoted string
+void AppendRequestId(std::string& out, const RequestId& id);
+
+// The binary counterparts, for CBOR and MessagePack envelopes. Headers and
+// keys are written directly; only values go through nlohmann's encoders.
+
+/// Append the header of a map with the given number of members
+void AppendBinaryMap(
+    std::string& out, std::size_t members,
+    transport::MessageEncoding encoding);
+
+/// Append the header of an array with the given number of elements
+void AppendBinaryArray(
+    std::string& out, std::size_t elements,
+    transport::MessageEncoding encoding);
+
+void AppendBinaryString(
+    std::string& out, std::string_view value,
+    transport::MessageEncoding encoding);
+
+/// Append a value encoded by nlohmann::json::to_cbor or to_msgpack
+void AppendBinaryValue(
+    std::string& out, const nlohmann::json& value,
+    transport::MessageEncoding encoding);
+
+void AppendBinaryRequestId(
+    std::string& out, const RequestId& id,
+    transport::MessageEncoding encoding);
+
+}  // namespace jsonrpc::endpoint
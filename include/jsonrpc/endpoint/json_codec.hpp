@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/transport/message_encoding.hpp"
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Parsers that can back ParseJson, picked when the library is built
+ *
+ * Handlers always see nlohmann::json; the backend only changes how incoming
+ * text becomes that value. Select it with the JSONRPC_JSON_BACKEND CMake
+ * option or the //:json_backend Bazel flag.
+ */
+enum class JsonBackend {
+  kNlohmann,
+  /// simdjson's on-demand parser, building nlohmann::json in one pass
+  kSimdjson,
+};
+
+/// The backend this build of the library parses with
+[[nodiscard]] auto ActiveJsonBackend() -> JsonBackend;
+
+/**
+ * @brief Parse a message with the build's backend
+ *
+ * @return The value, or a discarded value if the text is not valid JSON,
+ * so callers check is_discarded() as with nlohmann::json::parse
+ */
+[[nodiscard]] auto ParseJson(std::string_view text) -> nlohmann::json;
+
+/// Serialize a message compactly, the inverse of ParseJson
+[[nodiscard]] auto SerializeJson(const nlohmann::json& value) -> std::string;
+
+/**
+ * @brief Decode a message body in any wire encoding
+ *
+ * JSON bodies go through ParseJson; CBOR and MessagePack use nlohmann's
+ * binary readers. Invalid bodies yield a discarded value.
+ */
+[[nodiscard]] auto DecodeMessage(
+    std::string_view body, transport::MessageEncoding encoding)
+    -> nlohmann::json;
+
+/// Encode a message for the wire, the inverse of DecodeMessage
+[[nodiscard]] auto EncodeMessage(
+    const nlohmann::json& value, transport::MessageEncoding encoding)
+    -> std::string;
+
+}  // namespace jsonrpc::endpoint
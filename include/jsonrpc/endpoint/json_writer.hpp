@@ -0,0 +1,170 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/jsonrpc_traits.hpp"
+
+namespace jsonrpc::endpoint {
+
+/// Append text as a quoted JSON string, escaping what JSON requires
+void AppendJsonString(std::string& out, std::string_view value);
+
+/// Append a DOM value's compact text without a temporary string
+void AppendJson(std::string& out, const nlohmann::json& value);
+
+/**
+ * @brief Streaming JSON writer that appends straight to a string
+ *
+ * Builds a message without an intermediate nlohmann::json. Separators are
+ * inserted automatically; the caller is responsible for balancing Begin and
+ * End calls and for writing a Key before each value inside an object.
+ *
+ * Types opt in to direct writing by providing a WriteJson(JsonWriter&,
+ * const T&) overload found by argument-dependent lookup, see WireWritable.
+ */
+class JsonWriter {
+ public:
+  JsonWriter() = default;
+
+  /// Appends to buffer's existing contents
+  explicit JsonWriter(std::string buffer) : buffer_(std::move(buffer)) {
+  }
+
+  void BeginObject() {
+    Separate();
+    buffer_ += '{';
+    needs_comma_ = false;
+  }
+
+  void EndObject() {
+    buffer_ += '}';
+    needs_comma_ = true;
+  }
+
+  void BeginArray() {
+    Separate();
+    buffer_ += '[';
+    needs_comma_ = false;
+  }
+
+  void EndArray() {
+    buffer_ += ']';
+    needs_comma_ = true;
+  }
+
+  void Key(std::string_view key) {
+    Separate();
+    AppendString(key);
+    buffer_ += ':';
+    needs_comma_ = false;
+  }
+
+  void Null();
+
+  void Value(std::nullptr_t /*value*/) {
+    Null();
+  }
+
+  void Value(bool value);
+
+  void Value(std::string_view value) {
+    Separate();
+    AppendString(value);
+    needs_comma_ = true;
+  }
+
+  void Value(const char* value) {
+    Value(std::string_view(value));
+  }
+
+  void Value(const std::string& value) {
+    Value(std::string_view(value));
+  }
+
+  void Value(std::int64_t value);
+
+  void Value(std::uint64_t value);
+
+  template <std::signed_integral T>
+  void Value(T value) {
+    Value(static_cast<std::int64_t>(value));
+  }
+
+  template <std::unsigned_integral T>
+    requires(!std::same_as<T, bool>)
+  void Value(T value) {
+    Value(static_cast<std::uint64_t>(value));
+  }
+
+  /// Non-finite values are written as null, as nlohmann::json does
+  void Value(double value);
+
+  void Value(float value) {
+    Value(static_cast<double>(value));
+  }
+
+  /// Writes an existing DOM value, for mixing typed and untyped content
+  void Value(const nlohmann::json& value);
+
+  template <typename T>
+  void Value(const std::optional<T>& value) {
+    if (value.has_value()) {
+      Value(*value);
+    } else {
+      Null();
+    }
+  }
+
+  template <WireWritable T>
+  void Value(const T& value) {
+    WriteJson(*this, value);
+  }
+
+  /// Writes a key and its value
+  template <typename T>
+  void Field(std::string_view key, const T& value) {
+    Key(key);
+    Value(value);
+  }
+
+  /**
+   * @brief Appends text that is already valid JSON as the next value
+   */
+  void Raw(std::string_view json) {
+    Separate();
+    buffer_ += json;
+    needs_comma_ = true;
+  }
+
+  [[nodiscard]] auto View() const -> std::string_view {
+    return buffer_;
+  }
+
+  /// Moves the written text out, leaving the writer empty
+  [[nodiscard]] auto Take() -> std::string {
+    needs_comma_ = false;
+    return std::move(buffer_);
+  }
+
+ private:
+  void Separate() {
+    if (needs_comma_) {
+      buffer_ += ',';
+    }
+  }
+
+  void AppendString(std::string_view value) {
+    AppendJsonString(buffer_, value);
+  }
+
+  std::string buffer_;
+  bool needs_comma_ = false;
+};
+
+}  // namespace jsonrpc::endpoint
@@ -25,6 +25,19 @@ concept NotJsonLike =
     !std::is_same_v<std::decay_t<T>, nlohmann::json> &&
     !std::is_same_v<std::decay_t<T>, std::optional<nlohmann::json>>;
 
+class JsonWriter;
+
+/// Opts a type in to direct serialization through a JsonWriter, bypassing
+/// nlohmann::json, by providing WriteJson(JsonWriter&, const T&)
+template <typename T>
+concept WireWritable = requires(JsonWriter& writer, const T& value) {
+  WriteJson(writer, value);
+};
+
+/// Params a typed call can send, converted or written directly
+template <typename T>
+concept SendableParams = (ToJson<T> || WireWritable<T>) && NotJsonLike<T>;
+
 template <typename T>
 concept HasMessageMethod = std::is_same_v<T, std::monostate> || requires(T e) {
   { e.Message() } -> std::convertible_to<std::string>;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::endpoint {
+
+/// Subtype of the binary value that carries params still in their JSON text
+constexpr std::uint8_t kRawParamsSubtype = 'J';
+
+/// Whether a params value is raw JSON text left by ParseJsonWithLazyParams
+[[nodiscard]] inline auto IsRawParams(const nlohmann::json& params) -> bool {
+  return params.is_binary() && params.get_binary().has_subtype() &&
+         params.get_binary().subtype() == kRawParamsSubtype;
+}
+
+/**
+ * @brief Parse a message, leaving the params of some methods as raw text
+ *
+ * A request whose method satisfies wants_lazy gets its params object or
+ * array copied as it is into a binary value instead of being built into a
+ * DOM; only the other members are parsed. The params text is only checked
+ * for balanced brackets and strings here, so malformed JSON inside it shows
+ * up when a handler reads the broken part. Everything else, including
+ * batches, is parsed as by ParseJson.
+ */
+[[nodiscard]] auto ParseJsonWithLazyParams(
+    std::string_view text,
+    const std::function<bool(std::string_view)>& wants_lazy)
+    -> nlohmann::json;
+
+/**
+ * @brief The raw text of the value at a JSON pointer, found without
+ * building values
+ *
+ * @return The value's span in text, or std::nullopt if the pointer is
+ * invalid or names nothing
+ */
+[[nodiscard]] auto FindRawValue(std::string_view text, std::string_view pointer)
+    -> std::optional<std::string_view>;
+
+/**
+ * @brief Params of a lazy handler, decoded member by member on access
+ *
+ * Requests for methods registered with RegisterLazyMethodCall() or
+ * RegisterLazyNotification() arrive with their params as JSON text. Get()
+ * scans that text for one member and parses just that member, so a handler
+ * that rejects a call after looking at a field or two never builds the rest.
+ * Params that already arrived as a DOM, as from binary encodings, are read
+ * through the same interface.
+ */
+class LazyParams {
+ public:
+  explicit LazyParams(std::optional<nlohmann::json> params)
+      : params_(std::move(params)) {
+  }
+
+  /// Whether the request had params at all
+  [[nodiscard]] auto HasValue() const -> bool {
+    return params_.has_value() && !params_->is_null();
+  }
+
+  /// The params' JSON text, while they have not been parsed
+  [[nodiscard]] auto Raw() const -> std::optional<std::string_view>;
+
+  /// Whether a value exists at the JSON pointer, e.g. "/textDocument/uri"
+  [[nodiscard]] auto Contains(std::string_view pointer) const -> bool;
+
+  /**
+   * @brief Decode the value at a JSON pointer
+   *
+   * @return The value, or kInvalidParams if it is missing or malformed
+   */
+  [[nodiscard]] auto GetJson(std::string_view pointer) const
+      -> std::expected<nlohmann::json, error::RpcError>;
+
+  /// Decode the value at a JSON pointer as T, or fail with kInvalidParams
+  template <typename T>
+  [[nodiscard]] auto Get(std::string_view pointer) const
+      -> std::expected<T, error::RpcError> {
+    auto value = GetJson(pointer);
+    if (!value) {
+      return std::unexpected(value.error());
+    }
+    try {
+      return value->template get<T>();
+    } catch (const nlohmann::json::exception& ex) {
+      return error::RpcError::UnexpectedFromCode(
+          error::RpcErrorCode::kInvalidParams,
+          "Invalid value at " + std::string(pointer) + ": " + ex.what());
+    }
+  }
+
+  /// Decode all of the params, for handlers that accept the call
+  [[nodiscard]] auto ToJson() const
+      -> std::expected<nlohmann::json, error::RpcError> {
+    return GetJson("");
+  }
+
+ private:
+  std::optional<nlohmann::json> params_;
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "jsonrpc/transport/send_queue.hpp"
+
+namespace jsonrpc::endpoint {
+
+/// Point-in-time copy of a LatencyHistogram
+struct LatencySnapshot {
+  static constexpr std::size_t kSubBuckets = 8;
+  static constexpr std::size_t kBucketCount = 304;
+
+  std::array<std::uint64_t, kBucketCount> buckets{};
+  std::uint64_t count = 0;
+  std::chrono::microseconds sum{0};
+  std::chrono::microseconds max{0};
+
+  /// Bucket a value in microseconds falls into
+  static auto BucketFor(std::uint64_t micros) -> std::size_t;
+
+  /// Largest value in microseconds that lands in the bucket
+  static auto BucketUpperBound(std::size_t bucket) -> std::uint64_t;
+
+  /**
+   * @brief Latency below which the given fraction of samples fall
+   *
+   * Accurate to the bucket width, at most an eighth of the value.
+   * @param quantile Between 0 and 1
+   */
+  [[nodiscard]] auto Percentile(double quantile) const
+      -> std::chrono::microseconds;
+};
+
+/**
+ * @brief Log-linear latency histogram in the style of HdrHistogram
+ *
+ * Values below 8 us get a bucket each; above that every power of two is
+ * split into eight buckets, so the buckets cover microseconds to days in
+ * fixed memory. Recording is a few relaxed atomic additions, safe from any
+ * thread.
+ */
+class LatencyHistogram {
+ public:
+  void Record(std::chrono::nanoseconds latency) noexcept;
+
+  [[nodiscard]] auto Snapshot() const -> LatencySnapshot;
+
+ private:
+  std::array<std::atomic<std::uint64_t>, LatencySnapshot::kBucketCount>
+      buckets_{};
+  std::atomic<std::uint64_t> sum_micros_{0};
+  std::atomic<std::uint64_t> max_micros_{0};
+};
+
+struct MethodMetricsSnapshot {
+  std::uint64_t calls = 0;
+  std::uint64_t errors = 0;
+  std::uint64_t cache_hits = 0;
+  LatencySnapshot handler_latency;
+  LatencySnapshot queue_latency;
+};
+
+/// Shards that the counters of a method are split into
+constexpr std::size_t kMethodMetricShards = 8;
+
+/**
+ * @brief Counters of one method kept by the dispatcher
+ *
+ * Every thread that runs the method's calls updates them, so they are split
+ * into kMethodMetricShards cache-line-aligned shards. Each update goes to
+ * the shard picked by a hash of the calling thread's id, and Snapshot()
+ * sums the shards. A method takes about 40 KB, mostly histogram buckets.
+ */
+class MethodMetrics {
+ public:
+  void AddCall() noexcept {
+    Local().calls.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// A call answered with an error: handler exceptions and cancellations
+  void AddError() noexcept {
+    Local().errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// A call of an idempotent method answered from the result cache
+  void AddCacheHit() noexcept {
+    Local().cache_hits.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Time the handler ran
+  void RecordHandler(std::chrono::nanoseconds latency) noexcept {
+    Local().handler_latency.Record(latency);
+  }
+
+  /// Time from receiving the message to the handler starting, including
+  /// the wait for a serial method's earlier calls
+  void RecordQueue(std::chrono::nanoseconds latency) noexcept {
+    Local().queue_latency.Record(latency);
+  }
+
+  [[nodiscard]] auto Snapshot() const -> MethodMetricsSnapshot;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> errors{0};
+    std::atomic<std::uint64_t> cache_hits{0};
+    LatencyHistogram handler_latency;
+    LatencyHistogram queue_latency;
+  };
+
+  auto Local() noexcept -> Shard&;
+
+  std::array<Shard, kMethodMetricShards> shards_{};
+};
+
+/// Per-method metrics of a dispatcher, shared by all endpoints that use it
+struct DispatcherMetrics {
+  std::map<std::string, MethodMetricsSnapshot, std::less<>> methods;
+  /// Requests and notifications for methods without a handler
+  std::uint64_t unknown_method_calls = 0;
+};
+
+/// Receive failures seen by an endpoint's message loop, by kind
+struct ReceiveErrorStats {
+  /// Failures retried after a backoff
+  std::size_t transient = 0;
+  /// Failures that ended the loop because the transport lost its peer
+  std::size_t terminal = 0;
+};
+
+/**
+ * @brief Snapshot of an endpoint's counters, from RpcEndpoint::GetMetrics()
+ *
+ * Counters grow for the endpoint's lifetime; rates come from the difference
+ * between two snapshots.
+ */
+struct EndpointMetrics {
+  std::uint64_t messages_received = 0;
+  std::uint64_t messages_sent = 0;
+  /// Message bodies as the endpoint sees them, before framing and
+  /// compression
+  std::uint64_t bytes_received = 0;
+  std::uint64_t bytes_sent = 0;
+  /// Messages the transport could not frame
+  std::uint64_t framing_errors = 0;
+  ReceiveErrorStats receive_errors;
+  std::size_t pending_requests = 0;
+  std::size_t active_handlers = 0;
+  /// Handlers sent to the handler executor because the endpoint's thread
+  /// was past HandlerAffinity::spill_threshold
+  std::uint64_t spilled_handlers = 0;
+  transport::SendQueueStats send_queue;
+  DispatcherMetrics dispatcher;
+};
+
+/// Called with a fresh snapshot every EndpointOptions::metrics_interval
+using MetricsExporter = std::function<void(const EndpointMetrics &)>;
+
+/**
+ * @brief Render a snapshot in the Prometheus text exposition format
+ *
+ * Latencies become summaries with 0.5, 0.9 and 0.99 quantiles, in seconds,
+ * labelled by method.
+ * @param prefix Prepended to every metric name, followed by an underscore
+ */
+auto FormatPrometheus(
+    const EndpointMetrics &metrics, std::string_view prefix = "jsonrpc")
+    -> std::string;
+
+}  // namespace jsonrpc::endpoint
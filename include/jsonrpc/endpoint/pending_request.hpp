@@ -1,9 +1,10 @@
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
+#include <atomic>
+#include <string>
 
 #include <asio.hpp>
+#include <asio/experimental/concurrent_channel.hpp>
 #include <nlohmann/json.hpp>
 
 namespace jsonrpc::endpoint {
@@ -11,18 +12,19 @@ namespace jsonrpc::endpoint {
 /**
  * @brief A class representing a pending RPC request
  *
- * This class provides an awaitable interface for RPC requests using ASIO's
- * awaitable model directly.
+ * The result is delivered through a single-slot channel, so the coroutine
+ * waiting in GetResult() resumes as soon as SetResult() or Cancel() runs.
+ * Completion may happen from any thread.
  */
 class PendingRequest {
  public:
   /**
    * @brief Construct a new Pending Request object
    *
-   * @param strand The strand to use for synchronization
+   * @param executor The executor the completion channel is bound to
    */
-  explicit PendingRequest(asio::strand<asio::any_io_executor> strand)
-      : strand_(std::move(strand)) {
+  explicit PendingRequest(asio::any_io_executor executor)
+      : channel_(std::move(executor), 1) {
   }
 
   // Prevent copying and moving
@@ -39,20 +41,12 @@ class PendingRequest {
   /**
    * @brief Sets the result of the request
    *
+   * Only the first call has an effect; later results are dropped.
+   *
    * @param result The JSON result
    */
   void SetResult(nlohmann::json result) {
-    // Execute within the strand to ensure thread safety
-    asio::post(strand_, [this, result = std::move(result)]() mutable {
-      if (!is_ready_) {
-        result_ = std::move(result);
-        is_ready_ = true;
-
-        // Notify any waiting consumers
-        std::lock_guard<std::mutex> lock(mutex_);
-        ready_cv_.notify_all();
-      }
-    });
+    Complete(std::move(result), false);
   }
 
   /**
@@ -64,36 +58,29 @@ class PendingRequest {
   void Cancel(int code, const std::string& message) {
     // Create a JSON-RPC error object
     nlohmann::json error = {{"error", {{"code", code}, {"message", message}}}};
-
-    has_error_ = true;
-
-    // Set the result with the error
-    SetResult(std::move(error));
+    Complete(std::move(error), true);
   }
 
   /**
    * @brief Get the result asynchronously
    *
+   * The awaiting coroutine is suspended on the completion channel and resumed
+   * directly by SetResult() or Cancel(); no timer is involved. Cancelling
+   * the awaiting coroutine ends the wait early, leaving IsReady() false.
+   *
    * @return asio::awaitable<nlohmann::json> The result
    */
   auto GetResult() -> asio::awaitable<nlohmann::json> {
-    // If the result is already ready, return it immediately
-    if (is_ready_) {
-      co_return result_;
+    std::error_code ec;
+    auto result = co_await channel_.async_receive(
+        asio::redirect_error(asio::use_awaitable, ec));
+    if (ec) {
+      co_return nlohmann::json{
+          {"error",
+           {{"code", -32603},
+            {"message", "Pending request aborted: " + ec.message()}}}};
     }
-
-    // Otherwise, wait for the result using a timer and polling
-    // This is a simplified approach that works with ASIO
-    auto executor = co_await asio::this_coro::executor;
-    asio::steady_timer timer(executor, std::chrono::milliseconds(10));
-
-    while (!is_ready_) {
-      co_await timer.async_wait(asio::use_awaitable);
-      timer.expires_after(std::chrono::milliseconds(10));
-    }
-
-    // Return the result
-    co_return result_;
+    co_return result;
   }
 
   /**
@@ -102,7 +89,7 @@ class PendingRequest {
    * @return true if the result is ready, false otherwise
    */
   [[nodiscard]] bool IsReady() const {
-    return is_ready_;
+    return is_ready_.load();
   }
 
   /**
@@ -111,27 +98,41 @@ class PendingRequest {
    * @return true if the request has an error, false otherwise
    */
   [[nodiscard]] bool HasError() const {
-    return has_error_;
+    return has_error_.load();
+  }
+
+  /// Marks the request as scheduled on a timeout wheel; call it before the
+  /// request is published to other threads
+  void SetHasDeadline() {
+    has_deadline_ = true;
+  }
+
+  [[nodiscard]] auto HasDeadline() const -> bool {
+    return has_deadline_;
   }
 
  private:
-  /// Strand for synchronization
-  asio::strand<asio::any_io_executor> strand_;
+  void Complete(nlohmann::json result, bool is_error) {
+    // Only the first completion is delivered
+    if (is_ready_.exchange(true)) {
+      return;
+    }
+    has_error_ = is_error;
+    channel_.try_send(std::error_code{}, std::move(result));
+  }
 
-  /// The JSON result
-  nlohmann::json result_;
+  /// Single-slot channel carrying the result to the waiting coroutine
+  asio::experimental::concurrent_channel<void(
+      std::error_code, nlohmann::json)>
+      channel_;
 
   /// Flag indicating if the result is ready
-  bool is_ready_{};
+  std::atomic<bool> is_ready_{false};
 
   /// Flag indicating if the request has an error
-  bool has_error_{};
-
-  /// Mutex for condition variable
-  std::mutex mutex_;
+  std::atomic<bool> has_error_{false};
 
-  /// Condition variable for signaling
-  std::condition_variable ready_cv_;
+  bool has_deadline_{false};
 };
 
 }  // namespace jsonrpc::endpoint
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "jsonrpc/endpoint/pending_request.hpp"
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Fixed-size table of outstanding method calls, indexed by request id
+ *
+ * The table hands out request ids itself. An id maps to slot
+ * `id % capacity`, and since ids never repeat the id stored in a slot also
+ * serves as its generation: completing a call is a single compare-and-swap
+ * on the expected id, which cannot match a later call that reused the slot.
+ * When the slot for the next id is still busy, that id is skipped, so ids
+ * stay unique but are not always contiguous.
+ *
+ * Slots are allocated in segments the first time an id lands in them, so a
+ * large capacity costs memory only once that many ids have been used.
+ *
+ * All member functions are lock-free except Create(), which draws from a
+ * synchronized pool, and an Insert() that allocates a segment. They may be
+ * called from any thread.
+ */
+class PendingRequestTable {
+ public:
+  /**
+   * @brief Construct a new Pending Request Table object
+   *
+   * @param capacity Maximum number of outstanding calls, rounded up to a
+   * power of two
+   */
+  explicit PendingRequestTable(std::size_t capacity);
+
+  PendingRequestTable(const PendingRequestTable&) = delete;
+  PendingRequestTable(PendingRequestTable&&) = delete;
+  auto operator=(const PendingRequestTable&) -> PendingRequestTable& = delete;
+  auto operator=(PendingRequestTable&&) -> PendingRequestTable& = delete;
+
+  ~PendingRequestTable() = default;
+
+  /**
+   * @brief Allocate a pending request from the table's pool
+   *
+   * The pool must outlive the returned request, so the table has to outlive
+   * every call made through it.
+   */
+  auto Create(asio::any_io_executor executor)
+      -> std::shared_ptr<PendingRequest>;
+
+  /**
+   * @brief Register a request under a fresh id
+   *
+   * @return The id, or nullopt when every slot is busy
+   */
+  auto Insert(std::shared_ptr<PendingRequest> request)
+      -> std::optional<int64_t>;
+
+  /**
+   * @brief Remove the request registered under id
+   *
+   * @return The request, or nullptr if the id is unknown or already taken
+   */
+  auto Take(int64_t id) -> std::shared_ptr<PendingRequest>;
+
+  /**
+   * @brief Remove every registered request and cancel it with an error
+   *
+   * Requests inserted concurrently may be missed. Callers that stop taking
+   * calls set a flag first, and inserters check it after a seq_cst fence
+   * once Insert() returned; this scan starts with the matching fence.
+   */
+  void CancelAll(int code, const std::string& message);
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto Empty() const -> bool {
+    return Size() == 0;
+  }
+
+  [[nodiscard]] auto Capacity() const -> std::size_t {
+    return mask_ + 1;
+  }
+
+ private:
+  // Slot states; any non-negative value is the id of the registered call
+  static constexpr int64_t kFree = -1;
+  static constexpr int64_t kBusy = -2;
+
+  // Slots per segment, or fewer for a smaller table
+  static constexpr std::size_t kSegmentSlots = 1024;
+
+  struct Slot {
+    std::atomic<int64_t> state{kFree};
+    // Only accessed by the thread that moved state to kBusy
+    std::shared_ptr<PendingRequest> request;
+  };
+
+  struct Segment {
+    std::once_flag once;
+    // Set once slots exist, for readers that never allocate them
+    std::atomic<bool> allocated{false};
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  // The slot for id, allocating its segment; Insert() only
+  auto SlotFor(int64_t id) -> Slot&;
+
+  // The slot for id, or nullptr while its segment was never allocated
+  auto FindSlot(int64_t id) -> Slot*;
+
+  // Moves the request out of a slot whose state was swapped to kBusy
+  auto Release(Slot& slot) -> std::shared_ptr<PendingRequest>;
+
+  // Declared first so it outlives requests still held by the slots
+  std::pmr::synchronized_pool_resource pool_;
+  std::size_t mask_;
+  std::size_t segment_slots_;
+  std::vector<Segment> segments_;
+  std::atomic<int64_t> next_id_{0};
+  std::atomic<std::size_t> size_{0};
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/endpoint/jsonrpc_traits.hpp"
+#include "jsonrpc/endpoint/types.hpp"
+#include "jsonrpc/transport/transport.hpp"
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Tunables for a PooledRpcClient
+ */
+struct PoolOptions {
+  /// Number of connections; connection i uses factory i modulo the number of
+  /// factories
+  std::size_t connections = kDefaultPoolConnections;
+
+  /// Open connections Start() waits for before it returns; the others keep
+  /// connecting in the background. Zero waits for every attempt.
+  std::size_t ready_connections = 0;
+
+  /// Minimum time between connection attempts for the same connection
+  std::chrono::milliseconds reconnect_delay = kDefaultReconnectDelay;
+
+  /// How long Shutdown() lets outstanding calls finish before failing them.
+  /// A nullopt value waits for each call's own deadline.
+  std::optional<std::chrono::milliseconds> drain_timeout{};
+
+  /// Applied to every connection's endpoint
+  EndpointOptions endpoint{};
+};
+
+/**
+ * @brief Client that spreads calls over several connections
+ *
+ * Each call goes to the connected endpoint with the fewest outstanding
+ * method calls. Connections that fail or are closed by the server are
+ * reconnected on a later call, at most once per reconnect_delay; a call made
+ * while nothing is connected waits for the reconnect attempts in progress.
+ *
+ * Once started, the pool must be shut down before it is destroyed.
+ */
+class PooledRpcClient {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Creates the transport for one connection; it is started by the pool
+  using TransportFactory =
+      std::function<std::unique_ptr<transport::Transport>(
+          asio::any_io_executor)>;
+
+  PooledRpcClient(
+      asio::any_io_executor executor, TransportFactory factory,
+      PoolOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Construct a pool whose connections go to several servers
+   */
+  PooledRpcClient(
+      asio::any_io_executor executor, std::vector<TransportFactory> factories,
+      PoolOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  PooledRpcClient(const PooledRpcClient &) = delete;
+  PooledRpcClient(PooledRpcClient &&) = delete;
+  auto operator=(const PooledRpcClient &) -> PooledRpcClient & = delete;
+  auto operator=(PooledRpcClient &&) -> PooledRpcClient & = delete;
+
+  ~PooledRpcClient() = default;
+
+  /**
+   * @brief Open every connection
+   *
+   * All connections are opened at once. Succeeds if at least one could be
+   * opened; the others are retried lazily.
+   */
+  auto Start() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  /**
+   * @brief Stop taking calls, drain the outstanding ones and close every
+   * connection
+   */
+  auto Shutdown() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  [[nodiscard]] auto IsRunning() const -> bool {
+    return is_running_.load();
+  }
+
+  /// Number of connections currently open
+  [[nodiscard]] auto ConnectedCount() const -> std::size_t {
+    return connected_count_.load();
+  }
+
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
+    return logger_;
+  }
+
+  /// Sends a method call that expires after the endpoint's request timeout
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params = std::nullopt)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  /// Sends a method call that fails with kTimeoutError at the given deadline
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      Clock::time_point deadline)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  /// Sends a method call that fails with kTimeoutError after the timeout
+  auto SendMethodCall(
+      std::string method, std::optional<nlohmann::json> params,
+      std::chrono::milliseconds timeout)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  template <typename ParamsType, typename ResultType>
+  auto SendMethodCall(std::string method, ParamsType params)
+      -> asio::awaitable<std::expected<ResultType, RpcError>>
+    requires(SendableParams<ParamsType> && FromJson<ResultType>);
+
+  auto SendNotification(
+      std::string method, std::optional<nlohmann::json> params = std::nullopt)
+      -> asio::awaitable<std::expected<void, RpcError>>;
+
+ private:
+  struct Slot {
+    std::shared_ptr<RpcEndpoint> endpoint;
+    bool connecting = false;
+    Clock::time_point retry_after{};
+  };
+
+  /**
+   * @brief Pick the least loaded connected endpoint
+   *
+   * Resumes on strand_ and counts the caller as an active task, so the
+   * caller must call TaskFinished() once done with the endpoint. Starting a
+   * method call before the next suspension registers it with the endpoint,
+   * which keeps the counts seen by concurrent callers accurate.
+   */
+  auto Acquire()
+      -> asio::awaitable<std::expected<std::shared_ptr<RpcEndpoint>, RpcError>>;
+
+  auto SendMethodCallImpl(
+      std::string method, std::optional<nlohmann::json> params,
+      std::optional<Clock::time_point> deadline)
+      -> asio::awaitable<std::expected<nlohmann::json, RpcError>>;
+
+  // Must be called on strand_
+  void StartReconnect(std::size_t index);
+
+  auto Reconnect(std::size_t index) -> asio::awaitable<void>;
+
+  // Waits on strand_ for the next change of the pool's state
+  auto WaitForChange() -> asio::awaitable<void>;
+
+  void TaskFinished();
+
+  PoolOptions options_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  asio::any_io_executor executor_;
+
+  asio::strand<asio::any_io_executor> strand_;
+
+  std::vector<TransportFactory> factories_;
+
+  std::atomic<bool> is_running_{false};
+
+  std::atomic<std::size_t> connected_count_{0};
+
+  // Everything below is only touched on strand_
+  std::vector<Slot> slots_;
+
+  // Rotates the scan start so ties are broken round robin
+  std::size_t next_slot_ = 0;
+
+  // Calls and reconnects that have not finished yet
+  std::size_t active_tasks_ = 0;
+
+  std::optional<RpcError> last_connect_error_;
+
+  bool drain_expired_ = false;
+
+  // Never expires; cancelled to wake every waiter when the state changes
+  asio::steady_timer state_changed_;
+};
+
+template <typename ParamsType, typename ResultType>
+auto PooledRpcClient::SendMethodCall(std::string method, ParamsType params)
+    -> asio::awaitable<std::expected<ResultType, RpcError>>
+  requires(SendableParams<ParamsType> && FromJson<ResultType>)
+{
+  auto endpoint = co_await Acquire();
+  if (!endpoint) {
+    co_return std::unexpected(endpoint.error());
+  }
+  auto result =
+      co_await (*endpoint)->template SendMethodCall<ParamsType, ResultType>(
+          std::move(method), std::move(params));
+  TaskFinished();
+  co_return result;
+}
+
+}  // namespace jsonrpc::endpoint
@@ -9,6 +9,7 @@
 
 #include "jsonrpc/endpoint/types.hpp"
 #include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
 
 namespace jsonrpc::endpoint {
 
@@ -27,6 +28,14 @@ class Request {
   static auto FromJson(const nlohmann::json& json_obj)
       -> std::expected<Request, error::RpcError>;
 
+  /**
+   * @brief Build a request from a parsed message, moving its params out
+   *
+   * The message is left in a valid but unspecified state.
+   */
+  static auto FromJson(nlohmann::json&& json_obj)
+      -> std::expected<Request, error::RpcError>;
+
   [[nodiscard]] auto GetMethod() const -> const std::string& {
     return method_;
   }
@@ -35,6 +44,13 @@ class Request {
     return params_;
   }
 
+  /**
+   * @brief Move the params out of the request
+   */
+  [[nodiscard]] auto TakeParams() -> std::optional<nlohmann::json> {
+    return std::move(params_);
+  }
+
   [[nodiscard]] auto IsNotification() const -> bool {
     return is_notification_;
   }
@@ -43,10 +59,20 @@ class Request {
 
   [[nodiscard]] auto GetId() const -> RequestId;
 
+  /// Serialize with the build's JSON codec
   [[nodiscard]] auto Dump() const -> std::string;
 
   [[nodiscard]] auto ToJson() const -> nlohmann::json;
 
+  /**
+   * @brief Serialize in a wire encoding
+   *
+   * JSON is Dump(). Binary encodings are written straight from the params
+   * DOM, without building an envelope or going through JSON text.
+   */
+  [[nodiscard]] auto Encode(transport::MessageEncoding encoding) const
+      -> std::string;
+
  private:
   std::string method_;
   std::optional<nlohmann::json> params_;
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <expected>
+#include <memory>
 #include <optional>
+#include <string>
 
 #include <nlohmann/json.hpp>
 
 #include "jsonrpc/endpoint/types.hpp"
 #include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
 
 namespace jsonrpc::endpoint {
 
@@ -30,6 +33,15 @@ class Response {
       const nlohmann::json& result, const std::optional<RequestId>& id)
       -> Response;
 
+  /// Moves the result in instead of copying it
+  static auto CreateSuccess(
+      nlohmann::json&& result, const std::optional<RequestId>& id) -> Response;
+
+  /// Shares a result that outlives the response, such as a cached one
+  static auto CreateSuccess(
+      std::shared_ptr<const nlohmann::json> result,
+      const std::optional<RequestId>& id) -> Response;
+
   static auto CreateError(
       RpcErrorCode code, const std::optional<RequestId>& id = std::nullopt)
       -> Response;
@@ -52,14 +64,38 @@ class Response {
 
   [[nodiscard]] auto ToJson() const -> nlohmann::json;
 
+  /**
+   * @brief Serialize the response
+   *
+   * Only the id and the result or error are serialized; the envelope
+   * around them is written from constant fragments.
+   */
+  [[nodiscard]] auto Dump() const -> std::string;
+
+  /**
+   * @brief Serialize in a wire encoding
+   *
+   * JSON is Dump(). Binary encodings write the envelope directly and encode
+   * the result or error from its DOM, without going through JSON text.
+   */
+  [[nodiscard]] auto Encode(transport::MessageEncoding encoding) const
+      -> std::string;
+
  private:
-  explicit Response(nlohmann::json response) : response_(std::move(response)) {
+  Response(
+      std::shared_ptr<const nlohmann::json> body, bool is_success,
+      std::optional<nlohmann::json> id)
+      : body_(std::move(body)), is_success_(is_success), id_(std::move(id)) {
   }
 
-  [[nodiscard]] auto ValidateResponse() const
+  [[nodiscard]] static auto ValidateResponse(const nlohmann::json& response)
       -> std::expected<void, error::RpcError>;
 
-  nlohmann::json response_;
+  // The result, or the error object; the envelope is only built on demand
+  std::shared_ptr<const nlohmann::json> body_;
+  bool is_success_ = false;
+  // Without a value the response has no id member; errors may carry null
+  std::optional<nlohmann::json> id_;
 };
 
 }  // namespace jsonrpc::endpoint
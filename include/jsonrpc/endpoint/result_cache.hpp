@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Bounded LRU cache of idempotent method results, with single-flight
+ *
+ * Results are keyed on the method and the params' serialized text. As
+ * nlohmann::json keeps object members sorted, equal params give equal keys
+ * whatever order their members arrived in. Keys are spread over shards, each
+ * behind its own strand, so lookups of different keys rarely wait on each
+ * other. A lookup that misses while another call with the same key runs
+ * waits for that call's result instead of running the handler again.
+ */
+class ResultCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using ResultPtr = std::shared_ptr<const nlohmann::json>;
+
+ private:
+  struct Shard;
+  struct Flight;
+
+ public:
+  /**
+   * @brief The duty to fill a key, held by the one call that runs the handler
+   *
+   * Calls waiting on the key are released when the lease is fulfilled or
+   * dropped; after a dropped lease they run the handler themselves.
+   */
+  class Lease {
+   public:
+    Lease() = default;
+
+    Lease(const Lease&) = delete;
+    auto operator=(const Lease&) -> Lease& = delete;
+    Lease(Lease&&) noexcept = default;
+
+    // Releases the lease it replaces, so its waiters are not stranded
+    auto operator=(Lease&& other) -> Lease& {
+      if (this != &other) {
+        Release(nullptr, {});
+        shard_ = std::move(other.shard_);
+        key_ = std::move(other.key_);
+        flight_ = std::move(other.flight_);
+      }
+      return *this;
+    }
+
+    ~Lease() {
+      Release(nullptr, {});
+    }
+
+    /// Whether the lease still has to be fulfilled
+    [[nodiscard]] auto Holds() const -> bool {
+      return shard_ != nullptr;
+    }
+
+    /// Store the result for ttl and hand it to the calls waiting for it.
+    /// Does nothing, not even copy the result, on an empty lease.
+    void Fulfill(const nlohmann::json& result, std::chrono::milliseconds ttl) {
+      if (shard_) {
+        Release(std::make_shared<const nlohmann::json>(result), ttl);
+      }
+    }
+
+   private:
+    friend class ResultCache;
+
+    Lease(
+        std::shared_ptr<Shard> shard, std::string key,
+        std::shared_ptr<Flight> flight)
+        : shard_(std::move(shard)),
+          key_(std::move(key)),
+          flight_(std::move(flight)) {
+    }
+
+    void Release(ResultPtr result, std::chrono::milliseconds ttl);
+
+    std::shared_ptr<Shard> shard_;
+    std::string key_;
+    std::shared_ptr<Flight> flight_;
+  };
+
+  struct Lookup {
+    /// The cached result, or the one a running call with the same key made
+    ResultPtr hit;
+    /// Held on a miss that this caller has to fill
+    Lease lease;
+  };
+
+  /**
+   * @brief Construct a cache holding up to capacity results
+   *
+   * Capacity is split evenly over the shards. With zero capacity nothing is
+   * kept, but concurrent calls with equal keys still share one run.
+   */
+  ResultCache(
+      const asio::any_io_executor& executor, std::size_t capacity,
+      std::size_t shard_count);
+
+  /// The key a call of method with params is cached under
+  [[nodiscard]] static auto KeyOf(
+      std::string_view method, const std::optional<nlohmann::json>& params)
+      -> std::string;
+
+  /**
+   * @brief Look a key up, waiting for a running call with the same key
+   *
+   * @return A hit, or a lease on a miss. A caller that waited for a call
+   * that failed gets neither and runs the handler without caching.
+   */
+  auto Find(std::string key) -> asio::awaitable<Lookup>;
+
+  /**
+   * @brief Drop the cached results of a method
+   *
+   * Calls of the method already running do not store their results, and
+   * later lookups do not wait for them.
+   */
+  auto Invalidate(std::string_view method) -> asio::awaitable<void>;
+
+  /// Drop every cached result
+  auto Clear() -> asio::awaitable<void>;
+
+  /// Number of cached results, expired ones included until looked up
+  auto Size() -> asio::awaitable<std::size_t>;
+
+ private:
+  // Drops entries and detaches flights whose keys start with prefix
+  auto Drop(std::string_view prefix) -> asio::awaitable<void>;
+
+  [[nodiscard]] auto ShardFor(std::string_view key) const
+      -> const std::shared_ptr<Shard>&;
+
+  std::vector<std::shared_ptr<Shard>> shards_;
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <expected>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Where a streaming method call writes its result, part by part
+ *
+ * When the caller put a partialResultToken in the params, every Write()
+ * goes to it right away as a $/progress notification, the way LSP streams
+ * partial results, and the response carries an empty array. The handler
+ * then only ever holds one part. Otherwise the parts are collected and the
+ * response carries all of them as one array.
+ */
+class ResultStream {
+ public:
+  /// Sends a serialized notification to the peer that made the call
+  using Sender = std::function<asio::awaitable<
+      std::expected<void, error::RpcError>>(std::string)>;
+
+  /// Streams to token through sender when both are set, otherwise collects
+  ResultStream(std::optional<nlohmann::json> token, Sender sender);
+
+  /// The partialResultToken of params, if they have a valid one
+  static auto TokenOf(const std::optional<nlohmann::json>& params)
+      -> std::optional<nlohmann::json>;
+
+  /// Whether parts go to the peer as they are written
+  [[nodiscard]] auto IsStreaming() const -> bool {
+    return token_.has_value();
+  }
+
+  /**
+   * @brief Add items to the result
+   *
+   * An array adds each of its elements; any other value adds itself. Awaits
+   * the transport's backpressure while streaming.
+   */
+  auto Write(nlohmann::json items)
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  /// The result to answer the call with
+  auto TakeResult() -> nlohmann::json;
+
+ private:
+  std::optional<nlohmann::json> token_;
+  Sender sender_;
+  nlohmann::json collected_ = nlohmann::json::array();
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/dispatcher.hpp"
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/endpoint/jsonrpc_traits.hpp"
+#include "jsonrpc/endpoint/typed_handlers.hpp"
+#include "jsonrpc/endpoint/types.hpp"
+#include "jsonrpc/endpoint/worker_pool.hpp"
+#include "jsonrpc/transport/acceptor.hpp"
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Tunables for an RpcServer
+ *
+ * Per-connection memory is bounded by the TransportOptions given to the
+ * acceptors (message size, read buffer and send queue limits) together with
+ * endpoint.max_pending_requests.
+ */
+struct ServerOptions {
+  /// Connections accepted while this many sessions are open are closed
+  /// right away
+  std::size_t max_connections = kDefaultMaxConnections;
+
+  /// Sessions without traffic, outstanding calls or running handlers for
+  /// this long are closed. A nullopt value keeps idle sessions open.
+  std::optional<std::chrono::milliseconds> idle_timeout{};
+
+  /// Applied to every session. Its dispatcher and handler_executor settings
+  /// configure the dispatcher all sessions share.
+  EndpointOptions endpoint{};
+
+  /// Places each session on the worker with the fewest connections, where
+  /// its transport, message loop and parallel handlers all run. Handlers
+  /// past endpoint.handler_affinity.spill_threshold on a worker go to the
+  /// handler executor instead. The pool must outlive the server.
+  std::shared_ptr<WorkerPool> workers{};
+};
+
+/**
+ * @brief Serves any number of peers, one RpcEndpoint session per connection
+ *
+ * Every acceptor runs its own accept loop on its own executor, and its
+ * sessions stay on that executor unless ServerOptions::workers places them.
+ * Handlers are registered once on a dispatcher shared by all sessions, so
+ * register them before Start(); a serial method is serial across all
+ * connections.
+ *
+ * Shutdown() waits for the sessions' handlers to return, so a handler must
+ * not await it; spawn it detached instead. Once started, the server must be
+ * shut down before it is destroyed.
+ */
+class RpcServer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  RpcServer(
+      asio::any_io_executor executor,
+      std::unique_ptr<transport::Acceptor> acceptor, ServerOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Construct a server that accepts on several acceptors
+   *
+   * Typically SocketAcceptors with reuse_port sharing one port, each on the
+   * executor of a different thread.
+   */
+  RpcServer(
+      asio::any_io_executor executor,
+      std::vector<std::unique_ptr<transport::Acceptor>> acceptors,
+      ServerOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  RpcServer(const RpcServer &) = delete;
+  RpcServer(RpcServer &&) = delete;
+  auto operator=(const RpcServer &) -> RpcServer & = delete;
+  auto operator=(RpcServer &&) -> RpcServer & = delete;
+
+  ~RpcServer() = default;
+
+  /**
+   * @brief Listen on every acceptor and start accepting
+   *
+   * Completes once the acceptors listen, without waiting for a peer.
+   */
+  auto Start() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  /**
+   * @brief Wait until Shutdown() has closed every session
+   */
+  auto WaitForShutdown() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  /**
+   * @brief Stop accepting, shut down every session and wait for them to end
+   */
+  auto Shutdown() -> asio::awaitable<std::expected<void, RpcError>>;
+
+  [[nodiscard]] auto IsRunning() const -> bool {
+    return is_running_.load();
+  }
+
+  /// Number of open sessions
+  [[nodiscard]] auto ConnectionCount() const -> std::size_t {
+    return connection_count_.load();
+  }
+
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
+    return logger_;
+  }
+
+  void RegisterMethodCall(
+      std::string method, typename Dispatcher::MethodCallHandler handler,
+      HandlerOptions options = {});
+
+  template <typename ParamsType, typename ResultType>
+  void RegisterMethodCall(
+      std::string method,
+      std::function<asio::awaitable<ResultType>(ParamsType)> handler,
+      HandlerOptions options = {})
+    requires(FromJson<ParamsType> && ToJson<ResultType>);
+
+  template <typename ParamsType, typename ResultType, typename ErrorType>
+  void RegisterMethodCall(
+      std::string method,
+      std::function<
+          asio::awaitable<std::expected<ResultType, ErrorType>>(ParamsType)>
+          handler,
+      HandlerOptions options = {})
+    requires(FromJson<ParamsType> && ToJson<ResultType> && ToJson<ErrorType>);
+
+  void RegisterNotification(
+      std::string method, typename Dispatcher::NotificationHandler handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call that decodes its params on demand
+   *
+   * The params reach the handler as JSON text behind LazyParams, so a
+   * handler that only reads a field or two of a large message never builds
+   * the rest. Only JSON messages skip the params DOM.
+   */
+  void RegisterLazyMethodCall(
+      std::string method, typename Dispatcher::LazyMethodCallHandler handler,
+      HandlerOptions options = {});
+
+  /// Notification counterpart of RegisterLazyMethodCall()
+  void RegisterLazyNotification(
+      std::string method, typename Dispatcher::LazyNotificationHandler handler,
+      HandlerOptions options = {});
+
+  /**
+   * @brief Register a method call that writes its result in parts
+   *
+   * Parts reach callers that sent a partialResultToken as $/progress
+   * notifications while the handler runs; other callers get them all in
+   * the response.
+   */
+  void RegisterStreamingMethodCall(
+      std::string method,
+      typename Dispatcher::StreamingMethodCallHandler handler,
+      HandlerOptions options = {});
+
+  /// Drop the cached results of an idempotent method, as
+  /// Dispatcher::InvalidateCache() does, for every connection at once
+  auto InvalidateCache(std::string_view method) -> asio::awaitable<void> {
+    co_await dispatcher_->InvalidateCache(method);
+  }
+
+  template <typename ParamsType, typename ErrorType>
+  void RegisterNotification(
+      std::string method,
+      std::function<asio::awaitable<std::expected<void, ErrorType>>(ParamsType)>
+          handler,
+      HandlerOptions options = {})
+    requires(FromJson<ParamsType> && HasMessageMethod<ErrorType>);
+
+ private:
+  struct Session {
+    std::shared_ptr<RpcEndpoint> endpoint;
+    asio::any_io_executor executor;
+    // Empty without a worker pool
+    WorkerPool::Placement placement;
+  };
+
+  auto AcceptLoop(transport::Acceptor &acceptor) -> asio::awaitable<void>;
+
+  // Owns one session from its start until it is removed from sessions_
+  auto RunSession(uint64_t id, std::shared_ptr<RpcEndpoint> endpoint)
+      -> asio::awaitable<void>;
+
+  auto ReapIdleSessions() -> asio::awaitable<void>;
+
+  static void ShutdownSession(const Session &session);
+
+  // Counted down on strand_ so Shutdown() cannot return while a task still
+  // touches the server
+  void TaskFinished();
+
+  ServerOptions options_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  asio::any_io_executor executor_;
+
+  asio::strand<asio::any_io_executor> strand_;
+
+  std::vector<std::unique_ptr<transport::Acceptor>> acceptors_;
+
+  std::shared_ptr<Dispatcher> dispatcher_;
+
+  std::atomic<bool> is_running_{false};
+
+  std::atomic<std::size_t> connection_count_{0};
+
+  // Everything below is only touched on strand_
+  std::unordered_map<uint64_t, Session> sessions_;
+
+  uint64_t next_session_id_ = 0;
+
+  // Accept loops, sessions and the reaper that have not finished yet
+  std::size_t active_tasks_ = 0;
+
+  asio::steady_timer reap_timer_;
+
+  // Never expires; cancelled when the last task finishes
+  asio::steady_timer state_changed_;
+};
+
+template <typename ParamsType, typename ResultType>
+void RpcServer::RegisterMethodCall(
+    std::string method,
+    std::function<asio::awaitable<ResultType>(ParamsType)> handler,
+    HandlerOptions options)
+  requires(FromJson<ParamsType> && ToJson<ResultType>)
+{
+  auto typed_handler =
+      std::make_shared<TypedMethodHandler<ParamsType, ResultType>>(
+          std::move(handler));
+
+  RegisterMethodCall(
+      method,
+      [handler = std::move(typed_handler)](
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
+}
+
+template <typename ParamsType, typename ResultType, typename ErrorType>
+void RpcServer::RegisterMethodCall(
+    std::string method,
+    std::function<
+        asio::awaitable<std::expected<ResultType, ErrorType>>(ParamsType)>
+        handler,
+    HandlerOptions options)
+  requires(FromJson<ParamsType> && ToJson<ResultType> && ToJson<ErrorType>)
+{
+  auto typed_handler =
+      std::make_shared<TypedMethodHandler<ParamsType, ResultType, ErrorType>>(
+          std::move(handler));
+
+  RegisterMethodCall(
+      method,
+      [handler = std::move(typed_handler)](
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
+}
+
+template <typename ParamsType, typename ErrorType>
+void RpcServer::RegisterNotification(
+    std::string method,
+    std::function<asio::awaitable<std::expected<void, ErrorType>>(ParamsType)>
+        handler,
+    HandlerOptions options)
+  requires(FromJson<ParamsType> && HasMessageMethod<ErrorType>)
+{
+  auto typed_handler =
+      std::make_shared<TypedNotificationHandler<ParamsType, ErrorType>>(
+          std::move(handler));
+
+  RegisterNotification(
+      method,
+      [handler = std::move(typed_handler)](
+          std::optional<nlohmann::json> &&params) {
+        return (*handler)(std::move(params));
+      },
+      options);
+}
+
+}  // namespace jsonrpc::endpoint
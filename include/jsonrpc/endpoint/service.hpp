@@ -0,0 +1,250 @@
+#pragma once
+
+/**
+ * @file service.hpp
+ * @brief Compile-time descriptions of typed JSON-RPC services
+ *
+ * A service lists its methods as types, each carrying the method name and
+ * its params and result types:
+ *
+ * @code
+ * using Add = MethodCall<"add", AddParams, Result>;
+ * using Stop = Notification<"stop", StopParams>;
+ * using Calculator = Service<Add, Stop>;
+ * @endcode
+ *
+ * The server implements the service with one Handle() overload per entry,
+ * picked by overload resolution on the entry type, and binds it with
+ * RegisterService(). Clients call through ServiceClient, which only accepts
+ * entries of the service with their declared types. Both sides convert
+ * straight between the declared types and the message, without the
+ * std::function layers of the typed handlers in typed_handlers.hpp.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <asio/awaitable.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/dispatcher.hpp"
+#include "jsonrpc/endpoint/jsonrpc_traits.hpp"
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::endpoint {
+
+/// String literal usable as a template argument
+template <std::size_t N>
+struct MethodName {
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  consteval MethodName(const char (&name)[N]) {
+    std::copy_n(name, N, value);
+  }
+
+  [[nodiscard]] constexpr auto View() const -> std::string_view {
+    return {value, N - 1};
+  }
+
+  char value[N]{};
+};
+
+/// A method call of a service, answered with a ResultType
+template <MethodName Name, typename ParamsType, typename ResultType>
+  requires(JsonConvertible<ParamsType> && JsonConvertible<ResultType>)
+struct MethodCall {
+  static constexpr std::string_view kName = Name.View();
+  static constexpr bool kIsNotification = false;
+  using Params = ParamsType;
+  using Result = ResultType;
+  using HandlerResult = asio::awaitable<ResultType>;
+};
+
+/// A notification of a service
+template <MethodName Name, typename ParamsType>
+  requires(JsonConvertible<ParamsType>)
+struct Notification {
+  static constexpr std::string_view kName = Name.View();
+  static constexpr bool kIsNotification = true;
+  using Params = ParamsType;
+  using HandlerResult = asio::awaitable<void>;
+};
+
+/// The entries of a service; method names must be unique
+template <typename... Entries>
+struct Service {
+  /// Whether Entry is one of the service's entries
+  template <typename Entry>
+  static constexpr bool kHas = (std::is_same_v<Entry, Entries> || ...);
+
+ private:
+  static consteval auto NamesAreUnique() -> bool {
+    std::string_view names[] = {Entries::kName...};
+    for (std::size_t i = 0; i < sizeof...(Entries); ++i) {
+      for (std::size_t j = i + 1; j < sizeof...(Entries); ++j) {
+        if (names[i] == names[j]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  static_assert(sizeof...(Entries) > 0, "A service needs at least one entry");
+  static_assert(NamesAreUnique(), "Service method names must be unique");
+};
+
+/// Impl answers Entry with an overload of Handle()
+template <typename Impl, typename Entry>
+concept HandlesEntry = requires(Impl& impl, typename Entry::Params params) {
+  {
+    impl.Handle(Entry{}, std::move(params))
+  } -> std::same_as<typename Entry::HandlerResult>;
+};
+
+namespace detail {
+
+template <typename Entry>
+auto ParseParams(std::optional<nlohmann::json>&& params) ->
+    typename Entry::Params {
+  if (!params.has_value()) {
+    return typename Entry::Params{};
+  }
+  try {
+    return params->template get<typename Entry::Params>();
+  } catch (const nlohmann::json::exception& ex) {
+    throw std::runtime_error(
+        "Failed to parse parameters: " + std::string(ex.what()));
+  }
+}
+
+// Coroutines rather than coroutine lambdas, so the frame owns impl and the
+// params instead of referring to a closure that may be gone
+template <typename Entry, typename Impl>
+auto HandleCall(
+    std::shared_ptr<Impl> impl, std::optional<nlohmann::json> params)
+    -> asio::awaitable<nlohmann::json> {
+  co_return nlohmann::json(
+      co_await impl->Handle(Entry{}, ParseParams<Entry>(std::move(params))));
+}
+
+template <typename Entry, typename Impl>
+auto HandleNotification(
+    std::shared_ptr<Impl> impl, std::optional<nlohmann::json> params)
+    -> asio::awaitable<void> {
+  typename Entry::Params typed_params;
+  try {
+    typed_params = ParseParams<Entry>(std::move(params));
+  } catch (const std::runtime_error&) {
+    // Notifications have no one to report the error to
+    co_return;
+  }
+  co_await impl->Handle(Entry{}, std::move(typed_params));
+}
+
+template <typename Entry, typename Impl, typename Registrar>
+void RegisterEntry(
+    Registrar& registrar, const std::shared_ptr<Impl>& impl,
+    HandlerOptions options) {
+  // The dispatcher's handler is the only type erasure left, and it holds the
+  // shared_ptr inline; the call into Impl resolves at compile time
+  if constexpr (Entry::kIsNotification) {
+    registrar.RegisterNotification(
+        std::string(Entry::kName),
+        [impl](std::optional<nlohmann::json>&& params) {
+          return HandleNotification<Entry>(impl, std::move(params));
+        },
+        options);
+  } else {
+    registrar.RegisterMethodCall(
+        std::string(Entry::kName),
+        [impl](std::optional<nlohmann::json>&& params) {
+          return HandleCall<Entry>(impl, std::move(params));
+        },
+        options);
+  }
+}
+
+template <typename ServiceType>
+struct ServiceTraits;
+
+template <typename... Entries>
+struct ServiceTraits<Service<Entries...>> {
+  template <typename Impl, typename Registrar>
+  static void Register(
+      Registrar& registrar, const std::shared_ptr<Impl>& impl,
+      HandlerOptions options) {
+    (RegisterEntry<Entries>(registrar, impl, options), ...);
+  }
+
+  template <typename Impl>
+  static constexpr bool kImplements = (HandlesEntry<Impl, Entries> && ...);
+};
+
+}  // namespace detail
+
+/**
+ * @brief Register every entry of a service on an endpoint, server or
+ * dispatcher
+ *
+ * Impl must provide a Handle(Entry, Params) overload for every entry. The
+ * registered handlers share ownership of impl.
+ */
+template <typename ServiceType, typename Impl, typename Registrar>
+  requires(detail::ServiceTraits<ServiceType>::template kImplements<Impl>)
+void RegisterService(
+    Registrar& registrar, std::shared_ptr<Impl> impl,
+    HandlerOptions options = {}) {
+  detail::ServiceTraits<ServiceType>::Register(registrar, impl, options);
+}
+
+/**
+ * @brief Typed client stub for a service
+ *
+ * Wraps anything with the typed SendMethodCall and SendNotification of
+ * RpcEndpoint, such as PooledRpcClient. The caller must outlive the stub.
+ */
+template <typename ServiceType, typename Caller>
+class ServiceClient {
+ public:
+  explicit ServiceClient(Caller& caller) : caller_(caller) {
+  }
+
+  template <typename Entry>
+    requires(ServiceType::template kHas<Entry> && !Entry::kIsNotification)
+  auto Call(typename Entry::Params params) -> asio::awaitable<
+      std::expected<typename Entry::Result, error::RpcError>> {
+    co_return co_await caller_.template SendMethodCall<
+        typename Entry::Params, typename Entry::Result>(
+        std::string(Entry::kName), std::move(params));
+  }
+
+  template <typename Entry>
+    requires(ServiceType::template kHas<Entry> && Entry::kIsNotification)
+  auto Notify(typename Entry::Params params)
+      -> asio::awaitable<std::expected<void, error::RpcError>> {
+    nlohmann::json json_params;
+    try {
+      json_params = std::move(params);
+    } catch (const nlohmann::json::exception& ex) {
+      co_return error::RpcError::UnexpectedFromCode(
+          error::RpcErrorCode::kClientSerializationError,
+          "Failed to convert notification parameters: " +
+              std::string(ex.what()));
+    }
+    co_return co_await caller_.SendNotification(
+        std::string(Entry::kName), std::move(json_params));
+  }
+
+ private:
+  Caller& caller_;
+};
+
+}  // namespace jsonrpc::endpoint
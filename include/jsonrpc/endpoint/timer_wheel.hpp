@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <asio.hpp>
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief A hashed timer wheel that tracks request deadlines
+ *
+ * All deadlines share a single steady_timer which only runs while entries are
+ * scheduled. Ids that complete before their deadline are cancelled, so the
+ * timer stops as soon as nothing is left to expire. Scheduling and
+ * cancelling are O(1) on average.
+ *
+ * All member functions must be called from the strand passed at construction.
+ */
+class TimerWheel {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using ExpiryHandler = std::function<void(int64_t)>;
+
+  /**
+   * @brief Construct a new Timer Wheel object
+   *
+   * @param strand The strand the timer and expiry handler run on
+   * @param tick The resolution of the wheel
+   * @param slot_count The number of slots in the wheel
+   * @param on_expiry Invoked for every id whose deadline has passed
+   */
+  TimerWheel(
+      asio::strand<asio::any_io_executor> strand,
+      std::chrono::milliseconds tick, std::size_t slot_count,
+      ExpiryHandler on_expiry);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel(TimerWheel&&) = delete;
+  auto operator=(const TimerWheel&) -> TimerWheel& = delete;
+  auto operator=(TimerWheel&&) -> TimerWheel& = delete;
+
+  ~TimerWheel() = default;
+
+  /**
+   * @brief Schedule an id to expire at the given deadline
+   */
+  void Schedule(int64_t id, Clock::time_point deadline);
+
+  /**
+   * @brief Remove an id before its deadline; unknown ids are ignored
+   */
+  void Cancel(int64_t id);
+
+  /**
+   * @brief Drop all entries and stop the timer
+   */
+  void Stop();
+
+  /**
+   * @brief Number of entries neither expired nor cancelled
+   */
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return expiry_ticks_.size();
+  }
+
+ private:
+  struct Entry {
+    int64_t id;
+    uint64_t expiry_tick;
+  };
+
+  [[nodiscard]] auto TickFor(Clock::time_point time) const -> uint64_t;
+
+  void Arm();
+
+  void Advance();
+
+  asio::steady_timer timer_;
+  std::chrono::milliseconds tick_;
+  std::vector<std::vector<Entry>> slots_;
+  // Where each scheduled id sits, for Cancel()
+  std::unordered_map<int64_t, uint64_t> expiry_ticks_;
+  ExpiryHandler on_expiry_;
+  Clock::time_point origin_;
+  uint64_t current_tick_{0};
+  bool armed_{false};
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::endpoint {
+
+constexpr std::size_t kDefaultCaptureBufferBytes = 64 * 1024;
+
+constexpr std::size_t kDefaultCaptureMaxPendingBytes = 16 * 1024 * 1024;
+
+/**
+ * @brief Tunables for a TrafficCapture
+ */
+struct CaptureOptions {
+  /// Record one in this many messages; one records them all
+  std::size_t sample_one_in = 1;
+
+  /// Also record what endpoints send. Replay only needs what they receive.
+  bool outgoing = true;
+
+  /// Recorded lines are written to the file once this many bytes collect
+  std::size_t buffer_bytes = kDefaultCaptureBufferBytes;
+
+  /// Messages are dropped while this many bytes wait to be written, so a
+  /// slow disk never holds up the endpoints
+  std::size_t max_pending_bytes = kDefaultCaptureMaxPendingBytes;
+};
+
+enum class CaptureDirection {
+  /// Received by the endpoint
+  kIncoming,
+  /// Sent by the endpoint
+  kOutgoing,
+};
+
+/// One line of a capture
+struct CapturedMessage {
+  /// Since the capture started
+  std::chrono::microseconds at{0};
+  CaptureDirection direction = CaptureDirection::kIncoming;
+  /// Endpoint that saw the message, unique within a dispatcher
+  std::uint64_t peer = 0;
+  nlohmann::json message;
+};
+
+/**
+ * @brief Records the traffic of endpoints to a JSONL file for replay
+ *
+ * Each line is an object such as
+ * `{"t_us":1500,"dir":"in","peer":1,"message":{...}}` holding the message
+ * as it went over the wire. Endpoints point EndpointOptions::capture at
+ * one; the sessions of an RpcServer share it. Recording copies the message
+ * and posts it to the capture's strand, which buffers lines and writes
+ * them out in blocks, so pass an executor of its own to keep the writes off
+ * the endpoints' threads.
+ */
+class TrafficCapture : public std::enable_shared_from_this<TrafficCapture> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Open a capture file, truncating it
+   *
+   * @return The capture, or kInternalError if the file cannot be opened
+   */
+  static auto Create(
+      asio::any_io_executor executor, const std::string& path,
+      CaptureOptions options = {})
+      -> std::expected<std::shared_ptr<TrafficCapture>, error::RpcError>;
+
+  TrafficCapture(const TrafficCapture&) = delete;
+  TrafficCapture(TrafficCapture&&) = delete;
+  auto operator=(const TrafficCapture&) -> TrafficCapture& = delete;
+  auto operator=(TrafficCapture&&) -> TrafficCapture& = delete;
+
+  /// Writes whatever is still buffered
+  ~TrafficCapture();
+
+  /**
+   * @brief Whether the next message in this direction is to be recorded
+   *
+   * Cheap enough to ask for every message; counts toward the sampling.
+   */
+  auto ShouldRecord(CaptureDirection direction) -> bool;
+
+  /**
+   * @brief Record a message. Safe to call from any thread.
+   *
+   * @param message JSON text of one message or batch
+   */
+  void Record(
+      CaptureDirection direction, std::uint64_t peer,
+      std::string_view message);
+
+  /// Write out and flush everything recorded so far
+  auto Flush() -> asio::awaitable<void>;
+
+  /// Messages handed to the strand for writing
+  [[nodiscard]] auto Recorded() const -> std::uint64_t {
+    return recorded_.load(std::memory_order_relaxed);
+  }
+
+  /// Messages dropped over max_pending_bytes
+  [[nodiscard]] auto Dropped() const -> std::uint64_t {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Parse one line of a capture
+   *
+   * Also takes a bare JSON-RPC message or batch, as an incoming message at
+   * time zero, so any JSONL of messages can be replayed.
+   *
+   * @return The message, or nullopt for lines that are neither
+   */
+  static auto ParseLine(std::string_view line)
+      -> std::optional<CapturedMessage>;
+
+ private:
+  TrafficCapture(
+      asio::any_io_executor executor, std::ofstream file,
+      CaptureOptions options);
+
+  void Append(std::string line);
+
+  void WriteOut();
+
+  asio::strand<asio::any_io_executor> strand_;
+  CaptureOptions options_;
+  Clock::time_point started_ = Clock::now();
+
+  // Only touched on the strand
+  std::ofstream file_;
+  std::string buffer_;
+
+  std::atomic<std::uint64_t> sampled_{0};
+  std::atomic<std::size_t> pending_bytes_{0};
+  std::atomic<std::uint64_t> recorded_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <istream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/endpoint/metrics.hpp"
+#include "jsonrpc/endpoint/traffic_capture.hpp"
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::endpoint {
+
+constexpr std::size_t kDefaultReplayInFlight = 64;
+
+/// Process resources, read by ReplayOptions::counters
+struct ResourceCounters {
+  std::uint64_t allocations = 0;
+  std::chrono::microseconds cpu{0};
+
+  auto operator+=(const ResourceCounters& other) -> ResourceCounters& {
+    allocations += other.allocations;
+    cpu += other.cpu;
+    return *this;
+  }
+
+  auto operator-(const ResourceCounters& other) const -> ResourceCounters {
+    return ResourceCounters{
+        .allocations = allocations - other.allocations,
+        .cpu = cpu - other.cpu};
+  }
+};
+
+/**
+ * @brief How TrafficReplay paces what it sends
+ */
+struct ReplayOptions {
+  /// Messages sent per second. Zero sends as fast as max_in_flight allows.
+  double rate = 0.0;
+
+  /// Send at the pace the capture was recorded at instead, sped up by speed
+  bool recorded_timing = false;
+  double speed = 1.0;
+
+  /// Most method calls awaiting their results at once
+  std::size_t max_in_flight = kDefaultReplayInFlight;
+
+  /// Times the capture is played over
+  std::size_t loops = 1;
+
+  /// Reads the process's counters, such as a counting operator new and
+  /// getrusage. Read around the run, and around every message when
+  /// max_in_flight is one so that each method gets its own share.
+  std::function<ResourceCounters()> counters{};
+};
+
+/// What the messages of one method cost during a replay
+struct MethodReplayReport {
+  std::uint64_t sent = 0;
+  /// Failed sends, and calls answered with an error or timing out
+  std::uint64_t errors = 0;
+  /// From send to result; notifications until they were handed on
+  LatencySnapshot latency;
+  /// Over all of the method's messages, only with max_in_flight of one
+  std::optional<ResourceCounters> resources;
+};
+
+struct ReplayReport {
+  std::chrono::nanoseconds elapsed{0};
+  std::uint64_t sent = 0;
+  std::uint64_t errors = 0;
+  /// Over the whole run, when ReplayOptions::counters is set
+  std::optional<ResourceCounters> resources;
+  std::map<std::string, MethodReplayReport> methods;
+
+  /// Messages per second over the run
+  [[nodiscard]] auto Throughput(std::uint64_t messages) const -> double {
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? static_cast<double>(messages) / seconds : 0.0;
+  }
+};
+
+/**
+ * @brief Plays recorded traffic into a peer through a client endpoint
+ *
+ * Replays the method calls and notifications a TrafficCapture saw arrive,
+ * or those of any JSONL file of JSON-RPC messages, with batches taken
+ * apart. Responses and sent messages are left out, as the peer produces
+ * its own. Works over whatever transport the endpoint has.
+ */
+class TrafficReplay {
+ public:
+  explicit TrafficReplay(std::vector<CapturedMessage> messages);
+
+  /// Read a capture line by line, skipping lines that are not messages
+  static auto Load(std::istream& input) -> TrafficReplay;
+
+  static auto LoadFile(const std::string& path)
+      -> std::expected<TrafficReplay, error::RpcError>;
+
+  /// Messages each loop sends
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return messages_.size();
+  }
+
+  /// The calls and notifications each loop sends, in capture order
+  [[nodiscard]] auto Messages() const -> const std::vector<CapturedMessage>& {
+    return messages_;
+  }
+
+  /// Lines and messages left out: unparsable, responses, outgoing
+  [[nodiscard]] auto Skipped() const -> std::size_t {
+    return skipped_;
+  }
+
+  /**
+   * @brief Send the traffic through a started client and wait for results
+   *
+   * The endpoint must stay alive until the replay returns.
+   */
+  auto Run(RpcEndpoint& client, ReplayOptions options = {}) const
+      -> asio::awaitable<ReplayReport>;
+
+ private:
+  struct RunState;
+
+  auto RunOnStrand(RpcEndpoint& client, const ReplayOptions& options) const
+      -> asio::awaitable<ReplayReport>;
+
+  auto Send(
+      RpcEndpoint& client, const nlohmann::json& message, RunState& run,
+      const ReplayOptions& options) const -> asio::awaitable<void>;
+
+  void Add(CapturedMessage captured);
+
+  std::vector<CapturedMessage> messages_;
+  std::size_t skipped_ = 0;
+};
+
+}  // namespace jsonrpc::endpoint
@@ -77,14 +77,14 @@ class TypedMethodHandler {
 
     if constexpr (std::is_same_v<ErrorType, std::monostate>) {
       if constexpr (std::is_void_v<ResultType>) {
-        co_await handler_(typed_params);
+        co_await handler_(std::move(typed_params));
         co_return nlohmann::json();
       } else {
-        ResultType result = co_await handler_(typed_params);
+        ResultType result = co_await handler_(std::move(typed_params));
         co_return nlohmann::json(result);
       }
     } else {
-      auto result = co_await handler_(typed_params);
+      auto result = co_await handler_(std::move(typed_params));
       if (result) {
         if constexpr (std::is_void_v<ResultType>) {
           co_return nlohmann::json();
@@ -135,9 +135,9 @@ class TypedNotificationHandler {
     }
 
     if constexpr (std::is_same_v<ErrorType, std::monostate>) {
-      co_await handler_(typed_params);
+      co_await handler_(std::move(typed_params));
     } else {
-      auto result = co_await handler_(typed_params);
+      auto result = co_await handler_(std::move(typed_params));
       if (!result) {
         // Error ignored - notification handlers don't propagate errors
       }
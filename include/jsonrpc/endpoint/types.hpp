@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -12,6 +13,18 @@ namespace jsonrpc::endpoint {
 
 constexpr std::string_view kJsonRpcVersion = "2.0";
 
+/// Method a client calls to agree on a binary message encoding
+constexpr std::string_view kNegotiateEncodingMethod = "$/negotiateEncoding";
+
+/// Notification asking the peer to stop a running method call
+constexpr std::string_view kCancelRequestMethod = "$/cancelRequest";
+
+/// Notification carrying part of a method call's result, as in LSP
+constexpr std::string_view kProgressMethod = "$/progress";
+
+/// Params member a caller sets to ask for results in $/progress parts
+constexpr std::string_view kPartialResultTokenKey = "partialResultToken";
+
 using RequestId = std::variant<int64_t, std::string>;
 
 using MethodCallHandler =
@@ -23,6 +36,36 @@ using Handler = std::variant<MethodCallHandler, NotificationHandler>;
 
 constexpr auto kDefaultRequestTimeout = std::chrono::milliseconds(30000);
 
+constexpr auto kDefaultTimeoutTick = std::chrono::milliseconds(10);
+
+constexpr size_t kDefaultTimeoutWheelSlots = 1024;
+
+constexpr size_t kDefaultMaxPendingRequests = 128 * 1024;
+
+constexpr size_t kDefaultMaxConnections = 1024;
+
+constexpr size_t kDefaultPoolConnections = 4;
+
+constexpr auto kDefaultReconnectDelay = std::chrono::milliseconds(1000);
+
 constexpr size_t kDefaultMaxBatchSize = 100;
 
+constexpr size_t kDefaultMaxBatchConcurrency = kDefaultMaxBatchSize;
+
+constexpr size_t kDefaultResultCacheCapacity = 4096;
+
+constexpr size_t kDefaultResultCacheShards = 16;
+
+constexpr size_t kDefaultRunningCallShards = 16;
+
+constexpr auto kDefaultAutoBatchWindow = std::chrono::microseconds(500);
+
+constexpr size_t kDefaultAutoBatchMaxEntries = 64;
+
+constexpr auto kDefaultReceiveRetryDelay = std::chrono::milliseconds(10);
+
+constexpr auto kDefaultMaxReceiveRetryDelay = std::chrono::milliseconds(5000);
+
+constexpr auto kDefaultMetricsInterval = std::chrono::milliseconds(10000);
+
 }  // namespace jsonrpc::endpoint
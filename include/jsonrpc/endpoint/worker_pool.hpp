@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <spdlog/spdlog.h>
+
+namespace jsonrpc::endpoint {
+
+/**
+ * @brief Tunables for a WorkerPool
+ */
+struct WorkerPoolOptions {
+  /// Worker threads, each running its own io_context. Zero starts one per
+  /// hardware thread.
+  std::size_t threads = 0;
+
+  /// Pin each worker thread to one CPU. Only has an effect on Linux.
+  bool pin_threads = false;
+
+  /// CPUs the workers are pinned to, worker i taking cpus[i % size]. Empty
+  /// lists the machine's CPUs NUMA node by node, so that neighbouring
+  /// workers share a node.
+  std::vector<int> cpus{};
+};
+
+/**
+ * @brief Single-threaded io_contexts for pinning connections to one core
+ *
+ * Everything running on a worker's executor runs on that worker's thread,
+ * so a connection placed there keeps its socket, strands and handlers in
+ * one core's caches. Placement picks the worker with the fewest
+ * connections. The pool must outlive everything placed on it.
+ */
+class WorkerPool {
+ private:
+  struct Worker;
+
+ public:
+  /**
+   * @brief One connection's claim on a worker, released on destruction
+   */
+  class Placement {
+   public:
+    Placement() = default;
+
+    Placement(const Placement&) = delete;
+    auto operator=(const Placement&) -> Placement& = delete;
+    Placement(Placement&& other) noexcept = default;
+
+    // Releases the claim it replaces
+    auto operator=(Placement&& other) noexcept -> Placement&;
+
+    ~Placement();
+
+    [[nodiscard]] auto GetExecutor() const -> asio::any_io_executor;
+
+    /// Handlers in flight on the worker, shared by its connections
+    [[nodiscard]] auto HandlerLoad() const
+        -> std::shared_ptr<std::atomic<std::size_t>>;
+
+    /// Position of the worker in the pool
+    [[nodiscard]] auto Index() const -> std::size_t;
+
+   private:
+    friend class WorkerPool;
+
+    explicit Placement(std::shared_ptr<Worker> worker)
+        : worker_(std::move(worker)) {
+    }
+
+    std::shared_ptr<Worker> worker_;
+  };
+
+  explicit WorkerPool(
+      WorkerPoolOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  auto operator=(const WorkerPool&) -> WorkerPool& = delete;
+  auto operator=(WorkerPool&&) -> WorkerPool& = delete;
+
+  /// Stops the pool as Stop() does
+  ~WorkerPool();
+
+  /**
+   * @brief Let the workers run out of work and join their threads
+   *
+   * Waits for whatever still runs on the workers, so shut down the servers
+   * and endpoints placed on them first.
+   */
+  void Stop();
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return workers_.size();
+  }
+
+  [[nodiscard]] auto GetExecutor(std::size_t index) const
+      -> asio::any_io_executor;
+
+  /// Connections placed on a worker and not released yet
+  [[nodiscard]] auto Connections(std::size_t index) const -> std::size_t;
+
+  /// The CPU a worker is pinned to, if pinning is on
+  [[nodiscard]] auto Cpu(std::size_t index) const -> std::optional<int>;
+
+  /// The worker with the fewest connections; ties go to the lowest index
+  [[nodiscard]] auto LeastLoaded() const -> std::size_t;
+
+  /**
+   * @brief Claim the worker with the fewest connections
+   *
+   * Safe to call from any thread; concurrent calls may pick the same worker.
+   */
+  auto Place() -> Placement {
+    return Place(LeastLoaded());
+  }
+
+  /// Claim a given worker, such as one picked by LeastLoaded() earlier
+  auto Place(std::size_t index) -> Placement;
+
+  /**
+   * @brief CPUs of the machine, NUMA node by node
+   *
+   * Read from /sys/devices/system/node on Linux. Elsewhere, or when that
+   * cannot be read, the CPUs in index order.
+   */
+  [[nodiscard]] static auto CpusByNumaNode() -> std::vector<int>;
+
+  /// Parse a kernel CPU list such as "0-3,8,10-11"; malformed parts are
+  /// skipped
+  [[nodiscard]] static auto ParseCpuList(std::string_view list)
+      -> std::vector<int>;
+
+ private:
+  auto Logger() -> const std::shared_ptr<spdlog::logger>& {
+    return logger_;
+  }
+
+  std::shared_ptr<spdlog::logger> logger_;
+
+  std::vector<std::shared_ptr<Worker>> workers_;
+};
+
+}  // namespace jsonrpc::endpoint
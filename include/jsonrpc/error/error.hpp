@@ -20,6 +20,9 @@ enum class RpcErrorCode {
   kTransportError = -32010,
   kTimeoutError = -32001,
 
+  // Defined by the Language Server Protocol
+  kRequestCancelled = -32800,
+
   // Client errors
   kClientError = -32099,
   kClientSerializationError = -32002,
@@ -48,6 +51,8 @@ inline auto DefaultMessageFor(RpcErrorCode code) -> std::string_view {
       return "Transport error";
     case RpcErrorCode::kTimeoutError:
       return "Timeout error";
+    case RpcErrorCode::kRequestCancelled:
+      return "Request cancelled";
     case RpcErrorCode::kClientError:
       return "Client error";
     case RpcErrorCode::kClientSerializationError:
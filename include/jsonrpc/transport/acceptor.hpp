@@ -0,0 +1,89 @@
+#pragma once
+
+#include <expected>
+#include <memory>
+
+#include <asio.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/utils/strand.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Listening side of a transport that hands out one Transport per
+ * accepted connection
+ *
+ * Accepted transports run on the acceptor's executor unless Accept() is
+ * given another, and are returned connected but not started.
+ */
+class Acceptor {
+ public:
+  explicit Acceptor(
+      asio::any_io_executor executor,
+      std::shared_ptr<spdlog::logger> logger = nullptr)
+      : logger_(logger ? logger : spdlog::default_logger()),
+        executor_(std::move(executor)),
+        strand_(asio::make_strand(executor_)) {
+  }
+
+  Acceptor(const Acceptor &) = delete;
+  Acceptor(Acceptor &&) = delete;
+
+  auto operator=(const Acceptor &) -> Acceptor & = delete;
+  auto operator=(Acceptor &&) -> Acceptor & = delete;
+
+  virtual ~Acceptor() = default;
+
+  /**
+   * @brief Bind and start listening
+   *
+   * Connections queue up in the kernel until Accept() picks them up.
+   */
+  virtual auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> = 0;
+
+  /**
+   * @brief Wait for the next connection
+   */
+  auto Accept() -> asio::awaitable<
+      std::expected<std::unique_ptr<Transport>, error::RpcError>> {
+    return Accept(executor_);
+  }
+
+  /**
+   * @brief Wait for the next connection, whose transport runs on executor
+   *
+   * Lets a server hand each connection to a different thread's io_context.
+   */
+  virtual auto Accept(asio::any_io_executor executor) -> asio::awaitable<
+      std::expected<std::unique_ptr<Transport>, error::RpcError>> = 0;
+
+  /**
+   * @brief Stop listening; a pending Accept() fails
+   */
+  virtual auto Close() -> asio::awaitable<void> = 0;
+
+  [[nodiscard]] auto GetExecutor() const -> asio::any_io_executor {
+    return executor_;
+  }
+
+ protected:
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
+    return logger_;
+  }
+
+  /// Resumes on the strand that serializes Accept() and Close()
+  auto SwitchToStrand() -> asio::awaitable<void> {
+    return utils::SwitchTo(strand_);
+  }
+
+ private:
+  std::shared_ptr<spdlog::logger> logger_;
+  asio::any_io_executor executor_;
+  asio::strand<asio::any_io_executor> strand_;
+};
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+namespace jsonrpc::transport {
+
+/// Compression applied to a message body, named by its Content-Encoding
+enum class ContentCoding {
+  kIdentity,
+  kZstd,
+  kLz4,
+};
+
+/// Content-Encoding token of a coding
+[[nodiscard]] constexpr auto ContentCodingName(ContentCoding coding)
+    -> std::string_view {
+  switch (coding) {
+    case ContentCoding::kZstd:
+      return "zstd";
+    case ContentCoding::kLz4:
+      return "lz4";
+    case ContentCoding::kIdentity:
+      break;
+  }
+  return "identity";
+}
+
+[[nodiscard]] constexpr auto ContentCodingFromName(std::string_view name)
+    -> std::optional<ContentCoding> {
+  if (name == "identity") {
+    return ContentCoding::kIdentity;
+  }
+  if (name == "zstd") {
+    return ContentCoding::kZstd;
+  }
+  if (name == "lz4") {
+    return ContentCoding::kLz4;
+  }
+  return std::nullopt;
+}
+
+}  // namespace jsonrpc::transport
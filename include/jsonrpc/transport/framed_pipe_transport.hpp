@@ -4,7 +4,8 @@
 
 #include <asio.hpp>
 
-#include "jsonrpc/transport/message_framer.hpp"
+#include "jsonrpc/transport/framed_reader.hpp"
+#include "jsonrpc/transport/message_compressor.hpp"
 #include "jsonrpc/transport/pipe_transport.hpp"
 
 namespace jsonrpc::transport {
@@ -15,15 +16,52 @@ class FramedPipeTransport : public PipeTransport {
       asio::any_io_executor executor, const std::string& socket_path,
       bool is_server, std::shared_ptr<spdlog::logger> logger = nullptr);
 
+  /**
+   * @brief Construct a framed transport
+   *
+   * Messages always use Content-Length framing; options.framing is ignored
+   * and options.max_message_size bounds the accepted Content-Length as well
+   * as the size of decompressed bodies.
+   */
+  FramedPipeTransport(
+      asio::any_io_executor executor, const std::string& socket_path,
+      bool is_server, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Wrap a socket that is already connected, such as one returned by
+   * a FramedPipeAcceptor
+   */
+  FramedPipeTransport(
+      asio::local::stream_protocol::socket socket, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
   auto SendMessage(std::string message)
       -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
   auto ReceiveMessage()
       -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
 
+  /// Every encoding is labelled by the Content-Type header
+  [[nodiscard]] auto SupportsEncoding(MessageEncoding /*encoding*/) const
+      -> bool override {
+    return true;
+  }
+
+  auto SendEncodedMessage(std::string message, MessageEncoding encoding)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto SendMessageWithHints(
+      std::string message, MessageEncoding encoding, SendHints hints)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  [[nodiscard]] auto LastReceivedEncoding() const -> MessageEncoding override {
+    return reader_.LastEncoding();
+  }
+
  private:
-  std::string read_buffer_;
-  MessageFramer framer_;
+  MessageCompressor compressor_;
+  FramedReader reader_;
 };
 
 }  // namespace jsonrpc::transport
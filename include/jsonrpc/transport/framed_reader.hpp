@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <asio.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/content_coding.hpp"
+#include "jsonrpc/transport/message_compressor.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
+#include "jsonrpc/transport/message_framer.hpp"
+#include "jsonrpc/transport/message_pool.hpp"
+#include "jsonrpc/transport/read_buffer.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Receive side of Content-Length framing over a byte stream
+ *
+ * Reads into an adaptively sized buffer and deframes from it. The rest of
+ * a body larger than the next read goes straight into the message instead
+ * of through the buffer. Messages come from the transport's MessagePool,
+ * and compressed bodies are decoded with its MessageCompressor.
+ *
+ * Only the receiving coroutine may use it.
+ */
+class FramedReader {
+ public:
+  /// Reads whatever is available into the buffer, never zero bytes
+  using ReadSome = std::function<
+      asio::awaitable<std::expected<std::size_t, error::RpcError>>(
+          asio::mutable_buffer)>;
+
+  /// options.max_message_size bounds Content-Length and decoded bodies
+  FramedReader(
+      const TransportOptions& options, MessagePool& pool,
+      MessageCompressor& compressor, std::shared_ptr<spdlog::logger> logger);
+
+  auto Receive(ReadSome read_some)
+      -> asio::awaitable<std::expected<std::string, error::RpcError>>;
+
+  /// Encoding of the message the last Receive() returned
+  [[nodiscard]] auto LastEncoding() const -> MessageEncoding {
+    return last_encoding_;
+  }
+
+  /**
+   * @brief Whether the last Receive() failed on bytes that cannot be
+   * deframed
+   *
+   * The bad bytes stay buffered, so every later receive fails too.
+   */
+  [[nodiscard]] auto IsCorrupt() const -> bool {
+    return corrupt_;
+  }
+
+ private:
+  // Reads the rest of a body that does not fit the read buffer straight into
+  // the returned message
+  auto ReceiveLargeBody(
+      const ReadSome& read_some, std::size_t header_size,
+      std::size_t body_size)
+      -> asio::awaitable<std::expected<std::string, error::RpcError>>;
+
+  // Undoes the Content-Encoding of a received body
+  auto Decode(std::string body, ContentCoding coding)
+      -> std::expected<std::string, error::RpcError>;
+
+  MessagePool& pool_;
+  MessageCompressor& compressor_;
+  std::shared_ptr<spdlog::logger> logger_;
+  ReadBuffer read_buffer_;
+  AdaptiveReadSize read_size_;
+  MessageFramer framer_;
+  MessageEncoding last_encoding_{MessageEncoding::kJson};
+  bool corrupt_{false};
+};
+
+}  // namespace jsonrpc::transport
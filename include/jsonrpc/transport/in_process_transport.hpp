@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <asio.hpp>
+#include <asio/experimental/concurrent_channel.hpp>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/transport.hpp"
+
+namespace jsonrpc::transport {
+
+/// Messages one direction of an in-process link buffers before senders wait
+constexpr std::size_t kDefaultInProcessCapacity = 1024;
+
+/**
+ * @brief One end of a link between two endpoints in the same process
+ *
+ * Messages are moved from one end's SendMessage() into the other end's
+ * ReceiveMessage() through a bounded channel, without a syscall, framing or
+ * copying the body. Either end may run on any executor and send from any
+ * thread. Once a direction holds capacity messages, senders wait until the
+ * receiver catches up.
+ *
+ * Closing an end closes the link: the peer still receives the messages
+ * already sent, then sees the link disconnected.
+ */
+class InProcessTransport : public Transport {
+ public:
+  using Pair = std::pair<
+      std::unique_ptr<InProcessTransport>, std::unique_ptr<InProcessTransport>>;
+
+  /**
+   * @brief Create both ends of a link
+   *
+   * @param first_executor Runs the first end, typically a client's endpoint
+   * @param second_executor Runs the second end
+   * @param capacity Messages buffered in each direction
+   */
+  static auto CreatePair(
+      asio::any_io_executor first_executor,
+      asio::any_io_executor second_executor,
+      std::size_t capacity = kDefaultInProcessCapacity,
+      std::shared_ptr<spdlog::logger> logger = nullptr) -> Pair;
+
+  /// Both ends on one executor
+  static auto CreatePair(
+      asio::any_io_executor executor,
+      std::size_t capacity = kDefaultInProcessCapacity,
+      std::shared_ptr<spdlog::logger> logger = nullptr) -> Pair;
+
+  ~InProcessTransport() override;
+
+  InProcessTransport(const InProcessTransport&) = delete;
+  auto operator=(const InProcessTransport&) -> InProcessTransport& = delete;
+
+  InProcessTransport(InProcessTransport&&) = delete;
+  auto operator=(InProcessTransport&&) -> InProcessTransport& = delete;
+
+  auto Start()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto Close()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  void CloseNow() override;
+
+  auto SendMessage(std::string message)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  using Transport::Flush;
+
+  /// Sent messages are already in the peer's channel, so this only checks
+  /// the link is open
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto ReceiveMessage()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return !is_closed_ && link_->is_open;
+  }
+
+ private:
+  using Channel = asio::experimental::concurrent_channel<void(
+      std::error_code, std::string)>;
+
+  // State shared by both ends; each direction is received on the executor
+  // of the end it leads to
+  struct Link {
+    Link(
+        asio::any_io_executor first_executor,
+        asio::any_io_executor second_executor, std::size_t capacity)
+        : to_first(std::move(first_executor), capacity),
+          to_second(std::move(second_executor), capacity) {
+    }
+
+    Channel to_first;
+    Channel to_second;
+    // Cleared by whichever end closes first
+    std::atomic<bool> is_open{true};
+  };
+
+  InProcessTransport(
+      asio::any_io_executor executor, std::shared_ptr<Link> link,
+      bool is_first, std::shared_ptr<spdlog::logger> logger);
+
+  auto Incoming() -> Channel& {
+    return is_first_ ? link_->to_first : link_->to_second;
+  }
+
+  auto Outgoing() -> Channel& {
+    return is_first_ ? link_->to_second : link_->to_first;
+  }
+
+  // Closes both directions, waking the receivers on either end
+  void CloseLink();
+
+  std::shared_ptr<Link> link_;
+  bool is_first_;
+  std::atomic<bool> is_closed_{false};
+  std::atomic<bool> is_started_{false};
+};
+
+}  // namespace jsonrpc::transport
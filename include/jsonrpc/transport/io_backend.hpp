@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string_view>
+
+#include <asio/detail/config.hpp>
+
+namespace jsonrpc::transport {
+
+/// Kernel interface asio waits on for socket, pipe and timer I/O
+enum class IoBackend {
+  kEpoll,
+  kIoUring,
+  /// kqueue, select or IOCP outside Linux
+  kOther,
+};
+
+/**
+ * @brief The backend this build runs every transport on
+ *
+ * asio picks its reactor at compile time, so this is fixed per build:
+ * io_uring with JSONRPC_WITH_IO_URING, which defines ASIO_HAS_IO_URING and
+ * ASIO_DISABLE_EPOLL, and epoll otherwise on Linux.
+ */
+constexpr IoBackend kIoBackend =
+#if defined(ASIO_HAS_IO_URING_AS_DEFAULT)
+    IoBackend::kIoUring;
+#elif defined(ASIO_HAS_EPOLL)
+    IoBackend::kEpoll;
+#else
+    IoBackend::kOther;
+#endif
+
+[[nodiscard]] constexpr auto IoBackendName(IoBackend backend)
+    -> std::string_view {
+  switch (backend) {
+    case IoBackend::kEpoll:
+      return "epoll";
+    case IoBackend::kIoUring:
+      return "io_uring";
+    case IoBackend::kOther:
+      break;
+  }
+  return "other";
+}
+
+}  // namespace jsonrpc::transport
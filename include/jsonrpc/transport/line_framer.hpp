@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Newline-delimited framing: one message per line
+ *
+ * Like MessageFramer, TryDeframe() is meant to be called repeatedly on a
+ * buffer that only grows at the end. The framer remembers how much of the
+ * buffer has already been searched for a newline, so each byte is scanned
+ * once.
+ */
+class LineFramer {
+ public:
+  struct DeframeResult {
+    bool complete{false};
+    /// View of the line inside the buffer, without the line terminator
+    std::string_view message{};
+    std::size_t consumed_bytes{0};
+    std::string error{};
+  };
+
+  /// Terminator appended to every outgoing message
+  static constexpr std::string_view kDelimiter = "\n";
+
+  explicit LineFramer(
+      std::size_t max_message_size = std::numeric_limits<std::size_t>::max())
+      : max_message_size_(max_message_size) {
+  }
+
+  static auto Frame(std::string message) -> std::string {
+    message.append(kDelimiter);
+    return message;
+  }
+
+  /**
+   * @brief Try to extract one line from the front of the buffer
+   *
+   * A trailing '\r' is stripped so CRLF peers work too. Blank lines are
+   * returned as empty messages and can be skipped by the caller.
+   */
+  auto TryDeframe(std::string_view buffer) -> DeframeResult;
+
+  /**
+   * @brief Forget how much of the buffer has been searched
+   */
+  void Reset() {
+    scan_offset_ = 0;
+  }
+
+ private:
+  std::size_t max_message_size_;
+  std::size_t scan_offset_{0};
+};
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/content_coding.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Per-connection compression state for message bodies
+ *
+ * Keeps one compression and one decompression context, created on first use
+ * and reused for every later message instead of being allocated per message.
+ * The two directions use separate contexts, so one coroutine may compress
+ * while another decompresses; each direction on its own must not be used
+ * concurrently.
+ *
+ * Codecs are optional at build time, see IsAvailable().
+ */
+class MessageCompressor {
+ public:
+  MessageCompressor();
+
+  MessageCompressor(const MessageCompressor&) = delete;
+  MessageCompressor(MessageCompressor&&) noexcept;
+  auto operator=(const MessageCompressor&) -> MessageCompressor& = delete;
+  auto operator=(MessageCompressor&&) noexcept -> MessageCompressor&;
+
+  ~MessageCompressor();
+
+  /// Whether the library was built with the codec; identity always is
+  [[nodiscard]] static auto IsAvailable(ContentCoding coding) -> bool;
+
+  auto Compress(std::string_view body, ContentCoding coding, int level = 0)
+      -> std::expected<std::string, error::RpcError>;
+
+  /**
+   * @brief Restore a body compressed with the given coding
+   *
+   * Fails instead of allocating when the body would decompress to more than
+   * max_size bytes.
+   */
+  auto Decompress(
+      std::string_view body, ContentCoding coding, std::size_t max_size)
+      -> std::expected<std::string, error::RpcError>;
+
+  /**
+   * @brief Compress body in place when the options ask for it and it pays
+   * off
+   *
+   * Bodies under options.min_size, bodies that do not shrink and codecs that
+   * are not built in are left as they are.
+   *
+   * @return The coding the body ends up with
+   */
+  auto CompressIfWorthwhile(
+      std::string& body, const CompressionOptions& options) -> ContentCoding;
+
+ private:
+  struct Contexts;
+
+  std::unique_ptr<Contexts> contexts_;
+};
+
+}  // namespace jsonrpc::transport
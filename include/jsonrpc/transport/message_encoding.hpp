@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+namespace jsonrpc::transport {
+
+/// How a message body is encoded on the wire
+enum class MessageEncoding {
+  kJson,
+  kCbor,
+  kMsgpack,
+};
+
+/// Name used when peers negotiate an encoding
+[[nodiscard]] constexpr auto EncodingName(MessageEncoding encoding)
+    -> std::string_view {
+  switch (encoding) {
+    case MessageEncoding::kCbor:
+      return "cbor";
+    case MessageEncoding::kMsgpack:
+      return "msgpack";
+    case MessageEncoding::kJson:
+      break;
+  }
+  return "json";
+}
+
+[[nodiscard]] constexpr auto EncodingFromName(std::string_view name)
+    -> std::optional<MessageEncoding> {
+  if (name == "json") {
+    return MessageEncoding::kJson;
+  }
+  if (name == "cbor") {
+    return MessageEncoding::kCbor;
+  }
+  if (name == "msgpack") {
+    return MessageEncoding::kMsgpack;
+  }
+  return std::nullopt;
+}
+
+}  // namespace jsonrpc::transport
@@ -1,102 +1,139 @@
 #pragma once
 
-#include <sstream>
+#include <cstddef>
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
+
+#include "jsonrpc/transport/content_coding.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
 
 namespace jsonrpc::transport {
 
+/**
+ * @brief Content-Length framing as used by the Language Server Protocol
+ *
+ * TryDeframe() is meant to be called repeatedly on a buffer that only grows
+ * at the end until a message completes. The framer remembers how far it has
+ * already searched for the end of the headers and, once the headers are
+ * parsed, how long the body is, so no byte is scanned twice.
+ *
+ * The Content-Type header tells JSON bodies from CBOR and MessagePack ones;
+ * unknown or missing types are taken as JSON. A Content-Encoding header
+ * names the compression of the body, which the caller undoes.
+ */
 class MessageFramer {
  public:
   struct DeframeResult {
     bool complete{false};
-    std::string message;
+    /// View of the body inside the buffer passed to TryDeframe()
+    std::string_view message{};
     std::size_t consumed_bytes{0};
-    std::string error;
+    std::string error{};
+    MessageEncoding encoding{MessageEncoding::kJson};
+    ContentCoding coding{ContentCoding::kIdentity};
   };
 
+  explicit MessageFramer(
+      std::size_t max_message_size = std::numeric_limits<std::size_t>::max())
+      : max_message_size_(max_message_size) {
+  }
+
+  static constexpr std::string_view kDefaultContentType =
+      "application/vscode-jsonrpc; charset=utf-8";
+
+  static constexpr std::string_view kCborContentType = "application/cbor";
+
+  static constexpr std::string_view kMsgpackContentType =
+      "application/msgpack";
+
+  [[nodiscard]] static constexpr auto ContentTypeFor(MessageEncoding encoding)
+      -> std::string_view {
+    switch (encoding) {
+      case MessageEncoding::kCbor:
+        return kCborContentType;
+      case MessageEncoding::kMsgpack:
+        return kMsgpackContentType;
+      case MessageEncoding::kJson:
+        break;
+    }
+    return kDefaultContentType;
+  }
+
   static auto Frame(
       const std::string& message,
-      const std::string& content_type =
-          "application/vscode-jsonrpc; charset=utf-8") -> std::string {
-    std::ostringstream out;
-    out << "Content-Length: " << message.size() << "\r\n"
-        << "Content-Type: " << content_type << "\r\n"
-        << "\r\n"
-        << message;
-    return out.str();
-  }
+      std::string_view content_type = kDefaultContentType) -> std::string;
 
-  auto TryDeframe(const std::string& buffer) -> DeframeResult {
+  /**
+   * @brief Build only the headers for a body of the given size
+   *
+   * Lets callers write the headers and the body as separate buffers.
+   */
+  static auto FrameHeader(
+      std::size_t body_size,
+      std::string_view content_type = kDefaultContentType,
+      ContentCoding coding = ContentCoding::kIdentity) -> std::string;
+
+  /**
+   * @brief Try to extract one message from the front of the buffer
+   *
+   * On success the framer resets, and the caller should drop consumed_bytes
+   * from the front of the buffer before the next call.
+   */
+  auto TryDeframe(std::string_view buffer) -> DeframeResult;
+
+  /**
+   * @brief Body length of the message in progress, once its headers are read
+   */
+  [[nodiscard]] auto ExpectedBodySize() const -> std::optional<std::size_t> {
     if (!header_complete_) {
-      auto header_end = buffer.find("\r\n\r\n");
-      if (header_end == std::string::npos) {
-        return {
-            .complete = false,
-            .message = "",
-            .consumed_bytes = 0,
-            .error = ""};  // Need more data
-      }
-
-      // Parse headers
-      std::istringstream header_stream(buffer.substr(0, header_end));
-      std::string header_line;
-      bool found_length = false;
-      while (std::getline(header_stream, header_line) && !header_line.empty()) {
-        if (header_line.starts_with("Content-Length:")) {
-          try {
-            expected_length_ = std::stoi(header_line.substr(15));
-            found_length = true;
-          } catch (const std::exception&) {
-            return {
-                .complete = false,
-                .message = "",
-                .consumed_bytes = 0,
-                .error = "Invalid Content-Length header"};
-          }
-        }
-      }
-
-      if (!found_length) {
-        return {
-            .complete = false,
-            .message = "",
-            .consumed_bytes = 0,
-            .error = "Missing Content-Length header"};
-      }
-
-      header_complete_ = true;
-      header_size_ = header_end + 4;  // Include \r\n\r\n
+      return std::nullopt;
     }
+    return expected_length_;
+  }
 
-    // Check if we have enough data for the content
-    if (buffer.size() < header_size_ + expected_length_) {
-      return {
-          .complete = false,
-          .message = "",
-          .consumed_bytes = 0,
-          .error = ""};  // Need more data
-    }
+  /**
+   * @brief Size of the headers of the message in progress, including the
+   * blank line
+   */
+  [[nodiscard]] auto HeaderSize() const -> std::size_t {
+    return header_size_;
+  }
 
-    // Extract message
-    std::string message = buffer.substr(header_size_, expected_length_);
-    std::size_t total_consumed = header_size_ + expected_length_;
+  /**
+   * @brief Encoding of the message in progress, once its headers are read
+   */
+  [[nodiscard]] auto Encoding() const -> MessageEncoding {
+    return encoding_;
+  }
 
-    // Reset state for next message
-    header_complete_ = false;
-    expected_length_ = 0;
-    header_size_ = 0;
+  /**
+   * @brief Compression of the message in progress, once its headers are read
+   */
+  [[nodiscard]] auto Coding() const -> ContentCoding {
+    return coding_;
+  }
 
-    return {
-        .complete = true,
-        .message = message,
-        .consumed_bytes = total_consumed,
-        .error = ""};
+  [[nodiscard]] auto MaxMessageSize() const -> std::size_t {
+    return max_message_size_;
   }
 
+  /**
+   * @brief Forget the message in progress
+   */
+  void Reset();
+
  private:
+  auto ParseHeaders(std::string_view headers) -> std::string;
+
+  std::size_t max_message_size_;
   bool header_complete_{false};
   std::size_t expected_length_{0};
   std::size_t header_size_{0};
+  std::size_t scan_offset_{0};
+  MessageEncoding encoding_{MessageEncoding::kJson};
+  ContentCoding coding_{ContentCoding::kIdentity};
 };
 
 }  // namespace jsonrpc::transport
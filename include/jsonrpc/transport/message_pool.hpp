@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Recycles the storage of received message strings
+ *
+ * The reader hands each message back once it is parsed, and the next
+ * receive copies into that storage instead of allocating a new string.
+ * Strings too small to own heap storage, or large enough to be worth giving
+ * back to the system, are dropped instead of pooled.
+ *
+ * Not synchronized; only the coroutine that receives may use it.
+ */
+class MessagePool {
+ public:
+  /// Messages kept for reuse
+  static constexpr std::size_t kMaxPooled = 4;
+
+  /// Larger strings are freed rather than kept
+  static constexpr std::size_t kMaxPooledCapacity = 64 * 1024;
+
+  MessagePool() {
+    buffers_.reserve(kMaxPooled);
+  }
+
+  /// A string holding contents, in recycled storage when any is pooled
+  auto Acquire(std::string_view contents) -> std::string {
+    auto message = Take();
+    message.assign(contents);
+    return message;
+  }
+
+  /// A string of size bytes to be filled in by the caller
+  auto Acquire(std::size_t size) -> std::string {
+    auto message = Take();
+    message.resize(size);
+    return message;
+  }
+
+  void Release(std::string message) {
+    if (message.capacity() <= std::string().capacity() ||
+        message.capacity() > kMaxPooledCapacity ||
+        buffers_.size() >= kMaxPooled) {
+      return;
+    }
+    message.clear();
+    buffers_.push_back(std::move(message));
+  }
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return buffers_.size();
+  }
+
+ private:
+  auto Take() -> std::string {
+    if (buffers_.empty()) {
+      return {};
+    }
+    auto message = std::move(buffers_.back());
+    buffers_.pop_back();
+    return message;
+  }
+
+  std::vector<std::string> buffers_;
+};
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+
+#include <asio.hpp>
+#include <asio/local/stream_protocol.hpp>
+
+#include "jsonrpc/transport/acceptor.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Accepts unix socket connections and wraps each in a PipeTransport
+ *
+ * Any stale socket file is replaced on Listen() and removed on Close().
+ */
+class PipeAcceptor : public Acceptor {
+ public:
+  /**
+   * @brief Construct a new Pipe Acceptor object
+   *
+   * @param options Applied to every accepted transport, which makes them the
+   * per-connection message size and send queue limits
+   */
+  PipeAcceptor(
+      asio::any_io_executor executor, std::string socket_path,
+      TransportOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  PipeAcceptor(const PipeAcceptor&) = delete;
+  PipeAcceptor(PipeAcceptor&&) = delete;
+  auto operator=(const PipeAcceptor&) -> PipeAcceptor& = delete;
+  auto operator=(PipeAcceptor&&) -> PipeAcceptor& = delete;
+
+  ~PipeAcceptor() override;
+
+  auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  using Acceptor::Accept;
+
+  auto Accept(asio::any_io_executor executor) -> asio::awaitable<
+      std::expected<std::unique_ptr<Transport>, error::RpcError>> override;
+
+  auto Close() -> asio::awaitable<void> override;
+
+ protected:
+  /// Wraps an accepted socket; overridden to change the framing
+  virtual auto MakeTransport(asio::local::stream_protocol::socket socket)
+      -> std::unique_ptr<Transport>;
+
+  [[nodiscard]] auto Options() const -> const TransportOptions& {
+    return options_;
+  }
+
+ private:
+  auto RemoveSocketFile() -> std::expected<void, error::RpcError>;
+
+  std::string socket_path_;
+  TransportOptions options_;
+  asio::local::stream_protocol::acceptor acceptor_;
+  bool is_listening_{false};
+};
+
+/**
+ * @brief PipeAcceptor whose connections use Content-Length framing
+ */
+class FramedPipeAcceptor : public PipeAcceptor {
+ public:
+  using PipeAcceptor::PipeAcceptor;
+
+ protected:
+  auto MakeTransport(asio::local::stream_protocol::socket socket)
+      -> std::unique_ptr<Transport> override;
+};
+
+}  // namespace jsonrpc::transport
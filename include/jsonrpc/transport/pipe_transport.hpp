@@ -1,16 +1,20 @@
 #pragma once
 
-#include <array>
 #include <atomic>
-#include <deque>
 #include <expected>
+#include <optional>
 #include <string>
 
 #include <asio.hpp>
 #include <asio/local/stream_protocol.hpp>
 
 #include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/line_framer.hpp"
+#include "jsonrpc/transport/queued_writer.hpp"
+#include "jsonrpc/transport/read_buffer.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
 #include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
 
 namespace jsonrpc::transport {
 
@@ -20,6 +24,22 @@ class PipeTransport : public Transport {
       asio::any_io_executor executor, std::string socket_path,
       bool is_server = false, std::shared_ptr<spdlog::logger> logger = nullptr);
 
+  PipeTransport(
+      asio::any_io_executor executor, std::string socket_path, bool is_server,
+      TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Wrap a socket that is already connected, such as one returned by
+   * a PipeAcceptor
+   *
+   * Start() neither connects nor listens, and Close() leaves the listening
+   * socket file alone.
+   */
+  PipeTransport(
+      asio::local::stream_protocol::socket socket, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
   ~PipeTransport() override;
 
   PipeTransport(const PipeTransport&) = delete;
@@ -28,6 +48,16 @@ class PipeTransport : public Transport {
   PipeTransport(PipeTransport&&) = delete;
   auto operator=(PipeTransport&&) -> PipeTransport& = delete;
 
+  /**
+   * @brief Bind the socket file and listen, without waiting for a client
+   *
+   * Start() then waits for the first client; calling it without Listen()
+   * does both. Succeeds at once when already listening, and for clients and
+   * wrapped connections.
+   */
+  auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
   auto Start()
       -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
@@ -39,39 +69,100 @@ class PipeTransport : public Transport {
   auto SendMessage(std::string message)
       -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
-  auto Flush() -> asio::awaitable<std::expected<void, error::RpcError>>;
+  auto SendMessageWithHints(
+      std::string message, MessageEncoding encoding, SendHints hints)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  using Transport::Flush;
+
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
   auto ReceiveMessage()
       -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
 
+  auto GetSendQueueStats() -> asio::awaitable<SendQueueStats> override;
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return is_connected_;
+  }
+
  protected:
   auto GetSocket() -> asio::local::stream_protocol::socket&;
 
   auto RemoveExistingSocketFile() -> std::expected<void, error::RpcError>;
 
+  /// Connects, retrying as TransportOptions::connect_retry says
   auto Connect() -> asio::awaitable<std::expected<void, error::RpcError>>;
 
+  /// Binds and listens unless already listening
   auto BindAndListen() -> asio::awaitable<std::expected<void, error::RpcError>>;
 
+  auto AcceptConnection()
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  /**
+   * @brief Read whatever is available on the socket into the given buffer
+   *
+   * Lets derived transports read straight into their own storage instead of
+   * going through the string returned by ReceiveMessage().
+   *
+   * @return The number of bytes read, which is never zero on success
+   */
+  auto ReadSome(asio::mutable_buffer buffer)
+      -> asio::awaitable<std::expected<std::size_t, error::RpcError>>;
+
+  /**
+   * @brief Queue a message whose parts are written back to back
+   *
+   * Lets derived transports add framing without copying the body.
+   */
+  auto SendFrame(OutgoingMessage message)
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  [[nodiscard]] auto Options() const -> const TransportOptions& {
+    return options_;
+  }
+
+  /// For receive errors no retry can fix, so readers stop instead
+  void MarkDisconnected() {
+    is_connected_ = false;
+  }
+
  private:
-  // Sends messages from the queue in sequence
-  auto SendMessageLoop() -> asio::awaitable<void>;
+  // A single connect attempt
+  auto ConnectOnce() -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  // Performs one socket read into the free space of read_buffer_
+  auto FillReadBuffer()
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
 
+  // Returns the next line when newline-delimited framing is enabled
+  auto ReceiveLine()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>>;
+
+  TransportOptions options_;
   asio::local::stream_protocol::socket socket_;
   std::unique_ptr<asio::local::stream_protocol::acceptor> acceptor_;
   std::string socket_path_;
   bool is_server_;
   std::atomic<bool> is_closed_{false};
   std::atomic<bool> is_started_{false};
+  std::atomic<bool> is_listening_{false};
   std::atomic<bool> is_connected_{false};
 
-  // Message sending queue and state
-  std::deque<std::string> send_queue_;
-  std::atomic<bool> sending_{false};
+  // Send queue, cork window and write loop
+  QueuedWriter writer_;
+
+  // Waits between connect attempts; cancelled by Close()
+  asio::steady_timer connect_timer_;
+
+  // Buffer for reading data, sized by the observed read sizes
+  ReadBuffer read_buffer_;
+  AdaptiveReadSize read_size_;
 
-  // Buffer for reading data
-  std::array<char, 1024> read_buffer_;
-  std::string message_buffer_;
+  // Framing state for newline-delimited messages
+  LineFramer line_framer_;
 };
 
 }  // namespace jsonrpc::transport
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <system_error>
+
+#include <asio.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Send side of a stream transport: the send queue with its
+ * backpressure, the cork window and the loop that writes the queue out
+ *
+ * Messages queued while a write is in flight go out together in the next
+ * vectored write. The first failed write clears the queue and fails every
+ * later send with the same error.
+ *
+ * Not thread-safe; call it from the strand it was constructed with.
+ */
+class QueuedWriter {
+ public:
+  QueuedWriter(
+      asio::strand<asio::any_io_executor> strand,
+      const TransportOptions& options, std::shared_ptr<spdlog::logger> logger);
+
+  /**
+   * @brief Queue a message and start writing the queue to stream if idle
+   *
+   * Waits for room or fails at once, as TransportOptions::backpressure
+   * says. The stream must outlive the writer.
+   */
+  template <typename AsyncWriteStream>
+  auto Send(AsyncWriteStream& stream, OutgoingMessage message)
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  /// Transport::Flush() over the queue
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  /// Drop queued messages and wake everyone waiting on the queue
+  void Close();
+
+  [[nodiscard]] auto Stats() const -> SendQueueStats {
+    return queue_.Stats();
+  }
+
+ private:
+  // Applies the backpressure policy, then queues the message
+  auto Queue(OutgoingMessage message)
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  // Waits out the cork window, then takes what is queued
+  auto NextBatch() -> asio::awaitable<std::optional<WriteBatch>>;
+
+  // Records a written batch; false once the stream is unusable
+  auto FinishWrite(const WriteBatch& batch, const std::error_code& ec)
+      -> bool;
+
+  template <typename AsyncWriteStream>
+  auto WriteLoop(AsyncWriteStream& stream) -> asio::awaitable<void>;
+
+  asio::strand<asio::any_io_executor> strand_;
+  std::shared_ptr<spdlog::logger> logger_;
+  BackpressurePolicy backpressure_;
+  std::chrono::microseconds cork_delay_;
+  std::size_t cork_bytes_;
+  SendQueue queue_;
+
+  // Holds back writes for TransportOptions::cork_delay
+  asio::steady_timer cork_timer_;
+
+  bool writing_{false};
+  bool closed_{false};
+
+  // First write failure; once set, every later send fails with it
+  std::optional<error::RpcError> write_error_;
+};
+
+template <typename AsyncWriteStream>
+auto QueuedWriter::Send(AsyncWriteStream& stream, OutgoingMessage message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (auto queued = co_await Queue(std::move(message)); !queued) {
+    co_return queued;
+  }
+  if (!writing_) {
+    writing_ = true;
+    asio::co_spawn(strand_, WriteLoop(stream), asio::detached);
+  }
+  co_return error::Ok();
+}
+
+template <typename AsyncWriteStream>
+auto QueuedWriter::WriteLoop(AsyncWriteStream& stream)
+    -> asio::awaitable<void> {
+  while (auto batch = co_await NextBatch()) {
+    // One vectored write for everything queued so far
+    std::error_code ec;
+    co_await asio::async_write(
+        stream, batch->Buffers(), WriteChunkLimit(),
+        asio::redirect_error(asio::use_awaitable, ec));
+    if (!FinishWrite(*batch, ec)) {
+      break;
+    }
+  }
+  writing_ = false;
+}
+
+}  // namespace jsonrpc::transport
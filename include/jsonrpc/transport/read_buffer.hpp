@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <asio.hpp>
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief A growable byte buffer with separate read and write cursors
+ *
+ * Sockets read straight into the free space returned by Prepare(), and
+ * consumers look at the unread bytes through Data() without copying.
+ * Unread bytes are only moved to the front when the free space at the end is
+ * too small, so each byte is shifted at most once per compaction rather than
+ * on every consume.
+ *
+ * Views returned by Data() are invalidated by Prepare().
+ */
+class ReadBuffer {
+ public:
+  ReadBuffer() = default;
+
+  explicit ReadBuffer(std::size_t initial_capacity)
+      : storage_(initial_capacity) {
+  }
+
+  /**
+   * @brief The bytes that have been committed but not consumed
+   */
+  [[nodiscard]] auto Data() const -> std::string_view {
+    return {storage_.data() + read_pos_, write_pos_ - read_pos_};
+  }
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return write_pos_ - read_pos_;
+  }
+
+  [[nodiscard]] auto Empty() const -> bool {
+    return read_pos_ == write_pos_;
+  }
+
+  [[nodiscard]] auto Capacity() const -> std::size_t {
+    return storage_.size();
+  }
+
+  /**
+   * @brief Get at least min_size bytes of writable space
+   *
+   * The returned buffer may be larger than requested. Call Commit() with the
+   * number of bytes actually written.
+   */
+  auto Prepare(std::size_t min_size) -> asio::mutable_buffer {
+    if (storage_.size() - write_pos_ < min_size) {
+      Compact();
+      if (storage_.size() - write_pos_ < min_size) {
+        storage_.resize(std::max(storage_.size() * 2, write_pos_ + min_size));
+      }
+    }
+    return asio::buffer(
+        storage_.data() + write_pos_, storage_.size() - write_pos_);
+  }
+
+  /**
+   * @brief Mark n bytes of the prepared space as readable
+   */
+  void Commit(std::size_t n) {
+    write_pos_ += std::min(n, storage_.size() - write_pos_);
+  }
+
+  /**
+   * @brief Drop n bytes from the front of the readable data
+   */
+  void Consume(std::size_t n) {
+    read_pos_ += std::min(n, Size());
+    if (read_pos_ == write_pos_) {
+      // Nothing left to keep, so the next read starts at the front for free
+      read_pos_ = 0;
+      write_pos_ = 0;
+    }
+  }
+
+  void Clear() {
+    read_pos_ = 0;
+    write_pos_ = 0;
+  }
+
+  /**
+   * @brief Release storage beyond the given capacity while the buffer is empty
+   */
+  void ShrinkTo(std::size_t capacity) {
+    if (Empty() && storage_.size() > capacity) {
+      storage_ = std::vector<char>(capacity);
+    }
+  }
+
+ private:
+  void Compact() {
+    if (read_pos_ == 0) {
+      return;
+    }
+    std::memmove(storage_.data(), storage_.data() + read_pos_, Size());
+    write_pos_ -= read_pos_;
+    read_pos_ = 0;
+  }
+
+  std::vector<char> storage_;
+  std::size_t read_pos_{0};
+  std::size_t write_pos_{0};
+};
+
+/**
+ * @brief Picks the size of the next socket read from the sizes seen so far
+ *
+ * A read that fills the whole buffer suggests more data is waiting, so the
+ * next read doubles in size. A run of reads that use a small fraction of the
+ * buffer halves it again, so an idle connection goes back to the minimum.
+ */
+class AdaptiveReadSize {
+ public:
+  AdaptiveReadSize(std::size_t min_size, std::size_t max_size)
+      : min_(std::max<std::size_t>(min_size, 1)),
+        max_(std::max(max_size, min_)),
+        current_(min_) {
+  }
+
+  [[nodiscard]] auto Next() const -> std::size_t {
+    return current_;
+  }
+
+  [[nodiscard]] auto Min() const -> std::size_t {
+    return min_;
+  }
+
+  void Record(std::size_t bytes_read) {
+    if (bytes_read >= current_) {
+      current_ = std::min(current_ * 2, max_);
+      short_reads_ = 0;
+      return;
+    }
+    if (bytes_read > current_ / kShortReadDivisor) {
+      short_reads_ = 0;
+      return;
+    }
+    if (++short_reads_ >= kShrinkAfterShortReads) {
+      current_ = std::max(current_ / 2, min_);
+      short_reads_ = 0;
+    }
+  }
+
+ private:
+  // A read is short when it uses less than 1/kShortReadDivisor of the buffer
+  static constexpr std::size_t kShortReadDivisor = 4;
+  static constexpr std::size_t kShrinkAfterShortReads = 8;
+
+  std::size_t min_;
+  std::size_t max_;
+  std::size_t current_;
+  std::size_t short_reads_{0};
+};
+
+}  // namespace jsonrpc::transport
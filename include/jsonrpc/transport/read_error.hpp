@@ -0,0 +1,21 @@
+#pragma once
+
+#include <system_error>
+
+#include <asio.hpp>
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Whether a stream that failed a read with ec may still deliver data
+ *
+ * Interruptions and momentary shortages of buffers or memory are worth a
+ * retry; any other error leaves the stream unusable.
+ */
+inline auto IsTransientReadError(const std::error_code& ec) -> bool {
+  return ec == asio::error::interrupted || ec == asio::error::try_again ||
+         ec == asio::error::would_block || ec == asio::error::no_buffer_space ||
+         ec == asio::error::no_memory;
+}
+
+}  // namespace jsonrpc::transport
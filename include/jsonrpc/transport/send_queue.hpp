@@ -0,0 +1,250 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/// Upper bound for a single write syscall. Some platforms, notably WSL, fail
+/// large writes to unix sockets.
+constexpr std::size_t kMaxWriteChunkSize = 32 * 1024;
+
+/// Upper bound for the bytes gathered into one vectored write
+constexpr std::size_t kMaxWriteBatchSize = 1024 * 1024;
+
+/// Upper bound for the bulk bytes in one vectored write, which is as long as
+/// an interactive message queued behind them waits
+constexpr std::size_t kMaxBulkWriteBatchSize = 64 * 1024;
+
+/// Class of an outgoing message in the send queue
+enum class MessagePriority {
+  /// Responses and calls someone waits on; written ahead of bulk messages
+  kInteractive,
+  /// Traffic such as logs and diagnostics that may wait behind the rest
+  kBulk,
+};
+
+/// How a transport with a send queue should queue a message
+struct SendHints {
+  MessagePriority priority = MessagePriority::kInteractive;
+
+  /// When not empty, a message with the same key that is still queued is
+  /// replaced by this one in its place instead of being sent as well, for
+  /// notifications where only the latest value matters
+  std::string replace_key{};
+};
+
+/**
+ * @brief A message waiting to be written, split into the parts that go on
+ * the wire back to back
+ *
+ * Framing transports put their header and trailer next to the body instead
+ * of concatenating them into a new string. The trailer must point to storage
+ * that outlives the write, typically a string literal.
+ */
+struct OutgoingMessage {
+  std::string header{};
+  std::string body{};
+  std::string_view trailer{};
+  SendHints hints{};
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return header.size() + body.size() + trailer.size();
+  }
+};
+
+/**
+ * @brief Messages taken from a SendQueue for one vectored write
+ *
+ * The buffers point into the owned messages, so they stay valid for as long
+ * as the batch is alive, including across moves.
+ */
+class WriteBatch {
+ public:
+  WriteBatch() = default;
+
+  explicit WriteBatch(std::vector<OutgoingMessage> messages);
+
+  WriteBatch(const WriteBatch&) = delete;
+  auto operator=(const WriteBatch&) -> WriteBatch& = delete;
+  WriteBatch(WriteBatch&&) = default;
+  auto operator=(WriteBatch&&) -> WriteBatch& = default;
+  ~WriteBatch() = default;
+
+  [[nodiscard]] auto Buffers() const -> const std::vector<asio::const_buffer>& {
+    return buffers_;
+  }
+
+  [[nodiscard]] auto Count() const -> std::size_t {
+    return messages_.size();
+  }
+
+  [[nodiscard]] auto Bytes() const -> std::size_t {
+    return bytes_;
+  }
+
+ private:
+  std::vector<OutgoingMessage> messages_;
+  std::vector<asio::const_buffer> buffers_;
+  std::size_t bytes_{0};
+};
+
+/// Point-in-time view of a send queue, for monitoring
+struct SendQueueStats {
+  std::size_t queued_messages{0};
+  std::size_t queued_bytes{0};
+  /// Of the queued messages, those in the bulk class
+  std::size_t queued_bulk_messages{0};
+  std::size_t peak_queued_bytes{0};
+  /// Senders currently suspended by backpressure
+  std::size_t blocked_senders{0};
+  uint64_t sent_messages{0};
+  uint64_t sent_bytes{0};
+  /// Messages lost to write errors or dropped when the queue was cleared
+  uint64_t failed_messages{0};
+  /// Messages refused by the fail-fast backpressure policy
+  uint64_t rejected_messages{0};
+  /// Queued messages replaced by a newer one with the same replace key
+  uint64_t replaced_messages{0};
+};
+
+/**
+ * @brief Queue of outgoing messages that drains into vectored writes
+ *
+ * Messages of each MessagePriority are kept in order. Batches take the
+ * interactive messages first, so a response never waits behind more than
+ * kMaxBulkWriteBatchSize of bulk traffic already being written, and then
+ * fill up with bulk messages. Messages are never split, so a single bulk
+ * message larger than that still goes out whole. A message with a replace
+ * key overwrites the queued one with the same key, keeping its place.
+ *
+ * The queue is bounded by high and low watermarks. Once it reaches a high
+ * watermark, IsFull() stays true until it drains to the low watermarks, and
+ * WaitForRoom() suspends senders until then. Waiters share one timer that
+ * never expires and are woken by cancelling it.
+ *
+ * Not thread-safe; transports use it from their strand, and waiters resume
+ * on the executor passed at construction.
+ */
+class SendQueue {
+ public:
+  explicit SendQueue(
+      asio::any_io_executor executor, SendQueueLimits limits = {});
+
+  void Push(OutgoingMessage message);
+
+  /**
+   * @brief Take queued messages, interactive ones first, up to max_bytes in
+   * total and kMaxBulkWriteBatchSize of bulk ones
+   *
+   * At least one message is taken if any are queued, even if it alone is
+   * larger than max_bytes. The batch counts as in flight until it is passed
+   * to RecordWrite().
+   */
+  auto TakeBatch(std::size_t max_bytes = kMaxWriteBatchSize) -> WriteBatch;
+
+  /**
+   * @brief Drop all queued messages and wake suspended senders and flushers
+   */
+  void Clear();
+
+  /**
+   * @brief Whether senders should wait before queueing more
+   */
+  [[nodiscard]] auto IsFull() const -> bool {
+    return full_;
+  }
+
+  /**
+   * @brief Suspend until the queue drains below its low watermarks
+   *
+   * Returns immediately when the queue is not full. Callers should re-check
+   * the transport state afterwards, since Clear() also wakes waiters.
+   */
+  auto WaitForRoom() -> asio::awaitable<void>;
+
+  /**
+   * @brief Record the outcome of writing a batch taken from this queue
+   */
+  void RecordWrite(const WriteBatch& batch, const std::error_code& ec);
+
+  /**
+   * @brief Whether nothing is queued and every taken batch was written
+   */
+  [[nodiscard]] auto IsDrained() const -> bool {
+    return Empty() && in_flight_ == 0;
+  }
+
+  /**
+   * @brief Suspend until the queue is drained, cleared, or the deadline passes
+   *
+   * Each waiter parks on its own timer, which expires at the deadline or is
+   * cancelled by the queue; nothing polls.
+   *
+   * @return Whether the queue was drained when the waiter resumed
+   */
+  auto WaitForDrain(std::optional<std::chrono::steady_clock::time_point>
+                        deadline = std::nullopt) -> asio::awaitable<bool>;
+
+  void RecordRejected() {
+    ++stats_.rejected_messages;
+  }
+
+  [[nodiscard]] auto Empty() const -> bool {
+    return interactive_.empty() && bulk_.empty();
+  }
+
+  [[nodiscard]] auto Size() const -> std::size_t {
+    return interactive_.size() + bulk_.size();
+  }
+
+  /// Total bytes of queued messages
+  [[nodiscard]] auto Bytes() const -> std::size_t {
+    return bytes_;
+  }
+
+  [[nodiscard]] auto Stats() const -> SendQueueStats;
+
+ private:
+  void UpdateFullState();
+
+  void NotifyDrainWaiters();
+
+  SendQueueLimits limits_;
+  std::deque<OutgoingMessage> interactive_;
+  std::deque<OutgoingMessage> bulk_;
+  // Queued messages by replace key. Pushing and popping at the ends of a
+  // deque keeps the other elements in place.
+  std::unordered_map<std::string, OutgoingMessage*> replaceable_;
+  std::size_t bytes_{0};
+  bool full_{false};
+  std::size_t in_flight_{0};
+  asio::any_io_executor executor_;
+  asio::steady_timer room_timer_;
+  std::vector<asio::steady_timer*> drain_waiters_;
+  SendQueueStats stats_;
+};
+
+/**
+ * @brief Completion condition for asio::async_write that caps every write
+ * syscall at kMaxWriteChunkSize
+ */
+inline auto WriteChunkLimit() {
+  return [](const std::error_code& ec, std::size_t /*bytes*/) -> std::size_t {
+    return ec ? 0 : kMaxWriteChunkSize;
+  };
+}
+
+}  // namespace jsonrpc::transport
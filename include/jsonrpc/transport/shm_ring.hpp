@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "jsonrpc/error/error.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Single-producer single-consumer message ring over shared memory
+ *
+ * The ring does not own its memory, so both processes can map the same
+ * bytes and wrap them in a ShmRing each. Messages are written in place
+ * behind a four-byte length, wrapping around the end of the data area.
+ * Positions only grow and are masked into the area, which is why its size
+ * must be a power of two.
+ *
+ * One thread may push and one may pop at a time. The sleeping flag lets a
+ * consumer that found the ring empty ask the producer for a wakeup, so the
+ * producer only signals a peer that actually waits.
+ *
+ * Every byte of the mapping is writable by the peer, so the consumer checks
+ * the positions and length prefixes it reads before trusting them.
+ */
+class ShmRing {
+ public:
+  static constexpr std::size_t kCacheLine = 64;
+  static constexpr std::size_t kLengthSize = sizeof(std::uint32_t);
+
+  // Positions and flags shared between the processes; each counter gets its
+  // own cache line so the two sides do not invalidate each other's
+  struct Header {
+    // Advanced by the consumer
+    alignas(kCacheLine) std::atomic<std::uint64_t> head{0};
+    // Advanced by the producer
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail{0};
+    alignas(kCacheLine) std::atomic<std::uint32_t> reader_sleeping{0};
+    std::atomic<std::uint32_t> writer_closed{0};
+    std::atomic<std::uint32_t> reader_closed{0};
+  };
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+  /// Bytes of memory a ring with the given data capacity takes up
+  static constexpr auto RequiredSize(std::size_t capacity) -> std::size_t {
+    return sizeof(Header) + capacity;
+  }
+
+  /**
+   * @brief Set up an empty ring in memory no ring lives in yet
+   *
+   * @param memory RequiredSize(capacity) bytes aligned to a cache line,
+   * where capacity is a power of two
+   */
+  static auto Create(std::span<std::byte> memory) -> ShmRing {
+    new (memory.data()) Header();
+    return ShmRing(memory);
+  }
+
+  /// Wrap a ring another ShmRing created in the same memory
+  static auto Attach(std::span<std::byte> memory) -> ShmRing {
+    return ShmRing(memory);
+  }
+
+  [[nodiscard]] auto Capacity() const -> std::size_t {
+    return data_.size();
+  }
+
+  /// Largest message that fits into an empty ring
+  [[nodiscard]] auto MaxMessageSize() const -> std::size_t {
+    return Capacity() - kLengthSize;
+  }
+
+  /**
+   * @brief Write a message if there is room for it
+   *
+   * Producer only. Returns false when the ring is too full; larger messages
+   * than MaxMessageSize() never fit.
+   */
+  auto TryPush(std::string_view message) -> bool {
+    auto &header = GetHeader();
+    const auto tail = header.tail.load(std::memory_order_relaxed);
+    const auto head = header.head.load(std::memory_order_acquire);
+    const auto needed = kLengthSize + message.size();
+    if (needed > Capacity() - (tail - head)) {
+      return false;
+    }
+    const auto length = static_cast<std::uint32_t>(message.size());
+    CopyIn(tail, std::as_bytes(std::span(&length, 1)));
+    CopyIn(tail + kLengthSize, std::as_bytes(std::span(message)));
+    header.tail.store(tail + needed, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Size of the next message, if one is there
+   *
+   * Consumer only. Fails when the positions or the length prefix do not
+   * describe a message within what the producer published, which leaves
+   * the ring unusable.
+   */
+  [[nodiscard]] auto NextSize() const
+      -> std::expected<std::optional<std::size_t>, error::RpcError> {
+    const auto &header = GetHeader();
+    const auto head = header.head.load(std::memory_order_relaxed);
+    const auto published =
+        header.tail.load(std::memory_order_acquire) - head;
+    if (published == 0) {
+      return std::nullopt;
+    }
+    if (published < kLengthSize || published > Capacity()) {
+      return error::RpcError::UnexpectedFromCode(
+          error::RpcErrorCode::kTransportError,
+          "Shared memory ring positions are corrupt");
+    }
+    std::uint32_t length = 0;
+    CopyOut(head, std::as_writable_bytes(std::span(&length, 1)));
+    // As published is at most Capacity(), this also bounds the length by
+    // MaxMessageSize()
+    if (length > published - kLengthSize) {
+      return error::RpcError::UnexpectedFromCode(
+          error::RpcErrorCode::kTransportError,
+          "Shared memory message length exceeds the published bytes");
+    }
+    return std::optional<std::size_t>(length);
+  }
+
+  /**
+   * @brief Copy the next message out and free its space
+   *
+   * Consumer only, after NextSize() returned the size of out.
+   */
+  void Pop(std::span<char> out) {
+    auto &header = GetHeader();
+    const auto head = header.head.load(std::memory_order_relaxed);
+    CopyOut(head + kLengthSize, std::as_writable_bytes(out));
+    header.head.store(
+        head + kLengthSize + out.size(), std::memory_order_release);
+  }
+
+  /**
+   * @brief Ask the producer for a wakeup before sleeping
+   *
+   * Consumer only. Returns false if a message came in meanwhile, in which
+   * case the consumer should read instead of sleeping.
+   */
+  auto PrepareToSleep() -> bool {
+    auto &header = GetHeader();
+    header.reader_sleeping.store(1, std::memory_order_seq_cst);
+    if (header.head.load(std::memory_order_relaxed) !=
+        header.tail.load(std::memory_order_seq_cst)) {
+      header.reader_sleeping.store(0, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  /// Consumer only, once woken up
+  void StopSleeping() {
+    GetHeader().reader_sleeping.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Whether the producer must wake the consumer after a push
+   *
+   * Producer only. Clears the request, so each sleep gets one wakeup.
+   */
+  auto ShouldWakeReader() -> bool {
+    auto &header = GetHeader();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return header.reader_sleeping.load(std::memory_order_relaxed) != 0 &&
+           header.reader_sleeping.exchange(0) != 0;
+  }
+
+  /// Producer side: no more messages will come
+  void CloseWriter() {
+    GetHeader().writer_closed.store(1, std::memory_order_release);
+  }
+
+  /// Consumer side: nobody will read further messages
+  void CloseReader() {
+    GetHeader().reader_closed.store(1, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto IsWriterClosed() const -> bool {
+    return GetHeader().writer_closed.load(std::memory_order_acquire) != 0;
+  }
+
+  [[nodiscard]] auto IsReaderClosed() const -> bool {
+    return GetHeader().reader_closed.load(std::memory_order_acquire) != 0;
+  }
+
+ private:
+  explicit ShmRing(std::span<std::byte> memory)
+      : memory_(memory), data_(memory.subspan(sizeof(Header))) {
+  }
+
+  [[nodiscard]] auto GetHeader() const -> Header & {
+    return *std::launder(reinterpret_cast<Header *>(memory_.data()));
+  }
+
+  // Copies into the data area starting at a position, wrapping at the end
+  void CopyIn(std::uint64_t position, std::span<const std::byte> bytes) {
+    const auto offset = position & (Capacity() - 1);
+    const auto first = std::min(bytes.size(), Capacity() - offset);
+    std::memcpy(data_.data() + offset, bytes.data(), first);
+    std::memcpy(data_.data(), bytes.data() + first, bytes.size() - first);
+  }
+
+  void CopyOut(std::uint64_t position, std::span<std::byte> bytes) const {
+    const auto offset = position & (Capacity() - 1);
+    const auto first = std::min(bytes.size(), Capacity() - offset);
+    std::memcpy(bytes.data(), data_.data() + offset, first);
+    std::memcpy(bytes.data() + first, data_.data(), bytes.size() - first);
+  }
+
+  std::span<std::byte> memory_;
+  std::span<std::byte> data_;
+};
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string>
+
+#include <asio.hpp>
+#include <asio/posix/stream_descriptor.hpp>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/shm_ring.hpp"
+#include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/// Bytes of ring in each direction, which also caps the message size
+constexpr std::size_t kDefaultShmRingCapacity = 1024 * 1024;
+
+/// Times an empty or full ring is polled before waiting on a doorbell
+constexpr std::size_t kDefaultShmSpinIterations = 64;
+
+struct ShmTransportOptions {
+  /// Rounded up to a power of two. Only the server's value counts; clients
+  /// use the rings the server created.
+  std::size_t ring_capacity = kDefaultShmRingCapacity;
+
+  /// Yields to the io_context between polls before sleeping. Higher values
+  /// trade CPU on an idle link for lower wakeup latency.
+  std::size_t spin_iterations = kDefaultShmSpinIterations;
+
+  /// Messages larger than this are not sent, and one coming in fails the
+  /// transport like a corrupt ring does
+  std::size_t max_message_size = kDefaultMaxMessageSize;
+};
+
+/**
+ * @brief Transport between processes on one host over shared memory
+ *
+ * The server creates a POSIX shared memory object holding one ShmRing per
+ * direction, and the client maps the same object by name. Messages are
+ * written in place into the ring, so a message costs one copy in and one
+ * copy out and no syscall while the peer is busy.
+ *
+ * A receiver polls its ring for spin_iterations yields of the io_context,
+ * then sleeps on a doorbell: a FIFO next to the shared memory object that
+ * the sender writes a byte to, but only when the receiver asked for it. A
+ * sender that finds the ring full polls the same way, then backs off on a
+ * timer up to a millisecond.
+ *
+ * Messages larger than the ring capacity are rejected. The peer can write
+ * to the whole mapping, so lengths read from it are checked against what
+ * it published and against max_message_size; a bad one is a framing error
+ * that ends the transport. A peer process that dies without closing goes
+ * unnoticed, so calls over it rely on request timeouts. Needs Linux, which
+ * lets each side open its FIFOs for reading and writing without waiting for
+ * the other.
+ */
+class ShmTransport : public Transport {
+ public:
+  /**
+   * @param name Shared memory object name without the leading slash. The
+   * doorbell FIFOs live in the temporary directory under the same name.
+   */
+  ShmTransport(
+      asio::any_io_executor executor, std::string name, bool is_server,
+      ShmTransportOptions options = {},
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  ~ShmTransport() override;
+
+  ShmTransport(const ShmTransport&) = delete;
+  auto operator=(const ShmTransport&) -> ShmTransport& = delete;
+
+  ShmTransport(ShmTransport&&) = delete;
+  auto operator=(ShmTransport&&) -> ShmTransport& = delete;
+
+  /**
+   * @brief Create the rings as the server, or map them as the client
+   *
+   * The server's Start() returns as soon as the rings exist; messages it
+   * sends wait in the ring for the client. The client's fails if no server
+   * created the rings yet.
+   */
+  auto Start()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto Close()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  void CloseNow() override;
+
+  auto SendMessage(std::string message)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  using Transport::Flush;
+
+  /// Waits for senders blocked on a full ring; messages in the ring count
+  /// as written
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto ReceiveMessage()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return is_connected_;
+  }
+
+ private:
+  // Creates the shared memory object, its rings and the doorbell FIFOs
+  auto CreateRegion() -> std::expected<void, error::RpcError>;
+
+  // Maps the server's shared memory object and opens its doorbells
+  auto AttachRegion() -> std::expected<void, error::RpcError>;
+
+  // Maps size bytes of the object behind fd into region_
+  auto MapRegion(int fd, std::size_t size)
+      -> std::expected<void, error::RpcError>;
+
+  auto OpenDoorbells() -> std::expected<void, error::RpcError>;
+
+  // Yields for the first spin_iterations rounds, then sleeps for delay and
+  // doubles it; returns back on the strand
+  auto Backoff(std::size_t& round, std::chrono::microseconds& delay)
+      -> asio::awaitable<void>;
+
+  // Sleeps until the peer rings the incoming doorbell, unless a message
+  // came in meanwhile
+  auto WaitForMessage() -> asio::awaitable<void>;
+
+  static void RingDoorbell(asio::posix::stream_descriptor& doorbell);
+
+  // Unmaps the rings and closes the doorbells; the server also removes the
+  // names so that no client attaches to a dead transport
+  void ReleaseResources();
+
+  std::string name_;
+  bool is_server_;
+  ShmTransportOptions options_;
+
+  std::span<std::byte> region_;
+  std::optional<ShmRing> incoming_;
+  std::optional<ShmRing> outgoing_;
+
+  // Woken by the peer when incoming_ gets a message, and rung for it when
+  // outgoing_ does
+  asio::posix::stream_descriptor incoming_doorbell_;
+  asio::posix::stream_descriptor outgoing_doorbell_;
+
+  // Sends take tickets so that those waiting on a full ring keep their
+  // order; only touched on the strand
+  std::uint64_t next_send_ticket_ = 0;
+  std::uint64_t current_send_ticket_ = 0;
+
+  std::atomic<bool> is_closed_{false};
+  std::atomic<bool> is_started_{false};
+  std::atomic<bool> is_connected_{false};
+};
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <asio.hpp>
+
+#include "jsonrpc/transport/acceptor.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/**
+ * @brief Accepts TCP connections and wraps each in a SocketTransport
+ *
+ * With reuse_port set, several acceptors, typically one per thread or
+ * io_context, may listen on the same port and the kernel spreads incoming
+ * connections across them.
+ */
+class SocketAcceptor : public Acceptor {
+ public:
+  /**
+   * @brief Construct a new Socket Acceptor object
+   *
+   * @param port Port to listen on; zero picks a free port, see LocalPort()
+   * @param options Applied to every accepted transport, which makes them the
+   * per-connection message size and send queue limits
+   * @param reuse_port Sets SO_REUSEPORT so other acceptors can share the port
+   */
+  SocketAcceptor(
+      asio::any_io_executor executor, std::string address, uint16_t port,
+      TransportOptions options = {}, bool reuse_port = false,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  using Acceptor::Accept;
+
+  auto Accept(asio::any_io_executor executor) -> asio::awaitable<
+      std::expected<std::unique_ptr<Transport>, error::RpcError>> override;
+
+  auto Close() -> asio::awaitable<void> override;
+
+  /// The bound port, which differs from the requested one when that was zero
+  [[nodiscard]] auto LocalPort() const -> uint16_t {
+    return local_port_;
+  }
+
+ private:
+  std::string address_;
+  uint16_t port_;
+  uint16_t local_port_{0};
+  TransportOptions options_;
+  bool reuse_port_;
+  asio::ip::tcp::acceptor acceptor_;
+};
+
+}  // namespace jsonrpc::transport
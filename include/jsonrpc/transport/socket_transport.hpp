@@ -1,13 +1,18 @@
 #pragma once
 
-#include <array>
 #include <atomic>
-#include <deque>
 #include <string>
 
 #include <asio.hpp>
 
+#include "jsonrpc/transport/line_framer.hpp"
+#include "jsonrpc/transport/message_compressor.hpp"
+#include "jsonrpc/transport/message_framer.hpp"
+#include "jsonrpc/transport/queued_writer.hpp"
+#include "jsonrpc/transport/read_buffer.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
 #include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
 
 namespace jsonrpc::transport {
 
@@ -17,6 +22,21 @@ class SocketTransport : public Transport {
       asio::any_io_executor executor, std::string address, uint16_t port,
       bool is_server, std::shared_ptr<spdlog::logger> logger = nullptr);
 
+  SocketTransport(
+      asio::any_io_executor executor, std::string address, uint16_t port,
+      bool is_server, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Wrap a socket that is already connected, such as one returned by
+   * a SocketAcceptor
+   *
+   * Start() neither connects nor listens; it only marks the transport ready.
+   */
+  SocketTransport(
+      asio::ip::tcp::socket socket, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
   ~SocketTransport() override;
 
   SocketTransport(const SocketTransport&) = delete;
@@ -25,6 +45,16 @@ class SocketTransport : public Transport {
   SocketTransport(SocketTransport&&) = delete;
   auto operator=(SocketTransport&&) -> SocketTransport& = delete;
 
+  /**
+   * @brief Bind and listen, without waiting for a client
+   *
+   * Start() then waits for the first client; calling it without Listen()
+   * does both. Succeeds at once when already listening, and for clients and
+   * wrapped connections.
+   */
+  auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
   auto Start()
       -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
@@ -36,35 +66,103 @@ class SocketTransport : public Transport {
   auto SendMessage(std::string message)
       -> asio::awaitable<std::expected<void, error::RpcError>> override;
 
+  /// Binary encodings need Framing::kContentLength
+  [[nodiscard]] auto SupportsEncoding(MessageEncoding encoding) const
+      -> bool override {
+    return encoding == MessageEncoding::kJson ||
+           options_.framing == Framing::kContentLength;
+  }
+
+  auto SendEncodedMessage(std::string message, MessageEncoding encoding)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto SendMessageWithHints(
+      std::string message, MessageEncoding encoding, SendHints hints)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  [[nodiscard]] auto LastReceivedEncoding() const -> MessageEncoding override {
+    return last_received_encoding_;
+  }
+
+  using Transport::Flush;
+
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
   auto ReceiveMessage()
       -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
 
+  auto GetSendQueueStats() -> asio::awaitable<SendQueueStats> override;
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return is_connected_;
+  }
+
+  /// The port a server listens on once Listen() returns, which differs from
+  /// the requested one when that was zero
+  [[nodiscard]] auto LocalPort() const -> uint16_t {
+    return local_port_;
+  }
+
  private:
   auto GetSocket() -> asio::ip::tcp::socket&;
 
+  // Connects, retrying as TransportOptions::connect_retry says
   auto Connect() -> asio::awaitable<std::expected<void, error::RpcError>>;
 
+  auto ConnectOnce() -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  // Binds and listens unless already listening
   auto BindAndListen() -> asio::awaitable<std::expected<void, error::RpcError>>;
 
-  // Sends messages from the queue in sequence
-  auto SendMessageLoop() -> asio::awaitable<void>;
+  auto AcceptConnection()
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  // Reads whatever is available on the socket into the given buffer
+  auto ReadSome(asio::mutable_buffer buffer)
+      -> asio::awaitable<std::expected<std::size_t, error::RpcError>>;
 
+  // Performs one socket read into the free space of read_buffer_
+  auto FillReadBuffer()
+      -> asio::awaitable<std::expected<void, error::RpcError>>;
+
+  // Returns the next line when newline-delimited framing is enabled
+  auto ReceiveLine()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>>;
+
+  // Returns the next decoded body when Content-Length framing is enabled
+  auto ReceiveFramed()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>>;
+
+  TransportOptions options_;
   asio::ip::tcp::socket socket_;
   std::unique_ptr<asio::ip::tcp::acceptor> acceptor_;
   std::string address_;
   uint16_t port_;
+  std::atomic<uint16_t> local_port_{0};
   bool is_server_;
   std::atomic<bool> is_closed_{false};
   std::atomic<bool> is_started_{false};
+  std::atomic<bool> is_listening_{false};
   std::atomic<bool> is_connected_{false};
 
-  // Message sending queue and state
-  std::deque<std::string> send_queue_;
-  std::atomic<bool> sending_{false};
+  // Send queue, cork window and write loop
+  QueuedWriter writer_;
+
+  // Waits between connect attempts; cancelled by Close()
+  asio::steady_timer connect_timer_;
+
+  // Buffer for reading data, sized by the observed read sizes
+  ReadBuffer read_buffer_;
+  AdaptiveReadSize read_size_;
+
+  // Framing state for newline-delimited messages
+  LineFramer line_framer_;
 
-  // Buffer for reading data
-  std::array<char, 1024> read_buffer_;
-  std::string message_buffer_;
+  // Framing and compression state for Content-Length messages
+  MessageFramer message_framer_;
+  MessageCompressor compressor_;
+  MessageEncoding last_received_encoding_{MessageEncoding::kJson};
 };
 
 }  // namespace jsonrpc::transport
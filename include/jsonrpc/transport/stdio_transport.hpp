@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <asio/posix/stream_descriptor.hpp>
+
+#include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/framed_reader.hpp"
+#include "jsonrpc/transport/message_compressor.hpp"
+#include "jsonrpc/transport/queued_writer.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
+#include "jsonrpc/transport/transport.hpp"
+#include "jsonrpc/transport/transport_options.hpp"
+
+namespace jsonrpc::transport {
+
+/// Smallest read from stdin; editors send whole documents at once, so reads
+/// start larger than on sockets
+constexpr std::size_t kDefaultStdioMinReadBufferSize = 64 * 1024;
+
+/**
+ * @brief Transport over the process's stdin and stdout, as language
+ * servers use
+ *
+ * Messages use Content-Length framing, as the Language Server Protocol
+ * does. By default reads start at kDefaultStdioMinReadBufferSize, and
+ * bodies larger than the read buffer are read straight into the message.
+ * Messages queued while a write is in flight go out together in one
+ * vectored write.
+ *
+ * The descriptors are duplicated, so closing the transport leaves the
+ * process's stdin and stdout open, but asio puts them into non-blocking
+ * mode: nothing else may write to stdout while the transport runs. Both
+ * must be pipes, sockets or terminals; regular files cannot be waited on
+ * with epoll. Writing after the reader of stdout went away raises SIGPIPE
+ * unless the process ignores it.
+ */
+class StdioTransport : public Transport {
+ public:
+  explicit StdioTransport(
+      asio::any_io_executor executor,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Run on stdin and stdout with the given options
+   *
+   * options.framing is ignored; messages always use Content-Length framing.
+   */
+  StdioTransport(
+      asio::any_io_executor executor, TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  /**
+   * @brief Run on other descriptors, such as the pipes to a child process
+   *
+   * Takes ownership of both descriptors.
+   */
+  StdioTransport(
+      asio::any_io_executor executor, int input_fd, int output_fd,
+      TransportOptions options,
+      std::shared_ptr<spdlog::logger> logger = nullptr);
+
+  ~StdioTransport() override;
+
+  StdioTransport(const StdioTransport&) = delete;
+  auto operator=(const StdioTransport&) -> StdioTransport& = delete;
+
+  StdioTransport(StdioTransport&&) = delete;
+  auto operator=(StdioTransport&&) -> StdioTransport& = delete;
+
+  auto Start()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto Close()
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  void CloseNow() override;
+
+  auto SendMessage(std::string message)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  /// Every encoding is labelled by the Content-Type header
+  [[nodiscard]] auto SupportsEncoding(MessageEncoding /*encoding*/) const
+      -> bool override {
+    return true;
+  }
+
+  auto SendEncodedMessage(std::string message, MessageEncoding encoding)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto SendMessageWithHints(
+      std::string message, MessageEncoding encoding, SendHints hints)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  [[nodiscard]] auto LastReceivedEncoding() const -> MessageEncoding override {
+    return reader_.LastEncoding();
+  }
+
+  using Transport::Flush;
+
+  auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override;
+
+  auto ReceiveMessage()
+      -> asio::awaitable<std::expected<std::string, error::RpcError>> override;
+
+  auto GetSendQueueStats() -> asio::awaitable<SendQueueStats> override;
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return is_connected_;
+  }
+
+ private:
+  // Wraps fd, logging instead of throwing when it cannot be waited on
+  void AssignDescriptor(asio::posix::stream_descriptor& descriptor, int fd);
+
+  // Reads whatever stdin has into the buffer, never returning zero bytes
+  auto ReadSome(asio::mutable_buffer buffer)
+      -> asio::awaitable<std::expected<std::size_t, error::RpcError>>;
+
+  void CloseDescriptors();
+
+  TransportOptions options_;
+  asio::posix::stream_descriptor input_;
+  asio::posix::stream_descriptor output_;
+  std::atomic<bool> is_closed_{false};
+  std::atomic<bool> is_started_{false};
+  std::atomic<bool> is_connected_{false};
+
+  MessageCompressor compressor_;
+  QueuedWriter writer_;
+  FramedReader reader_;
+};
+
+}  // namespace jsonrpc::transport
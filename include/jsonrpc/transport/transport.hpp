@@ -1,12 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include <asio.hpp>
 #include <spdlog/spdlog.h>
 
 #include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
+#include "jsonrpc/transport/message_pool.hpp"
+#include "jsonrpc/transport/send_queue.hpp"
+#include "jsonrpc/utils/strand.hpp"
 
 namespace jsonrpc::transport {
 
@@ -28,6 +38,19 @@ class Transport {
 
   virtual ~Transport() = default;
 
+  /**
+   * @brief Get ready for a peer without waiting for one
+   *
+   * Server transports bind and listen here, so a peer that connects from
+   * then on is picked up by the Start() that follows. Lets a process report
+   * that it is ready before its first peer arrives. Transports with nothing
+   * to prepare complete at once.
+   */
+  virtual auto Listen()
+      -> asio::awaitable<std::expected<void, error::RpcError>> {
+    co_return std::expected<void, error::RpcError>{};
+  }
+
   virtual auto Start()
       -> asio::awaitable<std::expected<void, error::RpcError>> = 0;
 
@@ -42,6 +65,103 @@ class Transport {
   virtual auto ReceiveMessage()
       -> asio::awaitable<std::expected<std::string, error::RpcError>> = 0;
 
+  /**
+   * @brief Give back a message returned by ReceiveMessage() once consumed
+   *
+   * Later receives reuse its storage instead of allocating. Only call it
+   * from the coroutine that receives, between receives.
+   */
+  void RecycleMessage(std::string message) {
+    message_pool_.Release(std::move(message));
+  }
+
+  /**
+   * @brief Whether the wire format can label messages with this encoding
+   *
+   * Only JSON by default. Binary encodings need framing that carries the
+   * body's content type.
+   */
+  [[nodiscard]] virtual auto SupportsEncoding(MessageEncoding encoding) const
+      -> bool {
+    return encoding == MessageEncoding::kJson;
+  }
+
+  /**
+   * @brief Send a body already encoded as the given encoding
+   */
+  virtual auto SendEncodedMessage(
+      std::string message, MessageEncoding encoding)
+      -> asio::awaitable<std::expected<void, error::RpcError>> {
+    if (encoding != MessageEncoding::kJson) {
+      co_return error::RpcError::UnexpectedFromCode(
+          error::RpcErrorCode::kTransportError,
+          "Transport cannot carry binary messages");
+    }
+    co_return co_await SendMessage(std::move(message));
+  }
+
+  /**
+   * @brief Send a body with hints for the send queue
+   *
+   * Transports with a send queue write interactive messages ahead of bulk
+   * messages still queued, and replace a queued message with the same
+   * replace key. The others ignore the hints.
+   */
+  virtual auto SendMessageWithHints(
+      std::string message, MessageEncoding encoding, SendHints /*hints*/)
+      -> asio::awaitable<std::expected<void, error::RpcError>> {
+    co_return co_await SendEncodedMessage(std::move(message), encoding);
+  }
+
+  /**
+   * @brief Encoding of the message the last ReceiveMessage() returned
+   */
+  [[nodiscard]] virtual auto LastReceivedEncoding() const -> MessageEncoding {
+    return MessageEncoding::kJson;
+  }
+
+  /**
+   * @brief Wait until every message sent so far has been written out
+   *
+   * Completes once the last queued byte has been handed to the kernel, or
+   * fails with kTimeoutError when the timeout elapses first. Also fails if
+   * the transport is closed or a write fails before the queue drains.
+   */
+  virtual auto Flush(std::optional<std::chrono::milliseconds> timeout)
+      -> asio::awaitable<std::expected<void, error::RpcError>> = 0;
+
+  /**
+   * @brief Wait without a timeout until every message has been written out
+   */
+  auto Flush() -> asio::awaitable<std::expected<void, error::RpcError>> {
+    return Flush(std::nullopt);
+  }
+
+  /**
+   * @brief Snapshot of the outgoing queue, for monitoring
+   *
+   * Transports without a send queue report empty stats.
+   */
+  virtual auto GetSendQueueStats() -> asio::awaitable<SendQueueStats> {
+    co_return SendQueueStats{};
+  }
+
+  /**
+   * @brief Whether the peer is still there
+   *
+   * Turns false once the peer closes the stream, or after a receive error
+   * no retry can fix, which tells the endpoint to stop reading instead of
+   * retrying. Transports that cannot tell always report true.
+   */
+  [[nodiscard]] virtual auto IsConnected() const -> bool {
+    return true;
+  }
+
+  /// Received messages whose framing could not be parsed
+  [[nodiscard]] auto FramingErrorCount() const -> std::uint64_t {
+    return framing_errors_.load(std::memory_order_relaxed);
+  }
+
   [[nodiscard]] auto GetExecutor() const -> asio::any_io_executor {
     return executor_;
   }
@@ -51,14 +171,43 @@ class Transport {
   }
 
  protected:
-  auto Logger() -> std::shared_ptr<spdlog::logger> {
+  auto Logger() -> const std::shared_ptr<spdlog::logger> & {
     return logger_;
   }
 
+  /// Resumes the calling coroutine on the transport's strand
+  auto SwitchToStrand() -> asio::awaitable<void> {
+    return utils::SwitchTo(strand_);
+  }
+
+  void CountFramingError() {
+    framing_errors_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// A message to return from ReceiveMessage(), in recycled storage
+  auto NewMessage(std::string_view contents) -> std::string {
+    return message_pool_.Acquire(contents);
+  }
+
+  /// A message of size bytes for the caller to fill in
+  auto NewMessage(std::size_t size) -> std::string {
+    return message_pool_.Acquire(size);
+  }
+
+  /// For helpers such as FramedReader that hand out received messages
+  auto MessageStorage() -> MessagePool & {
+    return message_pool_;
+  }
+
  private:
   std::shared_ptr<spdlog::logger> logger_;
   asio::any_io_executor executor_;
   asio::strand<asio::any_io_executor> strand_;
+
+  // Storage of consumed messages, only touched by the receiving coroutine
+  MessagePool message_pool_;
+
+  std::atomic<std::uint64_t> framing_errors_{0};
 };
 
 }  // namespace jsonrpc::transport
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "jsonrpc/transport/content_coding.hpp"
+
+namespace jsonrpc::transport {
+
+/// How a byte stream transport separates messages
+enum class Framing {
+  /// Every read is returned as is; the peer must not coalesce or split
+  /// messages
+  kNone,
+  /// One message per line, terminated by '\n'. Messages must not contain raw
+  /// newlines, which holds for compact JSON.
+  kNewlineDelimited,
+  /// Content-Length headers before each message, which can also name a
+  /// Content-Type and a Content-Encoding. Used by SocketTransport; pipes get
+  /// it from FramedPipeTransport.
+  kContentLength,
+};
+
+constexpr std::size_t kDefaultMaxMessageSize = 64 * 1024 * 1024;
+
+constexpr std::size_t kDefaultMinReadBufferSize = 4 * 1024;
+
+constexpr std::size_t kDefaultMaxReadBufferSize = 1024 * 1024;
+
+constexpr std::size_t kDefaultSendHighWatermarkBytes = 16 * 1024 * 1024;
+
+constexpr std::size_t kDefaultSendLowWatermarkBytes = 8 * 1024 * 1024;
+
+constexpr std::size_t kDefaultCompressionThreshold = 1024;
+
+/**
+ * @brief Compression of outgoing message bodies
+ *
+ * Only applies with Content-Length framing, where the Content-Encoding
+ * header tells the peer how to decode the body. Incoming bodies are
+ * decompressed by their header whatever these options say, so both peers
+ * must be built with the codec.
+ */
+struct CompressionOptions {
+  ContentCoding coding = ContentCoding::kIdentity;
+
+  /// Bodies smaller than this are sent as they are
+  std::size_t min_size = kDefaultCompressionThreshold;
+
+  /// Codec-specific compression level; zero picks the codec's default
+  int level = 0;
+};
+
+/// What SendMessage does while the send queue is over its high watermark
+enum class BackpressurePolicy {
+  /// Suspend the sender until the queue drains below the low watermark
+  kSuspend,
+  /// Fail immediately with a transport error
+  kFailFast,
+};
+
+/// Bounds for the outgoing message queue. A zero high watermark disables
+/// that limit.
+struct SendQueueLimits {
+  std::size_t high_watermark_bytes = kDefaultSendHighWatermarkBytes;
+  std::size_t low_watermark_bytes = kDefaultSendLowWatermarkBytes;
+  std::size_t high_watermark_messages = 0;
+  std::size_t low_watermark_messages = 0;
+};
+
+constexpr auto kDefaultConnectRetryDelay = std::chrono::milliseconds(50);
+
+constexpr auto kDefaultMaxConnectRetryDelay = std::chrono::milliseconds(2000);
+
+/// How client transports retry a failed connect, such as to a server that
+/// is still starting. Each wait is twice the one before, up to max_delay.
+struct ConnectRetry {
+  /// Connect attempts in all; one fails on the first error
+  std::size_t attempts = 1;
+  std::chrono::milliseconds initial_delay = kDefaultConnectRetryDelay;
+  std::chrono::milliseconds max_delay = kDefaultMaxConnectRetryDelay;
+};
+
+struct TransportOptions {
+  Framing framing = Framing::kNone;
+
+  /// Incoming messages larger than this fail with a transport error instead
+  /// of growing the read buffer without bound
+  std::size_t max_message_size = kDefaultMaxMessageSize;
+
+  /// Smallest read issued to the socket, and the size idle buffers shrink to
+  std::size_t min_read_buffer_size = kDefaultMinReadBufferSize;
+
+  /// Largest read issued to the socket. Reads grow toward this while they
+  /// keep filling the buffer.
+  std::size_t max_read_buffer_size = kDefaultMaxReadBufferSize;
+
+  /// How long the sender may hold back a write so that more messages can
+  /// join it. Zero, the default, writes as soon as a message is queued.
+  std::chrono::microseconds cork_delay{0};
+
+  /// Queued bytes that end the cork delay early. Zero waits for the full
+  /// delay.
+  std::size_t cork_bytes = 0;
+
+  /// Bounds on queued but unwritten messages
+  SendQueueLimits send_limits{};
+
+  BackpressurePolicy backpressure = BackpressurePolicy::kSuspend;
+
+  CompressionOptions compression{};
+
+  /// Applied by Start() of client transports that connect
+  ConnectRetry connect_retry{};
+};
+
+}  // namespace jsonrpc::transport
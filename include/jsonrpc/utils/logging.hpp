@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file logging.hpp
+ * @brief Level-checked logging macros used throughout the library
+ *
+ * Unlike calling spdlog::logger::debug() directly, the macros only evaluate
+ * their format arguments once the logger accepts the level, so substrings
+ * and other arguments built for a debug line cost nothing while debug
+ * logging is off. Levels below JSONRPC_ACTIVE_LEVEL compile to nothing at
+ * all, e.g. -DJSONRPC_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO drops the trace and
+ * debug lines from a release build.
+ *
+ * The logger argument is evaluated once, and only when the level is
+ * compiled in.
+ */
+
+#include <spdlog/spdlog.h>
+
+#ifndef JSONRPC_ACTIVE_LEVEL
+#define JSONRPC_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+/// Whether a line at level would be written, for guarding costly setup
+#define JSONRPC_LOG_ENABLED(logger, level)                   \
+  (static_cast<int>(level) >= JSONRPC_ACTIVE_LEVEL && \
+   (logger)->should_log(level))
+
+#define JSONRPC_LOG(logger, level, ...)                               \
+  do {                                                                \
+    if constexpr (static_cast<int>(level) >= JSONRPC_ACTIVE_LEVEL) {  \
+      const auto& jsonrpc_log_target = (logger);                      \
+      if (jsonrpc_log_target->should_log(level)) {                    \
+        jsonrpc_log_target->log(level, __VA_ARGS__);                  \
+      }                                                               \
+    }                                                                 \
+  } while (false)
+
+#if JSONRPC_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define JSONRPC_LOG_TRACE(logger, ...) \
+  JSONRPC_LOG(logger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define JSONRPC_LOG_TRACE(logger, ...) (void)0
+#endif
+
+#if JSONRPC_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define JSONRPC_LOG_DEBUG(logger, ...) \
+  JSONRPC_LOG(logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define JSONRPC_LOG_DEBUG(logger, ...) (void)0
+#endif
+
+#if JSONRPC_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define JSONRPC_LOG_INFO(logger, ...) \
+  JSONRPC_LOG(logger, spdlog::level::info, __VA_ARGS__)
+#else
+#define JSONRPC_LOG_INFO(logger, ...) (void)0
+#endif
+
+#if JSONRPC_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define JSONRPC_LOG_WARN(logger, ...) \
+  JSONRPC_LOG(logger, spdlog::level::warn, __VA_ARGS__)
+#else
+#define JSONRPC_LOG_WARN(logger, ...) (void)0
+#endif
+
+#if JSONRPC_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define JSONRPC_LOG_ERROR(logger, ...) \
+  JSONRPC_LOG(logger, spdlog::level::err, __VA_ARGS__)
+#else
+#define JSONRPC_LOG_ERROR(logger, ...) (void)0
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <asio.hpp>
+
+namespace jsonrpc::utils {
+
+/**
+ * @brief Resume the calling coroutine on the given executor
+ *
+ * Awaiting asio::post(strand, use_awaitable) only schedules a hop through
+ * the strand and then resumes on the coroutine's own executor, which gives
+ * no exclusion once the io_context runs on several threads. Binding the
+ * completion to the executor keeps the code after this call, up to the next
+ * suspension, on it.
+ */
+template <typename Executor>
+auto SwitchTo(Executor executor) -> asio::awaitable<void> {
+  co_await asio::post(asio::bind_executor(executor, asio::use_awaitable));
+}
+
+}  // namespace jsonrpc::utils
@@ -1,47 +1,319 @@
 #include "jsonrpc/endpoint/dispatcher.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <utility>
+
+#include <asio/experimental/concurrent_channel.hpp>
+#include <asio/experimental/parallel_group.hpp>
 #include <jsonrpc/endpoint/request.hpp>
 
+#include "jsonrpc/endpoint/envelope.hpp"
+#include "jsonrpc/endpoint/json_codec.hpp"
 #include "jsonrpc/endpoint/response.hpp"
+#include "jsonrpc/utils/logging.hpp"
+#include "jsonrpc/utils/strand.hpp"
 
 namespace jsonrpc::endpoint {
 
 using jsonrpc::error::RpcError;
 using jsonrpc::error::RpcErrorCode;
 
+namespace {
+
+// Records the wait before a handler and, once it returns or throws, how long
+// it ran
+class HandlerTimer {
+ public:
+  HandlerTimer(
+      MethodMetrics& metrics, Dispatcher::Clock::time_point received_at)
+      : metrics_(metrics), started_(Dispatcher::Clock::now()) {
+    metrics_.RecordQueue(started_ - received_at);
+  }
+
+  HandlerTimer(const HandlerTimer&) = delete;
+  HandlerTimer(HandlerTimer&&) = delete;
+  auto operator=(const HandlerTimer&) -> HandlerTimer& = delete;
+  auto operator=(HandlerTimer&&) -> HandlerTimer& = delete;
+
+  ~HandlerTimer() {
+    metrics_.RecordHandler(Dispatcher::Clock::now() - started_);
+  }
+
+ private:
+  MethodMetrics& metrics_;
+  Dispatcher::Clock::time_point started_;
+};
+
+// Cancels a shard remembers for calls that have not reached it yet. Peers
+// also cancel calls that were just answered, so the oldest ones are dropped.
+constexpr std::size_t kEarlyCancelsPerShard = 64;
+
+}  // namespace
+
+struct Dispatcher::SerialLane {
+  // Gives the token back when destroyed, however the call finishes
+  class Ticket {
+   public:
+    explicit Ticket(std::shared_ptr<SerialLane> lane) : lane_(std::move(lane)) {
+    }
+
+    Ticket(const Ticket&) = delete;
+    auto operator=(const Ticket&) -> Ticket& = delete;
+    Ticket(Ticket&&) noexcept = default;
+    auto operator=(Ticket&&) noexcept -> Ticket& = default;
+
+    ~Ticket() {
+      if (lane_) {
+        lane_->token.try_send(std::error_code{});
+      }
+    }
+
+   private:
+    std::shared_ptr<SerialLane> lane_;
+  };
+
+  explicit SerialLane(const asio::any_io_executor& executor)
+      : strand(asio::make_strand(executor)), token(strand, 1) {
+    token.try_send(std::error_code{});
+  }
+
+  // Waits for the token; calls queue up in the order they ask for it
+  static auto Acquire(std::shared_ptr<SerialLane> lane)
+      -> asio::awaitable<Ticket> {
+    if (lane) {
+      co_await lane->token.async_receive(asio::use_awaitable);
+    }
+    co_return Ticket(std::move(lane));
+  }
+
+  asio::strand<asio::any_io_executor> strand;
+
+  // Holds one token while no call of the method is running
+  asio::experimental::concurrent_channel<void(std::error_code)> token;
+};
+
+struct Dispatcher::Coalescer {
+  Coalescer(const asio::any_io_executor& executor, CoalesceOptions options)
+      : strand(asio::make_strand(executor)), options(std::move(options)) {
+  }
+
+  asio::strand<asio::any_io_executor> strand;
+  CoalesceOptions options;
+
+  // Params of every key whose window is open, only touched on the strand
+  std::unordered_map<std::string, std::optional<nlohmann::json>> pending;
+};
+
 Dispatcher::Dispatcher(
     asio::any_io_executor executor, std::shared_ptr<spdlog::logger> logger)
-    : executor_(std::move(executor)),
+    : Dispatcher(std::move(executor), DispatcherOptions{}, std::move(logger)) {
+}
+
+Dispatcher::Dispatcher(
+    asio::any_io_executor executor, DispatcherOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : options_(options),
+      executor_(std::move(executor)),
+      result_cache_(
+          executor_, options_.result_cache_capacity,
+          options_.result_cache_shards),
       logger_(logger ? logger : spdlog::default_logger()) {
+  const auto shard_count =
+      std::max<std::size_t>(options_.running_call_shards, 1);
+  running_.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    running_.push_back(std::make_shared<RunningShard>(executor_));
+  }
 }
 
 void Dispatcher::RegisterMethodCall(
-    const std::string& method, const MethodCallHandler& handler) {
-  method_handlers_[method] = handler;
+    const std::string& method, const MethodCallHandler& handler,
+    HandlerOptions options) {
+  UpdateRoute(method, [this, &handler, options](Route& route) {
+    route.method_call = handler;
+    route.streaming_call = nullptr;
+    route.lazy_params = false;
+    route.cache_ttl = options.cache_ttl;
+    SetExecution(route, options);
+  });
 }
 
 void Dispatcher::RegisterNotification(
-    const std::string& method, const NotificationHandler& handler) {
-  notification_handlers_[method] = handler;
+    const std::string& method, const NotificationHandler& handler,
+    HandlerOptions options) {
+  UpdateRoute(method, [this, &handler, options](Route& route) {
+    route.notification = handler;
+    route.lazy_params = false;
+    SetExecution(route, options);
+    SetCoalescing(route, options.coalesce);
+  });
+}
+
+void Dispatcher::RegisterLazyMethodCall(
+    const std::string& method, LazyMethodCallHandler handler,
+    HandlerOptions options) {
+  // Shared so that calls in flight keep the handler's captures alive
+  auto shared_handler =
+      std::make_shared<LazyMethodCallHandler>(std::move(handler));
+  UpdateRoute(method, [this, &shared_handler, options](Route& route) {
+    route.method_call = [lazy = std::move(shared_handler)](
+                            std::optional<nlohmann::json>&& params) {
+      return (*lazy)(LazyParams(std::move(params)));
+    };
+    route.streaming_call = nullptr;
+    route.lazy_params = true;
+    route.cache_ttl = options.cache_ttl;
+    SetExecution(route, options);
+  });
+  has_lazy_handlers_ = true;
+}
+
+void Dispatcher::RegisterLazyNotification(
+    const std::string& method, LazyNotificationHandler handler,
+    HandlerOptions options) {
+  auto shared_handler =
+      std::make_shared<LazyNotificationHandler>(std::move(handler));
+  UpdateRoute(method, [this, &shared_handler, options](Route& route) {
+    route.notification = [lazy = std::move(shared_handler)](
+                             std::optional<nlohmann::json>&& params) {
+      return (*lazy)(LazyParams(std::move(params)));
+    };
+    route.lazy_params = true;
+    SetExecution(route, options);
+    SetCoalescing(route, options.coalesce);
+  });
+  has_lazy_handlers_ = true;
+}
+
+void Dispatcher::RegisterStreamingMethodCall(
+    const std::string& method, StreamingMethodCallHandler handler,
+    HandlerOptions options) {
+  auto shared_handler =
+      std::make_shared<StreamingMethodCallHandler>(std::move(handler));
+  UpdateRoute(method, [this, &shared_handler, options](Route& route) {
+    route.method_call = nullptr;
+    route.streaming_call = std::move(shared_handler);
+    route.lazy_params = false;
+    route.cache_ttl = std::chrono::milliseconds::zero();
+    SetExecution(route, options);
+  });
+}
+
+auto Dispatcher::WantsLazyParams(std::string_view method) const -> bool {
+  auto route = FindRoute(method);
+  return route && route->lazy_params;
+}
+
+template <typename Update>
+void Dispatcher::UpdateRoute(const std::string& method, Update&& update) {
+  auto& slot = routes_[method];
+  auto route =
+      slot ? std::make_shared<Route>(*slot) : std::make_shared<Route>();
+  std::forward<Update>(update)(*route);
+  if (!route->metrics) {
+    route->metrics = std::make_shared<MethodMetrics>();
+  }
+  slot = std::move(route);
+}
+
+void Dispatcher::SetExecution(Route& route, const HandlerOptions& options) {
+  route.priority = options.priority;
+  if (options.execution == HandlerExecution::kConcurrent) {
+    route.lane = nullptr;
+    return;
+  }
+  if (!route.lane) {
+    route.lane = std::make_shared<SerialLane>(executor_);
+  }
+}
+
+void Dispatcher::SetCoalescing(Route& route, const CoalesceOptions& options) {
+  // Notifications pending under the old options still run with them
+  route.coalescer = options.window > std::chrono::milliseconds::zero()
+                        ? std::make_shared<Coalescer>(executor_, options)
+                        : nullptr;
+}
+
+auto Dispatcher::FindRoute(std::string_view method) const
+    -> std::shared_ptr<const Route> {
+  auto it = routes_.find(method);
+  return it != routes_.end() ? it->second : nullptr;
+}
+
+auto Dispatcher::GetMetrics() const -> DispatcherMetrics {
+  DispatcherMetrics snapshot;
+  snapshot.unknown_method_calls =
+      unknown_method_calls_.load(std::memory_order_relaxed);
+  for (const auto& [method, route] : routes_) {
+    snapshot.methods.emplace(method, route->metrics->Snapshot());
+  }
+  return snapshot;
 }
 
-auto Dispatcher::DispatchRequest(std::string request)
+auto Dispatcher::ExecutorFor(const nlohmann::json& message) const
+    -> asio::any_io_executor {
+  if (message.is_object()) {
+    auto method = message.find("method");
+    if (method != message.end() && method->is_string()) {
+      auto route = FindRoute(method->get_ref<const std::string&>());
+      if (route && route->lane) {
+        return route->lane->strand;
+      }
+    }
+  }
+  return executor_;
+}
+
+auto Dispatcher::PriorityFor(const nlohmann::json& message) const
+    -> transport::MessagePriority {
+  if (message.is_object()) {
+    auto method = message.find("method");
+    if (method != message.end() && method->is_string()) {
+      auto route = FindRoute(method->get_ref<const std::string&>());
+      if (route) {
+        return route->priority;
+      }
+    }
+  }
+  return transport::MessagePriority::kInteractive;
+}
+
+auto Dispatcher::DispatchRequest(std::string request, PeerId peer)
     -> asio::awaitable<std::optional<std::string>> {
-  auto root = nlohmann::json::parse(request, nullptr, false);
+  auto root = HasLazyHandlers()
+                  ? ParseJsonWithLazyParams(
+                        request,
+                        [this](std::string_view method) {
+                          return WantsLazyParams(method);
+                        })
+                  : ParseJson(request);
   if (root.is_discarded()) {
-    co_return Response::CreateError(RpcErrorCode::kParseError).ToJson().dump();
+    co_return Response::CreateError(RpcErrorCode::kParseError).Dump();
   }
+  co_return co_await DispatchJson(std::move(root), peer);
+}
 
+auto Dispatcher::DispatchJson(
+    nlohmann::json root, PeerId peer,
+    std::optional<Clock::time_point> received_at, ResultStream::Sender sender,
+    std::optional<asio::any_io_executor> handler_executor,
+    transport::MessageEncoding encoding)
+    -> asio::awaitable<std::optional<std::string>> {
+  const auto received = received_at.value_or(Clock::now());
+  const auto executor = handler_executor.value_or(executor_);
   // Single request
   if (root.is_object()) {
-    auto request = Request::FromJson(root);
+    auto request = Request::FromJson(std::move(root));
     if (!request.has_value()) {
-      co_return Response::CreateError(request.error()).ToJson().dump();
+      co_return Response::CreateError(request.error()).Encode(encoding);
     }
 
-    auto response = co_await DispatchSingleRequest(request.value());
+    auto response = co_await DispatchSingleRequest(
+        std::move(request.value()), peer, received, sender, executor);
     if (response.has_value()) {
-      co_return response.value().ToJson().dump();
+      co_return response.value().Encode(encoding);
     }
     co_return std::nullopt;
   }
@@ -50,89 +322,389 @@ auto Dispatcher::DispatchRequest(std::string request)
   if (root.is_array()) {
     if (root.empty()) {
       co_return Response::CreateError(RpcErrorCode::kInvalidRequest)
-          .ToJson()
-          .dump();
+          .Encode(encoding);
+    }
+
+    if (root.size() > options_.max_batch_size) {
+      co_return Response::CreateError(
+          RpcError::FromCode(
+              RpcErrorCode::kInvalidRequest,
+              "Batch exceeds the maximum of " +
+                  std::to_string(options_.max_batch_size) + " requests"))
+          .Encode(encoding);
     }
 
     std::vector<Request> requests;
     std::vector<Response> responses;
-    for (const auto& element : root) {
-      auto request = Request::FromJson(element);
+    requests.reserve(root.size());
+    for (auto& element : root) {
+      auto request = Request::FromJson(std::move(element));
       if (!request.has_value()) {
         responses.push_back(Response::CreateError(request.error()));
         continue;
       }
-      requests.push_back(request.value());
+      requests.push_back(std::move(request.value()));
     }
 
-    auto dispatched = co_await DispatchBatchRequest(requests);
-    for (const auto& response : dispatched) {
-      responses.push_back(response);
+    auto dispatched = co_await DispatchBatchRequest(
+        std::move(requests), peer, received, sender, executor);
+    for (auto& response : dispatched) {
+      responses.push_back(std::move(response));
     }
 
-    co_return nlohmann::json(responses).dump();
+    // Each response writes its own envelope; no DOM of the batch is built
+    std::string text;
+    if (encoding == transport::MessageEncoding::kJson) {
+      text = "[";
+      for (const auto& response : responses) {
+        if (text.size() > 1) {
+          text += ',';
+        }
+        text += response.Dump();
+      }
+      text += ']';
+    } else {
+      AppendBinaryArray(text, responses.size(), encoding);
+      for (const auto& response : responses) {
+        text += response.Encode(encoding);
+      }
+    }
+    co_return text;
   }
 
   co_return Response::CreateError(RpcErrorCode::kInvalidRequest)
-      .ToJson()
-      .dump();
+      .Encode(encoding);
 }
 
-auto Dispatcher::DispatchSingleRequest(Request request)
+auto Dispatcher::DispatchRequest(Request request, PeerId peer)
     -> asio::awaitable<std::optional<Response>> {
-  auto method = request.GetMethod();
+  co_return co_await DispatchSingleRequest(
+      std::move(request), peer, Clock::now(), nullptr, executor_);
+}
+
+auto Dispatcher::DispatchSingleRequest(
+    Request request, PeerId peer, Clock::time_point received_at,
+    const ResultStream::Sender& sender,
+    const asio::any_io_executor& handler_executor)
+    -> asio::awaitable<std::optional<Response>> {
+  const auto& method = request.GetMethod();
+  auto route = FindRoute(method);
 
   if (request.IsNotification()) {
-    auto it = notification_handlers_.find(method);
-    if (it != notification_handlers_.end()) {
-      Logger()->debug(
-          "Dispatcher found notification handler for method: {}", method);
-      co_spawn(
-          executor_,
-          [handler = it->second, params = request.GetParams()] {
-            return handler(params);
-          },
-          asio::detached);
+    // A handler registered under the same name still sees the notification
+    if (!options_.cancel_method.empty() && method == options_.cancel_method) {
+      CancelRunning(peer, request.GetParams());
+    }
+    if (route && route->notification) {
+      JSONRPC_LOG_DEBUG(
+          Logger(), "Dispatcher found notification handler for method: {}",
+          method);
+      route->metrics->AddCall();
+      if (route->coalescer) {
+        co_await Coalesce(
+            logger_, handler_executor, std::move(route), request.TakeParams(),
+            received_at);
+      } else {
+        co_await RunNotification(
+            logger_, handler_executor, std::move(route), request.TakeParams(),
+            received_at);
+      }
       co_return std::nullopt;
     }
-    Logger()->debug(
-        "Dispatcher notification handler not found for method: {}", method);
+    unknown_method_calls_.fetch_add(1, std::memory_order_relaxed);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "Dispatcher notification handler not found for method: {}",
+        method);
     co_return std::nullopt;
   }
 
-  auto it = method_handlers_.find(method);
-  if (it != method_handlers_.end()) {
-    Logger()->debug("Dispatcher found method handler for method: {}", method);
-    auto result = co_await asio::co_spawn(
-        executor_,
-        [handler = it->second, params = request.GetParams()] {
-          return handler(params);
-        },
-        asio::use_awaitable);
-    co_return Response::CreateSuccess(result, request.GetId());
+  if (route && (route->method_call || route->streaming_call)) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "Dispatcher found method handler for method: {}", method);
+    // The table keeps the metrics of a method for the dispatcher's lifetime,
+    // even once the route is replaced
+    auto& metrics = *route->metrics;
+    metrics.AddCall();
+    auto executor = route->lane ? asio::any_io_executor(route->lane->strand)
+                                : handler_executor;
+    // Taken before the cache lookup, so a serial method's hits keep their
+    // place among its calls
+    auto ticket = co_await SerialLane::Acquire(route->lane);
+    const auto cache_ttl = route->cache_ttl;
+    ResultCache::Lease lease;
+    if (cache_ttl > std::chrono::milliseconds::zero()) {
+      // Hits skip the handler and its spawn altogether
+      auto lookup = co_await result_cache_.Find(
+          ResultCache::KeyOf(method, request.GetParams()));
+      // Find() resumes on its shard's strand, which only guards the shard
+      co_await utils::SwitchTo(handler_executor);
+      if (lookup.hit) {
+        metrics.AddCacheHit();
+        co_return Response::CreateSuccess(
+            std::move(lookup.hit), request.GetId());
+      }
+      lease = std::move(lookup.lease);
+    }
+    auto call = [route = std::move(route), params = request.TakeParams(),
+                 received_at,
+                 &sender]() mutable -> asio::awaitable<nlohmann::json> {
+      HandlerTimer timer(*route->metrics, received_at);
+      if (!route->streaming_call) {
+        co_return co_await route->method_call(std::move(params));
+      }
+      ResultStream stream(ResultStream::TokenOf(params), sender);
+      co_await (*route->streaming_call)(std::move(params), stream);
+      co_return stream.TakeResult();
+    };
+    try {
+      if (options_.cancel_method.empty()) {
+        auto result = co_await asio::co_spawn(
+            executor, std::move(call), asio::use_awaitable);
+        lease.Fulfill(result, cache_ttl);
+        co_return Response::CreateSuccess(std::move(result), request.GetId());
+      }
+      auto result = co_await RunCancellable(
+          RunningKey{peer, request.GetId()}, executor, std::move(call));
+      if (!result.has_value()) {
+        metrics.AddError();
+        JSONRPC_LOG_DEBUG(
+            Logger(), "Dispatcher handler for {} was cancelled", method);
+        co_return Response::CreateError(
+            RpcErrorCode::kRequestCancelled, request.GetId());
+      }
+      lease.Fulfill(*result, cache_ttl);
+      co_return Response::CreateSuccess(
+          std::move(*result), request.GetId());
+    } catch (const std::exception& ex) {
+      metrics.AddError();
+      JSONRPC_LOG_ERROR(
+          Logger(), "Dispatcher handler for {} failed: {}", method, ex.what());
+      co_return Response::CreateError(
+          RpcError::FromCode(RpcErrorCode::kInternalError, ex.what()),
+          request.GetId());
+    }
   }
-  Logger()->debug("Dispatcher method handler not found for method: {}", method);
+  unknown_method_calls_.fetch_add(1, std::memory_order_relaxed);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "Dispatcher method handler not found for method: {}", method);
   co_return Response::CreateError(
       RpcErrorCode::kMethodNotFound, request.GetId());
 }
 
-auto Dispatcher::DispatchBatchRequest(std::vector<Request> requests)
+auto Dispatcher::RunNotification(
+    std::shared_ptr<spdlog::logger> logger, asio::any_io_executor executor,
+    std::shared_ptr<const Route> route, std::optional<nlohmann::json> params,
+    Clock::time_point received_at) -> asio::awaitable<void> {
+  if (route->lane) {
+    executor = route->lane->strand;
+  }
+  auto ticket = co_await SerialLane::Acquire(route->lane);
+  // Awaited, so the endpoint counts the handler until it returns
+  try {
+    co_await co_spawn(
+        executor,
+        [&route, &params, received_at]() -> asio::awaitable<void> {
+          HandlerTimer timer(*route->metrics, received_at);
+          co_await route->notification(std::move(params));
+        },
+        asio::use_awaitable);
+  } catch (const std::exception& ex) {
+    route->metrics->AddError();
+    JSONRPC_LOG_ERROR(
+        logger, "Dispatcher notification handler failed: {}", ex.what());
+  }
+}
+
+auto Dispatcher::Coalesce(
+    std::shared_ptr<spdlog::logger> logger, asio::any_io_executor executor,
+    std::shared_ptr<const Route> route, std::optional<nlohmann::json> params,
+    Clock::time_point received_at) -> asio::awaitable<void> {
+  auto& coalescer = *route->coalescer;
+  auto key = coalescer.options.key ? coalescer.options.key(params) : "";
+  co_await utils::SwitchTo(coalescer.strand);
+  auto [pending, opened] = coalescer.pending.try_emplace(std::move(key));
+  if (!opened) {
+    pending->second = coalescer.options.merge
+                          ? coalescer.options.merge(
+                                std::move(pending->second), std::move(params))
+                          : std::move(params);
+    co_return;
+  }
+  pending->second = std::move(params);
+
+  // The window runs from the first notification, so later ones add no delay;
+  // the queue latency metric includes it
+  co_spawn(
+      coalescer.strand,
+      [logger = std::move(logger), executor = std::move(executor),
+       route = std::move(route), key = pending->first,
+       received_at]() mutable -> asio::awaitable<void> {
+        auto& coalescer = *route->coalescer;
+        asio::steady_timer window(coalescer.strand, coalescer.options.window);
+        co_await window.async_wait(asio::use_awaitable);
+        auto node = coalescer.pending.extract(key);
+        co_await RunNotification(
+            std::move(logger), std::move(executor), std::move(route),
+            std::move(node.mapped()), received_at);
+      },
+      asio::detached);
+}
+
+template <typename Call>
+auto Dispatcher::RunCancellable(
+    RunningKey key, asio::any_io_executor executor, Call call)
+    -> asio::awaitable<std::optional<nlohmann::json>> {
+  auto running = std::make_shared<RunningCall>(
+      co_await asio::this_coro::executor);
+  // Cancels are emitted on the call's strand, so the slot is connected there
+  // too. The strand wraps the executor this coroutine already runs on, so
+  // the hop stays on this thread.
+  co_await asio::dispatch(
+      asio::bind_executor(running->strand, asio::use_awaitable));
+  // A peer reusing the id of a running call cannot cancel the second one.
+  // The cancel of a call that was registered too late was remembered, and is
+  // emitted once the coroutine suspends below with the slot connected.
+  auto shard = RunningShardFor(key);
+  asio::post(shard->strand, [shard, key, running] {
+    if (!shard->calls.try_emplace(key, running).second) {
+      return;
+    }
+    auto early = std::ranges::find(shard->early_cancels, key);
+    if (early != shard->early_cancels.end()) {
+      shard->early_cancels.erase(early);
+      RunningCall::Cancel(running);
+    }
+  });
+
+  std::exception_ptr failure;
+  nlohmann::json result;
+  try {
+    result = co_await asio::co_spawn(
+        executor, std::move(call),
+        asio::bind_cancellation_slot(
+            running->signal.slot(),
+            asio::bind_executor(running->strand, asio::use_awaitable)));
+  } catch (...) {
+    failure = std::current_exception();
+  }
+
+  running->done = true;
+  asio::post(shard->strand, [shard, key, running] {
+    auto it = shard->calls.find(key);
+    if (it != shard->calls.end() && it->second == running) {
+      shard->calls.erase(it);
+    }
+  });
+  if (failure) {
+    if (running->cancelled) {
+      co_return std::nullopt;
+    }
+    std::rethrow_exception(failure);
+  }
+  // A handler that finished its work despite the cancel keeps its result
+  co_return result;
+}
+
+void Dispatcher::RunningCall::Cancel(std::shared_ptr<RunningCall> running) {
+  auto& strand = running->strand;
+  asio::dispatch(strand, [running = std::move(running)] {
+    if (running->done || running->cancelled) {
+      return;
+    }
+    running->cancelled = true;
+    running->signal.emit(asio::cancellation_type::terminal);
+  });
+}
+
+auto Dispatcher::RunningShardFor(const RunningKey& key) const
+    -> const std::shared_ptr<RunningShard>& {
+  const auto hash = std::hash<RequestId>{}(key.second) ^
+                    (std::hash<PeerId>{}(key.first) << 1);
+  return running_[hash % running_.size()];
+}
+
+void Dispatcher::CancelRunning(
+    PeerId peer, const std::optional<nlohmann::json>& params) {
+  if (!params || !params->is_object()) {
+    return;
+  }
+  auto id = params->find("id");
+  RunningKey key{peer, RequestId{}};
+  if (id != params->end() && id->is_number_integer()) {
+    key.second = id->get<int64_t>();
+  } else if (id != params->end() && id->is_string()) {
+    key.second = id->get<std::string>();
+  } else {
+    return;
+  }
+
+  auto shard = RunningShardFor(key);
+  auto& strand = shard->strand;
+  asio::post(
+      strand, [shard = std::move(shard), key, logger = logger_, peer] {
+        auto it = shard->calls.find(key);
+        if (it == shard->calls.end()) {
+          // Already answered, or not registered yet
+          if (std::ranges::find(shard->early_cancels, key) ==
+              shard->early_cancels.end()) {
+            if (shard->early_cancels.size() == kEarlyCancelsPerShard) {
+              shard->early_cancels.pop_front();
+            }
+            shard->early_cancels.push_back(key);
+          }
+          return;
+        }
+        JSONRPC_LOG_DEBUG(
+            logger, "Dispatcher cancelling request on peer {}", peer);
+        RunningCall::Cancel(it->second);
+      });
+}
+
+auto Dispatcher::DispatchBatchRequest(
+    std::vector<Request> requests, PeerId peer, Clock::time_point received_at,
+    const ResultStream::Sender& sender,
+    const asio::any_io_executor& handler_executor)
     -> asio::awaitable<std::vector<Response>> {
-  std::vector<asio::awaitable<std::optional<Response>>> pending;
-  pending.reserve(requests.size());
+  // Each element writes its own slot so responses keep the request order
+  std::vector<std::optional<Response>> slots(requests.size());
+  std::atomic<std::size_t> next{0};
+
+  // Workers pull the next element until the batch is drained, which caps the
+  // number of handlers running at once without a semaphore
+  auto worker = [this, &requests, &slots, &next, peer, received_at, &sender,
+                 &handler_executor]() -> asio::awaitable<void> {
+    for (auto index = next++; index < requests.size(); index = next++) {
+      slots[index] = co_await DispatchSingleRequest(
+          std::move(requests[index]), peer, received_at, sender,
+          handler_executor);
+    }
+  };
 
-  // Queue all requests in parallel
-  for (const auto& request : requests) {
-    // For valid requests, dispatch them normally
-    pending.push_back(DispatchSingleRequest(request));
+  auto worker_count = requests.size();
+  if (options_.max_batch_concurrency > 0) {
+    worker_count = std::min(worker_count, options_.max_batch_concurrency);
+  }
+
+  if (worker_count <= 1) {
+    co_await worker();
+  } else {
+    using WorkerOp =
+        decltype(asio::co_spawn(handler_executor, worker, asio::deferred));
+    std::vector<WorkerOp> workers;
+    workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+      workers.push_back(
+          asio::co_spawn(handler_executor, worker, asio::deferred));
+    }
+    co_await asio::experimental::make_parallel_group(std::move(workers))
+        .async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
   }
 
-  // Wait for all requests to complete
   std::vector<Response> responses;
-  for (auto& awaitable_response : pending) {
-    auto response = co_await std::move(awaitable_response);
-    if (response.has_value()) {
-      responses.push_back(response.value());
+  responses.reserve(slots.size());
+  for (auto& slot : slots) {
+    if (slot.has_value()) {
+      responses.push_back(std::move(slot.value()));
     }
   }
 
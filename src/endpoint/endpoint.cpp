@@ -1,11 +1,22 @@
 #include "jsonrpc/endpoint/endpoint.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <utility>
+
 #include <asio.hpp>
 #include <jsonrpc/error/error.hpp>
 #include <spdlog/spdlog.h>
 
+#include "jsonrpc/endpoint/envelope.hpp"
+#include "jsonrpc/endpoint/json_codec.hpp"
+#include "jsonrpc/endpoint/lazy_params.hpp"
 #include "jsonrpc/endpoint/request.hpp"
 #include "jsonrpc/endpoint/response.hpp"
+#include "jsonrpc/utils/logging.hpp"
+#include "jsonrpc/utils/strand.hpp"
 
 namespace jsonrpc::endpoint {
 
@@ -17,46 +28,123 @@ RpcEndpoint::RpcEndpoint(
     asio::any_io_executor executor,
     std::unique_ptr<transport::Transport> transport,
     std::shared_ptr<spdlog::logger> logger)
-    : logger_(logger ? logger : spdlog::default_logger()),
+    : RpcEndpoint(
+          std::move(executor), std::move(transport), EndpointOptions{},
+          std::move(logger)) {
+}
+
+RpcEndpoint::RpcEndpoint(
+    asio::any_io_executor executor,
+    std::unique_ptr<transport::Transport> transport, EndpointOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : RpcEndpoint(
+          executor, std::move(transport),
+          std::make_shared<Dispatcher>(
+              options.handler_executor.value_or(executor), options.dispatcher,
+              logger),
+          options, logger) {
+}
+
+RpcEndpoint::RpcEndpoint(
+    asio::any_io_executor executor,
+    std::unique_ptr<transport::Transport> transport,
+    std::shared_ptr<Dispatcher> dispatcher, EndpointOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : options_(std::move(options)),
+      logger_(logger ? logger : spdlog::default_logger()),
       executor_(std::move(executor)),
       transport_(std::move(transport)),
-      dispatcher_(executor_, logger_),
-      endpoint_strand_(asio::make_strand(executor_)) {
+      dispatcher_(std::move(dispatcher)),
+      peer_id_(dispatcher_->NewPeerId()),
+      pending_requests_(options_.max_pending_requests),
+      endpoint_strand_(asio::make_strand(executor_)),
+      timeout_wheel_(
+          endpoint_strand_, options_.timeout_tick,
+          options_.timeout_wheel_slots,
+          [this](int64_t id) { ExpireRequest(id); }),
+      last_activity_(Clock::now().time_since_epoch().count()),
+      state_changed_(endpoint_strand_, Clock::time_point::max()),
+      retry_timer_(endpoint_strand_),
+      metrics_timer_(endpoint_strand_),
+      batch_timer_(endpoint_strand_) {
+  handler_load_ = options_.handler_affinity.load
+                      ? options_.handler_affinity.load
+                      : std::make_shared<std::atomic<std::size_t>>(0);
 }
 
 auto RpcEndpoint::CreateClient(
     asio::any_io_executor executor,
     std::unique_ptr<transport::Transport> transport)
     -> asio::awaitable<std::expected<std::unique_ptr<RpcEndpoint>, RpcError>> {
-  auto endpoint = std::make_unique<RpcEndpoint>(executor, std::move(transport));
+  EndpointOptions options;
+  co_return co_await CreateClient(
+      std::move(executor), std::move(transport), std::move(options));
+}
+
+auto RpcEndpoint::CreateClient(
+    asio::any_io_executor executor,
+    std::unique_ptr<transport::Transport> transport, EndpointOptions options)
+    -> asio::awaitable<std::expected<std::unique_ptr<RpcEndpoint>, RpcError>> {
+  auto endpoint = std::make_unique<RpcEndpoint>(
+      executor, std::move(transport), std::move(options));
 
   auto start_result = co_await endpoint->Start();
   if (!start_result) {
     co_return std::unexpected(start_result.error());
   }
 
-  endpoint->Logger()->debug("Client endpoint initialized");
+  const bool wants_binary = std::ranges::any_of(
+      endpoint->options_.encodings, [](transport::MessageEncoding encoding) {
+        return encoding != transport::MessageEncoding::kJson;
+      });
+  if (wants_binary) {
+    // Peers that do not know the method answer with an error; stay on JSON
+    auto negotiated = co_await endpoint->NegotiateEncoding();
+    if (!negotiated) {
+      JSONRPC_LOG_DEBUG(
+          endpoint->Logger(), "Encoding negotiation failed, using JSON: {}",
+          negotiated.error().Message());
+    }
+  }
+
+  JSONRPC_LOG_DEBUG(endpoint->Logger(), "Client endpoint initialized");
   co_return endpoint;
 }
 
+auto RpcEndpoint::Listen() -> asio::awaitable<std::expected<void, RpcError>> {
+  co_return co_await transport_->Listen();
+}
+
 auto RpcEndpoint::Start() -> asio::awaitable<std::expected<void, RpcError>> {
-  Logger()->debug("RpcEndpoint starting");
+  JSONRPC_LOG_DEBUG(Logger(), "RpcEndpoint starting");
   if (is_running_.exchange(true)) {
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kClientError, "RPC endpoint is already running");
   }
 
-  pending_requests_.clear();
-
   // Start the transport
   auto start_result = co_await transport_->Start();
   if (!start_result) {
+    is_running_ = false;
     co_return start_result;
   }
 
   // Start message processing on the endpoint strand
   StartMessageProcessing();
 
+  if (options_.metrics_exporter) {
+    exporting_metrics_ = true;
+    asio::co_spawn(
+        endpoint_strand_, ExportMetricsLoop(),
+        asio::bind_executor(endpoint_strand_, [this](std::exception_ptr eptr) {
+          if (eptr) {
+            JSONRPC_LOG_ERROR(Logger(), "RpcEndpoint metrics exporter failed");
+          }
+          exporting_metrics_ = false;
+          state_changed_.cancel();
+        }));
+  }
+
   // Ensure Start completes before Wait checks is_running_
   co_return std::expected<void, RpcError>{};
 }
@@ -68,10 +156,7 @@ auto RpcEndpoint::WaitForShutdown()
     co_return std::expected<void, RpcError>{};
   }
 
-  if (message_loop_.valid()) {
-    co_await std::move(message_loop_);
-  }
-
+  co_await WaitForMessageLoop();
   co_return std::expected<void, RpcError>{};
 }
 
@@ -80,26 +165,30 @@ auto RpcEndpoint::Shutdown() -> asio::awaitable<std::expected<void, RpcError>> {
     co_return std::expected<void, RpcError>{};
   }
 
-  co_await asio::post(endpoint_strand_, asio::use_awaitable);
-  cancel_signal_.emit(asio::cancellation_type::all);
+  // Bind the resumption so the wheel is stopped on its strand
+  co_await utils::SwitchTo(endpoint_strand_);
 
-  Logger()->debug("Shutting down RPC endpoint");
+  JSONRPC_LOG_DEBUG(Logger(), "Shutting down RPC endpoint");
 
-  // Ensure all operations on the strand complete, including message processing
+  // Cancel pending requests, including those still waiting to be batched
+  timeout_wheel_.Stop();
+  batch_timer_.cancel();
+  batch_messages_.clear();
+  batch_call_ids_.clear();
+  pending_requests_.CancelAll(-32603, "RPC endpoint shutting down");
+  state_changed_.cancel();  // Wakes the loop if it waits for a handler slot
+  retry_timer_.cancel();
+  metrics_timer_.cancel();
 
-  // Cancel pending requests
-  for (auto &[id, request] : pending_requests_) {
-    request->Cancel(-32603, "RPC endpoint shutting down");
-  }
-  pending_requests_.clear();
-
-  // Wait for the message loop to complete
-  if (message_loop_.valid()) {
-    co_await std::move(message_loop_);
-  }
-
-  // Now close the transport
+  // Closing the transport fails the receive the loop is waiting on
   auto close_result = co_await transport_->Close();
+  co_await WaitForMessageLoop();
+  // The exporter may be reading the transport's stats
+  while (exporting_metrics_) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+  }
   if (!close_result) {
     co_return close_result;
   }
@@ -107,121 +196,705 @@ auto RpcEndpoint::Shutdown() -> asio::awaitable<std::expected<void, RpcError>> {
   co_return Ok();
 }
 
+auto RpcEndpoint::WaitForMessageLoop() -> asio::awaitable<void> {
+  co_await utils::SwitchTo(endpoint_strand_);
+  while (!loop_finished_) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+  }
+}
+
+auto RpcEndpoint::WaitForHandlerSlot() -> asio::awaitable<void> {
+  const auto limit = options_.max_in_flight_handlers;
+  if (limit == 0 || active_handlers_ < limit) {
+    co_return;
+  }
+  // Not reading is what pushes back on the peer
+  co_await utils::SwitchTo(endpoint_strand_);
+  waiting_for_handler_slot_ = true;
+  while (is_running_ && active_handlers_ >= limit) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+  }
+  waiting_for_handler_slot_ = false;
+}
+
+void RpcEndpoint::FinishHandler() {
+  // Counted down on the strand so WaitForHandlers() cannot return while the
+  // handler still touches the endpoint
+  asio::post(endpoint_strand_, [this] {
+    if (--active_handlers_ == 0 || waiting_for_handler_slot_) {
+      state_changed_.cancel();
+    }
+  });
+}
+
+auto RpcEndpoint::WaitBeforeRetry(std::chrono::milliseconds delay)
+    -> asio::awaitable<void> {
+  co_await utils::SwitchTo(endpoint_strand_);
+  // Shutdown() cancels the timer on this strand after clearing is_running_
+  if (!is_running_) {
+    co_return;
+  }
+  retry_timer_.expires_after(delay);
+  std::error_code ec;
+  co_await retry_timer_.async_wait(asio::redirect_error(
+      asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+}
+
+auto RpcEndpoint::WaitForHandlers() -> asio::awaitable<void> {
+  co_await utils::SwitchTo(endpoint_strand_);
+  while (active_handlers_ > 0) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+  }
+}
+
 auto RpcEndpoint::SendMethodCall(
     std::string method, std::optional<nlohmann::json> params)
     -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), DefaultDeadline());
+}
+
+auto RpcEndpoint::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    Clock::time_point deadline)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), deadline);
+}
+
+auto RpcEndpoint::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    std::chrono::milliseconds timeout)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), Clock::now() + timeout);
+}
+
+auto RpcEndpoint::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    transport::MessagePriority priority)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), DefaultDeadline(), priority);
+}
+
+auto RpcEndpoint::DefaultDeadline() const -> std::optional<Clock::time_point> {
+  if (!options_.request_timeout) {
+    return std::nullopt;
+  }
+  return Clock::now() + *options_.request_timeout;
+}
+
+auto RpcEndpoint::SendMethodCallImpl(
+    std::string method, std::optional<nlohmann::json> params,
+    std::optional<Clock::time_point> deadline,
+    transport::MessagePriority priority)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  auto call = BeginCall(deadline);
+  if (!call) {
+    co_return std::unexpected(call.error());
+  }
+  auto [request_id, pending_request] = std::move(*call);
+
+  Request request(method, std::move(params), request_id);
+  const auto encoding = RequestEncoding();
+  co_return co_await FinishCall(
+      request_id, std::move(pending_request), request.Encode(encoding),
+      encoding, priority);
+}
+
+auto RpcEndpoint::SendStreamingMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    PartialResultHandler on_partial)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  if (params && !params->is_object()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientSerializationError,
+        "Streaming calls need object params");
+  }
+  auto call = BeginCall(DefaultDeadline());
+  if (!call) {
+    co_return std::unexpected(call.error());
+  }
+  auto [request_id, pending_request] = std::move(*call);
+
+  // The call's own id is the token, unique while the call is outstanding
+  co_await utils::SwitchTo(endpoint_strand_);
+  partial_results_.insert_or_assign(request_id, std::move(on_partial));
+  streaming_calls_.store(partial_results_.size(), std::memory_order_release);
+  auto token_params = std::move(params).value_or(nlohmann::json::object());
+  token_params[kPartialResultTokenKey] = request_id;
+
+  Request request(method, std::move(token_params), request_id);
+  const auto encoding = RequestEncoding();
+  auto result = co_await FinishCall(
+      request_id, std::move(pending_request), request.Encode(encoding),
+      encoding);
+  co_await utils::SwitchTo(endpoint_strand_);
+  partial_results_.erase(request_id);
+  streaming_calls_.store(partial_results_.size(), std::memory_order_release);
+  co_return result;
+}
+
+auto RpcEndpoint::BeginCall(std::optional<Clock::time_point> deadline)
+    -> std::expected<std::pair<int64_t, std::shared_ptr<PendingRequest>>,
+                     RpcError> {
+  if (!is_running_) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "RPC endpoint is not running");
+  }
+
+  // Registered before sending, so the response cannot arrive first
+  auto call = RegisterCall(deadline);
+  if (!call) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "Too many outstanding requests");
+  }
+  return std::move(*call);
+}
+
+auto RpcEndpoint::FinishCall(
+    int64_t request_id, std::shared_ptr<PendingRequest> pending_request,
+    std::string message, transport::MessageEncoding encoding,
+    transport::MessagePriority priority)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint sending message: {}",
+      std::string_view(message).substr(0, 70));
+  transport::SendHints hints{.priority = priority};
+  auto send_result = co_await Transmit(
+      std::move(message), encoding, request_id, std::move(hints));
+  if (!send_result) {
+    TakeCall(request_id);
+    co_return std::unexpected(send_result.error());
+  }
+
+  auto completion = co_await pending_request->GetResult();
+  if (!pending_request->IsReady()) {
+    // The caller's coroutine was cancelled while it waited
+    TakeCall(request_id);
+    SendCancelRequest(request_id);
+    co_return RpcError::UnexpectedFromCode(RpcErrorCode::kRequestCancelled);
+  }
+  co_return ToResult(*pending_request, std::move(completion));
+}
+
+auto RpcEndpoint::RegisterCall(std::optional<Clock::time_point> deadline)
+    -> std::optional<std::pair<int64_t, std::shared_ptr<PendingRequest>>> {
+  auto pending_request = pending_requests_.Create(executor_);
+  if (deadline) {
+    pending_request->SetHasDeadline();
+  }
+  auto request_id = pending_requests_.Insert(pending_request);
+  if (!request_id) {
+    return std::nullopt;
+  }
+  // Shutdown() clears is_running_ before CancelAll() scans the table, so a
+  // call published behind the scan sees the flag here and cancels itself;
+  // the fences keep either side from missing the other's write
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!is_running_) {
+    if (auto request = pending_requests_.Take(*request_id)) {
+      request->Cancel(-32603, "RPC endpoint shutting down");
+    }
+  } else if (deadline) {
+    asio::post(endpoint_strand_, [this, id = *request_id, deadline] {
+      timeout_wheel_.Schedule(id, *deadline);
+    });
+  }
+  return std::pair{*request_id, std::move(pending_request)};
+}
+
+auto RpcEndpoint::TakeCall(int64_t id) -> std::shared_ptr<PendingRequest> {
+  auto request = pending_requests_.Take(id);
+  if (request && request->HasDeadline()) {
+    // Otherwise the wheel keeps ticking until the deadline of a call that
+    // is long done
+    asio::post(endpoint_strand_, [this, id] { timeout_wheel_.Cancel(id); });
+  }
+  return request;
+}
+
+auto RpcEndpoint::ToResult(
+    const PendingRequest &request, nlohmann::json completion)
+    -> std::expected<nlohmann::json, RpcError> {
+  if (auto err = completion.find("error"); err != completion.end()) {
+    // Local failures such as timeouts keep their own error code
+    auto code = request.HasError()
+                    ? static_cast<RpcErrorCode>((*err)["code"].get<int>())
+                    : RpcErrorCode::kClientError;
+    return RpcError::UnexpectedFromCode(
+        code, (*err)["message"].get_ref<const std::string &>());
+  }
+
+  return std::move(completion["result"]);
+}
+
+auto RpcEndpoint::SendBatch(
+    std::vector<BatchEntry> entries, std::optional<Clock::time_point> deadline)
+    -> asio::awaitable<std::expected<
+        std::vector<std::expected<nlohmann::json, RpcError>>, RpcError>> {
   if (!is_running_) {
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kClientError, "RPC endpoint is not running");
   }
+  if (entries.empty()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "Batch must not be empty");
+  }
+  if (!deadline) {
+    deadline = DefaultDeadline();
+  }
 
-  auto request_id = GetNextRequestId();
-  Request request(method, std::move(params), request_id);
-  std::string message = request.ToJson().dump();
+  // Null entries stand for notifications
+  std::vector<std::shared_ptr<PendingRequest>> calls(entries.size());
+  std::vector<int64_t> call_ids;
+  const auto encoding = encoding_.load();
+  const bool json = encoding == transport::MessageEncoding::kJson;
+  std::string batch;
+  if (json) {
+    batch = "[";
+  } else {
+    AppendBinaryArray(batch, entries.size(), encoding);
+  }
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    auto &entry = entries[i];
+    if (i > 0 && json) {
+      batch += ',';
+    }
+    if (entry.is_notification) {
+      batch += Request(std::move(entry.method), std::move(entry.params))
+                   .Encode(encoding);
+      continue;
+    }
+
+    auto call = RegisterCall(deadline);
+    if (!call) {
+      for (auto id : call_ids) {
+        TakeCall(id);
+      }
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kClientError, "Too many outstanding requests");
+    }
+    call_ids.push_back(call->first);
+    calls[i] = std::move(call->second);
+    batch +=
+        Request(std::move(entry.method), std::move(entry.params), call->first)
+            .Encode(encoding);
+  }
+  if (json) {
+    batch += ']';
+  }
+
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint sending batch of {}", entries.size());
+  TouchActivity();
+  auto send_result = co_await SendToTransport(std::move(batch), encoding);
+  if (!send_result) {
+    for (auto id : call_ids) {
+      TakeCall(id);
+    }
+    co_return std::unexpected(send_result.error());
+  }
+
+  std::vector<std::expected<nlohmann::json, RpcError>> results;
+  results.reserve(calls.size());
+  for (auto &call : calls) {
+    if (!call) {
+      results.emplace_back(nullptr);
+      continue;
+    }
+    results.push_back(ToResult(*call, co_await call->GetResult()));
+  }
+  co_return results;
+}
+
+auto RpcEndpoint::Transmit(
+    std::string message, transport::MessageEncoding encoding,
+    std::optional<int64_t> id, transport::SendHints hints)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  TouchActivity();
+  // A batch frame goes out as one message, so bulk and replaceable ones are
+  // kept out of it
+  if (!options_.auto_batch.enabled ||
+      hints.priority == transport::MessagePriority::kBulk ||
+      !hints.replace_key.empty() ||
+      encoding != transport::MessageEncoding::kJson) {
+    co_return co_await SendToTransport(
+        std::move(message), encoding, std::move(hints));
+  }
+  co_await EnqueueForBatch(std::move(message), id);
+  co_return Ok();
+}
+
+auto RpcEndpoint::EnqueueForBatch(
+    std::string message, std::optional<int64_t> id) -> asio::awaitable<void> {
+  co_await utils::SwitchTo(endpoint_strand_);
+  batch_messages_.push_back(std::move(message));
+  if (id) {
+    batch_call_ids_.push_back(*id);
+  }
 
-  Logger()->debug("RpcEndpoint sending message: {}", message.substr(0, 70));
-  auto pending_request = std::make_shared<PendingRequest>(endpoint_strand_);
-  asio::post(endpoint_strand_, [this, request_id, pending_request] {
-    pending_requests_[request_id] = pending_request;
+  if (batch_messages_.size() >=
+      std::max<std::size_t>(options_.auto_batch.max_entries, 1)) {
+    co_await FlushBatch();
+    co_return;
+  }
+  if (batch_timer_armed_) {
+    co_return;
+  }
+
+  batch_timer_armed_ = true;
+  batch_timer_.expires_after(options_.auto_batch.window);
+  batch_timer_.async_wait([this](std::error_code ec) {
+    // Cancelled by a full batch or Shutdown(); the endpoint may be gone
+    if (ec) {
+      return;
+    }
+    // Counted as a handler so WaitForHandlers() covers the send
+    ++active_handlers_;
+    asio::co_spawn(
+        endpoint_strand_,
+        [this]() -> asio::awaitable<void> {
+          co_await FlushBatch();
+          FinishHandler();
+        },
+        asio::detached);
   });
+}
+
+auto RpcEndpoint::FlushBatch() -> asio::awaitable<void> {
+  batch_timer_armed_ = false;
+  batch_timer_.cancel();
+  if (batch_messages_.empty()) {
+    co_return;
+  }
+
+  auto messages = std::exchange(batch_messages_, {});
+  auto call_ids = std::exchange(batch_call_ids_, {});
 
-  // FIX: Ensure the request is registered before sending to avoid race
-  // condition
-  co_await asio::post(endpoint_strand_, asio::use_awaitable);
+  // The entries are already serialized, so join them instead of building
+  // a JSON array; a lone entry goes out unwrapped
+  std::string frame;
+  if (messages.size() == 1) {
+    frame = std::move(messages.front());
+  } else {
+    std::size_t size = messages.size() + 1;
+    for (const auto &message : messages) {
+      size += message.size();
+    }
+    frame.reserve(size);
+    frame += '[';
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+      if (i > 0) {
+        frame += ',';
+      }
+      frame += messages[i];
+    }
+    frame += ']';
+  }
 
-  auto send_result = co_await transport_->SendMessage(message);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint flushing batch of {}", messages.size());
+  auto send_result = co_await SendToTransport(std::move(frame));
   if (!send_result) {
-    co_return std::unexpected(send_result.error());
+    // The callers are waiting on their results, so fail those instead
+    JSONRPC_LOG_ERROR(
+        Logger(), "RpcEndpoint failed to send batch: {}",
+        send_result.error().Message());
+    for (auto id : call_ids) {
+      if (auto request = TakeCall(id)) {
+        request->Cancel(
+            static_cast<int>(send_result.error().Code()),
+            send_result.error().Message());
+      }
+    }
   }
+}
 
-  auto result = co_await pending_request->GetResult();
-  if (result.contains("error")) {
-    auto err = result["error"];
-    co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientError, err["message"].get<std::string>());
+void RpcEndpoint::ExpireRequest(int64_t id) {
+  auto request = pending_requests_.Take(id);
+  if (!request) {
+    // Already answered
+    return;
   }
 
-  co_return result["result"];
+  JSONRPC_LOG_DEBUG(Logger(), "RpcEndpoint request {} timed out", id);
+  request->Cancel(
+      static_cast<int>(RpcErrorCode::kTimeoutError), "Request timed out");
+  SendCancelRequest(id);
+}
+
+void RpcEndpoint::SendCancelRequest(int64_t id) {
+  const auto &method = dispatcher_->CancelMethod();
+  if (method.empty() || !is_running_) {
+    return;
+  }
+  nlohmann::json params = {{"id", id}};
+  auto message = Request(method, std::move(params)).Dump();
+
+  // Counted as a handler so WaitForHandlers() covers the send
+  ++active_handlers_;
+  asio::co_spawn(
+      endpoint_strand_,
+      [this, message = std::move(message)]() mutable
+          -> asio::awaitable<void> {
+        auto send_result = co_await Transmit(
+            std::move(message), transport::MessageEncoding::kJson,
+            std::nullopt);
+        if (!send_result) {
+          JSONRPC_LOG_DEBUG(
+              Logger(), "RpcEndpoint failed to send cancel request: {}",
+              send_result.error().Message());
+        }
+        FinishHandler();
+      },
+      asio::detached);
 }
 
 auto RpcEndpoint::SendNotification(
     std::string method, std::optional<nlohmann::json> params)
     -> asio::awaitable<std::expected<void, RpcError>> {
-  Logger()->debug("RpcEndpoint sending notification: {}", method);
-  if (!is_running_) {
-    co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientError, "RpcEndpoint is not running");
-  }
+  JSONRPC_LOG_DEBUG(Logger(), "RpcEndpoint sending notification: {}", method);
+  Request request(method, std::move(params));
+  const auto encoding = RequestEncoding();
+  co_return co_await SendEncodedNotification(
+      request.Encode(encoding), encoding, NotificationHints(method));
+}
 
+auto RpcEndpoint::SendNotification(
+    std::string method, std::optional<nlohmann::json> params,
+    transport::MessagePriority priority)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  JSONRPC_LOG_DEBUG(Logger(), "RpcEndpoint sending notification: {}", method);
   Request request(method, std::move(params));
-  std::string message = request.ToJson().dump();
+  const auto encoding = RequestEncoding();
+  co_return co_await SendEncodedNotification(
+      request.Encode(encoding), encoding, NotificationHints(method, priority));
+}
 
-  Logger()->debug("RpcEndpoint sending message: {}", message.substr(0, 70));
-  auto send_result = co_await transport_->SendMessage(message);
-  if (!send_result) {
-    co_return send_result;
+auto RpcEndpoint::NotificationHints(
+    std::string_view method, transport::MessagePriority priority) const
+    -> transport::SendHints {
+  transport::SendHints hints{.priority = priority};
+  if (std::ranges::find(options_.latest_wins_notifications, method) !=
+      options_.latest_wins_notifications.end()) {
+    hints.replace_key = method;
   }
+  return hints;
+}
 
-  co_return std::expected<void, RpcError>{};
+auto RpcEndpoint::SendEncodedNotification(
+    std::string message, transport::MessageEncoding encoding,
+    transport::SendHints hints)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  if (!is_running_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "RpcEndpoint is not running");
+  }
+
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint sending message: {}",
+      std::string_view(message).substr(0, 70));
+  co_return co_await Transmit(
+      std::move(message), encoding, std::nullopt, std::move(hints));
 }
 
 void RpcEndpoint::RegisterMethodCall(
-    std::string method, typename Dispatcher::MethodCallHandler handler) {
-  dispatcher_.RegisterMethodCall(method, handler);
+    std::string method, typename Dispatcher::MethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterMethodCall(method, handler, options);
 }
 
 void RpcEndpoint::RegisterNotification(
-    std::string method, typename Dispatcher::NotificationHandler handler) {
-  dispatcher_.RegisterNotification(method, handler);
+    std::string method, typename Dispatcher::NotificationHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterNotification(method, handler, options);
+}
+
+void RpcEndpoint::RegisterLazyMethodCall(
+    std::string method, typename Dispatcher::LazyMethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterLazyMethodCall(method, std::move(handler), options);
+}
+
+void RpcEndpoint::RegisterLazyNotification(
+    std::string method, typename Dispatcher::LazyNotificationHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterLazyNotification(method, std::move(handler), options);
+}
+
+void RpcEndpoint::RegisterStreamingMethodCall(
+    std::string method, typename Dispatcher::StreamingMethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterStreamingMethodCall(method, std::move(handler), options);
 }
 
 auto RpcEndpoint::HasPendingRequests() const -> bool {
-  // This is safe to call without a strand because we're just checking if empty
-  return !pending_requests_.empty();
+  return !pending_requests_.Empty();
 }
 
-void RpcEndpoint::StartMessageProcessing() {
-  Logger()->debug("RpcEndpoint starting message processing");
-  message_loop_ = asio::co_spawn(
-      endpoint_strand_,
-      [this] {
-        Logger()->debug(
-            "RpcEndpoint starting message processing, is_running_: {}",
-            is_running_.load());
-        return this->ProcessMessagesLoop(cancel_signal_.slot());
-      },
-      asio::use_awaitable);
+auto RpcEndpoint::LastActivity() const -> Clock::time_point {
+  return Clock::time_point(
+      Clock::duration(last_activity_.load(std::memory_order_relaxed)));
 }
 
-namespace {
-auto RetryDelay(asio::any_io_executor exec) -> asio::awaitable<void> {
-  asio::steady_timer timer(exec, std::chrono::milliseconds(100));
-  co_await timer.async_wait(asio::use_awaitable);
+auto RpcEndpoint::GetMetrics() -> asio::awaitable<EndpointMetrics> {
+  EndpointMetrics metrics;
+  metrics.messages_received = messages_received_.load();
+  metrics.messages_sent = messages_sent_.load();
+  metrics.bytes_received = bytes_received_.load();
+  metrics.bytes_sent = bytes_sent_.load();
+  metrics.framing_errors = transport_->FramingErrorCount();
+  metrics.receive_errors = GetReceiveErrorStats();
+  metrics.pending_requests = pending_requests_.Size();
+  metrics.active_handlers = active_handlers_.load();
+  metrics.spilled_handlers = spilled_handlers_.load();
+  metrics.dispatcher = dispatcher_->GetMetrics();
+  metrics.send_queue = co_await transport_->GetSendQueueStats();
+  co_return metrics;
 }
-}  // namespace
 
-auto RpcEndpoint::ProcessMessagesLoop(asio::cancellation_slot slot)
-    -> asio::awaitable<void> {
-  auto state = co_await asio::this_coro::cancellation_state;
+auto RpcEndpoint::ExportMetricsLoop() -> asio::awaitable<void> {
+  while (is_running_) {
+    metrics_timer_.expires_after(options_.metrics_interval);
+    std::error_code ec;
+    co_await metrics_timer_.async_wait(asio::redirect_error(
+        asio::bind_executor(endpoint_strand_, asio::use_awaitable), ec));
+    if (!is_running_) {
+      break;
+    }
+    auto metrics = co_await GetMetrics();
+    // The send queue stats resume on the transport's strand
+    co_await utils::SwitchTo(endpoint_strand_);
+    options_.metrics_exporter(metrics);
+  }
+}
+
+void RpcEndpoint::TouchActivity() {
+  last_activity_.store(
+      Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void RpcEndpoint::StartMessageProcessing() {
+  JSONRPC_LOG_DEBUG(Logger(), "RpcEndpoint starting message processing");
+  // Spawned eagerly; an awaitable from co_spawn would only start once awaited
+  asio::co_spawn(
+      endpoint_strand_, ProcessMessagesLoop(),
+      asio::bind_executor(endpoint_strand_, [this](std::exception_ptr eptr) {
+        if (eptr) {
+          JSONRPC_LOG_ERROR(Logger(), "RpcEndpoint message loop failed");
+        }
+        loop_finished_ = true;
+        state_changed_.cancel();
+      }));
+}
 
-  while (is_running_ && !state.cancelled()) {
+auto RpcEndpoint::ProcessMessagesLoop() -> asio::awaitable<void> {
+  auto retry_delay = options_.receive_retry_delay;
+  while (is_running_) {
+    co_await WaitForHandlerSlot();
+    if (!is_running_) {
+      break;
+    }
     auto message_result = co_await transport_->ReceiveMessage();
     if (!message_result) {
-      Logger()->error("Receive error: {}", message_result.error().Message());
-      co_await RetryDelay(executor_);
+      if (!is_running_) {
+        break;  // Closed by Shutdown()
+      }
+      // A transport that lost its peer will fail every later receive too
+      if (!transport_->IsConnected()) {
+        ++terminal_receive_errors_;
+        JSONRPC_LOG_DEBUG(
+            Logger(), "RpcEndpoint peer disconnected: {}",
+            message_result.error().Message());
+        pending_requests_.CancelAll(
+            static_cast<int>(RpcErrorCode::kTransportError),
+            "Connection closed by peer");
+        break;
+      }
+      ++transient_receive_errors_;
+      JSONRPC_LOG_ERROR(
+          Logger(), "Receive error, retrying in {} ms: {}", retry_delay.count(),
+          message_result.error().Message());
+      co_await WaitBeforeRetry(retry_delay);
+      retry_delay = std::min(2 * retry_delay, options_.max_receive_retry_delay);
+      continue;
+    }
+    retry_delay = options_.receive_retry_delay;
+    TouchActivity();
+    const auto received_at = Clock::now();
+    messages_received_.fetch_add(1, std::memory_order_relaxed);
+    bytes_received_.fetch_add(
+        message_result->size(), std::memory_order_relaxed);
+
+    JSONRPC_LOG_DEBUG(
+        Logger(), "RpcEndpoint handling message: {}",
+        std::string_view(*message_result).substr(0, 70));
+    const auto encoding = transport_->LastReceivedEncoding();
+    const bool json = encoding == transport::MessageEncoding::kJson;
+    const bool capture = Captures(CaptureDirection::kIncoming);
+    if (capture && json) {
+      options_.capture->Record(
+          CaptureDirection::kIncoming, peer_id_, *message_result);
+    }
+    auto message = json && dispatcher_->HasLazyHandlers()
+                       ? ParseJsonWithLazyParams(
+                             *message_result,
+                             [this](std::string_view method) {
+                               return dispatcher_->WantsLazyParams(method);
+                             })
+                       : DecodeMessage(*message_result, encoding);
+    // The DOM owns its data, so the next receive can reuse the text's storage
+    transport_->RecycleMessage(std::move(*message_result));
+    if (message.is_discarded()) {
+      JSONRPC_LOG_ERROR(Logger(), "Handle error: Failed to parse message");
       continue;
     }
+    // Binary messages are recorded as JSON, written from the one decode
+    if (capture && !json) {
+      options_.capture->Record(
+          CaptureDirection::kIncoming, peer_id_, message.dump());
+    }
+    if (streaming_calls_.load(std::memory_order_acquire) > 0) {
+      // The receive may have resumed on the transport's strand, and the
+      // callbacks are promised the endpoint's
+      co_await utils::SwitchTo(endpoint_strand_);
+      if (HandlePartialResult(message)) {
+        continue;
+      }
+    }
 
-    // Spawn message handling concurrently (don't block the read loop)
+    // Only parsing happens on this loop. Handlers run on the dispatcher's
+    // executors, and serial methods are queued onto their strand here so
+    // they keep the receive order.
+    auto executor = dispatcher_->ExecutorFor(message);
+    const bool pinned = PinsHandler(executor);
+    if (pinned) {
+      executor = executor_;
+    }
+    ++active_handlers_;
     asio::co_spawn(
-        executor_,
-        [this, message = *message_result]() -> asio::awaitable<void> {
-          auto handle_result = co_await HandleMessage(message);
+        executor,
+        [this, message = std::move(message), received_at,
+         pinned]() mutable -> asio::awaitable<void> {
+          auto handle_result = co_await HandleMessage(
+              std::move(message), received_at,
+              pinned ? std::optional(executor_) : std::nullopt);
           if (!handle_result) {
-            Logger()->error(
-                "Handle error: {}", handle_result.error().Message());
+            JSONRPC_LOG_ERROR(
+                Logger(), "Handle error: {}", handle_result.error().Message());
           }
-          co_return;
+          if (pinned) {
+            handler_load_->fetch_sub(1, std::memory_order_relaxed);
+          }
+          FinishHandler();
         },
         asio::detached);
   }
@@ -232,67 +905,293 @@ auto IsResponse(const nlohmann::json &msg) -> bool {
   return msg.contains("id") &&
          (msg.contains("result") || msg.contains("error"));
 }
+
+// The members ToResult() reads: exactly one of result and error, and an
+// error with a code and a message
+auto HasValidOutcome(const nlohmann::json &msg) -> bool {
+  const auto result = msg.find("result");
+  const auto error = msg.find("error");
+  if ((result == msg.end()) == (error == msg.end())) {
+    return false;
+  }
+  if (error == msg.end()) {
+    return true;
+  }
+  if (!error->is_object()) {
+    return false;
+  }
+  const auto code = error->find("code");
+  const auto message = error->find("message");
+  return code != error->end() && code->is_number_integer() &&
+         message != error->end() && message->is_string();
+}
+
+// Our calls carry integer IDs; peers that echo them as strings still match
+auto ParseResponseId(const nlohmann::json &id) -> std::optional<int64_t> {
+  if (id.is_number_integer()) {
+    return id.get<int64_t>();
+  }
+  if (!id.is_string()) {
+    return std::nullopt;
+  }
+  const auto &text = id.get_ref<const std::string &>();
+  int64_t value = 0;
+  const auto *end = text.data() + text.size();
+  auto [parsed_end, ec] = std::from_chars(text.data(), end, value);
+  if (ec != std::errc{} || parsed_end != end) {
+    return std::nullopt;
+  }
+  return value;
+}
 }  // namespace
 
-auto RpcEndpoint::HandleMessage(std::string message)
-    -> asio::awaitable<std::expected<void, RpcError>> {
-  Logger()->debug("RpcEndpoint handling message: {}", message.substr(0, 70));
-  const auto json_message_result =
-      nlohmann::json::parse(message, nullptr, false);
-  if (json_message_result.is_discarded()) {
-    co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientError, "Failed to parse message");
+auto RpcEndpoint::PinsHandler(const asio::any_io_executor &executor)
+    -> bool {
+  const auto &affinity = options_.handler_affinity;
+  // Serial methods map to their strand, which keeps them in order
+  if (!affinity.enabled || executor != dispatcher_->GetExecutor()) {
+    return false;
+  }
+  const auto load = handler_load_->fetch_add(1, std::memory_order_relaxed);
+  if (affinity.spill_threshold > 0 && load >= affinity.spill_threshold) {
+    handler_load_->fetch_sub(1, std::memory_order_relaxed);
+    spilled_handlers_.fetch_add(1, std::memory_order_relaxed);
+    return false;
   }
-  const auto &json_message = json_message_result;
+  return true;
+}
 
-  if (IsResponse(json_message)) {
-    auto response = Response::FromJson(json_message);
-    if (!response.has_value()) {
-      co_return RpcError::UnexpectedFromCode(
-          RpcErrorCode::kClientError, "Invalid response");
+auto RpcEndpoint::HandleMessage(
+    nlohmann::json message, Clock::time_point received_at,
+    std::optional<asio::any_io_executor> handler_executor)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  // Answer to a batch we sent; an array of requests goes to the dispatcher
+  if (message.is_array() && !message.empty() &&
+      std::ranges::all_of(message, IsResponse)) {
+    std::expected<void, RpcError> first_error;
+    for (auto &element : message) {
+      auto handled = co_await HandleResponse(std::move(element));
+      if (!handled && first_error) {
+        first_error = std::move(handled);
+      }
     }
-    co_return co_await HandleResponse(std::move(response.value()));
+    co_return first_error;
+  }
+
+  if (IsResponse(message)) {
+    co_return co_await HandleResponse(std::move(message));
   }
 
-  if (auto response = co_await dispatcher_.DispatchRequest(message)) {
-    co_return co_await transport_->SendMessage(*response);
+  if (message.is_object() && message.contains("id") &&
+      message.contains("method") && message["method"].is_string() &&
+      message["method"].get_ref<const std::string &>() ==
+          kNegotiateEncodingMethod) {
+    co_return co_await HandleNegotiateEncoding(message);
+  }
+
+  const auto priority = dispatcher_->PriorityFor(message);
+  const auto encoding = encoding_.load();
+  auto response = co_await dispatcher_->DispatchJson(
+      std::move(message), peer_id_, received_at,
+      [this, priority](std::string part) {
+        return SendToTransport(
+            std::move(part), transport::SendHints{.priority = priority});
+      },
+      std::move(handler_executor), encoding);
+  if (response) {
+    transport::SendHints hints{.priority = priority};
+    co_return co_await SendToTransport(
+        std::move(*response), encoding, std::move(hints));
   }
 
   co_return std::expected<void, RpcError>{};
 }
 
-auto RpcEndpoint::HandleResponse(Response response)
-    -> asio::awaitable<std::expected<void, RpcError>> {
-  auto id_opt = response.GetId();
-  if (!id_opt || !std::holds_alternative<int64_t>(*id_opt)) {
+auto RpcEndpoint::NegotiateEncoding()
+    -> asio::awaitable<std::expected<transport::MessageEncoding, RpcError>> {
+  auto offered = nlohmann::json::array();
+  for (auto encoding : options_.encodings) {
+    if (encoding != transport::MessageEncoding::kJson &&
+        transport_->SupportsEncoding(encoding)) {
+      offered.push_back(transport::EncodingName(encoding));
+    }
+  }
+  if (offered.empty()) {
+    co_return transport::MessageEncoding::kJson;
+  }
+  offered.push_back(transport::EncodingName(transport::MessageEncoding::kJson));
+
+  const nlohmann::json params = {{"encodings", offered}};
+  auto result = co_await SendMethodCall(
+      std::string(kNegotiateEncodingMethod), params);
+  if (!result) {
+    co_return std::unexpected(result.error());
+  }
+
+  std::optional<transport::MessageEncoding> chosen;
+  if (result->is_object() && result->contains("encoding") &&
+      (*result)["encoding"].is_string()) {
+    const auto name = (*result)["encoding"].get<std::string>();
+    if (std::ranges::find(offered, nlohmann::json(name)) != offered.end()) {
+      chosen = transport::EncodingFromName(name);
+    }
+  }
+  if (!chosen) {
     co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientError, "Response ID missing or not int64");
+        RpcErrorCode::kClientError, "Peer chose an encoding we did not offer");
   }
 
-  const auto id = std::get<int64_t>(*id_opt);
+  encoding_ = *chosen;
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint negotiated {} encoding",
+      transport::EncodingName(*chosen));
+  co_return *chosen;
+}
 
-  std::shared_ptr<PendingRequest> request;
-  bool found = false;
+auto RpcEndpoint::HandleNegotiateEncoding(const nlohmann::json &message)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  std::vector<std::string> offered;
+  const auto params = message.value("params", nlohmann::json::object());
+  if (params.is_object() && params.contains("encodings") &&
+      params["encodings"].is_array()) {
+    for (const auto &name : params["encodings"]) {
+      if (name.is_string()) {
+        offered.push_back(name.get<std::string>());
+      }
+    }
+  }
 
-  asio::post(endpoint_strand_, [this, id, &request, &found] {
-    auto it = pending_requests_.find(id);
-    if (it != pending_requests_.end()) {
-      request = it->second;
-      pending_requests_.erase(it);
-      found = true;
+  // Our preference wins among the encodings both sides can handle
+  auto chosen = transport::MessageEncoding::kJson;
+  for (auto encoding : options_.encodings) {
+    const auto name = std::string(transport::EncodingName(encoding));
+    if (transport_->SupportsEncoding(encoding) &&
+        std::ranges::find(offered, name) != offered.end()) {
+      chosen = encoding;
+      break;
     }
-  });
+  }
+
+  const nlohmann::json result = {
+      {"encoding", transport::EncodingName(chosen)}};
+  std::optional<RequestId> id;
+  if (message["id"].is_number_integer()) {
+    id = message["id"].get<int64_t>();
+  } else if (message["id"].is_string()) {
+    id = message["id"].get<std::string>();
+  }
+
+  // The answer still goes out in the old encoding, so the peer can read it
+  auto send_result =
+      co_await SendToTransport(Response::CreateSuccess(result, id).Dump());
+  if (!send_result) {
+    co_return send_result;
+  }
+  encoding_ = chosen;
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcEndpoint switched to {} encoding",
+      transport::EncodingName(chosen));
+  co_return Ok();
+}
 
-  co_await asio::post(endpoint_strand_, asio::use_awaitable);
+auto RpcEndpoint::SendToTransport(
+    std::string message, transport::SendHints hints)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  co_return co_await SendToTransport(
+      std::move(message), transport::MessageEncoding::kJson, std::move(hints));
+}
 
-  if (!found || !request) {
+auto RpcEndpoint::SendToTransport(
+    std::string message, transport::MessageEncoding encoding,
+    transport::SendHints hints)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  const bool json = encoding == transport::MessageEncoding::kJson;
+  if (Captures(CaptureDirection::kOutgoing)) {
+    options_.capture->Record(
+        CaptureDirection::kOutgoing, peer_id_,
+        json ? message : DecodeMessage(message, encoding).dump());
+  }
+  // Only text without a DOM, such as typed calls and streamed parts, takes
+  // the detour through a parse
+  const auto negotiated = encoding_.load();
+  if (json && negotiated != transport::MessageEncoding::kJson) {
+    message = EncodeMessage(ParseJson(message), negotiated);
+    encoding = negotiated;
+  }
+  const auto size = message.size();
+  auto sent = co_await transport_->SendMessageWithHints(
+      std::move(message), encoding, std::move(hints));
+  if (sent) {
+    messages_sent_.fetch_add(1, std::memory_order_relaxed);
+    bytes_sent_.fetch_add(size, std::memory_order_relaxed);
+  }
+  co_return sent;
+}
+
+auto RpcEndpoint::RequestEncoding() const -> transport::MessageEncoding {
+  return options_.auto_batch.enabled ? transport::MessageEncoding::kJson
+                                     : encoding_.load();
+}
+
+auto RpcEndpoint::HandlePartialResult(nlohmann::json &message) -> bool {
+  if (!message.is_object() || message.contains("id")) {
+    return false;
+  }
+  auto method = message.find("method");
+  auto params = message.find("params");
+  if (method == message.end() || *method != kProgressMethod ||
+      params == message.end() || !params->is_object()) {
+    return false;
+  }
+  auto token = params->find("token");
+  auto value = params->find("value");
+  if (token == params->end() || !token->is_number_integer() ||
+      value == params->end()) {
+    return false;
+  }
+  auto call = partial_results_.find(token->get<int64_t>());
+  if (call == partial_results_.end()) {
+    // Some other progress, such as work done reports, for the handlers
+    return false;
+  }
+  if (call->second) {
+    call->second(std::move(*value));
+  }
+  return true;
+}
+
+auto RpcEndpoint::HandleResponse(nlohmann::json response)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  if (!HasValidOutcome(response)) {
     co_return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kClientError,
-        "Unknown request ID: " + std::to_string(id));
+        RpcErrorCode::kClientError, "Invalid response");
   }
 
-  request->SetResult(response.ToJson());
-  co_return std::expected<void, RpcError>{};
+  const auto &id_json = response["id"];
+  auto id = ParseResponseId(id_json);
+  if (!id) {
+    if (id_json.is_string()) {
+      // Well formed, but not an ID we ever sent
+      JSONRPC_LOG_DEBUG(
+          Logger(), "RpcEndpoint dropping response for unknown ID: {}",
+          id_json.get_ref<const std::string &>());
+      co_return Ok();
+    }
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "Response ID missing or not an integer");
+  }
+
+  auto request = TakeCall(*id);
+  if (!request) {
+    // Late responses to expired requests are expected, drop them quietly
+    JSONRPC_LOG_DEBUG(
+        Logger(), "RpcEndpoint dropping response for unknown ID: {}", *id);
+    co_return Ok();
+  }
+
+  // ToResult() only reads result or error, so the message goes as it is
+  request->SetResult(std::move(response));
+  co_return Ok();
 }
 
 }  // namespace jsonrpc::endpoint
@@ -0,0 +1,129 @@
+#include "jsonrpc/endpoint/envelope.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+
+#include "jsonrpc/endpoint/json_writer.hpp"
+
+namespace jsonrpc::endpoint {
+
+void AppendRequestId(std::string& out, const RequestId& id) {
+  if (const auto* number = std::get_if<int64_t>(&id)) {
+    // Room for the sign and all 19 digits of an int64_t
+    std::array<char, 24> digits{};
+    auto result =
+        std::to_chars(digits.data(), digits.data() + digits.size(), *number);
+    out.append(digits.data(), result.ptr);
+    return;
+  }
+  AppendJsonString(out, std::get<std::string>(id));
+}
+
+namespace {
+
+// CBOR major types, in the top three bits of the initial byte
+constexpr std::uint8_t kCborArray = 4 << 5;
+constexpr std::uint8_t kCborMap = 5 << 5;
+constexpr std::uint8_t kCborText = 3 << 5;
+
+void AppendBigEndian(std::string& out, std::uint64_t value, int bytes) {
+  for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8) {
+    out += static_cast<char>((value >> shift) & 0xff);
+  }
+}
+
+// Initial byte and length argument of a CBOR item
+void AppendCborHeader(std::string& out, std::uint8_t major, std::size_t n) {
+  if (n < 24) {
+    out += static_cast<char>(major | n);
+  } else if (n <= 0xff) {
+    out += static_cast<char>(major | 24);
+    AppendBigEndian(out, n, 1);
+  } else if (n <= 0xffff) {
+    out += static_cast<char>(major | 25);
+    AppendBigEndian(out, n, 2);
+  } else if (n <= 0xffffffff) {
+    out += static_cast<char>(major | 26);
+    AppendBigEndian(out, n, 4);
+  } else {
+    out += static_cast<char>(major | 27);
+    AppendBigEndian(out, n, 8);
+  }
+}
+
+// A MessagePack header: the fix form below fix_limit, else the 8, 16 or 32
+// bit form; tag8 is zero for types without an 8-bit one
+void AppendMsgpackHeader(
+    std::string& out, std::uint8_t fix, std::size_t fix_limit,
+    std::uint8_t tag8, std::uint8_t tag16, std::uint8_t tag32,
+    std::size_t n) {
+  if (n < fix_limit) {
+    out += static_cast<char>(fix | n);
+  } else if (tag8 != 0 && n <= 0xff) {
+    out += static_cast<char>(tag8);
+    AppendBigEndian(out, n, 1);
+  } else if (n <= 0xffff) {
+    out += static_cast<char>(tag16);
+    AppendBigEndian(out, n, 2);
+  } else {
+    out += static_cast<char>(tag32);
+    AppendBigEndian(out, n, 4);
+  }
+}
+
+}  // namespace
+
+void AppendBinaryMap(
+    std::string& out, std::size_t members,
+    transport::MessageEncoding encoding) {
+  if (encoding == transport::MessageEncoding::kCbor) {
+    AppendCborHeader(out, kCborMap, members);
+  } else {
+    AppendMsgpackHeader(out, 0x80, 16, 0, 0xde, 0xdf, members);
+  }
+}
+
+void AppendBinaryArray(
+    std::string& out, std::size_t elements,
+    transport::MessageEncoding encoding) {
+  if (encoding == transport::MessageEncoding::kCbor) {
+    AppendCborHeader(out, kCborArray, elements);
+  } else {
+    AppendMsgpackHeader(out, 0x90, 16, 0, 0xdc, 0xdd, elements);
+  }
+}
+
+void AppendBinaryString(
+    std::string& out, std::string_view value,
+    transport::MessageEncoding encoding) {
+  if (encoding == transport::MessageEncoding::kCbor) {
+    AppendCborHeader(out, kCborText, value.size());
+  } else {
+    AppendMsgpackHeader(out, 0xa0, 32, 0xd9, 0xda, 0xdb, value.size());
+  }
+  out += value;
+}
+
+void AppendBinaryValue(
+    std::string& out, const nlohmann::json& value,
+    transport::MessageEncoding encoding) {
+  // Both encoders append to a string output
+  if (encoding == transport::MessageEncoding::kCbor) {
+    nlohmann::json::to_cbor(value, out);
+  } else {
+    nlohmann::json::to_msgpack(value, out);
+  }
+}
+
+void AppendBinaryRequestId(
+    std::string& out, const RequestId& id,
+    transport::MessageEncoding encoding) {
+  if (const auto* number = std::get_if<int64_t>(&id)) {
+    AppendBinaryValue(out, *number, encoding);
+    return;
+  }
+  AppendBinaryString(out, std::get<std::string>(id), encoding);
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,145 @@
+#include "jsonrpc/endpoint/json_codec.hpp"
+
+#include <cstdint>
+#include <string>
+
+#ifdef JSONRPC_USE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace jsonrpc::endpoint {
+
+#ifdef JSONRPC_USE_SIMDJSON
+
+namespace {
+
+// Reused across messages, so each thread keeps one
+struct OnDemandParser {
+  simdjson::ondemand::parser parser;
+  // The parser reads up to SIMDJSON_PADDING bytes past the text
+  std::string padded;
+};
+
+// Builds the value in a single pass over the text. Works on a document or a
+// value, which share the accessors; either is consumed as it is read.
+template <typename Value>
+auto ToNlohmann(Value& value) -> nlohmann::json {
+  switch (simdjson::ondemand::json_type(value.type())) {
+    case simdjson::ondemand::json_type::object: {
+      auto object = nlohmann::json::object();
+      for (auto field_result : value.get_object()) {
+        simdjson::ondemand::field field = field_result;
+        std::string_view key = field.unescaped_key();
+        // Later duplicates win, as with nlohmann::json::parse
+        object[std::string(key)] = ToNlohmann(field.value());
+      }
+      return object;
+    }
+    case simdjson::ondemand::json_type::array: {
+      auto array = nlohmann::json::array();
+      for (auto element_result : value.get_array()) {
+        simdjson::ondemand::value element = element_result;
+        array.push_back(ToNlohmann(element));
+      }
+      return array;
+    }
+    case simdjson::ondemand::json_type::string: {
+      std::string_view text = value.get_string();
+      return std::string(text);
+    }
+    case simdjson::ondemand::json_type::number:
+      switch (simdjson::ondemand::number_type(value.get_number_type())) {
+        case simdjson::ondemand::number_type::signed_integer:
+          return std::int64_t(value.get_int64());
+        case simdjson::ondemand::number_type::unsigned_integer:
+          return std::uint64_t(value.get_uint64());
+        default:
+          // nlohmann also reads integers past 64 bits as doubles
+          return double(value.get_double());
+      }
+    case simdjson::ondemand::json_type::boolean:
+      return bool(value.get_bool());
+    case simdjson::ondemand::json_type::null:
+      if (bool(value.is_null())) {
+        return nullptr;
+      }
+      break;
+    default:
+      break;
+  }
+  throw simdjson::simdjson_error(simdjson::TAPE_ERROR);
+}
+
+}  // namespace
+
+auto ActiveJsonBackend() -> JsonBackend {
+  return JsonBackend::kSimdjson;
+}
+
+auto ParseJson(std::string_view text) -> nlohmann::json {
+  thread_local OnDemandParser state;
+  state.padded.reserve(text.size() + simdjson::SIMDJSON_PADDING);
+  state.padded.assign(text);
+  const simdjson::padded_string_view input(
+      state.padded.data(), state.padded.size(), state.padded.capacity());
+  try {
+    simdjson::ondemand::document document = state.parser.iterate(input);
+    auto value = ToNlohmann(document);
+    if (!document.at_end()) {
+      return nlohmann::json(nlohmann::json::value_t::discarded);
+    }
+    return value;
+  } catch (const simdjson::simdjson_error&) {
+    // On-demand parsing finds malformed text only as it reaches it
+    return nlohmann::json(nlohmann::json::value_t::discarded);
+  }
+}
+
+#else
+
+auto ActiveJsonBackend() -> JsonBackend {
+  return JsonBackend::kNlohmann;
+}
+
+auto ParseJson(std::string_view text) -> nlohmann::json {
+  return nlohmann::json::parse(text, nullptr, false);
+}
+
+#endif
+
+auto SerializeJson(const nlohmann::json& value) -> std::string {
+  return value.dump();
+}
+
+auto DecodeMessage(std::string_view body, transport::MessageEncoding encoding)
+    -> nlohmann::json {
+  switch (encoding) {
+    case transport::MessageEncoding::kCbor:
+      return nlohmann::json::from_cbor(body, true, false);
+    case transport::MessageEncoding::kMsgpack:
+      return nlohmann::json::from_msgpack(body, true, false);
+    case transport::MessageEncoding::kJson:
+      break;
+  }
+  return ParseJson(body);
+}
+
+auto EncodeMessage(
+    const nlohmann::json& value, transport::MessageEncoding encoding)
+    -> std::string {
+  std::string encoded;
+  switch (encoding) {
+    case transport::MessageEncoding::kCbor:
+      nlohmann::json::to_cbor(value, encoded);
+      break;
+    case transport::MessageEncoding::kMsgpack:
+      nlohmann::json::to_msgpack(value, encoded);
+      break;
+    case transport::MessageEncoding::kJson:
+      encoded = SerializeJson(value);
+      break;
+  }
+  return encoded;
+}
+
+}  // namespace jsonrpc::endpoint
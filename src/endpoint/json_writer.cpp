@@ -0,0 +1,124 @@
+#include "jsonrpc/endpoint/json_writer.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+
+namespace jsonrpc::endpoint {
+
+namespace {
+
+// Leaves room for the longest round-trip form of a double
+constexpr std::size_t kNumberBufferSize = 32;
+
+template <typename T>
+auto AppendNumber(std::string& buffer, T value) -> std::size_t {
+  std::array<char, kNumberBufferSize> chars{};
+  auto result =
+      std::to_chars(chars.data(), chars.data() + chars.size(), value);
+  buffer.append(chars.data(), result.ptr);
+  return static_cast<std::size_t>(result.ptr - chars.data());
+}
+
+}  // namespace
+
+void AppendJson(std::string& out, const nlohmann::json& value) {
+  // What nlohmann::json::dump() does, minus the string it returns
+  nlohmann::detail::serializer<nlohmann::json> serializer(
+      nlohmann::detail::output_adapter<char>(out), ' ');
+  serializer.dump(value, false, false, 0);
+}
+
+void JsonWriter::Null() {
+  Separate();
+  buffer_ += "null";
+  needs_comma_ = true;
+}
+
+void JsonWriter::Value(bool value) {
+  Separate();
+  buffer_ += value ? "true" : "false";
+  needs_comma_ = true;
+}
+
+void JsonWriter::Value(std::int64_t value) {
+  Separate();
+  AppendNumber(buffer_, value);
+  needs_comma_ = true;
+}
+
+void JsonWriter::Value(std::uint64_t value) {
+  Separate();
+  AppendNumber(buffer_, value);
+  needs_comma_ = true;
+}
+
+void JsonWriter::Value(double value) {
+  if (!std::isfinite(value)) {
+    Null();
+    return;
+  }
+  Separate();
+  // Keeps the value a float when read back, as nlohmann::json writes it
+  auto length = AppendNumber(buffer_, value);
+  auto written = std::string_view(buffer_).substr(buffer_.size() - length);
+  if (written.find_first_of(".e") == std::string_view::npos) {
+    buffer_ += ".0";
+  }
+  needs_comma_ = true;
+}
+
+void JsonWriter::Value(const nlohmann::json& value) {
+  Separate();
+  AppendJson(buffer_, value);
+  needs_comma_ = true;
+}
+
+void AppendJsonString(std::string& out, std::string_view value) {
+  static constexpr std::string_view kHex = "0123456789abcdef";
+
+  out.reserve(out.size() + value.size() + 2);
+  out += '"';
+  // Copies runs of plain characters at once and escapes the rest
+  std::size_t run_start = 0;
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    auto c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out.append(value.substr(run_start, i - run_start));
+    run_start = i + 1;
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += "\\u00";
+        out += kHex[c >> 4];
+        out += kHex[c & 0x0F];
+        break;
+    }
+  }
+  out.append(value.substr(run_start));
+  out += '"';
+}
+
+}  // namespace jsonrpc::endpoint
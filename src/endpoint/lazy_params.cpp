@@ -0,0 +1,346 @@
+#include "jsonrpc/endpoint/lazy_params.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "jsonrpc/endpoint/json_codec.hpp"
+
+namespace jsonrpc::endpoint {
+
+using error::RpcError;
+using error::RpcErrorCode;
+
+namespace {
+
+// Walks JSON text one value at a time, checking only what it takes to find
+// where each value ends
+class Scanner {
+ public:
+  explicit Scanner(std::string_view text) : text_(text) {
+  }
+
+  // The next character after whitespace, or '\0' at the end
+  auto Peek() -> char {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+    return pos_ < text_.size() ? text_[pos_] : '\0';
+  }
+
+  auto Consume(char expected) -> bool {
+    if (Peek() != expected) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  // Returns the span of the next value, string quotes included
+  auto SkipValue() -> std::optional<std::string_view> {
+    Peek();
+    const auto start = pos_;
+    if (start >= text_.size()) {
+      return std::nullopt;
+    }
+    const char first = text_[start];
+    bool skipped = false;
+    if (first == '"') {
+      skipped = SkipString();
+    } else if (first == '{' || first == '[') {
+      skipped = SkipContainer();
+    } else {
+      // Numbers and literals end at the next delimiter
+      while (pos_ < text_.size() && !IsDelimiter(text_[pos_])) {
+        ++pos_;
+      }
+      skipped = pos_ > start;
+    }
+    if (!skipped) {
+      return std::nullopt;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+ private:
+  static auto IsDelimiter(char c) -> bool {
+    return c == ',' || c == '}' || c == ']' || c == ':' || c == ' ' ||
+           c == '\t' || c == '\n' || c == '\r';
+  }
+
+  auto SkipString() -> bool {
+    ++pos_;  // Opening quote
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_++];
+      if (c == '\\') {
+        ++pos_;
+      } else if (c == '"') {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Brackets only need to balance; strings are skipped so that brackets
+  // inside them do not count
+  auto SkipContainer() -> bool {
+    std::vector<char> open;
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_];
+      if (c == '"') {
+        if (!SkipString()) {
+          return false;
+        }
+        continue;
+      }
+      ++pos_;
+      if (c == '{' || c == '[') {
+        open.push_back(c == '{' ? '}' : ']');
+      } else if (c == '}' || c == ']') {
+        if (open.empty() || open.back() != c) {
+          return false;
+        }
+        open.pop_back();
+        if (open.empty()) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+};
+
+// Object keys without escapes are compared in place; the rest are decoded
+auto DecodeKey(std::string_view quoted) -> std::optional<std::string> {
+  const auto inner = quoted.substr(1, quoted.size() - 2);
+  if (inner.find('\\') == std::string_view::npos) {
+    return std::string(inner);
+  }
+  auto decoded = nlohmann::json::parse(quoted, nullptr, false);
+  if (!decoded.is_string()) {
+    return std::nullopt;
+  }
+  return decoded.get<std::string>();
+}
+
+// Splits a JSON pointer into its unescaped reference tokens
+auto PointerTokens(std::string_view pointer)
+    -> std::optional<std::vector<std::string>> {
+  std::vector<std::string> tokens;
+  if (pointer.empty()) {
+    return tokens;
+  }
+  if (pointer.front() != '/') {
+    return std::nullopt;
+  }
+  pointer.remove_prefix(1);
+  while (true) {
+    const auto end = pointer.find('/');
+    const auto raw = pointer.substr(0, end);
+    std::string token;
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+      if (raw[i] != '~') {
+        token += raw[i];
+      } else if (
+          i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+        token += raw[++i] == '0' ? '~' : '/';
+      } else {
+        return std::nullopt;
+      }
+    }
+    tokens.push_back(std::move(token));
+    if (end == std::string_view::npos) {
+      return tokens;
+    }
+    pointer.remove_prefix(end + 1);
+  }
+}
+
+// Moves the scanner to the member named token of the object it is at
+auto EnterMember(Scanner& scanner, const std::string& token) -> bool {
+  if (!scanner.Consume('{') || scanner.Consume('}')) {
+    return false;
+  }
+  while (true) {
+    auto key = scanner.Peek() == '"' ? scanner.SkipValue() : std::nullopt;
+    if (!key || !scanner.Consume(':')) {
+      return false;
+    }
+    if (DecodeKey(*key) == token) {
+      return true;
+    }
+    if (!scanner.SkipValue() || !scanner.Consume(',')) {
+      return false;
+    }
+  }
+}
+
+// Moves the scanner to the element at the index token of the array
+auto EnterElement(Scanner& scanner, const std::string& token) -> bool {
+  std::size_t index = 0;
+  const auto* end = token.data() + token.size();
+  auto [parsed_end, ec] = std::from_chars(token.data(), end, index);
+  if (ec != std::errc{} || parsed_end != end || !scanner.Consume('[') ||
+      scanner.Peek() == ']') {
+    return false;
+  }
+  for (std::size_t i = 0; i < index; ++i) {
+    if (!scanner.SkipValue() || !scanner.Consume(',')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto InvalidParams(std::string message) -> std::unexpected<RpcError> {
+  return RpcError::UnexpectedFromCode(
+      RpcErrorCode::kInvalidParams, std::move(message));
+}
+
+}  // namespace
+
+auto FindRawValue(std::string_view text, std::string_view pointer)
+    -> std::optional<std::string_view> {
+  auto tokens = PointerTokens(pointer);
+  if (!tokens) {
+    return std::nullopt;
+  }
+  Scanner scanner(text);
+  for (const auto& token : *tokens) {
+    const char next = scanner.Peek();
+    const bool entered = next == '{'   ? EnterMember(scanner, token)
+                         : next == '[' ? EnterElement(scanner, token)
+                                       : false;
+    if (!entered) {
+      return std::nullopt;
+    }
+  }
+  return scanner.SkipValue();
+}
+
+auto ParseJsonWithLazyParams(
+    std::string_view text,
+    const std::function<bool(std::string_view)>& wants_lazy)
+    -> nlohmann::json {
+  // Members are only recorded while scanning; nothing is parsed unless the
+  // method turns out to want lazy params
+  Scanner scanner(text);
+  if (!scanner.Consume('{') || scanner.Consume('}')) {
+    return ParseJson(text);
+  }
+  std::vector<std::pair<std::string, std::string_view>> members;
+  std::optional<std::string_view> params;
+  bool is_lazy = false;
+  while (true) {
+    auto key = scanner.Peek() == '"' ? scanner.SkipValue() : std::nullopt;
+    if (!key || !scanner.Consume(':')) {
+      return ParseJson(text);
+    }
+    auto value = scanner.SkipValue();
+    if (!value) {
+      return ParseJson(text);
+    }
+    auto name = DecodeKey(*key);
+    if (!name) {
+      return ParseJson(text);
+    }
+    if (name == "params") {
+      params = value;
+    } else {
+      if (name == "method") {
+        auto method = ParseJson(*value);
+        if (!method.is_string() ||
+            !wants_lazy(method.get_ref<const std::string&>())) {
+          return ParseJson(text);
+        }
+        is_lazy = true;
+      }
+      members.emplace_back(std::move(*name), *value);
+    }
+    if (scanner.Consume('}')) {
+      break;
+    }
+    if (!scanner.Consume(',')) {
+      return ParseJson(text);
+    }
+  }
+  if (!is_lazy || scanner.Peek() != '\0') {
+    return ParseJson(text);
+  }
+
+  auto message = nlohmann::json::object();
+  for (auto& [name, value] : members) {
+    auto parsed = ParseJson(value);
+    if (parsed.is_discarded()) {
+      return ParseJson(text);
+    }
+    message[std::move(name)] = std::move(parsed);
+  }
+  if (params) {
+    const char first = params->front();
+    if (first == '{' || first == '[') {
+      message["params"] = nlohmann::json::binary(
+          std::vector<std::uint8_t>(params->begin(), params->end()),
+          kRawParamsSubtype);
+    } else {
+      // Left to request validation, which rejects anything but null
+      message["params"] = ParseJson(*params);
+    }
+  }
+  return message;
+}
+
+auto LazyParams::Raw() const -> std::optional<std::string_view> {
+  if (!params_ || !IsRawParams(*params_)) {
+    return std::nullopt;
+  }
+  const auto& bytes = params_->get_binary();
+  return std::string_view(
+      reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+auto LazyParams::Contains(std::string_view pointer) const -> bool {
+  if (auto raw = Raw()) {
+    return FindRawValue(*raw, pointer).has_value();
+  }
+  if (!HasValue()) {
+    return false;
+  }
+  try {
+    const nlohmann::json::json_pointer json_pointer{std::string(pointer)};
+    return params_->contains(json_pointer);
+  } catch (const nlohmann::json::exception&) {
+    return false;
+  }
+}
+
+auto LazyParams::GetJson(std::string_view pointer) const
+    -> std::expected<nlohmann::json, RpcError> {
+  if (!HasValue()) {
+    return InvalidParams("Missing params");
+  }
+  if (auto raw = Raw()) {
+    auto span = FindRawValue(*raw, pointer);
+    if (!span) {
+      return InvalidParams("No value at " + std::string(pointer));
+    }
+    auto value = ParseJson(*span);
+    if (value.is_discarded()) {
+      return InvalidParams("Malformed value at " + std::string(pointer));
+    }
+    return value;
+  }
+  try {
+    return params_->at(nlohmann::json::json_pointer(std::string(pointer)));
+  } catch (const nlohmann::json::exception&) {
+    return InvalidParams("No value at " + std::string(pointer));
+  }
+}
+
+}  // namespace jsonrpc::endpoint
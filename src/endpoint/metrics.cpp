@@ -0,0 +1,249 @@
+#include "jsonrpc/endpoint/metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <thread>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace jsonrpc::endpoint {
+
+namespace {
+
+constexpr std::size_t kLinearBuckets = LatencySnapshot::kSubBuckets;
+
+// Bits of a value below its leading one that pick the sub-bucket
+constexpr int kSubBucketBits = std::countr_zero(LatencySnapshot::kSubBuckets);
+
+constexpr std::array<double, 3> kExportedQuantiles = {0.5, 0.9, 0.99};
+
+auto ToSeconds(std::chrono::microseconds micros) -> double {
+  return std::chrono::duration<double>(micros).count();
+}
+
+// Label values escape backslashes, quotes and line breaks
+auto EscapeLabel(std::string_view value) -> std::string {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// Folds one shard's histogram into the sum of the shards
+void Merge(LatencySnapshot& into, const LatencySnapshot& from) {
+  for (std::size_t i = 0; i < into.buckets.size(); ++i) {
+    into.buckets[i] += from.buckets[i];
+  }
+  into.count += from.count;
+  into.sum += from.sum;
+  into.max = std::max(into.max, from.max);
+}
+
+class PrometheusWriter {
+ public:
+  explicit PrometheusWriter(std::string_view prefix) : prefix_(prefix) {
+  }
+
+  void Value(
+      std::string_view name, std::string_view type, std::uint64_t value) {
+    Type(name, type);
+    out_ += fmt::format("{}_{} {}\n", prefix_, name, value);
+  }
+
+  void Type(std::string_view name, std::string_view type) {
+    out_ += fmt::format("# TYPE {}_{} {}\n", prefix_, name, type);
+  }
+
+  void MethodValue(
+      std::string_view name, std::string_view method, std::uint64_t value) {
+    out_ += fmt::format(
+        "{}_{}{{method=\"{}\"}} {}\n", prefix_, name, EscapeLabel(method),
+        value);
+  }
+
+  void Summary(
+      std::string_view name, std::string_view method,
+      const LatencySnapshot& latency) {
+    const auto label = EscapeLabel(method);
+    for (double quantile : kExportedQuantiles) {
+      out_ += fmt::format(
+          "{}_{}{{method=\"{}\",quantile=\"{}\"}} {}\n", prefix_, name, label,
+          quantile, ToSeconds(latency.Percentile(quantile)));
+    }
+    out_ += fmt::format(
+        "{}_{}_sum{{method=\"{}\"}} {}\n", prefix_, name, label,
+        ToSeconds(latency.sum));
+    out_ += fmt::format(
+        "{}_{}_count{{method=\"{}\"}} {}\n", prefix_, name, label,
+        latency.count);
+  }
+
+  auto Take() -> std::string {
+    return std::move(out_);
+  }
+
+ private:
+  std::string_view prefix_;
+  std::string out_;
+};
+
+}  // namespace
+
+auto LatencySnapshot::BucketFor(std::uint64_t micros) -> std::size_t {
+  if (micros < kLinearBuckets) {
+    return static_cast<std::size_t>(micros);
+  }
+  const auto shift = std::bit_width(micros) - 1 - kSubBucketBits;
+  const auto sub = (micros >> shift) & (kSubBuckets - 1);
+  const auto bucket = kLinearBuckets + (shift * kSubBuckets) + sub;
+  return std::min<std::size_t>(bucket, kBucketCount - 1);
+}
+
+auto LatencySnapshot::BucketUpperBound(std::size_t bucket) -> std::uint64_t {
+  if (bucket < kLinearBuckets) {
+    return bucket;
+  }
+  const auto shift = (bucket - kLinearBuckets) / kSubBuckets;
+  const auto sub = (bucket - kLinearBuckets) % kSubBuckets;
+  const auto lower = static_cast<std::uint64_t>(kSubBuckets + sub) << shift;
+  return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+auto LatencySnapshot::Percentile(double quantile) const
+    -> std::chrono::microseconds {
+  if (count == 0) {
+    return std::chrono::microseconds{0};
+  }
+  const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(
+             std::ceil(std::clamp(quantile, 0.0, 1.0) * count)));
+  std::uint64_t seen = 0;
+  for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    seen += buckets[bucket];
+    if (seen >= rank) {
+      // The top bucket is open-ended, and none holds more than the maximum
+      return std::min(
+          std::chrono::microseconds(BucketUpperBound(bucket)), max);
+    }
+  }
+  return max;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) noexcept {
+  const auto micros = static_cast<std::uint64_t>(std::max<std::int64_t>(
+      0, std::chrono::duration_cast<std::chrono::microseconds>(latency)
+             .count()));
+  buckets_[LatencySnapshot::BucketFor(micros)].fetch_add(
+      1, std::memory_order_relaxed);
+  sum_micros_.fetch_add(micros, std::memory_order_relaxed);
+  auto max = max_micros_.load(std::memory_order_relaxed);
+  while (micros > max && !max_micros_.compare_exchange_weak(
+                             max, micros, std::memory_order_relaxed)) {
+  }
+}
+
+auto LatencyHistogram::Snapshot() const -> LatencySnapshot {
+  LatencySnapshot snapshot;
+  for (std::size_t i = 0; i < buckets_.size(); ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  // The count comes from the buckets, so it matches them even while samples
+  // come in
+  for (auto bucket : snapshot.buckets) {
+    snapshot.count += bucket;
+  }
+  snapshot.sum = std::chrono::microseconds(
+      sum_micros_.load(std::memory_order_relaxed));
+  snapshot.max = std::chrono::microseconds(
+      max_micros_.load(std::memory_order_relaxed));
+  return snapshot;
+}
+
+auto MethodMetrics::Local() noexcept -> Shard& {
+  // Threads keep their shard for life; a coroutine that resumes elsewhere
+  // simply records into the new thread's shard
+  const auto thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return shards_[thread % kMethodMetricShards];
+}
+
+auto MethodMetrics::Snapshot() const -> MethodMetricsSnapshot {
+  MethodMetricsSnapshot snapshot;
+  for (const auto& shard : shards_) {
+    snapshot.calls += shard.calls.load(std::memory_order_relaxed);
+    snapshot.errors += shard.errors.load(std::memory_order_relaxed);
+    snapshot.cache_hits += shard.cache_hits.load(std::memory_order_relaxed);
+    Merge(snapshot.handler_latency, shard.handler_latency.Snapshot());
+    Merge(snapshot.queue_latency, shard.queue_latency.Snapshot());
+  }
+  return snapshot;
+}
+
+auto FormatPrometheus(const EndpointMetrics& metrics, std::string_view prefix)
+    -> std::string {
+  PrometheusWriter writer(prefix);
+  writer.Value(
+      "messages_received_total", "counter", metrics.messages_received);
+  writer.Value("messages_sent_total", "counter", metrics.messages_sent);
+  writer.Value("received_bytes_total", "counter", metrics.bytes_received);
+  writer.Value("sent_bytes_total", "counter", metrics.bytes_sent);
+  writer.Value("framing_errors_total", "counter", metrics.framing_errors);
+  writer.Value(
+      "transient_receive_errors_total", "counter",
+      metrics.receive_errors.transient);
+  writer.Value(
+      "terminal_receive_errors_total", "counter",
+      metrics.receive_errors.terminal);
+  writer.Value("pending_requests", "gauge", metrics.pending_requests);
+  writer.Value("active_handlers", "gauge", metrics.active_handlers);
+  writer.Value(
+      "spilled_handlers_total", "counter", metrics.spilled_handlers);
+  writer.Value(
+      "send_queue_messages", "gauge", metrics.send_queue.queued_messages);
+  writer.Value("send_queue_bytes", "gauge", metrics.send_queue.queued_bytes);
+  writer.Value(
+      "send_queue_peak_bytes", "gauge", metrics.send_queue.peak_queued_bytes);
+  writer.Value(
+      "send_queue_failed_messages_total", "counter",
+      metrics.send_queue.failed_messages);
+  writer.Value(
+      "unknown_method_calls_total", "counter",
+      metrics.dispatcher.unknown_method_calls);
+
+  const auto& methods = metrics.dispatcher.methods;
+  writer.Type("method_calls_total", "counter");
+  for (const auto& [method, method_metrics] : methods) {
+    writer.MethodValue("method_calls_total", method, method_metrics.calls);
+  }
+  writer.Type("method_errors_total", "counter");
+  for (const auto& [method, method_metrics] : methods) {
+    writer.MethodValue("method_errors_total", method, method_metrics.errors);
+  }
+  writer.Type("method_cache_hits_total", "counter");
+  for (const auto& [method, method_metrics] : methods) {
+    writer.MethodValue(
+        "method_cache_hits_total", method, method_metrics.cache_hits);
+  }
+  writer.Type("handler_latency_seconds", "summary");
+  for (const auto& [method, method_metrics] : methods) {
+    writer.Summary(
+        "handler_latency_seconds", method, method_metrics.handler_latency);
+  }
+  writer.Type("queue_latency_seconds", "summary");
+  for (const auto& [method, method_metrics] : methods) {
+    writer.Summary(
+        "queue_latency_seconds", method, method_metrics.queue_latency);
+  }
+  return writer.Take();
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,117 @@
+#include "jsonrpc/endpoint/pending_request_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+namespace jsonrpc::endpoint {
+
+PendingRequestTable::PendingRequestTable(std::size_t capacity)
+    : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1),
+      segment_slots_(std::min(mask_ + 1, kSegmentSlots)),
+      segments_((mask_ + 1) / segment_slots_) {
+}
+
+auto PendingRequestTable::Create(asio::any_io_executor executor)
+    -> std::shared_ptr<PendingRequest> {
+  return std::allocate_shared<PendingRequest>(
+      std::pmr::polymorphic_allocator<PendingRequest>(&pool_),
+      std::move(executor));
+}
+
+auto PendingRequestTable::Insert(std::shared_ptr<PendingRequest> request)
+    -> std::optional<int64_t> {
+  // Each attempt consumes an id; give up after trying every slot once
+  for (std::size_t attempt = 0; attempt < Capacity(); ++attempt) {
+    auto id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = SlotFor(id);
+
+    auto expected = kFree;
+    if (!slot.state.compare_exchange_strong(
+            expected, kBusy, std::memory_order_acquire,
+            std::memory_order_relaxed)) {
+      continue;  // Still held by an older call
+    }
+    slot.request = std::move(request);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    slot.state.store(id, std::memory_order_release);
+    return id;
+  }
+  return std::nullopt;
+}
+
+auto PendingRequestTable::Take(int64_t id) -> std::shared_ptr<PendingRequest> {
+  auto* slot = FindSlot(id);
+  if (slot == nullptr) {
+    return nullptr;
+  }
+
+  auto expected = id;
+  if (!slot->state.compare_exchange_strong(
+          expected, kBusy, std::memory_order_acquire,
+          std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return Release(*slot);
+}
+
+void PendingRequestTable::CancelAll(int code, const std::string& message) {
+  // Pairs with the fence of an inserter that checks for shutdown after
+  // publishing, so a call this scan misses sees the shutdown instead
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (auto& segment : segments_) {
+    if (!segment.allocated.load(std::memory_order_acquire)) {
+      continue;
+    }
+    for (std::size_t i = 0; i < segment_slots_; ++i) {
+      auto& slot = segment.slots[i];
+      auto state = slot.state.load(std::memory_order_relaxed);
+      if (state < 0) {
+        continue;
+      }
+      // Losing the race means the call was completed concurrently
+      if (!slot.state.compare_exchange_strong(
+              state, kBusy, std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        continue;
+      }
+      if (auto request = Release(slot)) {
+        request->Cancel(code, message);
+      }
+    }
+  }
+}
+
+auto PendingRequestTable::SlotFor(int64_t id) -> Slot& {
+  const auto index = static_cast<std::size_t>(id) & mask_;
+  auto& segment = segments_[index / segment_slots_];
+  std::call_once(segment.once, [this, &segment] {
+    segment.slots = std::make_unique<Slot[]>(segment_slots_);
+    segment.allocated.store(true, std::memory_order_release);
+  });
+  return segment.slots[index % segment_slots_];
+}
+
+auto PendingRequestTable::FindSlot(int64_t id) -> Slot* {
+  if (id < 0) {
+    return nullptr;
+  }
+  const auto index = static_cast<std::size_t>(id) & mask_;
+  auto& segment = segments_[index / segment_slots_];
+  if (!segment.allocated.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &segment.slots[index % segment_slots_];
+}
+
+auto PendingRequestTable::Release(Slot& slot)
+    -> std::shared_ptr<PendingRequest> {
+  auto request = std::move(slot.request);
+  slot.request = nullptr;
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  slot.state.store(kFree, std::memory_order_release);
+  return request;
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,271 @@
+#include "jsonrpc/endpoint/pooled_rpc_client.hpp"
+
+#include <algorithm>
+
+#include <jsonrpc/error/error.hpp>
+
+#include "jsonrpc/utils/logging.hpp"
+#include "jsonrpc/utils/strand.hpp"
+
+namespace jsonrpc::endpoint {
+
+using jsonrpc::error::Ok;
+using jsonrpc::error::RpcError;
+using jsonrpc::error::RpcErrorCode;
+
+PooledRpcClient::PooledRpcClient(
+    asio::any_io_executor executor, TransportFactory factory,
+    PoolOptions options, std::shared_ptr<spdlog::logger> logger)
+    : PooledRpcClient(
+          std::move(executor),
+          std::vector<TransportFactory>{std::move(factory)},
+          std::move(options), std::move(logger)) {
+}
+
+PooledRpcClient::PooledRpcClient(
+    asio::any_io_executor executor, std::vector<TransportFactory> factories,
+    PoolOptions options, std::shared_ptr<spdlog::logger> logger)
+    : options_(std::move(options)),
+      logger_(logger ? logger : spdlog::default_logger()),
+      executor_(std::move(executor)),
+      strand_(asio::make_strand(executor_)),
+      factories_(std::move(factories)),
+      slots_(std::max<std::size_t>(options_.connections, 1)),
+      state_changed_(strand_, Clock::time_point::max()) {
+}
+
+auto PooledRpcClient::Start()
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  if (factories_.empty()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "Client pool has no transport factory");
+  }
+  if (is_running_.exchange(true)) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "Client pool is already running");
+  }
+
+  co_await utils::SwitchTo(strand_);
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    StartReconnect(i);
+  }
+  const auto ready = options_.ready_connections;
+  while (std::ranges::any_of(slots_, &Slot::connecting) &&
+         (ready == 0 || connected_count_ < ready)) {
+    co_await WaitForChange();
+  }
+
+  if (connected_count_ == 0) {
+    JSONRPC_LOG_ERROR(Logger(), "Client pool could not open any connection");
+    is_running_ = false;
+    co_return std::unexpected(last_connect_error_.value_or(RpcError(
+        RpcErrorCode::kTransportError, "Client pool could not connect")));
+  }
+  JSONRPC_LOG_DEBUG(
+      Logger(), "Client pool opened {} of {} connections",
+      connected_count_.load(), slots_.size());
+  co_return Ok();
+}
+
+auto PooledRpcClient::Shutdown()
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  if (!is_running_.exchange(false)) {
+    co_return Ok();
+  }
+  co_await utils::SwitchTo(strand_);
+  JSONRPC_LOG_DEBUG(Logger(), "Client pool draining {} tasks", active_tasks_);
+
+  // New calls fail from here on; give the outstanding ones time to finish
+  asio::steady_timer drain_timer(strand_);
+  drain_expired_ = false;
+  if (options_.drain_timeout) {
+    drain_timer.expires_after(*options_.drain_timeout);
+    drain_timer.async_wait([this](std::error_code ec) {
+      if (!ec) {
+        drain_expired_ = true;
+        state_changed_.cancel();
+      }
+    });
+  }
+  while (active_tasks_ > 0 && !drain_expired_) {
+    co_await WaitForChange();
+  }
+  drain_timer.cancel();
+
+  // Fails whatever is still outstanding
+  std::vector<std::shared_ptr<RpcEndpoint>> endpoints;
+  for (auto &slot : slots_) {
+    if (slot.endpoint) {
+      endpoints.push_back(std::move(slot.endpoint));
+    }
+  }
+  connected_count_ = 0;
+  for (auto &endpoint : endpoints) {
+    co_await endpoint->Shutdown();
+    co_await endpoint->WaitForHandlers();
+  }
+
+  co_await utils::SwitchTo(strand_);
+  while (active_tasks_ > 0) {
+    co_await WaitForChange();
+  }
+  JSONRPC_LOG_DEBUG(Logger(), "Client pool shut down");
+  co_return Ok();
+}
+
+auto PooledRpcClient::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), std::nullopt);
+}
+
+auto PooledRpcClient::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    Clock::time_point deadline)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), deadline);
+}
+
+auto PooledRpcClient::SendMethodCall(
+    std::string method, std::optional<nlohmann::json> params,
+    std::chrono::milliseconds timeout)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  co_return co_await SendMethodCallImpl(
+      std::move(method), std::move(params), Clock::now() + timeout);
+}
+
+auto PooledRpcClient::SendMethodCallImpl(
+    std::string method, std::optional<nlohmann::json> params,
+    std::optional<Clock::time_point> deadline)
+    -> asio::awaitable<std::expected<nlohmann::json, RpcError>> {
+  auto endpoint = co_await Acquire();
+  if (!endpoint) {
+    co_return std::unexpected(endpoint.error());
+  }
+
+  std::expected<nlohmann::json, RpcError> result;
+  if (deadline) {
+    result = co_await (*endpoint)->SendMethodCall(
+        std::move(method), std::move(params), *deadline);
+  } else {
+    result = co_await (*endpoint)->SendMethodCall(
+        std::move(method), std::move(params));
+  }
+  TaskFinished();
+  co_return result;
+}
+
+auto PooledRpcClient::SendNotification(
+    std::string method, std::optional<nlohmann::json> params)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  auto endpoint = co_await Acquire();
+  if (!endpoint) {
+    co_return std::unexpected(endpoint.error());
+  }
+  auto result = co_await (*endpoint)->SendNotification(
+      std::move(method), std::move(params));
+  TaskFinished();
+  co_return result;
+}
+
+auto PooledRpcClient::Acquire()
+    -> asio::awaitable<std::expected<std::shared_ptr<RpcEndpoint>, RpcError>> {
+  co_await utils::SwitchTo(strand_);
+
+  while (true) {
+    if (!is_running_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kClientError, "Client pool is not running");
+    }
+
+    std::shared_ptr<RpcEndpoint> best;
+    auto now = Clock::now();
+    bool connecting = false;
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+      auto index = (next_slot_ + i) % slots_.size();
+      auto &slot = slots_[index];
+      if (slot.endpoint && slot.endpoint->IsConnected()) {
+        auto load = slot.endpoint->PendingRequestCount();
+        if (!best || load < best->PendingRequestCount()) {
+          best = slot.endpoint;
+        }
+        continue;
+      }
+      if (!slot.connecting && now >= slot.retry_after) {
+        StartReconnect(index);
+      }
+      connecting = connecting || slot.connecting;
+    }
+    next_slot_ = (next_slot_ + 1) % slots_.size();
+
+    if (best) {
+      ++active_tasks_;
+      co_return best;
+    }
+    if (!connecting) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "No connection available");
+    }
+    co_await WaitForChange();
+  }
+}
+
+void PooledRpcClient::StartReconnect(std::size_t index) {
+  auto &slot = slots_[index];
+  if (slot.endpoint) {
+    connected_count_.fetch_sub(1);
+  }
+  slot.connecting = true;
+  ++active_tasks_;
+  asio::co_spawn(strand_, Reconnect(index), asio::detached);
+}
+
+auto PooledRpcClient::Reconnect(std::size_t index) -> asio::awaitable<void> {
+  // A closed endpoint still has to be shut down before it is dropped
+  if (auto stale = std::move(slots_[index].endpoint)) {
+    co_await stale->Shutdown();
+    co_await stale->WaitForHandlers();
+  }
+
+  const auto &factory = factories_[index % factories_.size()];
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor_, factory(executor_), options_.endpoint);
+
+  co_await utils::SwitchTo(strand_);
+  auto &slot = slots_[index];
+  slot.connecting = false;
+  if (!client) {
+    JSONRPC_LOG_WARN(
+        Logger(), "Client pool connection {} failed: {}", index,
+        client.error().Message());
+    slot.retry_after = Clock::now() + options_.reconnect_delay;
+    last_connect_error_ = client.error();
+  } else if (!is_running_) {
+    co_await (*client)->Shutdown();
+    co_await utils::SwitchTo(strand_);
+  } else {
+    JSONRPC_LOG_DEBUG(Logger(), "Client pool connection {} open", index);
+    slot.endpoint = std::move(*client);
+    connected_count_.fetch_add(1);
+  }
+  TaskFinished();
+}
+
+auto PooledRpcClient::WaitForChange() -> asio::awaitable<void> {
+  std::error_code ec;
+  co_await state_changed_.async_wait(asio::redirect_error(
+      asio::bind_executor(strand_, asio::use_awaitable), ec));
+}
+
+void PooledRpcClient::TaskFinished() {
+  // Counted down on strand_ so Shutdown() cannot return while a task still
+  // touches the pool
+  asio::post(strand_, [this] {
+    --active_tasks_;
+    state_changed_.cancel();
+  });
+}
+
+}  // namespace jsonrpc::endpoint
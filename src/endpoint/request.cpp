@@ -1,5 +1,12 @@
 #include "jsonrpc/endpoint/request.hpp"
 
+#include <type_traits>
+
+#include "jsonrpc/endpoint/envelope.hpp"
+#include "jsonrpc/endpoint/json_codec.hpp"
+#include "jsonrpc/endpoint/json_writer.hpp"
+#include "jsonrpc/endpoint/lazy_params.hpp"
+
 namespace jsonrpc::endpoint {
 
 using error::RpcError;
@@ -28,61 +35,96 @@ Request::Request(std::string method, std::optional<nlohmann::json> params)
       is_notification_(true) {  // No ID for notifications
 }
 
-auto Request::FromJson(const nlohmann::json& json_obj)
-    -> std::expected<Request, error::RpcError> {
-  using error::RpcError;
-  using error::RpcErrorCode;
+namespace {
 
+auto ValidateRequest(const nlohmann::json& json_obj)
+    -> std::expected<void, RpcError> {
   if (!json_obj.is_object()) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest, "Request must be a JSON object");
   }
 
-  if (!json_obj.contains("jsonrpc") ||
-      (json_obj["jsonrpc"].get<std::string>() != kJsonRpcVersion)) {
+  auto version = json_obj.find("jsonrpc");
+  if (version == json_obj.end() || !version->is_string() ||
+      version->get_ref<const std::string&>() != kJsonRpcVersion) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest, "Missing or invalid 'jsonrpc' version");
   }
 
-  if (!json_obj.contains("method") || !json_obj["method"].is_string()) {
+  auto method = json_obj.find("method");
+  if (method == json_obj.end() || !method->is_string()) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest, "Missing or invalid 'method'");
   }
 
-  auto method = json_obj["method"].get<std::string>();
-  auto params = json_obj.contains("params")
-                    ? std::optional<nlohmann::json>(json_obj["params"])
-                    : std::nullopt;
+  auto params = json_obj.find("params");
+  if (params != json_obj.end() && !params->is_array() &&
+      !params->is_object() && !params->is_null() && !IsRawParams(*params)) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kInvalidRequest,
+        "'params' must be object, array, or null");
+  }
 
-  if (json_obj.contains("params")) {
-    const auto& p = json_obj["params"];
-    if (!p.is_array() && !p.is_object() && !p.is_null()) {
-      return RpcError::UnexpectedFromCode(
-          RpcErrorCode::kInvalidRequest,
-          "'params' must be object, array, or null");
-    }
+  auto id = json_obj.find("id");
+  if (id != json_obj.end() && !id->is_string() && !id->is_number_integer()) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kInvalidRequest, "Invalid 'id' type");
   }
 
-  if (!json_obj.contains("id")) {
-    return Request(std::move(method), std::move(params));  // Notification
+  return {};
+}
+
+// Shared by both FromJson overloads; fields are moved out of rvalue messages
+template <typename Json>
+auto BuildRequest(Json&& json_obj) -> std::expected<Request, RpcError> {
+  constexpr bool kMovable = !std::is_const_v<std::remove_reference_t<Json>>;
+
+  if (auto valid = ValidateRequest(json_obj); !valid) {
+    return std::unexpected(valid.error());
   }
 
-  const auto& id_json = json_obj["id"];
-  if (!id_json.is_string() && !id_json.is_number_integer()) {
-    return RpcError::UnexpectedFromCode(
-        RpcErrorCode::kInvalidRequest, "Invalid 'id' type");
+  auto take = [](auto& value) -> nlohmann::json {
+    if constexpr (kMovable) {
+      return std::move(value);
+    } else {
+      return value;
+    }
+  };
+
+  auto method = json_obj.find("method")->template get<std::string>();
+
+  std::optional<nlohmann::json> params;
+  if (auto it = json_obj.find("params"); it != json_obj.end()) {
+    params = take(*it);
+  }
+
+  auto id_it = json_obj.find("id");
+  if (id_it == json_obj.end()) {
+    return Request(std::move(method), std::move(params));  // Notification
   }
 
   RequestId id;
-  if (id_json.is_string()) {
-    id = id_json.get<std::string>();
+  if (id_it->is_string()) {
+    id = id_it->template get<std::string>();
   } else {
-    id = id_json.get<int64_t>();
+    id = id_it->template get<int64_t>();
   }
 
   return Request(std::move(method), std::move(params), std::move(id));
 }
 
+}  // namespace
+
+auto Request::FromJson(const nlohmann::json& json_obj)
+    -> std::expected<Request, error::RpcError> {
+  return BuildRequest(json_obj);
+}
+
+auto Request::FromJson(nlohmann::json&& json_obj)
+    -> std::expected<Request, error::RpcError> {
+  return BuildRequest(std::move(json_obj));
+}
+
 auto Request::RequiresResponse() const -> bool {
   return !is_notification_;
 }
@@ -111,4 +153,64 @@ auto Request::ToJson() const -> nlohmann::json {
   return json_obj;
 }
 
+auto Request::Dump() const -> std::string {
+  // Only the id, method and params are written per call; the envelope
+  // around them is constant
+  std::string text;
+  text.reserve(kRequestEnvelopeSize + method_.size() + 2);
+  if (is_notification_) {
+    text += kEnvelopeVersionOpen;
+  } else {
+    text += kEnvelopeIdOpen;
+    AppendRequestId(text, id_);
+    text += kEnvelopeVersion;
+  }
+  text += kEnvelopeMethodKey;
+  AppendJsonString(text, method_);
+  if (params_.has_value()) {
+    text += kEnvelopeParamsKey;
+    if (IsRawParams(*params_)) {
+      const auto& raw = params_->get_binary();
+      text.append(raw.begin(), raw.end());
+    } else {
+      AppendJson(text, *params_);
+    }
+  }
+  text += '}';
+  return text;
+}
+
+auto Request::Encode(transport::MessageEncoding encoding) const
+    -> std::string {
+  if (encoding == transport::MessageEncoding::kJson) {
+    return Dump();
+  }
+  // Members in the order Dump() writes them
+  std::string out;
+  AppendBinaryMap(
+      out, 2 + (is_notification_ ? 0 : 1) + (params_ ? 1 : 0), encoding);
+  if (!is_notification_) {
+    AppendBinaryString(out, "id", encoding);
+    AppendBinaryRequestId(out, id_, encoding);
+  }
+  AppendBinaryString(out, "jsonrpc", encoding);
+  AppendBinaryString(out, kJsonRpcVersion, encoding);
+  AppendBinaryString(out, "method", encoding);
+  AppendBinaryString(out, method_, encoding);
+  if (params_.has_value()) {
+    AppendBinaryString(out, "params", encoding);
+    if (IsRawParams(*params_)) {
+      const auto& raw = params_->get_binary();
+      AppendBinaryValue(
+          out,
+          ParseJson(std::string_view(
+              reinterpret_cast<const char*>(raw.data()), raw.size())),
+          encoding);
+    } else {
+      AppendBinaryValue(out, *params_, encoding);
+    }
+  }
+  return out;
+}
+
 }  // namespace jsonrpc::endpoint
@@ -1,117 +1,207 @@
 #include "jsonrpc/endpoint/response.hpp"
 
+#include <stdexcept>
+
 #include <jsonrpc/error/error.hpp>
 
+#include "jsonrpc/endpoint/envelope.hpp"
+#include "jsonrpc/endpoint/json_codec.hpp"
+#include "jsonrpc/endpoint/json_writer.hpp"
+
 namespace jsonrpc::endpoint {
 
 using jsonrpc::error::RpcError;
 
+namespace {
+
+auto IdOf(const std::optional<RequestId>& id) -> std::optional<nlohmann::json> {
+  if (!id) {
+    return std::nullopt;
+  }
+  return std::visit([](const auto& v) { return nlohmann::json(v); }, *id);
+}
+
+auto ErrorObject(const RpcError& error)
+    -> std::shared_ptr<const nlohmann::json> {
+  return std::make_shared<const nlohmann::json>(nlohmann::json{
+      {"code", static_cast<int>(error.Code())}, {"message", error.Message()}});
+}
+
+}  // namespace
+
 auto Response::FromJson(const nlohmann::json& json)
     -> std::expected<Response, error::RpcError> {
-  Response r{json};
-  if (auto result = r.ValidateResponse(); !result) {
+  if (auto result = ValidateResponse(json); !result) {
     return std::unexpected(result.error());
   }
-  return r;
+  const bool is_success = json.contains("result");
+  auto body = std::make_shared<const nlohmann::json>(
+      json[is_success ? "result" : "error"]);
+  auto id = json.find("id");
+  return Response(
+      std::move(body), is_success,
+      id != json.end() ? std::optional(*id) : std::nullopt);
 }
 
 auto Response::CreateSuccess(
     const nlohmann::json& result, const std::optional<RequestId>& id)
     -> Response {
-  nlohmann::json response = {{"jsonrpc", kJsonRpcVersion}, {"result", result}};
-  if (id) {
-    std::visit([&response](const auto& v) { response["id"] = v; }, *id);
-  }
-  return Response{std::move(response)};
+  return Response(
+      std::make_shared<const nlohmann::json>(result), true, IdOf(id));
+}
+
+auto Response::CreateSuccess(
+    nlohmann::json&& result, const std::optional<RequestId>& id) -> Response {
+  return Response(
+      std::make_shared<const nlohmann::json>(std::move(result)), true,
+      IdOf(id));
+}
+
+auto Response::CreateSuccess(
+    std::shared_ptr<const nlohmann::json> result,
+    const std::optional<RequestId>& id) -> Response {
+  return Response(std::move(result), true, IdOf(id));
 }
 
 auto Response::CreateError(
     RpcErrorCode code, const std::optional<RequestId>& id) -> Response {
-  RpcError err = RpcError::FromCode(code);
-
-  nlohmann::json error = {
-      {"code", static_cast<int>(err.Code())}, {"message", err.Message()}};
-  nlohmann::json response = {{"jsonrpc", kJsonRpcVersion}, {"error", error}};
-  if (id) {
-    std::visit([&response](const auto& v) { response["id"] = v; }, *id);
-  } else {
-    response["id"] = nullptr;
-  }
-  return Response{std::move(response)};
+  // Unlike the other overloads, answers without an id carry a null id
+  return Response(
+      ErrorObject(RpcError::FromCode(code)), false,
+      id ? IdOf(id) : std::optional(nlohmann::json(nullptr)));
 }
 
 auto Response::CreateError(
     const RpcError& error, const std::optional<RequestId>& id) -> Response {
-  nlohmann::json error_json = error.to_json();
-  return CreateError(error_json, id);
+  return CreateError(error.to_json(), id);
 }
 
 auto Response::CreateError(
     const nlohmann::json& error, const std::optional<RequestId>& id)
     -> Response {
-  nlohmann::json response = {{"jsonrpc", kJsonRpcVersion}, {"error", error}};
-  if (id) {
-    std::visit([&response](const auto& v) { response["id"] = v; }, *id);
-  }
-  return Response{std::move(response)};
+  return Response(
+      std::make_shared<const nlohmann::json>(error), false, IdOf(id));
 }
 
 auto Response::IsSuccess() const -> bool {
-  return response_.contains("result");
+  return is_success_;
 }
 
 auto Response::GetResult() const -> const nlohmann::json& {
   if (!IsSuccess()) {
     throw std::runtime_error("Response is not a success response");
   }
-  return response_["result"];
+  return *body_;
 }
 
 auto Response::GetError() const -> const nlohmann::json& {
-  if (IsSuccess()) {
+  if (IsSuccess() || !body_) {
     throw std::runtime_error("Response is not an error response");
   }
-  return response_["error"];
+  return *body_;
 }
 
 auto Response::GetId() const -> std::optional<RequestId> {
-  if (!response_.contains("id") || response_["id"].is_null()) {
+  if (!id_ || id_->is_null()) {
     return std::nullopt;
   }
-
-  const auto& id = response_["id"];
-  if (id.is_string()) {
-    return id.get<std::string>();
+  if (id_->is_string()) {
+    return id_->get<std::string>();
   }
-  return id.get<int64_t>();
+  return id_->get<int64_t>();
 }
 
 auto Response::ToJson() const -> nlohmann::json {
-  return response_;
+  if (!body_) {
+    return nullptr;
+  }
+  nlohmann::json response = {
+      {"jsonrpc", kJsonRpcVersion},
+      {is_success_ ? "result" : "error", *body_}};
+  if (id_) {
+    response["id"] = *id_;
+  }
+  return response;
+}
+
+auto Response::Dump() const -> std::string {
+  if (!body_) {
+    return "null";
+  }
+  std::string text;
+  if (is_success_) {
+    if (id_) {
+      text += kEnvelopeIdOpen;
+      AppendJson(text, *id_);
+      text += kEnvelopeVersion;
+    } else {
+      text += kEnvelopeVersionOpen;
+    }
+    text += kEnvelopeResultKey;
+    AppendJson(text, *body_);
+  } else {
+    text += kEnvelopeErrorOpen;
+    AppendJson(text, *body_);
+    if (id_) {
+      text += kEnvelopeIdKey;
+      AppendJson(text, *id_);
+    }
+    text += kEnvelopeVersion;
+  }
+  text += '}';
+  return text;
+}
+
+auto Response::Encode(transport::MessageEncoding encoding) const
+    -> std::string {
+  if (encoding == transport::MessageEncoding::kJson) {
+    return Dump();
+  }
+  if (!body_) {
+    return EncodeMessage(nullptr, encoding);
+  }
+  // Members in the order Dump() writes them
+  std::string out;
+  AppendBinaryMap(out, id_ ? 3 : 2, encoding);
+  if (!is_success_) {
+    AppendBinaryString(out, "error", encoding);
+    AppendBinaryValue(out, *body_, encoding);
+  }
+  if (id_) {
+    AppendBinaryString(out, "id", encoding);
+    AppendBinaryValue(out, *id_, encoding);
+  }
+  AppendBinaryString(out, "jsonrpc", encoding);
+  AppendBinaryString(out, kJsonRpcVersion, encoding);
+  if (is_success_) {
+    AppendBinaryString(out, "result", encoding);
+    AppendBinaryValue(out, *body_, encoding);
+  }
+  return out;
 }
 
-auto Response::ValidateResponse() const
+auto Response::ValidateResponse(const nlohmann::json& response)
     -> std::expected<void, error::RpcError> {
-  if (!response_.contains("jsonrpc") ||
-      (response_["jsonrpc"].get<std::string>() != kJsonRpcVersion)) {
+  if (!response.contains("jsonrpc") ||
+      (response["jsonrpc"].get<std::string>() != kJsonRpcVersion)) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest, "Invalid JSON-RPC version");
   }
 
-  if (!response_.contains("result") && !response_.contains("error")) {
+  if (!response.contains("result") && !response.contains("error")) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest,
         "Response must contain either 'result' or 'error' field");
   }
 
-  if (response_.contains("result") && response_.contains("error")) {
+  if (response.contains("result") && response.contains("error")) {
     return RpcError::UnexpectedFromCode(
         RpcErrorCode::kInvalidRequest,
         "Response cannot contain both 'result' and 'error' fields");
   }
 
-  if (response_.contains("error")) {
-    const auto& error = response_["error"];
+  if (response.contains("error")) {
+    const auto& error = response["error"];
     if (!error.contains("code") || !error.contains("message")) {
       return RpcError::UnexpectedFromCode(
           RpcErrorCode::kInvalidRequest,
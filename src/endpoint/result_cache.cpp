@@ -0,0 +1,210 @@
+#include "jsonrpc/endpoint/result_cache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <system_error>
+#include <utility>
+
+#include "jsonrpc/endpoint/json_codec.hpp"
+#include "jsonrpc/endpoint/lazy_params.hpp"
+#include "jsonrpc/utils/strand.hpp"
+
+namespace jsonrpc::endpoint {
+
+// A call computing the result of a key that other calls wait for
+struct ResultCache::Flight {
+  explicit Flight(const asio::strand<asio::any_io_executor>& strand)
+      : done(strand, Clock::time_point::max()) {
+  }
+
+  // Cancelled once the result is in, which wakes every waiter
+  asio::steady_timer done;
+  ResultPtr result;
+};
+
+// One strand's part of the cache; every member is only touched on strand
+struct ResultCache::Shard {
+  struct Node {
+    std::string key;
+    ResultPtr result;
+    Clock::time_point expires_at;
+  };
+
+  Shard(const asio::any_io_executor& executor, std::size_t capacity)
+      : strand(asio::make_strand(executor)), capacity(capacity) {
+  }
+
+  // The unexpired result under key, which becomes the most recently used
+  auto Get(std::string_view key, Clock::time_point now) -> ResultPtr {
+    auto it = index.find(key);
+    if (it == index.end()) {
+      return nullptr;
+    }
+    auto node = it->second;
+    if (node->expires_at <= now) {
+      index.erase(it);
+      lru.erase(node);
+      return nullptr;
+    }
+    lru.splice(lru.begin(), lru, node);
+    return node->result;
+  }
+
+  void Put(std::string key, ResultPtr result, Clock::time_point expires_at) {
+    if (capacity == 0) {
+      return;
+    }
+    if (auto it = index.find(key); it != index.end()) {
+      lru.erase(it->second);
+      index.erase(it);
+    }
+    lru.push_front(Node{
+        .key = std::move(key),
+        .result = std::move(result),
+        .expires_at = expires_at});
+    index.emplace(lru.front().key, lru.begin());
+    while (lru.size() > capacity) {
+      index.erase(lru.back().key);
+      lru.pop_back();
+    }
+  }
+
+  asio::strand<asio::any_io_executor> strand;
+  std::size_t capacity;
+
+  // Most recently used first; the index keys view the nodes' keys
+  std::list<Node> lru;
+  std::unordered_map<std::string_view, std::list<Node>::iterator> index;
+
+  std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+};
+
+namespace {
+
+auto ExpiryOf(std::chrono::milliseconds ttl) -> ResultCache::Clock::time_point {
+  const auto now = ResultCache::Clock::now();
+  // Long TTLs such as milliseconds::max() mean until evicted
+  if (ttl >= std::chrono::duration_cast<std::chrono::milliseconds>(
+                 ResultCache::Clock::time_point::max() - now)) {
+    return ResultCache::Clock::time_point::max();
+  }
+  return now + ttl;
+}
+
+}  // namespace
+
+void ResultCache::Lease::Release(
+    ResultPtr result, std::chrono::milliseconds ttl) {
+  if (!shard_) {
+    return;
+  }
+  auto& strand = shard_->strand;
+  asio::post(
+      strand, [shard = std::move(shard_), key = std::move(key_),
+               flight = std::move(flight_), result = std::move(result),
+               ttl]() mutable {
+        // An invalidation since the lookup detached the flight; its result
+        // still goes to the calls that waited, but is not kept
+        auto it = shard->flights.find(key);
+        if (it != shard->flights.end() && it->second == flight) {
+          shard->flights.erase(it);
+          if (result) {
+            shard->Put(std::move(key), result, ExpiryOf(ttl));
+          }
+        }
+        flight->result = std::move(result);
+        flight->done.cancel();
+      });
+}
+
+ResultCache::ResultCache(
+    const asio::any_io_executor& executor, std::size_t capacity,
+    std::size_t shard_count) {
+  shard_count = std::max<std::size_t>(shard_count, 1);
+  const auto per_shard = (capacity + shard_count - 1) / shard_count;
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_shared<Shard>(executor, per_shard));
+  }
+}
+
+auto ResultCache::KeyOf(
+    std::string_view method, const std::optional<nlohmann::json>& params)
+    -> std::string {
+  std::string key(method);
+  key += '\0';
+  if (!params) {
+    return key;
+  }
+  if (IsRawParams(*params)) {
+    // Lazy params are keyed on their text as it arrived
+    const auto& bytes = params->get_binary();
+    key.append(bytes.begin(), bytes.end());
+  } else {
+    key += SerializeJson(*params);
+  }
+  return key;
+}
+
+auto ResultCache::ShardFor(std::string_view key) const
+    -> const std::shared_ptr<Shard>& {
+  return shards_[std::hash<std::string_view>{}(key) % shards_.size()];
+}
+
+auto ResultCache::Find(std::string key) -> asio::awaitable<Lookup> {
+  auto shard = ShardFor(key);
+  co_await utils::SwitchTo(shard->strand);
+  if (auto result = shard->Get(key, Clock::now())) {
+    co_return Lookup{.hit = std::move(result)};
+  }
+
+  auto [it, leading] = shard->flights.try_emplace(key);
+  if (leading) {
+    it->second = std::make_shared<Flight>(shard->strand);
+    auto flight = it->second;
+    co_return Lookup{
+        .lease = Lease(std::move(shard), std::move(key), std::move(flight))};
+  }
+  auto flight = it->second;
+  std::error_code ec;
+  co_await flight->done.async_wait(
+      asio::redirect_error(asio::use_awaitable, ec));
+  co_return Lookup{.hit = flight->result};
+}
+
+auto ResultCache::Invalidate(std::string_view method)
+    -> asio::awaitable<void> {
+  std::string prefix(method);
+  prefix += '\0';
+  co_await Drop(prefix);
+}
+
+auto ResultCache::Clear() -> asio::awaitable<void> {
+  co_await Drop("");
+}
+
+auto ResultCache::Drop(std::string_view prefix) -> asio::awaitable<void> {
+  for (const auto& shard : shards_) {
+    co_await utils::SwitchTo(shard->strand);
+    std::erase_if(shard->index, [&prefix](const auto& entry) {
+      return entry.first.starts_with(prefix);
+    });
+    std::erase_if(shard->lru, [&prefix](const Shard::Node& node) {
+      return node.key.starts_with(prefix);
+    });
+    std::erase_if(shard->flights, [&prefix](const auto& entry) {
+      return std::string_view(entry.first).starts_with(prefix);
+    });
+  }
+}
+
+auto ResultCache::Size() -> asio::awaitable<std::size_t> {
+  std::size_t size = 0;
+  for (const auto& shard : shards_) {
+    co_await utils::SwitchTo(shard->strand);
+    size += shard->lru.size();
+  }
+  co_return size;
+}
+
+}  // namespace jsonrpc::endpoint
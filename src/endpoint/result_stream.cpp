@@ -0,0 +1,64 @@
+#include "jsonrpc/endpoint/result_stream.hpp"
+
+#include <utility>
+
+#include "jsonrpc/endpoint/request.hpp"
+#include "jsonrpc/endpoint/types.hpp"
+
+namespace jsonrpc::endpoint {
+
+using error::RpcError;
+
+namespace {
+
+auto ProgressParams(const nlohmann::json& token, nlohmann::json items)
+    -> nlohmann::json {
+  auto params = nlohmann::json::object();
+  params["token"] = token;
+  params["value"] = std::move(items);
+  return params;
+}
+
+}  // namespace
+
+ResultStream::ResultStream(std::optional<nlohmann::json> token, Sender sender)
+    : token_(sender ? std::move(token) : std::nullopt),
+      sender_(std::move(sender)) {
+}
+
+auto ResultStream::TokenOf(const std::optional<nlohmann::json>& params)
+    -> std::optional<nlohmann::json> {
+  if (!params || !params->is_object()) {
+    return std::nullopt;
+  }
+  auto token = params->find(kPartialResultTokenKey);
+  if (token == params->end() ||
+      !(token->is_string() || token->is_number_integer())) {
+    return std::nullopt;
+  }
+  return *token;
+}
+
+auto ResultStream::Write(nlohmann::json items)
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  if (!items.is_array()) {
+    auto single = nlohmann::json::array();
+    single.push_back(std::move(items));
+    items = std::move(single);
+  }
+  if (!token_) {
+    for (auto& item : items) {
+      collected_.push_back(std::move(item));
+    }
+    co_return std::expected<void, RpcError>{};
+  }
+  Request progress(
+      std::string(kProgressMethod), ProgressParams(*token_, std::move(items)));
+  co_return co_await sender_(progress.Dump());
+}
+
+auto ResultStream::TakeResult() -> nlohmann::json {
+  return std::exchange(collected_, nlohmann::json::array());
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,302 @@
+#include "jsonrpc/endpoint/rpc_server.hpp"
+
+#include <algorithm>
+
+#include <jsonrpc/error/error.hpp>
+
+#include "jsonrpc/utils/logging.hpp"
+#include "jsonrpc/utils/strand.hpp"
+
+namespace jsonrpc::endpoint {
+
+using jsonrpc::error::Ok;
+using jsonrpc::error::RpcError;
+using jsonrpc::error::RpcErrorCode;
+
+namespace {
+// Pause after a failed accept, e.g. when out of file descriptors
+constexpr auto kAcceptRetryDelay = std::chrono::milliseconds(100);
+
+constexpr auto kMinReapInterval = std::chrono::milliseconds(10);
+}  // namespace
+
+RpcServer::RpcServer(
+    asio::any_io_executor executor,
+    std::unique_ptr<transport::Acceptor> acceptor, ServerOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : RpcServer(
+          std::move(executor),
+          [&acceptor] {
+            std::vector<std::unique_ptr<transport::Acceptor>> acceptors;
+            acceptors.push_back(std::move(acceptor));
+            return acceptors;
+          }(),
+          std::move(options), std::move(logger)) {
+}
+
+RpcServer::RpcServer(
+    asio::any_io_executor executor,
+    std::vector<std::unique_ptr<transport::Acceptor>> acceptors,
+    ServerOptions options, std::shared_ptr<spdlog::logger> logger)
+    : options_(std::move(options)),
+      logger_(logger ? logger : spdlog::default_logger()),
+      executor_(std::move(executor)),
+      strand_(asio::make_strand(executor_)),
+      acceptors_(std::move(acceptors)),
+      dispatcher_(std::make_shared<Dispatcher>(
+          options_.endpoint.handler_executor.value_or(executor_),
+          options_.endpoint.dispatcher, logger_)),
+      reap_timer_(strand_),
+      state_changed_(strand_, Clock::time_point::max()) {
+}
+
+auto RpcServer::Start() -> asio::awaitable<std::expected<void, RpcError>> {
+  if (is_running_.exchange(true)) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kClientError, "RPC server is already running");
+  }
+
+  for (auto &acceptor : acceptors_) {
+    auto listening = co_await acceptor->Listen();
+    if (!listening) {
+      JSONRPC_LOG_ERROR(
+          Logger(), "RpcServer failed to listen: {}",
+          listening.error().Message());
+      is_running_ = false;
+      for (auto &opened : acceptors_) {
+        co_await opened->Close();
+      }
+      co_return listening;
+    }
+  }
+
+  co_await utils::SwitchTo(strand_);
+  for (auto &acceptor : acceptors_) {
+    ++active_tasks_;
+    asio::co_spawn(
+        acceptor->GetExecutor(),
+        [this, &acceptor = *acceptor]() -> asio::awaitable<void> {
+          co_await AcceptLoop(acceptor);
+          TaskFinished();
+        },
+        asio::detached);
+  }
+
+  if (options_.idle_timeout) {
+    ++active_tasks_;
+    asio::co_spawn(
+        strand_,
+        [this]() -> asio::awaitable<void> {
+          co_await ReapIdleSessions();
+          TaskFinished();
+        },
+        asio::detached);
+  }
+
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcServer started with {} acceptors", acceptors_.size());
+  co_return Ok();
+}
+
+auto RpcServer::WaitForShutdown()
+    -> asio::awaitable<std::expected<void, RpcError>> {
+  co_await utils::SwitchTo(strand_);
+  while (is_running_ || active_tasks_ > 0) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(strand_, asio::use_awaitable), ec));
+  }
+  co_return Ok();
+}
+
+auto RpcServer::Shutdown() -> asio::awaitable<std::expected<void, RpcError>> {
+  if (!is_running_.exchange(false)) {
+    co_return Ok();
+  }
+  JSONRPC_LOG_DEBUG(Logger(), "RpcServer shutting down");
+
+  // Fails the pending accepts, which ends the accept loops
+  for (auto &acceptor : acceptors_) {
+    co_await acceptor->Close();
+  }
+
+  // Sessions registered from here on see is_running_ and close themselves
+  co_await utils::SwitchTo(strand_);
+  reap_timer_.cancel();
+  for (const auto &[id, session] : sessions_) {
+    ShutdownSession(session);
+  }
+
+  while (active_tasks_ > 0) {
+    std::error_code ec;
+    co_await state_changed_.async_wait(asio::redirect_error(
+        asio::bind_executor(strand_, asio::use_awaitable), ec));
+  }
+
+  JSONRPC_LOG_DEBUG(Logger(), "RpcServer shut down");
+  co_return Ok();
+}
+
+auto RpcServer::AcceptLoop(transport::Acceptor &acceptor)
+    -> asio::awaitable<void> {
+  while (is_running_) {
+    // The socket is accepted onto the least loaded worker, which is only
+    // claimed once the connection is there
+    std::optional<std::size_t> worker;
+    auto executor = acceptor.GetExecutor();
+    if (options_.workers) {
+      worker = options_.workers->LeastLoaded();
+      executor = options_.workers->GetExecutor(*worker);
+    }
+
+    auto accepted = co_await acceptor.Accept(executor);
+    if (!accepted) {
+      if (!is_running_) {
+        break;
+      }
+      JSONRPC_LOG_WARN(
+          Logger(), "RpcServer accept failed: {}", accepted.error().Message());
+      asio::steady_timer delay(acceptor.GetExecutor(), kAcceptRetryDelay);
+      std::error_code ec;
+      co_await delay.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+      continue;
+    }
+
+    if (connection_count_.fetch_add(1) >= options_.max_connections) {
+      connection_count_.fetch_sub(1);
+      JSONRPC_LOG_WARN(
+          Logger(), "RpcServer rejecting connection, {} sessions open",
+          options_.max_connections);
+      (*accepted)->CloseNow();
+      continue;
+    }
+
+    WorkerPool::Placement placement;
+    auto session_options = options_.endpoint;
+    if (worker) {
+      placement = options_.workers->Place(*worker);
+      session_options.handler_affinity.enabled = true;
+      session_options.handler_affinity.load = placement.HandlerLoad();
+    }
+    auto endpoint = std::make_shared<RpcEndpoint>(
+        executor, std::move(*accepted), dispatcher_,
+        std::move(session_options), logger_);
+    if (auto started = co_await endpoint->Start(); !started) {
+      JSONRPC_LOG_WARN(
+          Logger(), "RpcServer failed to start session: {}",
+          started.error().Message());
+      connection_count_.fetch_sub(1);
+      continue;
+    }
+
+    co_await utils::SwitchTo(strand_);
+    if (!is_running_) {
+      // Shutdown() already swept the sessions
+      co_await endpoint->Shutdown();
+      connection_count_.fetch_sub(1);
+      break;
+    }
+
+    auto id = next_session_id_++;
+    sessions_.emplace(
+        id, Session{endpoint, executor, std::move(placement)});
+    ++active_tasks_;
+    JSONRPC_LOG_DEBUG(
+        Logger(), "RpcServer opened session {}, {} open", id,
+        connection_count_.load());
+    asio::co_spawn(
+        executor, RunSession(id, std::move(endpoint)), asio::detached);
+  }
+}
+
+auto RpcServer::RunSession(uint64_t id, std::shared_ptr<RpcEndpoint> endpoint)
+    -> asio::awaitable<void> {
+  // Returns when the peer disconnects or the session is shut down
+  co_await endpoint->WaitForShutdown();
+  co_await endpoint->Shutdown();
+  co_await endpoint->WaitForHandlers();
+
+  co_await utils::SwitchTo(strand_);
+  sessions_.erase(id);
+  connection_count_.fetch_sub(1);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "RpcServer closed session {}, {} open", id,
+      connection_count_.load());
+  TaskFinished();
+}
+
+auto RpcServer::ReapIdleSessions() -> asio::awaitable<void> {
+  auto idle_timeout = *options_.idle_timeout;
+  auto interval = std::max<Clock::duration>(idle_timeout / 2, kMinReapInterval);
+
+  while (is_running_) {
+    reap_timer_.expires_after(interval);
+    std::error_code ec;
+    co_await reap_timer_.async_wait(asio::redirect_error(
+        asio::bind_executor(strand_, asio::use_awaitable), ec));
+    if (!is_running_) {
+      break;
+    }
+
+    auto now = Clock::now();
+    for (const auto &[id, session] : sessions_) {
+      const auto &endpoint = session.endpoint;
+      if (endpoint->HasPendingRequests() || endpoint->HasActiveHandlers() ||
+          now - endpoint->LastActivity() < idle_timeout) {
+        continue;
+      }
+      JSONRPC_LOG_DEBUG(Logger(), "RpcServer closing idle session {}", id);
+      ShutdownSession(session);
+    }
+  }
+}
+
+void RpcServer::ShutdownSession(const Session &session) {
+  // RunSession() notices the end of the message loop and cleans up
+  asio::co_spawn(
+      session.executor,
+      [endpoint = session.endpoint]() -> asio::awaitable<void> {
+        co_await endpoint->Shutdown();
+      },
+      asio::detached);
+}
+
+void RpcServer::TaskFinished() {
+  asio::post(strand_, [this] {
+    if (--active_tasks_ == 0) {
+      state_changed_.cancel();
+    }
+  });
+}
+
+void RpcServer::RegisterMethodCall(
+    std::string method, typename Dispatcher::MethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterMethodCall(method, handler, options);
+}
+
+void RpcServer::RegisterNotification(
+    std::string method, typename Dispatcher::NotificationHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterNotification(method, handler, options);
+}
+
+void RpcServer::RegisterLazyMethodCall(
+    std::string method, typename Dispatcher::LazyMethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterLazyMethodCall(method, std::move(handler), options);
+}
+
+void RpcServer::RegisterLazyNotification(
+    std::string method, typename Dispatcher::LazyNotificationHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterLazyNotification(method, std::move(handler), options);
+}
+
+void RpcServer::RegisterStreamingMethodCall(
+    std::string method, typename Dispatcher::StreamingMethodCallHandler handler,
+    HandlerOptions options) {
+  dispatcher_->RegisterStreamingMethodCall(method, std::move(handler), options);
+}
+
+}  // namespace jsonrpc::endpoint
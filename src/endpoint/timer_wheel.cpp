@@ -0,0 +1,115 @@
+#include "jsonrpc/endpoint/timer_wheel.hpp"
+
+#include <algorithm>
+
+namespace jsonrpc::endpoint {
+
+TimerWheel::TimerWheel(
+    asio::strand<asio::any_io_executor> strand, std::chrono::milliseconds tick,
+    std::size_t slot_count, ExpiryHandler on_expiry)
+    : timer_(std::move(strand)),
+      tick_(std::max(tick, std::chrono::milliseconds(1))),
+      slots_(std::max<std::size_t>(slot_count, 1)),
+      on_expiry_(std::move(on_expiry)),
+      origin_(Clock::now()) {
+}
+
+auto TimerWheel::TickFor(Clock::time_point time) const -> uint64_t {
+  if (time <= origin_) {
+    return 0;
+  }
+  // Round up so an entry never fires before its deadline
+  auto elapsed = time - origin_;
+  auto ticks = (elapsed + tick_ - Clock::duration(1)) / tick_;
+  return static_cast<uint64_t>(ticks);
+}
+
+void TimerWheel::Schedule(int64_t id, Clock::time_point deadline) {
+  Cancel(id);
+  if (expiry_ticks_.empty() && !armed_) {
+    // Skip the ticks that passed while the wheel was idle
+    auto idle_ticks = static_cast<uint64_t>((Clock::now() - origin_) / tick_);
+    current_tick_ = std::max(current_tick_, idle_ticks);
+  }
+
+  // Anything already due fires on the next tick
+  auto expiry_tick = std::max(TickFor(deadline), current_tick_ + 1);
+  slots_[expiry_tick % slots_.size()].push_back({id, expiry_tick});
+  expiry_ticks_.emplace(id, expiry_tick);
+  Arm();
+}
+
+void TimerWheel::Cancel(int64_t id) {
+  auto found = expiry_ticks_.find(id);
+  if (found == expiry_ticks_.end()) {
+    return;
+  }
+  auto& slot = slots_[found->second % slots_.size()];
+  auto entry = std::ranges::find_if(
+      slot, [id](const Entry& e) { return e.id == id; });
+  *entry = slot.back();
+  slot.pop_back();
+  expiry_ticks_.erase(found);
+
+  if (expiry_ticks_.empty() && armed_) {
+    armed_ = false;
+    timer_.cancel();
+  }
+}
+
+void TimerWheel::Stop() {
+  for (auto& slot : slots_) {
+    slot.clear();
+  }
+  expiry_ticks_.clear();
+  armed_ = false;
+  timer_.cancel();
+}
+
+void TimerWheel::Arm() {
+  if (armed_ || expiry_ticks_.empty()) {
+    return;
+  }
+  armed_ = true;
+
+  timer_.expires_at(
+      origin_ + static_cast<int64_t>(current_tick_ + 1) * tick_);
+  timer_.async_wait([this](std::error_code ec) {
+    // Do not touch members when cancelled, the wheel may be gone
+    if (ec) {
+      return;
+    }
+    armed_ = false;
+    Advance();
+    Arm();
+  });
+}
+
+void TimerWheel::Advance() {
+  auto now_tick = TickFor(Clock::now());
+  if (now_tick <= current_tick_) {
+    return;
+  }
+
+  // Visit each slot at most once, even after a long stall
+  auto steps = std::min<uint64_t>(now_tick - current_tick_, slots_.size());
+  std::vector<int64_t> expired;
+  for (uint64_t step = 1; step <= steps; ++step) {
+    auto& slot = slots_[(current_tick_ + step) % slots_.size()];
+    auto it = std::partition(slot.begin(), slot.end(), [now_tick](auto e) {
+      return e.expiry_tick > now_tick;
+    });
+    for (auto expired_it = it; expired_it != slot.end(); ++expired_it) {
+      expired.push_back(expired_it->id);
+      expiry_ticks_.erase(expired_it->id);
+    }
+    slot.erase(it, slot.end());
+  }
+  current_tick_ = now_tick;
+
+  for (auto id : expired) {
+    on_expiry_(id);
+  }
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,166 @@
+#include "jsonrpc/endpoint/traffic_capture.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "jsonrpc/utils/strand.hpp"
+
+namespace jsonrpc::endpoint {
+
+namespace {
+
+constexpr std::string_view kIncomingName = "in";
+constexpr std::string_view kOutgoingName = "out";
+
+auto IsMessage(const nlohmann::json& value) -> bool {
+  return value.is_object() &&
+         (value.contains("method") || value.contains("result") ||
+          value.contains("error"));
+}
+
+}  // namespace
+
+auto TrafficCapture::Create(
+    asio::any_io_executor executor, const std::string& path,
+    CaptureOptions options)
+    -> std::expected<std::shared_ptr<TrafficCapture>, error::RpcError> {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return error::RpcError::UnexpectedFromCode(
+        error::RpcErrorCode::kInternalError,
+        "Cannot open capture file " + path);
+  }
+  // The constructor is private, so make_shared cannot reach it
+  return std::shared_ptr<TrafficCapture>(
+      new TrafficCapture(std::move(executor), std::move(file), options));
+}
+
+TrafficCapture::TrafficCapture(
+    asio::any_io_executor executor, std::ofstream file,
+    CaptureOptions options)
+    : strand_(asio::make_strand(std::move(executor))),
+      options_(options),
+      file_(std::move(file)) {
+  buffer_.reserve(options_.buffer_bytes);
+}
+
+TrafficCapture::~TrafficCapture() {
+  // Every posted line holds a reference, so all of them are in the buffer
+  WriteOut();
+}
+
+auto TrafficCapture::ShouldRecord(CaptureDirection direction) -> bool {
+  if (direction == CaptureDirection::kOutgoing && !options_.outgoing) {
+    return false;
+  }
+  if (options_.sample_one_in <= 1) {
+    return true;
+  }
+  return sampled_.fetch_add(1, std::memory_order_relaxed) %
+             options_.sample_one_in ==
+         0;
+}
+
+void TrafficCapture::Record(
+    CaptureDirection direction, std::uint64_t peer, std::string_view message) {
+  if (message.empty()) {
+    return;
+  }
+  const auto at = std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - started_);
+
+  std::string line;
+  line.reserve(message.size() + 64);
+  line += R"({"t_us":)";
+  line += std::to_string(at.count());
+  line += R"(,"dir":")";
+  line += direction == CaptureDirection::kIncoming ? kIncomingName
+                                                   : kOutgoingName;
+  line += R"(","peer":)";
+  line += std::to_string(peer);
+  line += R"(,"message":)";
+  const auto body = line.size();
+  line += message;
+  // Raw newlines in valid JSON can only be whitespace between tokens, so
+  // blanking them keeps the message intact on one line
+  std::replace_if(
+      line.begin() + static_cast<std::ptrdiff_t>(body), line.end(),
+      [](char c) { return c == '\n' || c == '\r'; }, ' ');
+  line += "}\n";
+
+  const auto size = line.size();
+  if (pending_bytes_.fetch_add(size, std::memory_order_relaxed) + size >
+      options_.max_pending_bytes) {
+    pending_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  recorded_.fetch_add(1, std::memory_order_relaxed);
+  asio::post(
+      strand_, [self = shared_from_this(), line = std::move(line)]() mutable {
+        self->Append(std::move(line));
+      });
+}
+
+auto TrafficCapture::Flush() -> asio::awaitable<void> {
+  // Lines posted before this hop are ahead of it on the strand
+  co_await utils::SwitchTo(strand_);
+  WriteOut();
+  file_.flush();
+}
+
+void TrafficCapture::Append(std::string line) {
+  buffer_ += line;
+  if (buffer_.size() >= options_.buffer_bytes) {
+    WriteOut();
+  }
+}
+
+void TrafficCapture::WriteOut() {
+  if (buffer_.empty()) {
+    return;
+  }
+  file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  pending_bytes_.fetch_sub(buffer_.size(), std::memory_order_relaxed);
+  buffer_.clear();
+}
+
+auto TrafficCapture::ParseLine(std::string_view line)
+    -> std::optional<CapturedMessage> {
+  auto value = nlohmann::json::parse(line, nullptr, false);
+  if (value.is_discarded()) {
+    return std::nullopt;
+  }
+
+  if (value.is_object() && value.contains("message") &&
+      value.contains("dir")) {
+    CapturedMessage captured;
+    const auto at = value.find("t_us");
+    if (at != value.end() && at->is_number_integer()) {
+      captured.at = std::chrono::microseconds(at->get<std::int64_t>());
+    }
+    const auto peer = value.find("peer");
+    if (peer != value.end() && peer->is_number_unsigned()) {
+      captured.peer = peer->get<std::uint64_t>();
+    }
+    captured.direction = value["dir"] == kOutgoingName
+                             ? CaptureDirection::kOutgoing
+                             : CaptureDirection::kIncoming;
+    captured.message = std::move(value["message"]);
+    return captured;
+  }
+
+  const bool is_batch =
+      value.is_array() && !value.empty() &&
+      std::ranges::all_of(value, [](const auto& entry) {
+        return IsMessage(entry);
+      });
+  if (!IsMessage(value) && !is_batch) {
+    return std::nullopt;
+  }
+  CapturedMessage captured;
+  captured.message = std::move(value);
+  return captured;
+}
+
+}  // namespace jsonrpc::endpoint
@@ -0,0 +1,228 @@
+#include "jsonrpc/endpoint/traffic_replay.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <utility>
+
+namespace jsonrpc::endpoint {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+}  // namespace
+
+// Only touched on the run's strand
+struct TrafficReplay::RunState {
+  struct Method {
+    LatencyHistogram latency;
+    std::uint64_t sent = 0;
+    std::uint64_t errors = 0;
+    ResourceCounters resources;
+  };
+
+  explicit RunState(const asio::any_io_executor& executor)
+      : slot_freed(executor) {
+  }
+
+  // Wakes on the next completed message; the caller checks in_flight again
+  auto WaitForSlot() -> asio::awaitable<void> {
+    slot_freed.expires_at(asio::steady_timer::time_point::max());
+    std::error_code ec;
+    co_await slot_freed.async_wait(
+        asio::redirect_error(asio::use_awaitable, ec));
+  }
+
+  std::size_t in_flight = 0;
+  asio::steady_timer slot_freed;
+  std::map<std::string, Method> methods;
+};
+
+TrafficReplay::TrafficReplay(std::vector<CapturedMessage> messages) {
+  messages_.reserve(messages.size());
+  for (auto& captured : messages) {
+    Add(std::move(captured));
+  }
+}
+
+auto TrafficReplay::Load(std::istream& input) -> TrafficReplay {
+  TrafficReplay replay(std::vector<CapturedMessage>{});
+  std::string line;
+  while (std::getline(input, line)) {
+    if (std::ranges::all_of(line, [](unsigned char c) {
+          return std::isspace(c) != 0;
+        })) {
+      continue;
+    }
+    auto captured = TrafficCapture::ParseLine(line);
+    if (!captured) {
+      ++replay.skipped_;
+      continue;
+    }
+    replay.Add(std::move(*captured));
+  }
+  return replay;
+}
+
+auto TrafficReplay::LoadFile(const std::string& path)
+    -> std::expected<TrafficReplay, error::RpcError> {
+  std::ifstream file(path);
+  if (!file) {
+    return error::RpcError::UnexpectedFromCode(
+        error::RpcErrorCode::kInternalError,
+        "Cannot open capture file " + path);
+  }
+  return Load(file);
+}
+
+void TrafficReplay::Add(CapturedMessage captured) {
+  if (captured.direction == CaptureDirection::kOutgoing) {
+    ++skipped_;
+    return;
+  }
+  if (captured.message.is_array()) {
+    for (auto& entry : captured.message) {
+      Add(CapturedMessage{
+          .at = captured.at,
+          .direction = captured.direction,
+          .peer = captured.peer,
+          .message = std::move(entry)});
+    }
+    return;
+  }
+  // Encoding negotiation belongs to the replaying client's own handshake
+  const auto& message = captured.message;
+  const auto method = message.is_object() ? message.find("method")
+                                          : message.end();
+  if (method == message.end() || !method->is_string() ||
+      method->get_ref<const std::string&>() == kNegotiateEncodingMethod) {
+    ++skipped_;
+    return;
+  }
+  messages_.push_back(std::move(captured));
+}
+
+auto TrafficReplay::Run(RpcEndpoint& client, ReplayOptions options) const
+    -> asio::awaitable<ReplayReport> {
+  // Every message of the run completes on one strand, so the counters need
+  // no locks whatever threads the client's executor has
+  auto strand = asio::make_strand(co_await asio::this_coro::executor);
+  co_return co_await asio::co_spawn(
+      strand, RunOnStrand(client, options), asio::use_awaitable);
+}
+
+auto TrafficReplay::RunOnStrand(
+    RpcEndpoint& client, const ReplayOptions& options) const
+    -> asio::awaitable<ReplayReport> {
+  auto executor = co_await asio::this_coro::executor;
+  RunState run(executor);
+  asio::steady_timer pace(executor);
+  const auto max_in_flight = std::max<std::size_t>(1, options.max_in_flight);
+  const auto speed = options.speed > 0 ? options.speed : 1.0;
+  const auto first_at =
+      messages_.empty() ? std::chrono::microseconds(0) : messages_.front().at;
+  const auto span =
+      messages_.empty() ? std::chrono::microseconds(0)
+                        : messages_.back().at - first_at;
+
+  std::optional<ResourceCounters> before;
+  if (options.counters) {
+    before = options.counters();
+  }
+  const auto start = Clock::now();
+  std::uint64_t index = 0;
+  for (std::size_t loop = 0; loop < options.loops; ++loop) {
+    for (const auto& captured : messages_) {
+      std::optional<Clock::time_point> due;
+      if (options.recorded_timing) {
+        const auto offset =
+            captured.at - first_at +
+            span * static_cast<std::chrono::microseconds::rep>(loop);
+        due = start + std::chrono::duration_cast<Clock::duration>(
+                          std::chrono::duration<double, std::micro>(
+                              static_cast<double>(offset.count()) / speed));
+      } else if (options.rate > 0) {
+        due = start + std::chrono::duration_cast<Clock::duration>(
+                          std::chrono::duration<double>(
+                              static_cast<double>(index) / options.rate));
+      }
+      if (due && *due > Clock::now()) {
+        pace.expires_at(*due);
+        std::error_code ec;
+        co_await pace.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+      }
+
+      while (run.in_flight >= max_in_flight) {
+        co_await run.WaitForSlot();
+      }
+      ++run.in_flight;
+      ++index;
+      asio::co_spawn(
+          executor, Send(client, captured.message, run, options),
+          asio::detached);
+    }
+  }
+  while (run.in_flight > 0) {
+    co_await run.WaitForSlot();
+  }
+
+  ReplayReport report;
+  report.elapsed = Clock::now() - start;
+  if (before) {
+    report.resources = options.counters() - *before;
+  }
+  const bool per_message = options.counters && max_in_flight == 1;
+  for (auto& [name, method] : run.methods) {
+    MethodReplayReport entry;
+    entry.sent = method.sent;
+    entry.errors = method.errors;
+    entry.latency = method.latency.Snapshot();
+    if (per_message) {
+      entry.resources = method.resources;
+    }
+    report.sent += method.sent;
+    report.errors += method.errors;
+    report.methods.emplace(name, std::move(entry));
+  }
+  co_return report;
+}
+
+auto TrafficReplay::Send(
+    RpcEndpoint& client, const nlohmann::json& message, RunState& run,
+    const ReplayOptions& options) const -> asio::awaitable<void> {
+  const auto& name = message["method"].get_ref<const std::string&>();
+  std::optional<nlohmann::json> params;
+  if (auto found = message.find("params"); found != message.end()) {
+    params = *found;
+  }
+  const bool per_message = options.counters && options.max_in_flight <= 1;
+  ResourceCounters before;
+  if (per_message) {
+    before = options.counters();
+  }
+
+  const auto start = Clock::now();
+  bool succeeded = false;
+  if (message.contains("id")) {
+    auto result = co_await client.SendMethodCall(name, std::move(params));
+    succeeded = result.has_value();
+  } else {
+    auto result = co_await client.SendNotification(name, std::move(params));
+    succeeded = result.has_value();
+  }
+
+  auto& method = run.methods[name];
+  method.latency.Record(Clock::now() - start);
+  ++method.sent;
+  if (!succeeded) {
+    ++method.errors;
+  }
+  if (per_message) {
+    method.resources += options.counters() - before;
+  }
+  --run.in_flight;
+  run.slot_freed.cancel();
+}
+
+}  // namespace jsonrpc::endpoint
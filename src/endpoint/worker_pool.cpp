@@ -0,0 +1,222 @@
+#include "jsonrpc/endpoint/worker_pool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::endpoint {
+
+struct WorkerPool::Worker {
+  explicit Worker(std::size_t index)
+      : index(index), io_context(1), guard(asio::make_work_guard(io_context)) {
+  }
+
+  std::size_t index;
+  asio::io_context io_context;
+  asio::executor_work_guard<asio::io_context::executor_type> guard;
+  std::thread thread;
+  std::optional<int> cpu;
+
+  std::atomic<std::size_t> connections{0};
+  std::shared_ptr<std::atomic<std::size_t>> handler_load =
+      std::make_shared<std::atomic<std::size_t>>(0);
+};
+
+namespace {
+
+// Parses one number of a CPU list, or fails on anything but digits
+auto ParseCpu(std::string_view text) -> std::optional<int> {
+  int cpu = 0;
+  const auto* end = text.data() + text.size();
+  auto [parsed_end, ec] = std::from_chars(text.data(), end, cpu);
+  if (ec != std::errc{} || parsed_end != end || text.empty()) {
+    return std::nullopt;
+  }
+  return cpu;
+}
+
+auto PinToCpu(std::thread& thread, int cpu) -> bool {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) ==
+         0;
+#else
+  (void)thread;
+  (void)cpu;
+  return false;
+#endif
+}
+
+}  // namespace
+
+WorkerPool::Placement::~Placement() {
+  if (worker_) {
+    worker_->connections.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+auto WorkerPool::Placement::operator=(Placement&& other) noexcept
+    -> Placement& {
+  if (this != &other) {
+    if (worker_) {
+      worker_->connections.fetch_sub(1, std::memory_order_relaxed);
+    }
+    worker_ = std::move(other.worker_);
+  }
+  return *this;
+}
+
+auto WorkerPool::Placement::GetExecutor() const -> asio::any_io_executor {
+  return worker_->io_context.get_executor();
+}
+
+auto WorkerPool::Placement::Index() const -> std::size_t {
+  return worker_->index;
+}
+
+auto WorkerPool::Placement::HandlerLoad() const
+    -> std::shared_ptr<std::atomic<std::size_t>> {
+  return worker_->handler_load;
+}
+
+WorkerPool::WorkerPool(
+    WorkerPoolOptions options, std::shared_ptr<spdlog::logger> logger)
+    : logger_(logger ? logger : spdlog::default_logger()) {
+  auto threads = options.threads;
+  if (threads == 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  auto cpus = std::move(options.cpus);
+  if (options.pin_threads && cpus.empty()) {
+    cpus = CpusByNumaNode();
+  }
+
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    auto worker = std::make_shared<Worker>(i);
+    worker->thread = std::thread([&io_context = worker->io_context] {
+      io_context.run();
+    });
+    if (options.pin_threads && !cpus.empty()) {
+      const auto cpu = cpus[i % cpus.size()];
+      if (PinToCpu(worker->thread, cpu)) {
+        worker->cpu = cpu;
+      } else {
+        JSONRPC_LOG_WARN(
+            Logger(), "WorkerPool could not pin worker {} to CPU {}", i, cpu);
+      }
+    }
+    workers_.push_back(std::move(worker));
+  }
+  JSONRPC_LOG_DEBUG(Logger(), "WorkerPool started {} workers", threads);
+}
+
+WorkerPool::~WorkerPool() {
+  Stop();
+}
+
+void WorkerPool::Stop() {
+  for (const auto& worker : workers_) {
+    worker->guard.reset();
+  }
+  for (const auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+auto WorkerPool::GetExecutor(std::size_t index) const
+    -> asio::any_io_executor {
+  return workers_[index]->io_context.get_executor();
+}
+
+auto WorkerPool::Connections(std::size_t index) const -> std::size_t {
+  return workers_[index]->connections.load(std::memory_order_relaxed);
+}
+
+auto WorkerPool::Cpu(std::size_t index) const -> std::optional<int> {
+  return workers_[index]->cpu;
+}
+
+auto WorkerPool::LeastLoaded() const -> std::size_t {
+  std::size_t index = 0;
+  for (std::size_t i = 1; i < workers_.size(); ++i) {
+    if (Connections(i) < Connections(index)) {
+      index = i;
+    }
+  }
+  return index;
+}
+
+auto WorkerPool::Place(std::size_t index) -> Placement {
+  workers_[index]->connections.fetch_add(1, std::memory_order_relaxed);
+  return Placement(workers_[index]);
+}
+
+auto WorkerPool::CpusByNumaNode() -> std::vector<int> {
+  std::vector<int> cpus;
+#ifdef __linux__
+  for (int node = 0;; ++node) {
+    const auto path = std::filesystem::path("/sys/devices/system/node") /
+                      ("node" + std::to_string(node)) / "cpulist";
+    std::ifstream file(path);
+    if (!file) {
+      break;
+    }
+    std::string list;
+    std::getline(file, list);
+    for (auto cpu : ParseCpuList(list)) {
+      cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const auto count = std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < count; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+auto WorkerPool::ParseCpuList(std::string_view list) -> std::vector<int> {
+  std::vector<int> cpus;
+  while (!list.empty()) {
+    auto comma = list.find(',');
+    auto part = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view{}
+                                           : list.substr(comma + 1);
+    while (!part.empty() && std::isspace(static_cast<unsigned char>(
+                                part.back()))) {
+      part.remove_suffix(1);
+    }
+
+    auto dash = part.find('-');
+    auto first = ParseCpu(part.substr(0, dash));
+    auto last = dash == std::string_view::npos
+                    ? first
+                    : ParseCpu(part.substr(dash + 1));
+    if (!first || !last || *last < *first) {
+      continue;
+    }
+    for (int cpu = *first; cpu <= *last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+}  // namespace jsonrpc::endpoint
@@ -4,45 +4,79 @@
 
 namespace jsonrpc::transport {
 
-using error::RpcError;
-using error::RpcErrorCode;
+namespace {
+// The base transport carries the Content-Length frames as raw bytes
+auto WithoutFraming(TransportOptions options) -> TransportOptions {
+  options.framing = Framing::kNone;
+  return options;
+}
+}  // namespace
 
 FramedPipeTransport::FramedPipeTransport(
     asio::any_io_executor executor, const std::string& socket_path,
     bool is_server, std::shared_ptr<spdlog::logger> logger)
-    : PipeTransport(std::move(executor), socket_path, is_server, logger) {
+    : FramedPipeTransport(
+          std::move(executor), socket_path, is_server, TransportOptions{},
+          std::move(logger)) {
+}
+
+FramedPipeTransport::FramedPipeTransport(
+    asio::any_io_executor executor, const std::string& socket_path,
+    bool is_server, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : PipeTransport(
+          std::move(executor), socket_path, is_server, WithoutFraming(options),
+          std::move(logger)),
+      reader_(options, MessageStorage(), compressor_, Logger()) {
+}
+
+FramedPipeTransport::FramedPipeTransport(
+    asio::local::stream_protocol::socket socket, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : PipeTransport(
+          std::move(socket), WithoutFraming(options), std::move(logger)),
+      reader_(options, MessageStorage(), compressor_, Logger()) {
 }
 
 auto FramedPipeTransport::SendMessage(std::string message)
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  auto framed_message = MessageFramer::Frame(message);
-  co_return co_await PipeTransport::SendMessage(std::move(framed_message));
+  co_return co_await SendEncodedMessage(
+      std::move(message), MessageEncoding::kJson);
+}
+
+auto FramedPipeTransport::SendEncodedMessage(
+    std::string message, MessageEncoding encoding)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_return co_await SendMessageWithHints(
+      std::move(message), encoding, SendHints{});
+}
+
+auto FramedPipeTransport::SendMessageWithHints(
+    std::string message, MessageEncoding encoding, SendHints hints)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  // Compression contexts are per connection, so compress on the strand
+  co_await SwitchToStrand();
+  auto coding =
+      compressor_.CompressIfWorthwhile(message, Options().compression);
+
+  // The header goes out as its own buffer, so the body is not copied
+  auto header = MessageFramer::FrameHeader(
+      message.size(), MessageFramer::ContentTypeFor(encoding), coding);
+  co_return co_await SendFrame(
+      {.header = std::move(header),
+       .body = std::move(message),
+       .hints = std::move(hints)});
 }
 
 auto FramedPipeTransport::ReceiveMessage()
     -> asio::awaitable<std::expected<std::string, error::RpcError>> {
-  while (true) {
-    // Try to deframe from existing buffer
-    auto result = framer_.TryDeframe(read_buffer_);
-    if (result.complete) {
-      read_buffer_.erase(0, result.consumed_bytes);
-      co_return result.message;
-    }
-
-    if (!result.error.empty()) {
-      Logger()->error("Framing error: {}", result.error);
-      co_return RpcError::UnexpectedFromCode(
-          RpcErrorCode::kTransportError, "Framing error: " + result.error);
-    }
-
-    // Get more data using base class receive
-    auto chunk_result = co_await PipeTransport::ReceiveMessage();
-    if (!chunk_result) {
-      co_return chunk_result;
-    }
-
-    read_buffer_ += *chunk_result;  // append new data
+  auto message = co_await reader_.Receive(
+      [this](asio::mutable_buffer buffer) { return ReadSome(buffer); });
+  if (!message && reader_.IsCorrupt()) {
+    CountFramingError();
+    MarkDisconnected();
   }
+  co_return message;
 }
 
 }  // namespace jsonrpc::transport
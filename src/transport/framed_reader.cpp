@@ -0,0 +1,103 @@
+#include "jsonrpc/transport/framed_reader.hpp"
+
+#include <cstring>
+
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::RpcError;
+using error::RpcErrorCode;
+
+FramedReader::FramedReader(
+    const TransportOptions& options, MessagePool& pool,
+    MessageCompressor& compressor, std::shared_ptr<spdlog::logger> logger)
+    : pool_(pool),
+      compressor_(compressor),
+      logger_(std::move(logger)),
+      read_size_(options.min_read_buffer_size, options.max_read_buffer_size),
+      framer_(options.max_message_size) {
+}
+
+auto FramedReader::Receive(ReadSome read_some)
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  corrupt_ = false;
+  while (true) {
+    auto result = framer_.TryDeframe(read_buffer_.Data());
+    if (result.complete) {
+      last_encoding_ = result.encoding;
+      auto message = pool_.Acquire(result.message);
+      read_buffer_.Consume(result.consumed_bytes);
+      read_buffer_.ShrinkTo(2 * read_size_.Next());
+      co_return Decode(std::move(message), result.coding);
+    }
+
+    if (!result.error.empty()) {
+      JSONRPC_LOG_ERROR(logger_, "Framing error: {}", result.error);
+      corrupt_ = true;
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Framing error: " + result.error);
+    }
+
+    // Skip the read buffer when most of a large body is still to come
+    if (auto body_size = framer_.ExpectedBodySize()) {
+      auto buffered = read_buffer_.Size() - framer_.HeaderSize();
+      if (*body_size - buffered > read_size_.Next()) {
+        co_return co_await ReceiveLargeBody(
+            read_some, framer_.HeaderSize(), *body_size);
+      }
+    }
+
+    auto read_size = read_size_.Next();
+    auto bytes_read = co_await read_some(
+        asio::buffer(read_buffer_.Prepare(read_size), read_size));
+    if (!bytes_read) {
+      co_return std::unexpected(bytes_read.error());
+    }
+    read_buffer_.Commit(*bytes_read);
+    read_size_.Record(*bytes_read);
+  }
+}
+
+auto FramedReader::ReceiveLargeBody(
+    const ReadSome& read_some, std::size_t header_size, std::size_t body_size)
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  // Everything buffered after the headers is the start of the body
+  auto buffered = read_buffer_.Data().substr(header_size);
+
+  auto message = pool_.Acquire(body_size);
+  std::memcpy(message.data(), buffered.data(), buffered.size());
+  std::size_t filled = buffered.size();
+  read_buffer_.Clear();
+  last_encoding_ = framer_.Encoding();
+  auto coding = framer_.Coding();
+  framer_.Reset();
+
+  while (filled < body_size) {
+    auto bytes_read = co_await read_some(
+        asio::buffer(message.data() + filled, body_size - filled));
+    if (!bytes_read) {
+      co_return std::unexpected(bytes_read.error());
+    }
+    filled += *bytes_read;
+  }
+
+  co_return Decode(std::move(message), coding);
+}
+
+auto FramedReader::Decode(std::string body, ContentCoding coding)
+    -> std::expected<std::string, error::RpcError> {
+  if (coding == ContentCoding::kIdentity) {
+    return body;
+  }
+  auto message =
+      compressor_.Decompress(body, coding, framer_.MaxMessageSize());
+  pool_.Release(std::move(body));
+  if (!message) {
+    JSONRPC_LOG_ERROR(
+        logger_, "Decompression error: {}", message.error().Message());
+  }
+  return message;
+}
+
+}  // namespace jsonrpc::transport
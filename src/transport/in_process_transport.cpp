@@ -0,0 +1,164 @@
+#include "jsonrpc/transport/in_process_transport.hpp"
+
+#include <string>
+
+#include <asio/use_awaitable.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+auto InProcessTransport::CreatePair(
+    asio::any_io_executor first_executor,
+    asio::any_io_executor second_executor, std::size_t capacity,
+    std::shared_ptr<spdlog::logger> logger) -> Pair {
+  auto link =
+      std::make_shared<Link>(first_executor, second_executor, capacity);
+  // The constructor is private, so make_unique cannot reach it
+  return {
+      std::unique_ptr<InProcessTransport>(new InProcessTransport(
+          std::move(first_executor), link, true, logger)),
+      std::unique_ptr<InProcessTransport>(new InProcessTransport(
+          std::move(second_executor), link, false, logger))};
+}
+
+auto InProcessTransport::CreatePair(
+    asio::any_io_executor executor, std::size_t capacity,
+    std::shared_ptr<spdlog::logger> logger) -> Pair {
+  return CreatePair(executor, executor, capacity, std::move(logger));
+}
+
+InProcessTransport::InProcessTransport(
+    asio::any_io_executor executor, std::shared_ptr<Link> link,
+    bool is_first, std::shared_ptr<spdlog::logger> logger)
+    : Transport(std::move(executor), std::move(logger)),
+      link_(std::move(link)),
+      is_first_(is_first) {
+}
+
+InProcessTransport::~InProcessTransport() {
+  if (!is_closed_) {
+    CloseNow();
+  }
+}
+
+auto InProcessTransport::Start()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_started_) {
+    JSONRPC_LOG_DEBUG(Logger(), "InProcessTransport already started");
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "InProcessTransport already started");
+  }
+
+  if (is_closed_) {
+    JSONRPC_LOG_ERROR(
+        Logger(), "InProcessTransport cannot start a closed transport");
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot start a closed transport");
+  }
+
+  is_started_ = true;
+  JSONRPC_LOG_DEBUG(Logger(), "InProcessTransport started");
+  co_return Ok();
+}
+
+auto InProcessTransport::Close()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  if (!is_closed_) {
+    CloseNow();
+  }
+  co_return Ok();
+}
+
+void InProcessTransport::CloseNow() {
+  if (is_closed_.exchange(true)) {
+    return;
+  }
+  is_started_ = false;
+  CloseLink();
+  JSONRPC_LOG_DEBUG(Logger(), "InProcessTransport closed");
+}
+
+void InProcessTransport::CloseLink() {
+  link_->is_open = false;
+  // A closed channel still hands out what it buffered, so the peer reads
+  // every message sent before the close
+  Outgoing().close();
+  Incoming().close();
+}
+
+auto InProcessTransport::SendMessage(std::string message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (!is_started_ || is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        is_closed_ ? "Cannot send on closed transport"
+                   : "Cannot send before transport is started");
+  }
+
+  // try_send only takes the message when it succeeds, so a full channel
+  // leaves it for the waiting send below
+  if (Outgoing().try_send(std::error_code{}, std::move(message))) {
+    co_return Ok();
+  }
+
+  std::error_code ec;
+  co_await Outgoing().async_send(
+      std::error_code{}, std::move(message),
+      asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "InProcessTransport send failed: {}", ec.message());
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Peer closed the link");
+  }
+  co_return Ok();
+}
+
+auto InProcessTransport::Flush(
+    std::optional<std::chrono::milliseconds> /*timeout*/)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot flush a closed transport");
+  }
+  co_return Ok();
+}
+
+auto InProcessTransport::ReceiveMessage()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "ReceiveMessage called after transport was closed");
+  }
+
+  if (!is_started_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Transport not started before receiving message");
+  }
+
+  std::error_code ec;
+  auto message = co_await Incoming().async_receive(
+      asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) {
+    // Only a close ends a receive, and every message is in by then
+    link_->is_open = false;
+    JSONRPC_LOG_DEBUG(
+        Logger(), "InProcessTransport receive ended: {}", ec.message());
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Peer closed the link");
+  }
+  co_return message;
+}
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,36 @@
+#include "jsonrpc/transport/line_framer.hpp"
+
+#include <cstring>
+
+namespace jsonrpc::transport {
+
+auto LineFramer::TryDeframe(std::string_view buffer) -> DeframeResult {
+  const void* newline = nullptr;
+  if (scan_offset_ < buffer.size()) {
+    newline = std::memchr(
+        buffer.data() + scan_offset_, '\n', buffer.size() - scan_offset_);
+  }
+
+  if (newline == nullptr) {
+    scan_offset_ = buffer.size();
+    if (buffer.size() > max_message_size_) {
+      return {.error = "Message exceeds maximum size"};
+    }
+    return {};  // Need more data
+  }
+
+  auto line_end = static_cast<std::size_t>(
+      static_cast<const char*>(newline) - buffer.data());
+  auto line = buffer.substr(0, line_end);
+  if (line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+  Reset();
+
+  if (line.size() > max_message_size_) {
+    return {.error = "Message exceeds maximum size"};
+  }
+  return {.complete = true, .message = line, .consumed_bytes = line_end + 1};
+}
+
+}  // namespace jsonrpc::transport
@@ -0,0 +1,305 @@
+#include "jsonrpc/transport/message_compressor.hpp"
+
+#include <utility>
+
+#ifdef JSONRPC_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef JSONRPC_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
+namespace jsonrpc::transport {
+
+using error::RpcError;
+using error::RpcErrorCode;
+
+namespace {
+
+auto CompressionError(std::string message) -> std::unexpected<RpcError> {
+  return RpcError::UnexpectedFromCode(
+      RpcErrorCode::kTransportError, std::move(message));
+}
+
+auto NotBuiltIn(ContentCoding coding) -> std::unexpected<RpcError> {
+  return CompressionError(
+      "Content-Encoding " + std::string(ContentCodingName(coding)) +
+      " is not built in");
+}
+
+auto NoContext() -> std::unexpected<RpcError> {
+  return CompressionError("Failed to allocate a compression context");
+}
+
+auto TooLarge() -> std::unexpected<RpcError> {
+  return CompressionError("Decompressed message exceeds maximum size");
+}
+
+}  // namespace
+
+struct MessageCompressor::Contexts {
+#ifdef JSONRPC_WITH_ZSTD
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> zstd_compress{
+      nullptr, ZSTD_freeCCtx};
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> zstd_decompress{
+      nullptr, ZSTD_freeDCtx};
+#endif
+#ifdef JSONRPC_WITH_LZ4
+  std::unique_ptr<LZ4F_cctx, decltype(&LZ4F_freeCompressionContext)>
+      lz4_compress{nullptr, LZ4F_freeCompressionContext};
+  std::unique_ptr<LZ4F_dctx, decltype(&LZ4F_freeDecompressionContext)>
+      lz4_decompress{nullptr, LZ4F_freeDecompressionContext};
+#endif
+};
+
+namespace {
+
+#ifdef JSONRPC_WITH_ZSTD
+auto ZstdCompress(ZSTD_CCtx& context, std::string_view body, int level)
+    -> std::expected<std::string, RpcError> {
+  // Zero selects zstd's default level
+  ZSTD_CCtx_setParameter(&context, ZSTD_c_compressionLevel, level);
+  std::string compressed(ZSTD_compressBound(body.size()), '\0');
+  auto size = ZSTD_compress2(
+      &context, compressed.data(), compressed.size(), body.data(),
+      body.size());
+  if (ZSTD_isError(size) != 0) {
+    return CompressionError(
+        std::string("zstd compression failed: ") + ZSTD_getErrorName(size));
+  }
+  compressed.resize(size);
+  return compressed;
+}
+
+auto ZstdDecompress(
+    ZSTD_DCtx& context, std::string_view body, std::size_t max_size)
+    -> std::expected<std::string, RpcError> {
+  // Frames written by ZSTD_compress2 record their decompressed size
+  auto content_size = ZSTD_getFrameContentSize(body.data(), body.size());
+  if (content_size == ZSTD_CONTENTSIZE_ERROR ||
+      content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return CompressionError("Invalid zstd frame");
+  }
+  if (content_size > max_size) {
+    return TooLarge();
+  }
+  std::string message(content_size, '\0');
+  auto size = ZSTD_decompressDCtx(
+      &context, message.data(), message.size(), body.data(), body.size());
+  if (ZSTD_isError(size) != 0 || size != content_size) {
+    return CompressionError("Invalid zstd frame");
+  }
+  return message;
+}
+#endif
+
+#ifdef JSONRPC_WITH_LZ4
+auto Lz4Compress(LZ4F_cctx& context, std::string_view body, int level)
+    -> std::expected<std::string, RpcError> {
+  LZ4F_preferences_t preferences{};
+  preferences.frameInfo.contentSize = body.size();
+  preferences.compressionLevel = level;
+
+  std::string compressed(
+      LZ4F_compressFrameBound(body.size(), &preferences), '\0');
+  auto* out = compressed.data();
+  auto capacity = compressed.size();
+
+  auto header = LZ4F_compressBegin(&context, out, capacity, &preferences);
+  if (LZ4F_isError(header) != 0) {
+    return CompressionError(
+        std::string("LZ4 compression failed: ") + LZ4F_getErrorName(header));
+  }
+  auto written = header;
+  auto data = LZ4F_compressUpdate(
+      &context, out + written, capacity - written, body.data(), body.size(),
+      nullptr);
+  if (LZ4F_isError(data) != 0) {
+    return CompressionError(
+        std::string("LZ4 compression failed: ") + LZ4F_getErrorName(data));
+  }
+  written += data;
+  auto end =
+      LZ4F_compressEnd(&context, out + written, capacity - written, nullptr);
+  if (LZ4F_isError(end) != 0) {
+    return CompressionError(
+        std::string("LZ4 compression failed: ") + LZ4F_getErrorName(end));
+  }
+  compressed.resize(written + end);
+  return compressed;
+}
+
+auto Lz4Decompress(
+    LZ4F_dctx& context, std::string_view body, std::size_t max_size)
+    -> std::expected<std::string, RpcError> {
+  auto fail = [&context]() {
+    // A failed frame leaves the context mid-frame
+    LZ4F_resetDecompressionContext(&context);
+    return CompressionError("Invalid LZ4 frame");
+  };
+
+  LZ4F_frameInfo_t info{};
+  auto consumed = body.size();
+  if (LZ4F_isError(
+          LZ4F_getFrameInfo(&context, &info, body.data(), &consumed)) != 0 ||
+      info.contentSize == 0) {
+    return fail();
+  }
+  if (info.contentSize > max_size) {
+    LZ4F_resetDecompressionContext(&context);
+    return TooLarge();
+  }
+  body.remove_prefix(consumed);
+
+  std::string message(info.contentSize, '\0');
+  std::size_t filled = 0;
+  while (true) {
+    auto out_size = message.size() - filled;
+    auto in_size = body.size();
+    auto hint = LZ4F_decompress(
+        &context, message.data() + filled, &out_size, body.data(), &in_size,
+        nullptr);
+    if (LZ4F_isError(hint) != 0) {
+      return fail();
+    }
+    filled += out_size;
+    body.remove_prefix(in_size);
+    if (hint == 0) {
+      break;  // Frame complete
+    }
+    if (body.empty() || (in_size == 0 && out_size == 0)) {
+      return fail();  // Truncated
+    }
+  }
+  if (filled != message.size()) {
+    return fail();
+  }
+  return message;
+}
+#endif
+
+}  // namespace
+
+MessageCompressor::MessageCompressor()
+    : contexts_(std::make_unique<Contexts>()) {
+}
+
+MessageCompressor::MessageCompressor(MessageCompressor&&) noexcept = default;
+
+auto MessageCompressor::operator=(MessageCompressor&&) noexcept
+    -> MessageCompressor& = default;
+
+MessageCompressor::~MessageCompressor() = default;
+
+auto MessageCompressor::IsAvailable(ContentCoding coding) -> bool {
+  switch (coding) {
+    case ContentCoding::kIdentity:
+      return true;
+    case ContentCoding::kZstd:
+#ifdef JSONRPC_WITH_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    case ContentCoding::kLz4:
+#ifdef JSONRPC_WITH_LZ4
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+auto MessageCompressor::Compress(
+    std::string_view body, ContentCoding coding, [[maybe_unused]] int level)
+    -> std::expected<std::string, RpcError> {
+  switch (coding) {
+    case ContentCoding::kIdentity:
+      return std::string(body);
+    case ContentCoding::kZstd:
+#ifdef JSONRPC_WITH_ZSTD
+      if (!contexts_->zstd_compress) {
+        contexts_->zstd_compress.reset(ZSTD_createCCtx());
+      }
+      if (!contexts_->zstd_compress) {
+        return NoContext();
+      }
+      return ZstdCompress(*contexts_->zstd_compress, body, level);
+#else
+      break;
+#endif
+    case ContentCoding::kLz4:
+#ifdef JSONRPC_WITH_LZ4
+      if (!contexts_->lz4_compress) {
+        LZ4F_cctx* context = nullptr;
+        LZ4F_createCompressionContext(&context, LZ4F_VERSION);
+        contexts_->lz4_compress.reset(context);
+      }
+      if (!contexts_->lz4_compress) {
+        return NoContext();
+      }
+      return Lz4Compress(*contexts_->lz4_compress, body, level);
+#else
+      break;
+#endif
+  }
+  return NotBuiltIn(coding);
+}
+
+auto MessageCompressor::Decompress(
+    std::string_view body, ContentCoding coding,
+    [[maybe_unused]] std::size_t max_size)
+    -> std::expected<std::string, RpcError> {
+  switch (coding) {
+    case ContentCoding::kIdentity:
+      if (body.size() > max_size) {
+        return TooLarge();
+      }
+      return std::string(body);
+    case ContentCoding::kZstd:
+#ifdef JSONRPC_WITH_ZSTD
+      if (!contexts_->zstd_decompress) {
+        contexts_->zstd_decompress.reset(ZSTD_createDCtx());
+      }
+      if (!contexts_->zstd_decompress) {
+        return NoContext();
+      }
+      return ZstdDecompress(*contexts_->zstd_decompress, body, max_size);
+#else
+      break;
+#endif
+    case ContentCoding::kLz4:
+#ifdef JSONRPC_WITH_LZ4
+      if (!contexts_->lz4_decompress) {
+        LZ4F_dctx* context = nullptr;
+        LZ4F_createDecompressionContext(&context, LZ4F_VERSION);
+        contexts_->lz4_decompress.reset(context);
+      }
+      if (!contexts_->lz4_decompress) {
+        return NoContext();
+      }
+      return Lz4Decompress(*contexts_->lz4_decompress, body, max_size);
+#else
+      break;
+#endif
+  }
+  return NotBuiltIn(coding);
+}
+
+auto MessageCompressor::CompressIfWorthwhile(
+    std::string& body, const CompressionOptions& options) -> ContentCoding {
+  if (options.coding == ContentCoding::kIdentity ||
+      body.size() < options.min_size || !IsAvailable(options.coding)) {
+    return ContentCoding::kIdentity;
+  }
+  auto compressed = Compress(body, options.coding, options.level);
+  if (!compressed || compressed->size() >= body.size()) {
+    return ContentCoding::kIdentity;
+  }
+  body = std::move(*compressed);
+  return options.coding;
+}
+
+}  // namespace jsonrpc::transport
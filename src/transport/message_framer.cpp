@@ -0,0 +1,194 @@
+#include "jsonrpc/transport/message_framer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace jsonrpc::transport {
+
+namespace {
+
+constexpr std::string_view kHeaderDelimiter = "\r\n\r\n";
+constexpr std::string_view kLineDelimiter = "\r\n";
+constexpr std::string_view kContentLength = "Content-Length";
+constexpr std::string_view kContentType = "Content-Type";
+constexpr std::string_view kContentEncoding = "Content-Encoding";
+
+auto Trim(std::string_view value) -> std::string_view {
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+auto EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) -> bool {
+  return std::ranges::equal(lhs, rhs, [](char a, char b) {
+    return std::tolower(static_cast<unsigned char>(a)) ==
+           std::tolower(static_cast<unsigned char>(b));
+  });
+}
+
+// Parameters such as charset do not change the encoding
+auto EncodingForContentType(std::string_view content_type)
+    -> MessageEncoding {
+  auto media_type = Trim(content_type.substr(0, content_type.find(';')));
+  if (EqualsIgnoreCase(media_type, MessageFramer::kCborContentType)) {
+    return MessageEncoding::kCbor;
+  }
+  if (EqualsIgnoreCase(media_type, MessageFramer::kMsgpackContentType) ||
+      EqualsIgnoreCase(media_type, "application/x-msgpack")) {
+    return MessageEncoding::kMsgpack;
+  }
+  return MessageEncoding::kJson;
+}
+
+auto CodingForContentEncoding(std::string_view content_encoding)
+    -> std::optional<ContentCoding> {
+  auto token = Trim(content_encoding);
+  for (auto coding :
+       {ContentCoding::kIdentity, ContentCoding::kZstd, ContentCoding::kLz4}) {
+    if (EqualsIgnoreCase(token, ContentCodingName(coding))) {
+      return coding;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+auto MessageFramer::Frame(
+    const std::string& message, std::string_view content_type)
+    -> std::string {
+  auto framed = FrameHeader(message.size(), content_type);
+  framed.reserve(framed.size() + message.size());
+  framed.append(message);
+  return framed;
+}
+
+auto MessageFramer::FrameHeader(
+    std::size_t body_size, std::string_view content_type,
+    ContentCoding coding) -> std::string {
+  // Room for the header names, separators and the length digits
+  constexpr std::size_t kHeaderOverhead = 64;
+
+  std::string header;
+  header.reserve(content_type.size() + kHeaderOverhead);
+  header.append(kContentLength).append(": ").append(std::to_string(body_size));
+  header.append(kLineDelimiter);
+  header.append(kContentType).append(": ").append(content_type);
+  if (coding != ContentCoding::kIdentity) {
+    header.append(kLineDelimiter);
+    header.append(kContentEncoding).append(": ");
+    header.append(ContentCodingName(coding));
+  }
+  header.append(kHeaderDelimiter);
+  return header;
+}
+
+auto MessageFramer::TryDeframe(std::string_view buffer) -> DeframeResult {
+  if (!header_complete_) {
+    // Resume where the last call stopped, backing up in case the delimiter
+    // was split across reads
+    auto start = scan_offset_ >= kHeaderDelimiter.size() - 1
+                     ? scan_offset_ - (kHeaderDelimiter.size() - 1)
+                     : 0;
+    auto header_end = buffer.find(kHeaderDelimiter, start);
+    if (header_end == std::string_view::npos) {
+      scan_offset_ = buffer.size();
+      if (buffer.size() > max_message_size_) {
+        Reset();
+        return {.error = "Headers exceed maximum message size"};
+      }
+      return {};  // Need more data
+    }
+
+    auto error = ParseHeaders(buffer.substr(0, header_end));
+    if (!error.empty()) {
+      Reset();
+      return {.error = std::move(error)};
+    }
+
+    header_complete_ = true;
+    header_size_ = header_end + kHeaderDelimiter.size();
+  }
+
+  // Check if we have enough data for the content
+  if (buffer.size() - header_size_ < expected_length_) {
+    return {};  // Need more data
+  }
+
+  DeframeResult result{
+      .complete = true,
+      .message = buffer.substr(header_size_, expected_length_),
+      .consumed_bytes = header_size_ + expected_length_,
+      .encoding = encoding_,
+      .coding = coding_};
+  Reset();
+  return result;
+}
+
+void MessageFramer::Reset() {
+  header_complete_ = false;
+  expected_length_ = 0;
+  header_size_ = 0;
+  scan_offset_ = 0;
+  encoding_ = MessageEncoding::kJson;
+  coding_ = ContentCoding::kIdentity;
+}
+
+auto MessageFramer::ParseHeaders(std::string_view headers) -> std::string {
+  bool found_length = false;
+
+  while (!headers.empty()) {
+    auto line_end = headers.find(kLineDelimiter);
+    auto line = headers.substr(0, line_end);
+    headers = line_end == std::string_view::npos
+                  ? std::string_view{}
+                  : headers.substr(line_end + kLineDelimiter.size());
+
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    auto name = Trim(line.substr(0, colon));
+    if (EqualsIgnoreCase(name, kContentType)) {
+      encoding_ = EncodingForContentType(line.substr(colon + 1));
+      continue;
+    }
+    if (EqualsIgnoreCase(name, kContentEncoding)) {
+      auto coding = CodingForContentEncoding(line.substr(colon + 1));
+      if (!coding) {
+        return "Unsupported Content-Encoding header";
+      }
+      coding_ = *coding;
+      continue;
+    }
+    if (!EqualsIgnoreCase(name, kContentLength)) {
+      continue;
+    }
+
+    auto value = Trim(line.substr(colon + 1));
+    std::size_t length = 0;
+    auto [ptr, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), length);
+    if (ec != std::errc{} || ptr != value.data() + value.size() ||
+        value.empty()) {
+      return "Invalid Content-Length header";
+    }
+    if (length > max_message_size_) {
+      return "Content-Length exceeds maximum message size";
+    }
+    expected_length_ = length;
+    found_length = true;
+  }
+
+  if (!found_length) {
+    return "Missing Content-Length header";
+  }
+  return {};
+}
+
+}  // namespace jsonrpc::transport
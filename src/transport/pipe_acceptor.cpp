@@ -0,0 +1,126 @@
+#include "jsonrpc/transport/pipe_acceptor.hpp"
+
+#include <filesystem>
+
+#include "jsonrpc/transport/framed_pipe_transport.hpp"
+#include "jsonrpc/transport/pipe_transport.hpp"
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+PipeAcceptor::PipeAcceptor(
+    asio::any_io_executor executor, std::string socket_path,
+    TransportOptions options, std::shared_ptr<spdlog::logger> logger)
+    : Acceptor(std::move(executor), std::move(logger)),
+      socket_path_(std::move(socket_path)),
+      options_(options),
+      acceptor_(GetExecutor()) {
+}
+
+PipeAcceptor::~PipeAcceptor() {
+  std::error_code ec;
+  acceptor_.close(ec);
+  if (is_listening_) {
+    RemoveSocketFile();
+  }
+}
+
+auto PipeAcceptor::Listen()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  JSONRPC_LOG_DEBUG(Logger(), "PipeAcceptor binding to {}", socket_path_);
+
+  if (auto removed = RemoveSocketFile(); !removed) {
+    co_return removed;
+  }
+
+  asio::local::stream_protocol::endpoint endpoint(socket_path_);
+  std::error_code ec;
+  acceptor_.open(endpoint.protocol(), ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Error opening acceptor: " + ec.message());
+  }
+  acceptor_.bind(endpoint, ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Error binding acceptor: " + ec.message());
+  }
+  acceptor_.listen(asio::socket_base::max_listen_connections, ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Error listening on acceptor: " + ec.message());
+  }
+
+  is_listening_ = true;
+  JSONRPC_LOG_DEBUG(Logger(), "PipeAcceptor listening on {}", socket_path_);
+  co_return Ok();
+}
+
+auto PipeAcceptor::Accept(asio::any_io_executor executor) -> asio::awaitable<
+    std::expected<std::unique_ptr<Transport>, error::RpcError>> {
+  co_await SwitchToStrand();
+  if (!acceptor_.is_open()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Acceptor is not listening");
+  }
+
+  std::error_code ec;
+  auto socket = co_await acceptor_.async_accept(
+      executor, asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Error accepting connection: " + ec.message());
+  }
+  co_return MakeTransport(std::move(socket));
+}
+
+auto PipeAcceptor::Close() -> asio::awaitable<void> {
+  co_await SwitchToStrand();
+  std::error_code ec;
+  acceptor_.close(ec);
+  if (ec) {
+    JSONRPC_LOG_WARN(
+        Logger(), "PipeAcceptor error closing acceptor: {}", ec.message());
+  }
+  if (is_listening_) {
+    is_listening_ = false;
+    if (auto removed = RemoveSocketFile(); !removed) {
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeAcceptor error removing socket file: {}",
+          removed.error().Message());
+    }
+  }
+}
+
+auto PipeAcceptor::MakeTransport(asio::local::stream_protocol::socket socket)
+    -> std::unique_ptr<Transport> {
+  return std::make_unique<PipeTransport>(std::move(socket), options_, Logger());
+}
+
+auto PipeAcceptor::RemoveSocketFile() -> std::expected<void, error::RpcError> {
+  std::error_code ec;
+  std::filesystem::remove(socket_path_, ec);
+  if (ec) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Error removing socket file: " + ec.message());
+  }
+  return Ok();
+}
+
+auto FramedPipeAcceptor::MakeTransport(
+    asio::local::stream_protocol::socket socket) -> std::unique_ptr<Transport> {
+  return std::make_unique<FramedPipeTransport>(
+      std::move(socket), Options(), Logger());
+}
+
+}  // namespace jsonrpc::transport
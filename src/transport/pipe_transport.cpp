@@ -4,12 +4,13 @@
 #include <filesystem>
 #include <string>
 
-#include <asio/co_spawn.hpp>
-#include <asio/detached.hpp>
 #include <asio/use_awaitable.hpp>
 #include <jsonrpc/utils/string_utils.hpp>
 #include <spdlog/spdlog.h>
 
+#include "jsonrpc/transport/read_error.hpp"
+#include "jsonrpc/utils/logging.hpp"
+
 namespace jsonrpc::transport {
 
 using error::Ok;
@@ -19,77 +20,127 @@ using error::RpcErrorCode;
 PipeTransport::PipeTransport(
     asio::any_io_executor executor, std::string socket_path, bool is_server,
     std::shared_ptr<spdlog::logger> logger)
+    : PipeTransport(
+          std::move(executor), std::move(socket_path), is_server,
+          TransportOptions{}, std::move(logger)) {
+}
+
+PipeTransport::PipeTransport(
+    asio::any_io_executor executor, std::string socket_path, bool is_server,
+    TransportOptions options, std::shared_ptr<spdlog::logger> logger)
     : Transport(std::move(executor), logger),
+      options_(options),
       socket_(GetExecutor()),
       socket_path_(std::move(socket_path)),
       is_server_(is_server),
-      read_buffer_() {
+      writer_(GetStrand(), options_, Logger()),
+      connect_timer_(GetStrand()),
+      read_size_(options_.min_read_buffer_size, options_.max_read_buffer_size),
+      line_framer_(options_.max_message_size) {
+}
+
+PipeTransport::PipeTransport(
+    asio::local::stream_protocol::socket socket, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : Transport(socket.get_executor(), logger),
+      options_(options),
+      socket_(std::move(socket)),
+      is_server_(false),
+      writer_(GetStrand(), options_, Logger()),
+      connect_timer_(GetStrand()),
+      read_size_(options_.min_read_buffer_size, options_.max_read_buffer_size),
+      line_framer_(options_.max_message_size) {
+  is_connected_ = socket_.is_open();
 }
 
 PipeTransport::~PipeTransport() {
   if (!is_closed_) {
-    Logger()->debug("PipeTransport destructor triggering CloseNow()");
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport destructor triggering CloseNow()");
     try {
       CloseNow();
     } catch (const std::exception &e) {
-      Logger()->error("PipeTransport destructor error: {}", e.what());
+      JSONRPC_LOG_ERROR(
+          Logger(), "PipeTransport destructor error: {}", e.what());
     }
   }
 }
 
+auto PipeTransport::Listen()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot listen on a closed transport");
+  }
+  if (!is_server_ || is_connected_) {
+    co_return Ok();
+  }
+  co_return co_await BindAndListen();
+}
+
 auto PipeTransport::Start()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("PipeTransport starting");
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport starting");
+  co_await SwitchToStrand();
 
   if (is_started_) {
-    Logger()->debug("PipeTransport already started");
+    JSONRPC_LOG_DEBUG(Logger(), "PipeTransport already started");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "PipeTransport already started");
   }
 
   if (is_closed_) {
-    Logger()->error("PipeTransport cannot start a closed transport");
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport cannot start a closed transport");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Cannot start a closed transport");
   }
 
-  if (is_server_) {
-    // For server, bind and listen for connections
-    Logger()->debug("PipeTransport starting server at {}", socket_path_);
+  if (is_connected_) {
+    JSONRPC_LOG_DEBUG(Logger(), "PipeTransport using an accepted connection");
+  } else if (is_server_) {
+    // For server, listen unless Listen() already did and wait for a client
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport starting server at {}", socket_path_);
     auto result = co_await BindAndListen();
+    if (result) {
+      result = co_await AcceptConnection();
+    }
     if (!result) {
-      Logger()->error(
-          "PipeTransport server error starting at {}: {}", socket_path_,
-          result.error().Message());
+      JSONRPC_LOG_ERROR(
+          Logger(), "PipeTransport server error starting at {}: {}",
+          socket_path_, result.error().Message());
       co_return result;
     }
   } else {
     // For client, connect to the server
-    Logger()->debug("PipeTransport connecting client to {}", socket_path_);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport connecting client to {}", socket_path_);
     auto result = co_await Connect();
     if (!result) {
-      Logger()->error(
-          "PipeTransport client error connecting to {}: {}", socket_path_,
-          result.error().Message());
+      JSONRPC_LOG_ERROR(
+          Logger(), "PipeTransport client error connecting to {}: {}",
+          socket_path_, result.error().Message());
       co_return result;
     }
   }
-  Logger()->debug("PipeTransport client connected to {}", socket_path_);
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport connected on {}", socket_path_);
 
   // Set started flag before performing operations
   is_started_ = true;
-  Logger()->debug("PipeTransport successfully started");
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport successfully started");
   co_return Ok();
 }
 
 auto PipeTransport::Close()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("PipeTransport closing");
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport closing");
+  co_await SwitchToStrand();
 
   if (is_closed_) {
-    Logger()->debug("PipeTransport already closed");
+    JSONRPC_LOG_DEBUG(Logger(), "PipeTransport already closed");
     co_return Ok();
   }
 
@@ -97,18 +148,21 @@ auto PipeTransport::Close()
   is_connected_ = false;
 
   // Clear the message queue
-  send_queue_.clear();
+  writer_.Close();
+  connect_timer_.cancel();
 
   // Cancel and close the socket safely
   std::error_code ec;
   if (socket_.is_open()) {
     socket_.cancel(ec);
     if (ec) {
-      Logger()->warn("PipeTransport error canceling socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error canceling socket: {}", ec.message());
     }
     socket_.close(ec);
     if (ec) {
-      Logger()->warn("PipeTransport error closing socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error closing socket: {}", ec.message());
     }
   }
 
@@ -116,12 +170,13 @@ auto PipeTransport::Close()
   if (is_server_ && acceptor_) {
     acceptor_->cancel(ec);
     if (ec) {
-      Logger()->warn(
-          "PipeTransport error canceling acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error canceling acceptor: {}", ec.message());
     }
     acceptor_->close(ec);
     if (ec) {
-      Logger()->warn("PipeTransport error closing acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error closing acceptor: {}", ec.message());
     }
   }
 
@@ -129,13 +184,13 @@ auto PipeTransport::Close()
   if (is_server_ && !socket_path_.empty()) {
     auto result = RemoveExistingSocketFile();
     if (!result) {
-      Logger()->warn(
-          "PipeTransport error removing socket file: {}",
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error removing socket file: {}",
           result.error().Message());
     }
   }
 
-  Logger()->debug("PipeTransport closed");
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport closed");
   co_return Ok();
 }
 
@@ -144,19 +199,21 @@ void PipeTransport::CloseNow() {
   is_connected_ = false;
 
   // Clear the message queue
-  send_queue_.clear();
+  writer_.Close();
+  connect_timer_.cancel();
 
   auto try_close_socket = [&]() {
     if (!socket_.is_open()) {
       return;
     }
-    Logger()->debug("PipeTransport closing socket synchronously");
+    JSONRPC_LOG_DEBUG(Logger(), "PipeTransport closing socket synchronously");
 
     std::error_code ec;
     socket_.cancel();
     socket_.close(ec);
     if (ec) {
-      Logger()->warn("PipeTransport error closing socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error closing socket: {}", ec.message());
     }
   };
 
@@ -164,13 +221,14 @@ void PipeTransport::CloseNow() {
     if (!is_server_ || !acceptor_ || !acceptor_->is_open()) {
       return;
     }
-    Logger()->debug("PipeTransport closing acceptor synchronously");
+    JSONRPC_LOG_DEBUG(Logger(), "PipeTransport closing acceptor synchronously");
 
     std::error_code ec;
     acceptor_->cancel();
     acceptor_->close(ec);
     if (ec) {
-      Logger()->warn("PipeTransport error closing acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error closing acceptor: {}", ec.message());
     }
   };
 
@@ -183,14 +241,16 @@ void PipeTransport::CloseNow() {
     if (std::filesystem::exists(socket_path_, ec) && !ec) {
       std::filesystem::remove(socket_path_, ec);
       if (ec) {
-        Logger()->warn(
-            "PipeTransport error removing socket file: {}", ec.message());
+        JSONRPC_LOG_WARN(
+            Logger(), "PipeTransport error removing socket file: {}",
+            ec.message());
       } else {
-        Logger()->debug("PipeTransport removed socket file: {}", socket_path_);
+        JSONRPC_LOG_DEBUG(
+            Logger(), "PipeTransport removed socket file: {}", socket_path_);
       }
     } else if (ec) {
-      Logger()->warn(
-          "PipeTransport error checking socket file existence: {}",
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error checking socket file existence: {}",
           ec.message());
     }
   };
@@ -200,7 +260,8 @@ void PipeTransport::CloseNow() {
     try_close_acceptor();
     try_remove_socket_file();
   } catch (const std::exception &e) {
-    Logger()->error("PipeTransport error during CloseNow(): {}", e.what());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error during CloseNow(): {}", e.what());
   }
 }
 
@@ -223,18 +284,41 @@ auto PipeTransport::RemoveExistingSocketFile()
           RpcErrorCode::kTransportError,
           "Error removing socket file: " + ec.message());
     }
-    Logger()->debug(
-        "PipeTransport removed existing socket file: {}", socket_path_);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport removed existing socket file: {}",
+        socket_path_);
   } else {
-    Logger()->debug(
-        "PipeTransport no existing socket file to remove: {}", socket_path_);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport no existing socket file to remove: {}",
+        socket_path_);
   }
   return {};
 }
 
 auto PipeTransport::SendMessage(std::string message)
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  co_return co_await SendMessageWithHints(
+      std::move(message), MessageEncoding::kJson, SendHints{});
+}
+
+auto PipeTransport::SendMessageWithHints(
+    std::string message, MessageEncoding encoding, SendHints hints)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (encoding != MessageEncoding::kJson) {
+    co_return co_await Transport::SendEncodedMessage(
+        std::move(message), encoding);
+  }
+  OutgoingMessage outgoing{
+      .body = std::move(message), .hints = std::move(hints)};
+  if (options_.framing == Framing::kNewlineDelimited) {
+    outgoing.trailer = LineFramer::kDelimiter;
+  }
+  co_return co_await SendFrame(std::move(outgoing));
+}
+
+auto PipeTransport::SendFrame(OutgoingMessage message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
 
   if (is_closed_) {
     co_return RpcError::UnexpectedFromCode(
@@ -253,78 +337,100 @@ auto PipeTransport::SendMessage(std::string message)
         RpcErrorCode::kTransportError, "Socket not open");
   }
 
-  Logger()->debug("Queuing {} bytes to send to pipe", message.size());
-  send_queue_.push_back(std::move(message));
-
-  // If there's no active sending task, start one
-  if (!sending_.exchange(true)) {
-    asio::co_spawn(GetStrand(), SendMessageLoop(), asio::detached);
-  }
+  co_return co_await writer_.Send(socket_, std::move(message));
+}
 
-  co_return Ok();
+auto PipeTransport::Flush(std::optional<std::chrono::milliseconds> timeout)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  co_return co_await writer_.Flush(timeout);
 }
 
-auto PipeTransport::SendMessageLoop() -> asio::awaitable<void> {
-  while (!send_queue_.empty()) {
-    std::string message = std::move(send_queue_.front());
-    send_queue_.pop_front();
+auto PipeTransport::GetSendQueueStats() -> asio::awaitable<SendQueueStats> {
+  co_await SwitchToStrand();
+  co_return writer_.Stats();
+}
 
-    Logger()->debug("Sending {} bytes to pipe", message.size());
-    std::size_t bytes_sent = 0;
-    const std::size_t chunk_size =
-        32 * 1024;  // 32KB chunks to be safe for WSL's 64KB limit
+auto PipeTransport::ReceiveMessage()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  if (options_.framing == Framing::kNewlineDelimited) {
+    co_return co_await ReceiveLine();
+  }
 
-    while (bytes_sent < message.size()) {
-      auto remaining = message.size() - bytes_sent;
-      auto current_chunk_size = std::min(remaining, chunk_size);
+  if (auto filled = co_await FillReadBuffer(); !filled) {
+    co_return std::unexpected(filled.error());
+  }
 
-      // Use string_view to avoid copying data
-      std::string_view chunk =
-          std::string_view(message).substr(bytes_sent, current_chunk_size);
+  auto message = NewMessage(read_buffer_.Data());
+  read_buffer_.Clear();
+  read_buffer_.ShrinkTo(2 * read_size_.Next());
 
-      // Write to the socket with error redirection
-      std::error_code ec;
-      auto chunk_sent = co_await asio::async_write(
-          socket_, asio::buffer(chunk),
-          asio::redirect_error(asio::use_awaitable, ec));
+  if (JSONRPC_LOG_ENABLED(Logger(), spdlog::level::debug)) {
+    auto log_message = message.substr(0, 70);
+    if (message.size() > 70) {
+      log_message += "...";
+    }
+    std::ranges::replace(log_message, '\n', ' ');
+    std::ranges::replace(log_message, '\r', ' ');
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport received message: {}", log_message);
+  }
+  co_return message;
+}
 
-      if (ec) {
-        Logger()->error(
-            "PipeTransport error sending message: {}", ec.message());
-        break;  // Exit but continue processing other messages
+auto PipeTransport::ReceiveLine()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  while (true) {
+    auto result = line_framer_.TryDeframe(read_buffer_.Data());
+    if (result.complete) {
+      // Blank lines carry no message
+      auto message =
+          result.message.empty() ? std::string() : NewMessage(result.message);
+      read_buffer_.Consume(result.consumed_bytes);
+      // Give memory back once reads have settled well below the buffer
+      read_buffer_.ShrinkTo(2 * read_size_.Next());
+      if (message.empty()) {
+        continue;
       }
+      co_return message;
+    }
 
-      bytes_sent += chunk_sent;
-      Logger()->debug(
-          "Sent {} bytes to pipe, total {}/{}", chunk_sent, bytes_sent,
-          message.size());
+    if (!result.error.empty()) {
+      CountFramingError();
+      JSONRPC_LOG_ERROR(
+          Logger(), "PipeTransport framing error: {}", result.error);
+      // The bad bytes stay buffered, so every later read would fail too
+      is_connected_ = false;
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Framing error: " + result.error);
     }
-  }
 
-  // Mark sending as complete
-  sending_ = false;
+    if (auto filled = co_await FillReadBuffer(); !filled) {
+      co_return std::unexpected(filled.error());
+    }
+  }
 }
 
-auto PipeTransport::Flush()
+auto PipeTransport::FillReadBuffer()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("Flushing message queue");
-  while (true) {
-    co_await asio::post(GetStrand(), asio::use_awaitable);
-    if (send_queue_.empty() && !sending_) {
-      break;
-    }
-    co_await asio::steady_timer(GetExecutor(), std::chrono::milliseconds(10))
-        .async_wait(asio::use_awaitable);
-  }
+  auto read_size = read_size_.Next();
+  auto bytes_read = co_await ReadSome(
+      asio::buffer(read_buffer_.Prepare(read_size), read_size));
+  if (!bytes_read) {
+    co_return std::unexpected(bytes_read.error());
+  }
+  read_buffer_.Commit(*bytes_read);
+  read_size_.Record(*bytes_read);
   co_return Ok();
 }
 
-auto PipeTransport::ReceiveMessage()
-    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+auto PipeTransport::ReadSome(asio::mutable_buffer buffer)
+    -> asio::awaitable<std::expected<std::size_t, error::RpcError>> {
+  co_await SwitchToStrand();
 
   if (is_closed_) {
-    Logger()->warn(
+    JSONRPC_LOG_WARN(
+        Logger(),
         "PipeTransport ReceiveMessage called after transport was closed");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
@@ -338,56 +444,73 @@ auto PipeTransport::ReceiveMessage()
   }
 
   if (!socket_.is_open()) {
-    Logger()->warn("PipeTransport ReceiveMessage called on a closed socket");
+    JSONRPC_LOG_WARN(
+        Logger(), "PipeTransport ReceiveMessage called on a closed socket");
+    is_connected_ = false;
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
         "ReceiveMessage called on a closed socket");
   }
 
-  message_buffer_.clear();
-
   std::error_code ec;
   std::size_t bytes_read = co_await socket_.async_read_some(
-      asio::buffer(read_buffer_),
-      asio::redirect_error(asio::use_awaitable, ec));
+      buffer, asio::redirect_error(asio::use_awaitable, ec));
 
   if (ec) {
-    if (ec == asio::error::eof) {
-      Logger()->debug("PipeTransport connection closed by peer (EOF)");
+    if (ec == asio::error::eof || ec == asio::error::connection_reset) {
+      JSONRPC_LOG_DEBUG(
+          Logger(), "PipeTransport connection closed by peer (EOF)");
       is_connected_ = false;
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Connection closed by peer");
     } else if (ec == asio::error::operation_aborted) {
-      Logger()->debug("PipeTransport Receive operation aborted");
+      JSONRPC_LOG_DEBUG(Logger(), "PipeTransport Receive operation aborted");
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Receive aborted");
     } else {
-      Logger()->error(
-          "PipeTransport error receiving message: {}", ec.message());
+      // Anything but a momentary shortage leaves the socket unusable
+      if (!IsTransientReadError(ec)) {
+        is_connected_ = false;
+      }
+      JSONRPC_LOG_ERROR(
+          Logger(), "PipeTransport error receiving message: {}", ec.message());
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Receive error: " + ec.message());
     }
   }
 
   if (bytes_read == 0) {
+    is_connected_ = false;
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "No data received");
   }
 
-  message_buffer_.append(read_buffer_.data(), bytes_read);
-  auto log_message = message_buffer_;
-  if (log_message.size() > 70) {
-    log_message = log_message.substr(0, 70) + "...";
-  }
-  std::ranges::replace(log_message, '\n', ' ');
-  std::ranges::replace(log_message, '\r', ' ');
-  Logger()->debug("PipeTransport received message: {}", log_message);
-  co_return std::move(message_buffer_);
+  co_return bytes_read;
 }
 
 auto PipeTransport::Connect()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("PipeTransport connecting to {}", socket_path_);
+  const auto &retry = options_.connect_retry;
+  auto delay = retry.initial_delay;
+  for (std::size_t attempt = 1;; ++attempt) {
+    auto result = co_await ConnectOnce();
+    if (result || attempt >= retry.attempts || is_closed_) {
+      co_return result;
+    }
+    JSONRPC_LOG_DEBUG(
+        Logger(), "PipeTransport retrying connect to {} in {}ms",
+        socket_path_, delay.count());
+    connect_timer_.expires_after(delay);
+    std::error_code ec;
+    co_await connect_timer_.async_wait(asio::redirect_error(
+        asio::bind_executor(GetStrand(), asio::use_awaitable), ec));
+    delay = std::min(delay * 2, retry.max_delay);
+  }
+}
+
+auto PipeTransport::ConnectOnce()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport connecting to {}", socket_path_);
 
   // Make sure we're not already connected
   if (is_connected_) {
@@ -405,8 +528,8 @@ auto PipeTransport::Connect()
   if (socket_.is_open()) {
     socket_.close(ec);
     if (ec) {
-      Logger()->warn(
-          "PipeTransport error closing socket before reconnect: {}",
+      JSONRPC_LOG_WARN(
+          Logger(), "PipeTransport error closing socket before reconnect: {}",
           ec.message());
     }
   }
@@ -419,26 +542,30 @@ auto PipeTransport::Connect()
   co_await socket_.async_connect(
       endpoint, asio::redirect_error(asio::use_awaitable, ec));
   if (ec) {
-    Logger()->error(
-        "PipeTransport error connecting to {}: {}", socket_path_, ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error connecting to {}: {}", socket_path_,
+        ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Error connecting to: " + ec.message());
   }
 
   is_connected_ = true;
-  Logger()->debug("PipeTransport connected to {}", socket_path_);
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport connected to {}", socket_path_);
 
   co_return Ok();
 }
 
 auto PipeTransport::BindAndListen()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("PipeTransport binding to {}", socket_path_);
+  if (is_listening_) {
+    co_return Ok();
+  }
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport binding to {}", socket_path_);
 
   auto result = RemoveExistingSocketFile();
   if (!result) {
-    Logger()->error(
-        "PipeTransport error removing existing socket file: {}",
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error removing existing socket file: {}",
         result.error().Message());
     co_return result;
   }
@@ -456,40 +583,51 @@ auto PipeTransport::BindAndListen()
   std::error_code ec;
   acceptor_->open(endpoint.protocol(), ec);
   if (ec) {
-    Logger()->error("PipeTransport error opening acceptor: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error opening acceptor: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
         "Error opening acceptor: " + ec.message());
   }
   acceptor_->bind(endpoint, ec);
   if (ec) {
-    Logger()->error("PipeTransport error binding acceptor: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error binding acceptor: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
         "Error binding acceptor: " + ec.message());
   }
   acceptor_->listen(asio::socket_base::max_listen_connections, ec);
   if (ec) {
-    Logger()->error(
-        "PipeTransport error listening on acceptor: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error listening on acceptor: {}",
+        ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
         "Error listening on acceptor: " + ec.message());
   }
+  is_listening_ = true;
+  JSONRPC_LOG_DEBUG(Logger(), "PipeTransport listening on {}", socket_path_);
+  co_return Ok();
+}
 
-  // Accept a connection
-  Logger()->debug("PipeTransport waiting for connection on {}", socket_path_);
+auto PipeTransport::AcceptConnection()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  JSONRPC_LOG_DEBUG(
+      Logger(), "PipeTransport waiting for connection on {}", socket_path_);
+  asio::error_code ec;
   co_await acceptor_->async_accept(
       socket_, asio::redirect_error(asio::use_awaitable, ec));
   if (ec) {
-    Logger()->error(
-        "PipeTransport error accepting connection: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "PipeTransport error accepting connection: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
         "Error accepting connection: " + ec.message());
   }
   is_connected_ = true;
-  Logger()->debug("PipeTransport accepted connection on {}", socket_path_);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "PipeTransport accepted connection on {}", socket_path_);
 
   co_return Ok();
 }
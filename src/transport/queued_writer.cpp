@@ -0,0 +1,126 @@
+#include "jsonrpc/transport/queued_writer.hpp"
+
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+QueuedWriter::QueuedWriter(
+    asio::strand<asio::any_io_executor> strand,
+    const TransportOptions& options, std::shared_ptr<spdlog::logger> logger)
+    : strand_(std::move(strand)),
+      logger_(std::move(logger)),
+      backpressure_(options.backpressure),
+      cork_delay_(options.cork_delay),
+      cork_bytes_(options.cork_bytes),
+      queue_(strand_, options.send_limits),
+      cork_timer_(strand_) {
+}
+
+auto QueuedWriter::Queue(OutgoingMessage message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (write_error_) {
+    co_return std::unexpected(*write_error_);
+  }
+
+  if (queue_.IsFull()) {
+    if (backpressure_ == BackpressurePolicy::kFailFast) {
+      queue_.RecordRejected();
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Send queue is full");
+    }
+
+    JSONRPC_LOG_DEBUG(
+        logger_, "Send queue full ({} bytes), waiting", queue_.Bytes());
+    co_await queue_.WaitForRoom();
+
+    // The queue may have been cleared by Close() or a write error
+    if (write_error_) {
+      co_return std::unexpected(*write_error_);
+    }
+    if (closed_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError,
+          "Transport closed while waiting to send");
+    }
+  }
+
+  JSONRPC_LOG_DEBUG(logger_, "Queuing {} bytes to send", message.Size());
+  queue_.Push(std::move(message));
+  if (cork_bytes_ > 0 && queue_.Bytes() >= cork_bytes_) {
+    cork_timer_.cancel();  // End the cork window early
+  }
+  co_return Ok();
+}
+
+auto QueuedWriter::NextBatch() -> asio::awaitable<std::optional<WriteBatch>> {
+  auto enough_bytes = cork_bytes_ > 0 && queue_.Bytes() >= cork_bytes_;
+  if (!queue_.Empty() && cork_delay_.count() > 0 && !enough_bytes) {
+    // Queue() cancels the timer once cork_bytes are queued
+    cork_timer_.expires_after(cork_delay_);
+    std::error_code ec;
+    co_await cork_timer_.async_wait(
+        asio::redirect_error(asio::use_awaitable, ec));
+  }
+
+  // Empty once written out, or cleared by Close() while corked
+  if (queue_.Empty()) {
+    co_return std::nullopt;
+  }
+  auto batch = queue_.TakeBatch();
+  JSONRPC_LOG_DEBUG(
+      logger_, "Sending {} messages, {} bytes", batch.Count(), batch.Bytes());
+  co_return batch;
+}
+
+auto QueuedWriter::FinishWrite(
+    const WriteBatch& batch, const std::error_code& ec) -> bool {
+  queue_.RecordWrite(batch, ec);
+  if (!ec) {
+    return true;
+  }
+  JSONRPC_LOG_ERROR(
+      logger_, "Error sending {} messages: {}", batch.Count(), ec.message());
+  // The stream is unusable now; fail queued and future sends
+  write_error_ = RpcError(
+      RpcErrorCode::kTransportError, "Write failed: " + ec.message());
+  queue_.Clear();
+  return false;
+}
+
+auto QueuedWriter::Flush(std::optional<std::chrono::milliseconds> timeout)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  JSONRPC_LOG_DEBUG(logger_, "Flushing {} queued bytes", queue_.Bytes());
+
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  if (timeout) {
+    deadline = std::chrono::steady_clock::now() + *timeout;
+  }
+  auto drained = co_await queue_.WaitForDrain(deadline);
+
+  // A failed write also drains the queue, so check for it first
+  if (write_error_) {
+    co_return std::unexpected(*write_error_);
+  }
+  if (drained) {
+    co_return Ok();
+  }
+  if (closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Transport closed before flush completed");
+  }
+  co_return RpcError::UnexpectedFromCode(
+      RpcErrorCode::kTimeoutError, "Flush timed out");
+}
+
+void QueuedWriter::Close() {
+  closed_ = true;
+  queue_.Clear();
+  cork_timer_.cancel();
+}
+
+}  // namespace jsonrpc::transport
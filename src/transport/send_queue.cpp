@@ -0,0 +1,184 @@
+#include "jsonrpc/transport/send_queue.hpp"
+
+#include <algorithm>
+
+namespace jsonrpc::transport {
+
+WriteBatch::WriteBatch(std::vector<OutgoingMessage> messages)
+    : messages_(std::move(messages)) {
+  buffers_.reserve(messages_.size() * 3);
+  for (const auto& message : messages_) {
+    for (std::string_view part : {
+             std::string_view(message.header), std::string_view(message.body),
+             message.trailer}) {
+      if (!part.empty()) {
+        buffers_.emplace_back(part.data(), part.size());
+      }
+    }
+    bytes_ += message.Size();
+  }
+}
+
+SendQueue::SendQueue(asio::any_io_executor executor, SendQueueLimits limits)
+    : limits_(limits),
+      executor_(std::move(executor)),
+      room_timer_(executor_, asio::steady_timer::time_point::max()) {
+}
+
+void SendQueue::Push(OutgoingMessage message) {
+  OutgoingMessage** replaceable = nullptr;
+  if (!message.hints.replace_key.empty()) {
+    auto [it, inserted] =
+        replaceable_.try_emplace(message.hints.replace_key, nullptr);
+    if (!inserted) {
+      bytes_ = bytes_ - it->second->Size() + message.Size();
+      *it->second = std::move(message);
+      ++stats_.replaced_messages;
+      stats_.peak_queued_bytes = std::max(stats_.peak_queued_bytes, bytes_);
+      UpdateFullState();
+      return;
+    }
+    replaceable = &it->second;
+  }
+
+  bytes_ += message.Size();
+  auto& lane =
+      message.hints.priority == MessagePriority::kBulk ? bulk_ : interactive_;
+  lane.push_back(std::move(message));
+  if (replaceable != nullptr) {
+    *replaceable = &lane.back();
+  }
+  stats_.peak_queued_bytes = std::max(stats_.peak_queued_bytes, bytes_);
+  UpdateFullState();
+}
+
+auto SendQueue::TakeBatch(std::size_t max_bytes) -> WriteBatch {
+  std::vector<OutgoingMessage> messages;
+  std::size_t batch_bytes = 0;
+
+  auto take = [&](std::deque<OutgoingMessage>& lane, std::size_t limit) {
+    std::size_t lane_bytes = 0;
+    while (!lane.empty()) {
+      auto size = lane.front().Size();
+      if (!messages.empty() &&
+          (batch_bytes + size > max_bytes || lane_bytes + size > limit)) {
+        break;
+      }
+      batch_bytes += size;
+      lane_bytes += size;
+      bytes_ -= size;
+      if (!lane.front().hints.replace_key.empty()) {
+        replaceable_.erase(lane.front().hints.replace_key);
+      }
+      messages.push_back(std::move(lane.front()));
+      lane.pop_front();
+    }
+  };
+  take(interactive_, max_bytes);
+  take(bulk_, std::min(max_bytes, kMaxBulkWriteBatchSize));
+
+  if (!messages.empty()) {
+    ++in_flight_;
+  }
+  UpdateFullState();
+  return WriteBatch(std::move(messages));
+}
+
+void SendQueue::Clear() {
+  stats_.failed_messages += Size();
+  interactive_.clear();
+  bulk_.clear();
+  replaceable_.clear();
+  bytes_ = 0;
+  UpdateFullState();
+  NotifyDrainWaiters();
+}
+
+auto SendQueue::WaitForRoom() -> asio::awaitable<void> {
+  ++stats_.blocked_senders;
+  while (full_) {
+    // The timer never expires; UpdateFullState() cancels it to wake waiters
+    std::error_code ec;
+    co_await room_timer_.async_wait(asio::redirect_error(
+        asio::bind_executor(executor_, asio::use_awaitable), ec));
+  }
+  --stats_.blocked_senders;
+}
+
+void SendQueue::RecordWrite(
+    const WriteBatch& batch, const std::error_code& ec) {
+  if (batch.Count() > 0 && in_flight_ > 0) {
+    --in_flight_;
+  }
+  if (ec) {
+    stats_.failed_messages += batch.Count();
+  } else {
+    stats_.sent_messages += batch.Count();
+    stats_.sent_bytes += batch.Bytes();
+  }
+  if (IsDrained()) {
+    NotifyDrainWaiters();
+  }
+}
+
+auto SendQueue::WaitForDrain(
+    std::optional<std::chrono::steady_clock::time_point> deadline)
+    -> asio::awaitable<bool> {
+  if (IsDrained()) {
+    co_return true;
+  }
+
+  asio::steady_timer timer(
+      executor_, deadline.value_or(asio::steady_timer::time_point::max()));
+  drain_waiters_.push_back(&timer);
+
+  // Woken by expiry at the deadline or by NotifyDrainWaiters()
+  std::error_code ec;
+  co_await timer.async_wait(asio::redirect_error(
+      asio::bind_executor(executor_, asio::use_awaitable), ec));
+
+  std::erase(drain_waiters_, &timer);
+  co_return IsDrained();
+}
+
+auto SendQueue::Stats() const -> SendQueueStats {
+  auto stats = stats_;
+  stats.queued_messages = Size();
+  stats.queued_bytes = bytes_;
+  stats.queued_bulk_messages = bulk_.size();
+  return stats;
+}
+
+void SendQueue::NotifyDrainWaiters() {
+  for (auto* timer : drain_waiters_) {
+    timer->cancel();
+  }
+}
+
+void SendQueue::UpdateFullState() {
+  auto over = [](std::size_t value, std::size_t high) {
+    return high > 0 && value >= high;
+  };
+  auto under = [](std::size_t value, std::size_t high, std::size_t low) {
+    return high == 0 || value <= low;
+  };
+
+  if (!full_) {
+    full_ = over(bytes_, limits_.high_watermark_bytes) ||
+            over(Size(), limits_.high_watermark_messages);
+    return;
+  }
+
+  auto drained = under(
+                     bytes_, limits_.high_watermark_bytes,
+                     limits_.low_watermark_bytes) &&
+                 under(
+                     Size(), limits_.high_watermark_messages,
+                     limits_.low_watermark_messages);
+  if (drained) {
+    full_ = false;
+    room_timer_.cancel();
+  }
+}
+
+}  // namespace jsonrpc::transport
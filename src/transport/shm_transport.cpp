@@ -0,0 +1,464 @@
+#include "jsonrpc/transport/shm_transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <asio/use_awaitable.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+namespace {
+
+// "JRPCSHM1", written last by the server once the rings are set up
+constexpr std::uint64_t kShmMagic = 0x4a52504353484d31;
+
+constexpr std::chrono::microseconds kFirstBackoff{10};
+constexpr std::chrono::microseconds kMaxBackoff{1000};
+
+// Rings in the region, named by the side that receives from them
+constexpr std::size_t kToServer = 0;
+constexpr std::size_t kToClient = 1;
+
+// Start of the shared region, followed by the two rings
+struct RegionHeader {
+  alignas(ShmRing::kCacheLine) std::atomic<std::uint64_t> magic{0};
+  std::uint64_t ring_capacity = 0;
+};
+
+auto RegionSize(std::size_t ring_capacity) -> std::size_t {
+  return sizeof(RegionHeader) + 2 * ShmRing::RequiredSize(ring_capacity);
+}
+
+auto ShmName(const std::string &name) -> std::string {
+  return "/" + name;
+}
+
+auto DoorbellPath(const std::string &name, std::size_t ring) -> std::string {
+  return std::filesystem::temp_directory_path() /
+         (name + (ring == kToServer ? ".to_server" : ".to_client"));
+}
+
+auto SystemError(const std::string &what) -> std::unexpected<RpcError> {
+  return RpcError::UnexpectedFromCode(
+      RpcErrorCode::kTransportError, what + ": " + std::strerror(errno));
+}
+
+auto GetRegionHeader(std::span<std::byte> region) -> RegionHeader & {
+  return *std::launder(reinterpret_cast<RegionHeader *>(region.data()));
+}
+
+auto RingMemory(
+    std::span<std::byte> region, std::size_t ring_capacity, std::size_t ring)
+    -> std::span<std::byte> {
+  const auto ring_size = ShmRing::RequiredSize(ring_capacity);
+  return region.subspan(sizeof(RegionHeader) + ring * ring_size, ring_size);
+}
+
+}  // namespace
+
+ShmTransport::ShmTransport(
+    asio::any_io_executor executor, std::string name, bool is_server,
+    ShmTransportOptions options, std::shared_ptr<spdlog::logger> logger)
+    : Transport(std::move(executor), std::move(logger)),
+      name_(std::move(name)),
+      is_server_(is_server),
+      options_(options),
+      incoming_doorbell_(GetExecutor()),
+      outgoing_doorbell_(GetExecutor()) {
+}
+
+ShmTransport::~ShmTransport() {
+  if (!is_closed_) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "ShmTransport destructor triggering CloseNow()");
+    CloseNow();
+  }
+}
+
+auto ShmTransport::Start()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_started_) {
+    JSONRPC_LOG_DEBUG(Logger(), "ShmTransport already started");
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "ShmTransport already started");
+  }
+
+  if (is_closed_) {
+    JSONRPC_LOG_ERROR(Logger(), "ShmTransport cannot start a closed transport");
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot start a closed transport");
+  }
+
+  auto result = is_server_ ? CreateRegion() : AttachRegion();
+  if (!result) {
+    JSONRPC_LOG_ERROR(
+        Logger(), "ShmTransport failed to start on {}: {}", name_,
+        result.error().Message());
+    ReleaseResources();
+    co_return result;
+  }
+
+  is_started_ = true;
+  is_connected_ = true;
+  JSONRPC_LOG_DEBUG(
+      Logger(), "ShmTransport started on {} with {} byte rings", name_,
+      incoming_->Capacity());
+  co_return Ok();
+}
+
+auto ShmTransport::CreateRegion() -> std::expected<void, error::RpcError> {
+  // Names left behind by a server that did not close
+  ReleaseResources();
+
+  const auto capacity =
+      std::bit_ceil(std::max(options_.ring_capacity, ShmRing::kCacheLine));
+  const auto size = RegionSize(capacity);
+
+  const int fd =
+      ::shm_open(ShmName(name_).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return SystemError("Failed to create shared memory " + name_);
+  }
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    auto error = SystemError("Failed to size shared memory " + name_);
+    ::close(fd);
+    return error;
+  }
+  auto mapped = MapRegion(fd, size);
+  ::close(fd);
+  if (!mapped) {
+    return mapped;
+  }
+
+  auto &header = *new (region_.data()) RegionHeader();
+  header.ring_capacity = capacity;
+  incoming_ = ShmRing::Create(RingMemory(region_, capacity, kToServer));
+  outgoing_ = ShmRing::Create(RingMemory(region_, capacity, kToClient));
+
+  for (auto ring : {kToServer, kToClient}) {
+    if (::mkfifo(DoorbellPath(name_, ring).c_str(), 0600) != 0) {
+      return SystemError("Failed to create doorbell for " + name_);
+    }
+  }
+  if (auto opened = OpenDoorbells(); !opened) {
+    return opened;
+  }
+
+  // Clients attach only once everything above is in place
+  header.magic.store(kShmMagic, std::memory_order_release);
+  return Ok();
+}
+
+auto ShmTransport::AttachRegion() -> std::expected<void, error::RpcError> {
+  const int fd = ::shm_open(ShmName(name_).c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return SystemError("No shared memory transport named " + name_);
+  }
+  struct stat status {};
+  if (::fstat(fd, &status) != 0) {
+    auto error = SystemError("Failed to inspect shared memory " + name_);
+    ::close(fd);
+    return error;
+  }
+  const auto size = static_cast<std::size_t>(status.st_size);
+  if (size < sizeof(RegionHeader)) {
+    ::close(fd);
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Shared memory " + name_ + " is not set up yet");
+  }
+  auto mapped = MapRegion(fd, size);
+  ::close(fd);
+  if (!mapped) {
+    return mapped;
+  }
+
+  auto &header = GetRegionHeader(region_);
+  if (header.magic.load(std::memory_order_acquire) != kShmMagic ||
+      RegionSize(header.ring_capacity) != size) {
+    return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Shared memory " + name_ + " is not set up yet");
+  }
+  incoming_ = ShmRing::Attach(
+      RingMemory(region_, header.ring_capacity, kToClient));
+  outgoing_ = ShmRing::Attach(
+      RingMemory(region_, header.ring_capacity, kToServer));
+  return OpenDoorbells();
+}
+
+auto ShmTransport::MapRegion(int fd, std::size_t size)
+    -> std::expected<void, error::RpcError> {
+  void *memory =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    return SystemError("Failed to map shared memory " + name_);
+  }
+  region_ = {static_cast<std::byte *>(memory), size};
+  return Ok();
+}
+
+auto ShmTransport::OpenDoorbells() -> std::expected<void, error::RpcError> {
+  const auto incoming = is_server_ ? kToServer : kToClient;
+  const auto outgoing = is_server_ ? kToClient : kToServer;
+  // Read-write, so neither side waits for the other to open its end
+  for (auto [ring, doorbell] :
+       {std::pair{incoming, &incoming_doorbell_},
+        std::pair{outgoing, &outgoing_doorbell_}}) {
+    const int fd =
+        ::open(DoorbellPath(name_, ring).c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+      return SystemError("Failed to open doorbell for " + name_);
+    }
+    doorbell->assign(fd);
+  }
+  return Ok();
+}
+
+auto ShmTransport::Close()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  JSONRPC_LOG_DEBUG(Logger(), "ShmTransport closing");
+  co_await SwitchToStrand();
+  if (!is_closed_) {
+    CloseNow();
+  }
+  co_return Ok();
+}
+
+void ShmTransport::CloseNow() {
+  if (is_closed_.exchange(true)) {
+    return;
+  }
+  is_started_ = false;
+  is_connected_ = false;
+
+  if (outgoing_) {
+    outgoing_->CloseWriter();
+    // Wake the peer whether it sleeps or not, so it sees the close
+    RingDoorbell(outgoing_doorbell_);
+  }
+  if (incoming_) {
+    incoming_->CloseReader();
+  }
+  ReleaseResources();
+  JSONRPC_LOG_DEBUG(Logger(), "ShmTransport closed");
+}
+
+void ShmTransport::ReleaseResources() {
+  std::error_code ec;
+  incoming_doorbell_.close(ec);
+  outgoing_doorbell_.close(ec);
+  incoming_.reset();
+  outgoing_.reset();
+
+  if (!region_.empty()) {
+    ::munmap(region_.data(), region_.size());
+    region_ = {};
+  }
+
+  if (is_server_) {
+    // The mappings outlive the names, so an attached client keeps working
+    ::shm_unlink(ShmName(name_).c_str());
+    for (auto ring : {kToServer, kToClient}) {
+      ::unlink(DoorbellPath(name_, ring).c_str());
+    }
+  }
+}
+
+void ShmTransport::RingDoorbell(asio::posix::stream_descriptor &doorbell) {
+  if (!doorbell.is_open()) {
+    return;
+  }
+  const char byte = 1;
+  // A full FIFO already holds a wakeup, so a failed write loses nothing
+  [[maybe_unused]] auto written = ::write(doorbell.native_handle(), &byte, 1);
+}
+
+auto ShmTransport::Backoff(
+    std::size_t &round, std::chrono::microseconds &delay)
+    -> asio::awaitable<void> {
+  if (round < options_.spin_iterations) {
+    ++round;
+    co_await SwitchToStrand();
+    co_return;
+  }
+  asio::steady_timer timer(GetStrand(), delay);
+  std::error_code ec;
+  co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+  delay = std::min(delay * 2, kMaxBackoff);
+  co_await SwitchToStrand();
+}
+
+auto ShmTransport::SendMessage(std::string message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot send on closed transport");
+  }
+  if (!is_started_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Cannot send before transport is started");
+  }
+  if (message.size() > outgoing_->MaxMessageSize() ||
+      message.size() > options_.max_message_size) {
+    JSONRPC_LOG_ERROR(
+        Logger(), "ShmTransport message of {} bytes exceeds the ring",
+        message.size());
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Message of " + std::to_string(message.size()) +
+            " bytes exceeds the ring capacity or maximum message size");
+  }
+
+  const auto ticket = next_send_ticket_++;
+  std::size_t round = 0;
+  auto delay = kFirstBackoff;
+  while (true) {
+    if (is_closed_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Transport closed while sending");
+    }
+    if (outgoing_->IsReaderClosed()) {
+      is_connected_ = false;
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Peer closed the transport");
+    }
+    if (ticket == current_send_ticket_ && outgoing_->TryPush(message)) {
+      ++current_send_ticket_;
+      if (outgoing_->ShouldWakeReader()) {
+        RingDoorbell(outgoing_doorbell_);
+      }
+      co_return Ok();
+    }
+    co_await Backoff(round, delay);
+  }
+}
+
+auto ShmTransport::Flush(std::optional<std::chrono::milliseconds> timeout)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  const auto deadline =
+      timeout ? std::optional(std::chrono::steady_clock::now() + *timeout)
+              : std::nullopt;
+  std::size_t round = 0;
+  auto delay = kFirstBackoff;
+  while (current_send_ticket_ != next_send_ticket_) {
+    if (is_closed_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Transport closed while flushing");
+    }
+    if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTimeoutError, "Timed out flushing the send queue");
+    }
+    co_await Backoff(round, delay);
+  }
+  co_return Ok();
+}
+
+auto ShmTransport::WaitForMessage() -> asio::awaitable<void> {
+  if (!incoming_->PrepareToSleep()) {
+    co_return;
+  }
+  std::error_code ec;
+  co_await incoming_doorbell_.async_wait(
+      asio::posix::stream_descriptor::wait_read,
+      asio::redirect_error(asio::use_awaitable, ec));
+  co_await SwitchToStrand();
+  if (is_closed_) {
+    co_return;
+  }
+
+  // Wakeups are only a hint to look at the ring, so drain them all
+  std::array<char, 64> bytes{};
+  const int fd = incoming_doorbell_.native_handle();
+  while (::read(fd, bytes.data(), bytes.size()) > 0) {
+  }
+  incoming_->StopSleeping();
+}
+
+auto ShmTransport::ReceiveMessage()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (!is_started_ && !is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Transport not started before receiving message");
+  }
+
+  std::size_t round = 0;
+  while (true) {
+    if (is_closed_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError,
+          "ReceiveMessage called after transport was closed");
+    }
+
+    auto size = incoming_->NextSize();
+    if (size && *size && **size > options_.max_message_size) {
+      size = RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError,
+          "Message of " + std::to_string(**size) +
+              " bytes exceeds maximum message size");
+    }
+    if (!size) {
+      // The ring cannot be read past a bad message, so the link is gone
+      JSONRPC_LOG_ERROR(
+          Logger(), "ShmTransport {} framing error: {}", name_,
+          size.error().Message());
+      is_connected_ = false;
+      incoming_->CloseReader();
+      co_return std::unexpected(size.error());
+    }
+    if (*size) {
+      auto message = NewMessage(**size);
+      incoming_->Pop(message);
+      co_return message;
+    }
+
+    // The writer closes after its last push, so look once more before
+    // giving up
+    if (incoming_->IsWriterClosed()) {
+      if (auto last = incoming_->NextSize(); !last || *last) {
+        continue;
+      }
+      is_connected_ = false;
+      JSONRPC_LOG_DEBUG(Logger(), "ShmTransport peer closed {}", name_);
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Peer closed the transport");
+    }
+
+    if (round < options_.spin_iterations) {
+      ++round;
+      co_await SwitchToStrand();
+      continue;
+    }
+    co_await WaitForMessage();
+    round = 0;
+  }
+}
+
+}  // namespace jsonrpc::transport
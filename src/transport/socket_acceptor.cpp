@@ -0,0 +1,121 @@
+#include "jsonrpc/transport/socket_acceptor.hpp"
+
+#include "jsonrpc/transport/socket_transport.hpp"
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+namespace {
+#ifdef SO_REUSEPORT
+using ReusePort =
+    asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+}  // namespace
+
+SocketAcceptor::SocketAcceptor(
+    asio::any_io_executor executor, std::string address, uint16_t port,
+    TransportOptions options, bool reuse_port,
+    std::shared_ptr<spdlog::logger> logger)
+    : Acceptor(std::move(executor), std::move(logger)),
+      address_(std::move(address)),
+      port_(port),
+      options_(options),
+      reuse_port_(reuse_port),
+      acceptor_(GetExecutor()) {
+}
+
+auto SocketAcceptor::Listen()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketAcceptor binding to {}:{}", address_, port_);
+
+  asio::error_code ec;
+  asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port_);
+  if (address_ != "0.0.0.0" && address_ != "::") {
+    asio::ip::tcp::resolver resolver(GetExecutor());
+    auto results = co_await resolver.async_resolve(
+        address_, std::to_string(port_),
+        asio::redirect_error(asio::use_awaitable, ec));
+    co_await SwitchToStrand();
+    if (ec) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Resolve error: " + ec.message());
+    }
+    endpoint = *results.begin();
+  }
+
+  acceptor_.open(endpoint.protocol(), ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Open error: " + ec.message());
+  }
+
+  acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+  if (!ec && reuse_port_) {
+#ifdef SO_REUSEPORT
+    acceptor_.set_option(ReusePort(true), ec);
+#else
+    ec = asio::error::operation_not_supported;
+#endif
+  }
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Set option error: " + ec.message());
+  }
+
+  acceptor_.bind(endpoint, ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Bind error: " + ec.message());
+  }
+
+  acceptor_.listen(asio::socket_base::max_listen_connections, ec);
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Listen error: " + ec.message());
+  }
+
+  local_port_ = acceptor_.local_endpoint(ec).port();
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketAcceptor listening on {}:{}", address_, local_port_);
+  co_return Ok();
+}
+
+auto SocketAcceptor::Accept(asio::any_io_executor executor) -> asio::awaitable<
+    std::expected<std::unique_ptr<Transport>, error::RpcError>> {
+  co_await SwitchToStrand();
+  if (!acceptor_.is_open()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Acceptor is not listening");
+  }
+
+  std::error_code ec;
+  auto socket = co_await acceptor_.async_accept(
+      executor, asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Accept error: " + ec.message());
+  }
+
+  // Small RPC messages should not wait for Nagle's algorithm
+  socket.set_option(asio::ip::tcp::no_delay(true), ec);
+  co_return std::make_unique<SocketTransport>(
+      std::move(socket), options_, Logger());
+}
+
+auto SocketAcceptor::Close() -> asio::awaitable<void> {
+  co_await SwitchToStrand();
+  std::error_code ec;
+  acceptor_.close(ec);
+  if (ec) {
+    JSONRPC_LOG_WARN(
+        Logger(), "SocketAcceptor error closing acceptor: {}", ec.message());
+  }
+}
+
+}  // namespace jsonrpc::transport
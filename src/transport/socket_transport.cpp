@@ -1,7 +1,12 @@
 #include "jsonrpc/transport/socket_transport.hpp"
 
+#include <algorithm>
+
 #include <asio.hpp>
 
+#include "jsonrpc/transport/read_error.hpp"
+#include "jsonrpc/utils/logging.hpp"
+
 namespace jsonrpc::transport {
 
 using error::Ok;
@@ -11,80 +16,141 @@ using error::RpcErrorCode;
 SocketTransport::SocketTransport(
     asio::any_io_executor executor, std::string address, uint16_t port,
     bool is_server, std::shared_ptr<spdlog::logger> logger)
+    : SocketTransport(
+          std::move(executor), std::move(address), port, is_server,
+          TransportOptions{}, std::move(logger)) {
+}
+
+SocketTransport::SocketTransport(
+    asio::any_io_executor executor, std::string address, uint16_t port,
+    bool is_server, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
     : Transport(std::move(executor), logger),
+      options_(options),
       socket_(GetExecutor()),
       address_(std::move(address)),
       port_(port),
       is_server_(is_server),
-      read_buffer_() {
+      writer_(GetStrand(), options_, Logger()),
+      connect_timer_(GetStrand()),
+      read_size_(options_.min_read_buffer_size, options_.max_read_buffer_size),
+      line_framer_(options_.max_message_size),
+      message_framer_(options_.max_message_size) {
+}
+
+SocketTransport::SocketTransport(
+    asio::ip::tcp::socket socket, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : Transport(socket.get_executor(), logger),
+      options_(options),
+      socket_(std::move(socket)),
+      port_(0),
+      is_server_(false),
+      writer_(GetStrand(), options_, Logger()),
+      connect_timer_(GetStrand()),
+      read_size_(options_.min_read_buffer_size, options_.max_read_buffer_size),
+      line_framer_(options_.max_message_size),
+      message_framer_(options_.max_message_size) {
+  std::error_code ec;
+  auto peer = socket_.remote_endpoint(ec);
+  if (!ec) {
+    address_ = peer.address().to_string();
+    port_ = peer.port();
+  }
+  is_connected_ = socket_.is_open();
 }
 
 SocketTransport::~SocketTransport() {
   if (!is_closed_) {
-    Logger()->debug("SocketTransport destructor triggering CloseNow()");
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport destructor triggering CloseNow()");
     try {
       CloseNow();
     } catch (const std::exception &e) {
-      Logger()->error("SocketTransport destructor error: {}", e.what());
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport destructor error: {}", e.what());
     }
   }
 }
 
+auto SocketTransport::Listen()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot listen on a closed transport");
+  }
+  if (!is_server_ || is_connected_) {
+    co_return Ok();
+  }
+  co_return co_await BindAndListen();
+}
+
 auto SocketTransport::Start()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("SocketTransport starting");
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  JSONRPC_LOG_DEBUG(Logger(), "SocketTransport starting");
+  co_await SwitchToStrand();
 
   if (is_started_) {
-    Logger()->debug("SocketTransport already started");
+    JSONRPC_LOG_DEBUG(Logger(), "SocketTransport already started");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "SocketTransport already started");
   }
 
   if (is_closed_) {
-    Logger()->error("SocketTransport cannot start a closed transport");
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport cannot start a closed transport");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Cannot start a closed transport");
   }
 
   std::expected<void, error::RpcError> result;
 
-  if (is_server_) {
-    Logger()->debug(
-        "SocketTransport starting server at {}:{}", address_, port_);
+  if (is_connected_) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport using connection from {}:{}", address_,
+        port_);
+  } else if (is_server_) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport starting server at {}:{}", address_, port_);
     result = co_await BindAndListen();
+    if (result) {
+      result = co_await AcceptConnection();
+    }
     if (!result) {
-      Logger()->error(
-          "SocketTransport error starting server: {}",
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport error starting server: {}",
           result.error().Message());
       co_return result;
     }
   } else {
-    Logger()->debug(
-        "Connecting SocketTransport client to {}:{}", address_, port_);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "Connecting SocketTransport client to {}:{}", address_,
+        port_);
     result = co_await Connect();
     if (!result) {
-      Logger()->error(
-          "SocketTransport error connecting client: {}",
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport error connecting client: {}",
           result.error().Message());
       co_return result;
     }
-    Logger()->debug(
-        "SocketTransport client connected to {}:{}", address_, port_);
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport client connected to {}:{}", address_, port_);
   }
 
   is_started_ = true;
-  Logger()->debug("SocketTransport successfully started");
+  JSONRPC_LOG_DEBUG(Logger(), "SocketTransport successfully started");
   co_return Ok();
 }
 
 auto SocketTransport::Close()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("SocketTransport closing");
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  JSONRPC_LOG_DEBUG(Logger(), "SocketTransport closing");
+  co_await SwitchToStrand();
 
   if (is_closed_) {
-    Logger()->debug("SocketTransport already closed");
+    JSONRPC_LOG_DEBUG(Logger(), "SocketTransport already closed");
     co_return std::expected<void, error::RpcError>{};
   }
 
@@ -92,21 +158,23 @@ auto SocketTransport::Close()
   is_connected_ = false;
 
   // Clear the message queue
-  send_queue_.clear();
+  writer_.Close();
+  connect_timer_.cancel();
 
-  Logger()->debug("SocketTransport closing");
+  JSONRPC_LOG_DEBUG(Logger(), "SocketTransport closing");
 
   // Cancel and close the socket safely
   std::error_code ec;
   if (socket_.is_open()) {
     socket_.cancel(ec);
     if (ec) {
-      Logger()->warn(
-          "SocketTransport error canceling socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error canceling socket: {}", ec.message());
     }
     socket_.close(ec);
     if (ec) {
-      Logger()->warn("SocketTransport error closing socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error closing socket: {}", ec.message());
     }
   }
 
@@ -114,17 +182,18 @@ auto SocketTransport::Close()
   if (is_server_ && acceptor_) {
     acceptor_->cancel(ec);
     if (ec) {
-      Logger()->warn(
-          "SocketTransport error canceling acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error canceling acceptor: {}",
+          ec.message());
     }
     acceptor_->close(ec);
     if (ec) {
-      Logger()->warn(
-          "SocketTransport error closing acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error closing acceptor: {}", ec.message());
     }
   }
 
-  Logger()->debug("SocketTransport closed");
+  JSONRPC_LOG_DEBUG(Logger(), "SocketTransport closed");
   co_return Ok();
 }
 
@@ -133,19 +202,21 @@ void SocketTransport::CloseNow() {
   is_connected_ = false;
 
   // Clear the message queue
-  send_queue_.clear();
+  writer_.Close();
+  connect_timer_.cancel();
 
   auto try_close_socket = [&]() {
     if (!socket_.is_open()) {
       return;
     }
-    Logger()->debug("SocketTransport closing socket synchronously");
+    JSONRPC_LOG_DEBUG(Logger(), "SocketTransport closing socket synchronously");
 
     std::error_code ec;
     socket_.cancel();
     socket_.close(ec);
     if (ec) {
-      Logger()->warn("SocketTransport error closing socket: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error closing socket: {}", ec.message());
     }
   };
 
@@ -153,14 +224,15 @@ void SocketTransport::CloseNow() {
     if (!is_server_ || !acceptor_ || !acceptor_->is_open()) {
       return;
     }
-    Logger()->debug("SocketTransport closing acceptor synchronously");
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport closing acceptor synchronously");
 
     std::error_code ec;
     acceptor_->cancel();
     acceptor_->close(ec);
     if (ec) {
-      Logger()->warn(
-          "SocketTransport error closing acceptor: {}", ec.message());
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error closing acceptor: {}", ec.message());
     }
   };
 
@@ -168,7 +240,8 @@ void SocketTransport::CloseNow() {
     try_close_socket();
     try_close_acceptor();
   } catch (const std::exception &e) {
-    Logger()->error("SocketTransport error during CloseNow(): {}", e.what());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error during CloseNow(): {}", e.what());
   }
 }
 
@@ -178,7 +251,26 @@ auto SocketTransport::GetSocket() -> asio::ip::tcp::socket & {
 
 auto SocketTransport::SendMessage(std::string message)
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  co_return co_await SendEncodedMessage(
+      std::move(message), MessageEncoding::kJson);
+}
+
+auto SocketTransport::SendEncodedMessage(
+    std::string message, MessageEncoding encoding)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_return co_await SendMessageWithHints(
+      std::move(message), encoding, SendHints{});
+}
+
+auto SocketTransport::SendMessageWithHints(
+    std::string message, MessageEncoding encoding, SendHints hints)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  if (!SupportsEncoding(encoding)) {
+    co_return co_await Transport::SendEncodedMessage(
+        std::move(message), encoding);
+  }
+
+  co_await SwitchToStrand();
 
   if (is_closed_) {
     co_return RpcError::UnexpectedFromCode(
@@ -197,63 +289,147 @@ auto SocketTransport::SendMessage(std::string message)
         RpcErrorCode::kTransportError, "Socket not open in SendMessage()");
   }
 
-  Logger()->debug("Queuing {} bytes to send to socket", message.size());
-  send_queue_.push_back(std::move(message));
+  OutgoingMessage outgoing{
+      .body = std::move(message), .hints = std::move(hints)};
+  if (options_.framing == Framing::kNewlineDelimited) {
+    outgoing.trailer = LineFramer::kDelimiter;
+  } else if (options_.framing == Framing::kContentLength) {
+    // On the strand, which the compression contexts rely on
+    auto coding =
+        compressor_.CompressIfWorthwhile(outgoing.body, options_.compression);
+    outgoing.header = MessageFramer::FrameHeader(
+        outgoing.body.size(), MessageFramer::ContentTypeFor(encoding), coding);
+  }
+
+  co_return co_await writer_.Send(socket_, std::move(outgoing));
+}
 
-  // If there's no active sending task, start one
-  if (!sending_.exchange(true)) {
-    asio::co_spawn(GetStrand(), SendMessageLoop(), asio::detached);
+auto SocketTransport::Flush(std::optional<std::chrono::milliseconds> timeout)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  co_return co_await writer_.Flush(timeout);
+}
+
+auto SocketTransport::GetSendQueueStats() -> asio::awaitable<SendQueueStats> {
+  co_await SwitchToStrand();
+  co_return writer_.Stats();
+}
+
+auto SocketTransport::ReceiveMessage()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  if (options_.framing == Framing::kNewlineDelimited) {
+    co_return co_await ReceiveLine();
+  }
+  if (options_.framing == Framing::kContentLength) {
+    co_return co_await ReceiveFramed();
   }
 
-  co_return Ok();
+  if (auto filled = co_await FillReadBuffer(); !filled) {
+    co_return std::unexpected(filled.error());
+  }
+
+  auto message = NewMessage(read_buffer_.Data());
+  read_buffer_.Clear();
+  read_buffer_.ShrinkTo(2 * read_size_.Next());
+
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport received {} bytes", message.size());
+  co_return message;
 }
 
-auto SocketTransport::SendMessageLoop() -> asio::awaitable<void> {
-  while (!send_queue_.empty()) {
-    std::string message = std::move(send_queue_.front());
-    send_queue_.pop_front();
-
-    Logger()->debug("Sending {} bytes to socket", message.size());
-    std::size_t bytes_sent = 0;
-    const std::size_t chunk_size = 32 * 1024;  // 32KB chunks to be safe
-
-    while (bytes_sent < message.size()) {
-      auto remaining = message.size() - bytes_sent;
-      auto current_chunk_size = std::min(remaining, chunk_size);
-
-      // Use string_view to avoid copying data
-      std::string_view chunk =
-          std::string_view(message).substr(bytes_sent, current_chunk_size);
-
-      // Write to the socket with error redirection
-      std::error_code ec;
-      auto chunk_sent = co_await asio::async_write(
-          socket_, asio::buffer(chunk),
-          asio::redirect_error(asio::use_awaitable, ec));
-
-      if (ec) {
-        Logger()->error(
-            "SocketTransport error sending message: {}", ec.message());
-        break;  // Stop sending this message but continue with others
+auto SocketTransport::ReceiveLine()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  while (true) {
+    auto result = line_framer_.TryDeframe(read_buffer_.Data());
+    if (result.complete) {
+      // Blank lines carry no message
+      auto message =
+          result.message.empty() ? std::string() : NewMessage(result.message);
+      read_buffer_.Consume(result.consumed_bytes);
+      // Give memory back once reads have settled well below the buffer
+      read_buffer_.ShrinkTo(2 * read_size_.Next());
+      if (message.empty()) {
+        continue;
       }
+      co_return message;
+    }
 
-      bytes_sent += chunk_sent;
-      Logger()->debug(
-          "Sent {} bytes to socket, total {}/{}", chunk_sent, bytes_sent,
-          message.size());
+    if (!result.error.empty()) {
+      CountFramingError();
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport framing error: {}", result.error);
+      // The bad bytes stay buffered, so every later read would fail too
+      is_connected_ = false;
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Framing error: " + result.error);
     }
-  }
 
-  // Mark sending as complete
-  sending_ = false;
+    if (auto filled = co_await FillReadBuffer(); !filled) {
+      co_return std::unexpected(filled.error());
+    }
+  }
 }
 
-auto SocketTransport::ReceiveMessage()
+auto SocketTransport::ReceiveFramed()
     -> asio::awaitable<std::expected<std::string, error::RpcError>> {
-  co_await asio::post(GetStrand(), asio::use_awaitable);
+  while (true) {
+    auto result = message_framer_.TryDeframe(read_buffer_.Data());
+    if (result.complete) {
+      last_received_encoding_ = result.encoding;
+      auto coding = result.coding;
+      auto message = NewMessage(result.message);
+      read_buffer_.Consume(result.consumed_bytes);
+      read_buffer_.ShrinkTo(2 * read_size_.Next());
+      if (coding == ContentCoding::kIdentity) {
+        co_return message;
+      }
+      auto decoded =
+          compressor_.Decompress(message, coding, options_.max_message_size);
+      RecycleMessage(std::move(message));
+      if (!decoded) {
+        JSONRPC_LOG_ERROR(
+            Logger(), "SocketTransport decompression error: {}",
+            decoded.error().Message());
+      }
+      co_return decoded;
+    }
+
+    if (!result.error.empty()) {
+      CountFramingError();
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport framing error: {}", result.error);
+      // The bad bytes stay buffered, so every later read would fail too
+      is_connected_ = false;
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Framing error: " + result.error);
+    }
+
+    if (auto filled = co_await FillReadBuffer(); !filled) {
+      co_return std::unexpected(filled.error());
+    }
+  }
+}
+
+auto SocketTransport::FillReadBuffer()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  auto read_size = read_size_.Next();
+  auto bytes_read = co_await ReadSome(
+      asio::buffer(read_buffer_.Prepare(read_size), read_size));
+  if (!bytes_read) {
+    co_return std::unexpected(bytes_read.error());
+  }
+  read_buffer_.Commit(*bytes_read);
+  read_size_.Record(*bytes_read);
+  co_return Ok();
+}
+
+auto SocketTransport::ReadSome(asio::mutable_buffer buffer)
+    -> asio::awaitable<std::expected<std::size_t, error::RpcError>> {
+  co_await SwitchToStrand();
 
   if (is_closed_) {
-    Logger()->warn(
+    JSONRPC_LOG_WARN(
+        Logger(),
         "SocketTransport ReceiveMessage() called after transport was closed");
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError,
@@ -267,50 +443,74 @@ auto SocketTransport::ReceiveMessage()
   }
 
   if (!socket_.is_open()) {
-    Logger()->warn("SocketTransport ReceiveMessage() socket not open");
+    JSONRPC_LOG_WARN(
+        Logger(), "SocketTransport ReceiveMessage() socket not open");
+    is_connected_ = false;
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Socket not open in ReceiveMessage()");
   }
 
-  message_buffer_.clear();
-
   std::error_code ec;
   size_t bytes_read = co_await socket_.async_read_some(
-      asio::buffer(read_buffer_),
-      asio::redirect_error(asio::use_awaitable, ec));
+      buffer, asio::redirect_error(asio::use_awaitable, ec));
 
   if (ec) {
-    if (ec == asio::error::eof) {
-      Logger()->debug(
-          "SocketTransport EOF received, connection closed by peer");
+    if (ec == asio::error::eof || ec == asio::error::connection_reset) {
+      JSONRPC_LOG_DEBUG(
+          Logger(), "SocketTransport EOF received, connection closed by peer");
       is_connected_ = false;
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Connection closed by peer");
     } else if (ec == asio::error::operation_aborted) {
-      Logger()->debug("SocketTransport Read operation aborted");
+      JSONRPC_LOG_DEBUG(Logger(), "SocketTransport Read operation aborted");
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Receive operation aborted");
     } else {
-      Logger()->error(
-          "SocketTransport ASIO error in ReceiveMessage(): {}", ec.message());
+      // Anything but a momentary shortage leaves the socket unusable
+      if (!IsTransientReadError(ec)) {
+        is_connected_ = false;
+      }
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport ASIO error in ReceiveMessage(): {}",
+          ec.message());
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Receive error: " + ec.message());
     }
   }
 
   if (bytes_read == 0) {
+    is_connected_ = false;
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Connection closed by peer (no data)");
   }
 
-  message_buffer_.append(read_buffer_.data(), bytes_read);
-  Logger()->debug("SocketTransport received {} bytes", bytes_read);
-  co_return std::move(message_buffer_);
+  co_return bytes_read;
 }
 
 auto SocketTransport::Connect()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("SocketTransport connecting to {}:{}", address_, port_);
+  const auto &retry = options_.connect_retry;
+  auto delay = retry.initial_delay;
+  for (std::size_t attempt = 1;; ++attempt) {
+    auto result = co_await ConnectOnce();
+    if (result || attempt >= retry.attempts || is_closed_) {
+      co_return result;
+    }
+    JSONRPC_LOG_DEBUG(
+        Logger(), "SocketTransport retrying connect to {}:{} in {}ms",
+        address_, port_, delay.count());
+    connect_timer_.expires_after(delay);
+    std::error_code ec;
+    co_await connect_timer_.async_wait(asio::redirect_error(
+        asio::bind_executor(GetStrand(), asio::use_awaitable), ec));
+    delay = std::min(delay * 2, retry.max_delay);
+  }
+}
+
+auto SocketTransport::ConnectOnce()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport connecting to {}:{}", address_, port_);
 
   if (is_connected_) {
     co_return Ok();
@@ -326,8 +526,8 @@ auto SocketTransport::Connect()
   if (socket_.is_open()) {
     socket_.close(ec);
     if (ec) {
-      Logger()->warn(
-          "SocketTransport error closing socket before reconnect: {}",
+      JSONRPC_LOG_WARN(
+          Logger(), "SocketTransport error closing socket before reconnect: {}",
           ec.message());
     }
   }
@@ -343,8 +543,8 @@ auto SocketTransport::Connect()
       address_, std::to_string(port_),
       asio::redirect_error(asio::use_awaitable, ec));
   if (ec) {
-    Logger()->error(
-        "SocketTransport error resolving {}:{}: {}", address_, port_,
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error resolving {}:{}: {}", address_, port_,
         ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Resolve error: " + ec.message());
@@ -354,9 +554,9 @@ auto SocketTransport::Connect()
   co_await asio::async_connect(
       socket_, endpoints, asio::redirect_error(asio::use_awaitable, ec));
   if (ec) {
-    Logger()->error(
-        "SocketTransport error connecting to {}:{}: {}", address_, port_,
-        ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error connecting to {}:{}: {}", address_,
+        port_, ec.message());
     if (socket_.is_open()) {
       socket_.close();
     }
@@ -365,13 +565,18 @@ auto SocketTransport::Connect()
   }
 
   is_connected_ = true;
-  Logger()->debug("SocketTransport connected to {}:{}", address_, port_);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport connected to {}:{}", address_, port_);
   co_return Ok();
 }
 
 auto SocketTransport::BindAndListen()
     -> asio::awaitable<std::expected<void, error::RpcError>> {
-  Logger()->debug("SocketTransport binding to {}:{}", address_, port_);
+  if (is_listening_) {
+    co_return Ok();
+  }
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport binding to {}:{}", address_, port_);
 
   asio::error_code ec;
 
@@ -385,9 +590,9 @@ auto SocketTransport::BindAndListen()
         address_, std::to_string(port_),
         asio::redirect_error(asio::use_awaitable, ec));
     if (ec) {
-      Logger()->error(
-          "SocketTransport error resolving {}:{}: {}", address_, port_,
-          ec.message());
+      JSONRPC_LOG_ERROR(
+          Logger(), "SocketTransport error resolving {}:{}: {}", address_,
+          port_, ec.message());
       co_return RpcError::UnexpectedFromCode(
           RpcErrorCode::kTransportError, "Resolve error: " + ec.message());
     }
@@ -402,48 +607,62 @@ auto SocketTransport::BindAndListen()
   // Create and open acceptor
   acceptor_->open(endpoint.protocol(), ec);
   if (ec) {
-    Logger()->error("SocketTransport error opening acceptor: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error opening acceptor: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Open error: " + ec.message());
   }
 
   acceptor_->set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
   if (ec) {
-    Logger()->error(
-        "SocketTransport error setting reuse_address: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error setting reuse_address: {}",
+        ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Set option error: " + ec.message());
   }
 
   acceptor_->bind(endpoint, ec);
   if (ec) {
-    Logger()->error("SocketTransport error binding acceptor: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error binding acceptor: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Bind error: " + ec.message());
   }
 
   acceptor_->listen(asio::socket_base::max_listen_connections, ec);
   if (ec) {
-    Logger()->error("SocketTransport error listening: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error listening: {}", ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Listen error: " + ec.message());
   }
 
-  Logger()->debug("SocketTransport listening on {}:{}", address_, port_);
+  is_listening_ = true;
+  local_port_ = acceptor_->local_endpoint(ec).port();
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport listening on {}:{}", address_,
+      local_port_.load());
+  co_return Ok();
+}
 
-  // Accept a connection
+auto SocketTransport::AcceptConnection()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  asio::error_code ec;
   co_await acceptor_->async_accept(
       socket_, asio::redirect_error(asio::use_awaitable, ec));
   if (ec) {
-    Logger()->error(
-        "SocketTransport error accepting connection: {}", ec.message());
+    JSONRPC_LOG_ERROR(
+        Logger(), "SocketTransport error accepting connection: {}",
+        ec.message());
     co_return RpcError::UnexpectedFromCode(
         RpcErrorCode::kTransportError, "Accept error: " + ec.message());
   }
 
   is_connected_ = true;
-  Logger()->debug(
-      "SocketTransport accepted connection on {}:{}", address_, port_);
+  JSONRPC_LOG_DEBUG(
+      Logger(), "SocketTransport accepted connection on {}:{}", address_,
+      port_);
 
   co_return Ok();
 }
@@ -0,0 +1,260 @@
+#include "jsonrpc/transport/stdio_transport.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include <asio/use_awaitable.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/transport/read_error.hpp"
+#include "jsonrpc/utils/logging.hpp"
+
+namespace jsonrpc::transport {
+
+using error::Ok;
+using error::RpcError;
+using error::RpcErrorCode;
+
+namespace {
+auto DefaultStdioOptions() -> TransportOptions {
+  TransportOptions options;
+  options.min_read_buffer_size = kDefaultStdioMinReadBufferSize;
+  return options;
+}
+}  // namespace
+
+StdioTransport::StdioTransport(
+    asio::any_io_executor executor, std::shared_ptr<spdlog::logger> logger)
+    : StdioTransport(
+          std::move(executor), DefaultStdioOptions(), std::move(logger)) {
+}
+
+StdioTransport::StdioTransport(
+    asio::any_io_executor executor, TransportOptions options,
+    std::shared_ptr<spdlog::logger> logger)
+    : StdioTransport(
+          std::move(executor), ::dup(STDIN_FILENO), ::dup(STDOUT_FILENO),
+          options, std::move(logger)) {
+}
+
+StdioTransport::StdioTransport(
+    asio::any_io_executor executor, int input_fd, int output_fd,
+    TransportOptions options, std::shared_ptr<spdlog::logger> logger)
+    : Transport(std::move(executor), logger),
+      options_(options),
+      input_(GetExecutor()),
+      output_(GetExecutor()),
+      writer_(GetStrand(), options_, Logger()),
+      reader_(options_, MessageStorage(), compressor_, Logger()) {
+  AssignDescriptor(input_, input_fd);
+  AssignDescriptor(output_, output_fd);
+  is_connected_ = input_.is_open() && output_.is_open();
+}
+
+StdioTransport::~StdioTransport() {
+  if (!is_closed_) {
+    JSONRPC_LOG_DEBUG(
+        Logger(), "StdioTransport destructor triggering CloseNow()");
+    try {
+      CloseNow();
+    } catch (const std::exception &e) {
+      JSONRPC_LOG_ERROR(
+          Logger(), "StdioTransport destructor error: {}", e.what());
+    }
+  }
+}
+
+void StdioTransport::AssignDescriptor(
+    asio::posix::stream_descriptor &descriptor, int fd) {
+  if (fd < 0) {
+    JSONRPC_LOG_ERROR(
+        Logger(), "StdioTransport got no descriptor: {}",
+        std::strerror(errno));
+    return;
+  }
+  std::error_code ec;
+  descriptor.assign(fd, ec);
+  if (ec) {
+    JSONRPC_LOG_ERROR(
+        Logger(), "StdioTransport cannot wait on descriptor {}: {}", fd,
+        ec.message());
+    ::close(fd);
+  }
+}
+
+auto StdioTransport::Start()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_started_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "StdioTransport already started");
+  }
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Cannot start a closed transport");
+  }
+
+  if (!input_.is_open() || !output_.is_open()) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "StdioTransport has no usable stdin or stdout");
+  }
+
+  is_started_ = true;
+  JSONRPC_LOG_DEBUG(Logger(), "StdioTransport started");
+  co_return Ok();
+}
+
+auto StdioTransport::Close()
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  CloseNow();
+  JSONRPC_LOG_DEBUG(Logger(), "StdioTransport closed");
+  co_return Ok();
+}
+
+void StdioTransport::CloseNow() {
+  if (is_closed_.exchange(true)) {
+    return;
+  }
+  is_connected_ = false;
+
+  writer_.Close();
+  CloseDescriptors();
+}
+
+void StdioTransport::CloseDescriptors() {
+  for (auto *descriptor : {&input_, &output_}) {
+    if (!descriptor->is_open()) {
+      continue;
+    }
+    std::error_code ec;
+    descriptor->cancel(ec);
+    descriptor->close(ec);
+    if (ec) {
+      JSONRPC_LOG_WARN(
+          Logger(), "StdioTransport error closing descriptor: {}",
+          ec.message());
+    }
+  }
+}
+
+auto StdioTransport::SendMessage(std::string message)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_return co_await SendEncodedMessage(
+      std::move(message), MessageEncoding::kJson);
+}
+
+auto StdioTransport::SendEncodedMessage(
+    std::string message, MessageEncoding encoding)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_return co_await SendMessageWithHints(
+      std::move(message), encoding, SendHints{});
+}
+
+auto StdioTransport::SendMessageWithHints(
+    std::string message, MessageEncoding encoding, SendHints hints)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Attempt to send message on closed transport");
+  }
+
+  if (!is_started_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Transport not started before sending message");
+  }
+
+  // Compression contexts are per transport, so compress on the strand
+  auto coding =
+      compressor_.CompressIfWorthwhile(message, options_.compression);
+  // The header goes out as its own buffer, so the body is not copied
+  auto header = MessageFramer::FrameHeader(
+      message.size(), MessageFramer::ContentTypeFor(encoding), coding);
+  co_return co_await writer_.Send(
+      output_,
+      {.header = std::move(header),
+       .body = std::move(message),
+       .hints = std::move(hints)});
+}
+
+auto StdioTransport::GetSendQueueStats() -> asio::awaitable<SendQueueStats> {
+  co_await SwitchToStrand();
+  co_return writer_.Stats();
+}
+
+auto StdioTransport::Flush(std::optional<std::chrono::milliseconds> timeout)
+    -> asio::awaitable<std::expected<void, error::RpcError>> {
+  co_await SwitchToStrand();
+  co_return co_await writer_.Flush(timeout);
+}
+
+auto StdioTransport::ReceiveMessage()
+    -> asio::awaitable<std::expected<std::string, error::RpcError>> {
+  auto message = co_await reader_.Receive(
+      [this](asio::mutable_buffer buffer) { return ReadSome(buffer); });
+  if (!message && reader_.IsCorrupt()) {
+    CountFramingError();
+    is_connected_ = false;
+  }
+  co_return message;
+}
+
+auto StdioTransport::ReadSome(asio::mutable_buffer buffer)
+    -> asio::awaitable<std::expected<std::size_t, error::RpcError>> {
+  co_await SwitchToStrand();
+
+  if (is_closed_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "ReceiveMessage called after transport was closed");
+  }
+
+  if (!is_started_) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError,
+        "Transport not started before receiving message");
+  }
+
+  std::error_code ec;
+  std::size_t bytes_read = co_await input_.async_read_some(
+      buffer, asio::redirect_error(asio::use_awaitable, ec));
+
+  if (ec == asio::error::eof) {
+    JSONRPC_LOG_DEBUG(Logger(), "StdioTransport stdin closed (EOF)");
+    is_connected_ = false;
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Connection closed by peer");
+  }
+  if (ec == asio::error::operation_aborted) {
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Receive aborted");
+  }
+  if (ec) {
+    // Anything but a momentary shortage leaves the descriptor unusable
+    if (!IsTransientReadError(ec)) {
+      is_connected_ = false;
+    }
+    JSONRPC_LOG_ERROR(
+        Logger(), "StdioTransport error receiving message: {}", ec.message());
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "Receive error: " + ec.message());
+  }
+
+  if (bytes_read == 0) {
+    is_connected_ = false;
+    co_return RpcError::UnexpectedFromCode(
+        RpcErrorCode::kTransportError, "No data received");
+  }
+
+  co_return bytes_read;
+}
+
+}  // namespace jsonrpc::transport
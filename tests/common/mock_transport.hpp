@@ -117,6 +117,15 @@ class MockTransport : public jsonrpc::transport::Transport {
     co_return Ok();
   }
 
+  using Transport::Flush;
+
+  auto Flush(std::optional<std::chrono::milliseconds> /*timeout*/)
+      -> asio::awaitable<std::expected<void, error::RpcError>> override {
+    // Sent messages are recorded synchronously, so there is nothing to drain
+    co_await asio::post(strand_, asio::use_awaitable);
+    co_return Ok();
+  }
+
   auto ReceiveMessage()
       -> asio::awaitable<std::expected<std::string, error::RpcError>> override {
     if (is_closed_) {
@@ -201,6 +210,10 @@ class MockTransport : public jsonrpc::transport::Transport {
     return sent_requests_;
   }
 
+  void ClearSentRequests() {
+    sent_requests_.clear();
+  }
+
  private:
   std::vector<std::string> sent_requests_;
   std::queue<std::string> incoming_messages_;
@@ -1,5 +1,13 @@
 #include "jsonrpc/endpoint/dispatcher.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <asio.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/core.h>
@@ -7,6 +15,11 @@
 #include <spdlog/spdlog.h>
 
 using jsonrpc::endpoint::Dispatcher;
+using jsonrpc::endpoint::DispatcherOptions;
+using jsonrpc::endpoint::HandlerExecution;
+using jsonrpc::endpoint::HandlerOptions;
+using jsonrpc::endpoint::LazyParams;
+using jsonrpc::endpoint::Request;
 using jsonrpc::error::RpcErrorCode;
 
 // Helper function for running dispatcher tests
@@ -62,6 +75,54 @@ TEST_CASE("Method registration and handling", "[Dispatcher]") {
   });
 }
 
+TEST_CASE("Route registration", "[Dispatcher]") {
+  SECTION("A method call and a notification can share a name") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      int notified = 0;
+      dispatcher.RegisterMethodCall(
+          "ping",
+          [](std::optional<nlohmann::json>) -> asio::awaitable<nlohmann::json> {
+            co_return "pong";
+          });
+      dispatcher.RegisterNotification(
+          "ping",
+          [&notified](std::optional<nlohmann::json>) -> asio::awaitable<void> {
+            ++notified;
+            co_return;
+          });
+
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"ping","id":1})");
+      REQUIRE(response.has_value());
+      REQUIRE(nlohmann::json::parse(*response)["result"] == "pong");
+
+      auto none = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"ping"})");
+      REQUIRE_FALSE(none.has_value());
+      co_await asio::post(executor, asio::use_awaitable);
+      REQUIRE(notified == 1);
+    });
+  }
+
+  SECTION("Re-registering replaces the handler") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      for (int version : {1, 2}) {
+        dispatcher.RegisterMethodCall(
+            "version",
+            [version](std::optional<nlohmann::json>)
+                -> asio::awaitable<nlohmann::json> { co_return version; });
+      }
+
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"version","id":1})");
+      REQUIRE(response.has_value());
+      REQUIRE(nlohmann::json::parse(*response)["result"] == 2);
+    });
+  }
+}
+
 TEST_CASE("Batch request handling", "[Dispatcher]") {
   asio::io_context io_ctx;
   auto executor = io_ctx.get_executor();
@@ -201,3 +262,731 @@ TEST_CASE("Error handling", "[Dispatcher]") {
     });
   }
 }
+
+TEST_CASE("Pre-parsed dispatch", "[Dispatcher]") {
+  SECTION("Dispatch a parsed message") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      dispatcher.RegisterMethodCall(
+          "echo",
+          [](std::optional<nlohmann::json> params)
+              -> asio::awaitable<nlohmann::json> { co_return *params; });
+
+      auto message = nlohmann::json::parse(
+          R"({"jsonrpc":"2.0","method":"echo","params":{"a":1},"id":1})");
+      auto response = co_await dispatcher.DispatchJson(std::move(message));
+      REQUIRE(response.has_value());
+      auto result = nlohmann::json::parse(*response);
+      REQUIRE(result["result"]["a"] == 1);
+      REQUIRE(result["id"] == 1);
+    });
+  }
+
+  SECTION("Params are moved into the handler") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      const std::string* received = nullptr;
+      dispatcher.RegisterMethodCall(
+          "inspect",
+          [&received](const std::optional<nlohmann::json>& params)
+              -> asio::awaitable<nlohmann::json> {
+            received = &(*params)[0].get_ref<const std::string&>();
+            co_return params->at(0).get_ref<const std::string&>().size();
+          });
+
+      nlohmann::json message = {
+          {"jsonrpc", "2.0"},
+          {"method", "inspect"},
+          {"params", {std::string(4096, 'x')}},
+          {"id", 1}};
+      const auto* original = &message["params"][0].get_ref<std::string&>();
+
+      auto request = Request::FromJson(std::move(message));
+      REQUIRE(request.has_value());
+      auto response = co_await dispatcher.DispatchRequest(
+          std::move(request.value()));
+      REQUIRE(response.has_value());
+      REQUIRE(response->GetResult() == 4096);
+      REQUIRE(received == original);
+    });
+  }
+
+  SECTION("Batch of parsed requests") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      dispatcher.RegisterMethodCall(
+          "size",
+          [](std::optional<nlohmann::json> params)
+              -> asio::awaitable<nlohmann::json> { co_return params->size(); });
+
+      auto batch = nlohmann::json::parse(R"([
+          {"jsonrpc":"2.0","method":"size","params":[1,2],"id":1},
+          {"jsonrpc":"2.0","method":"size","params":[1,2,3],"id":2}
+      ])");
+      auto response = co_await dispatcher.DispatchJson(std::move(batch));
+      REQUIRE(response.has_value());
+      auto result = nlohmann::json::parse(*response);
+      REQUIRE(result.size() == 2);
+      REQUIRE(result[0]["result"] == 2);
+      REQUIRE(result[1]["result"] == 3);
+    });
+  }
+}
+
+TEST_CASE("Concurrent batch execution", "[Dispatcher]") {
+  auto register_sleep = [](Dispatcher& dispatcher, int& active, int& peak) {
+    dispatcher.RegisterMethodCall(
+        "sleep",
+        [&active, &peak](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          peak = std::max(peak, ++active);
+          asio::steady_timer timer(
+              co_await asio::this_coro::executor,
+              std::chrono::milliseconds(params->at(0).get<int>()));
+          co_await timer.async_wait(asio::use_awaitable);
+          --active;
+          co_return params->at(1);
+        });
+  };
+
+  auto make_batch = [](int count, int delay_ms) {
+    auto batch = nlohmann::json::array();
+    for (int i = 0; i < count; ++i) {
+      // Earlier elements sleep longer so completion order differs from
+      // request order
+      batch.push_back(
+          {{"jsonrpc", "2.0"},
+           {"method", "sleep"},
+           {"params", {delay_ms * (count - i) / count, i}},
+           {"id", i}});
+    }
+    return batch;
+  };
+
+  SECTION("Elements run concurrently and keep request order") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      int active = 0;
+      int peak = 0;
+      register_sleep(dispatcher, active, peak);
+
+      auto start = std::chrono::steady_clock::now();
+      auto response = co_await dispatcher.DispatchJson(make_batch(10, 100));
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      REQUIRE(response.has_value());
+      auto result = nlohmann::json::parse(*response);
+      REQUIRE(result.size() == 10);
+      for (int i = 0; i < 10; ++i) {
+        REQUIRE(result[i]["id"] == i);
+        REQUIRE(result[i]["result"] == i);
+      }
+      REQUIRE(peak == 10);
+      REQUIRE(elapsed < std::chrono::milliseconds(400));
+    });
+  }
+
+  SECTION("Concurrency cap is respected") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(
+          executor, DispatcherOptions{.max_batch_concurrency = 3});
+      int active = 0;
+      int peak = 0;
+      register_sleep(dispatcher, active, peak);
+
+      auto response = co_await dispatcher.DispatchJson(make_batch(9, 30));
+      REQUIRE(response.has_value());
+      auto result = nlohmann::json::parse(*response);
+      REQUIRE(result.size() == 9);
+      REQUIRE(result[8]["result"] == 8);
+      REQUIRE(peak == 3);
+    });
+  }
+
+  SECTION("Oversized batch is rejected") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor, DispatcherOptions{.max_batch_size = 4});
+      int active = 0;
+      int peak = 0;
+      register_sleep(dispatcher, active, peak);
+
+      auto response = co_await dispatcher.DispatchJson(make_batch(5, 0));
+      REQUIRE(response.has_value());
+      auto result = nlohmann::json::parse(*response);
+      REQUIRE(result.is_object());
+      REQUIRE(
+          result["error"]["code"] ==
+          static_cast<int>(RpcErrorCode::kInvalidRequest));
+      REQUIRE(peak == 0);
+    });
+  }
+}
+
+TEST_CASE("Serial handlers on a thread pool", "[Dispatcher]") {
+  asio::thread_pool pool(4);
+  Dispatcher dispatcher(pool.get_executor());
+
+  std::atomic<int> active{0};
+  std::atomic<int> peak{0};
+  std::vector<int> order;
+  dispatcher.RegisterMethodCall(
+      "append",
+      [&](std::optional<nlohmann::json> params)
+          -> asio::awaitable<nlohmann::json> {
+        auto now = ++active;
+        peak = std::max(peak.load(), now);
+        // Suspend mid-call; the next call must still wait for this one
+        asio::steady_timer timer(
+            co_await asio::this_coro::executor, std::chrono::milliseconds(2));
+        co_await timer.async_wait(asio::use_awaitable);
+        order.push_back(params->at(0).get<int>());
+        --active;
+        co_return nullptr;
+      },
+      HandlerOptions{.execution = HandlerExecution::kSerial});
+
+  constexpr int kCalls = 20;
+  std::atomic<int> done{0};
+  for (int i = 0; i < kCalls; ++i) {
+    nlohmann::json message = {
+        {"jsonrpc", "2.0"}, {"method", "append"}, {"params", {i}}, {"id", i}};
+    auto executor = dispatcher.ExecutorFor(message);
+    asio::co_spawn(
+        executor,
+        [&dispatcher, &done, message]() mutable -> asio::awaitable<void> {
+          co_await dispatcher.DispatchJson(std::move(message));
+          ++done;
+        },
+        asio::detached);
+  }
+  pool.join();
+
+  REQUIRE(done == kCalls);
+  REQUIRE(peak == 1);
+  REQUIRE(order.size() == static_cast<std::size_t>(kCalls));
+  for (int i = 0; i < kCalls; ++i) {
+    REQUIRE(order[i] == i);
+  }
+}
+
+TEST_CASE("Request cancellation", "[Dispatcher]") {
+  // Answers after the delay unless it is cancelled first
+  auto register_wait = [](Dispatcher& dispatcher) {
+    dispatcher.RegisterMethodCall(
+        "wait",
+        [](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          asio::steady_timer timer(
+              co_await asio::this_coro::executor,
+              std::chrono::milliseconds(params->at(0).get<int>()));
+          co_await timer.async_wait(asio::use_awaitable);
+          co_return "finished";
+        });
+  };
+
+  // Starts a call on the peer, sends the cancel from another, and returns
+  // the call's response
+  auto cancel_call = [](Dispatcher& dispatcher, asio::any_io_executor executor,
+                        Dispatcher::PeerId cancel_peer)
+      -> asio::awaitable<nlohmann::json> {
+    std::optional<std::string> response;
+    asio::co_spawn(
+        executor,
+        [&dispatcher, &response]() -> asio::awaitable<void> {
+          nlohmann::json call = {
+              {"jsonrpc", "2.0"}, {"method", "wait"}, {"params", {50}},
+              {"id", 7}};
+          response = co_await dispatcher.DispatchJson(std::move(call), 1);
+        },
+        asio::detached);
+
+    asio::steady_timer timer(executor, std::chrono::milliseconds(10));
+    co_await timer.async_wait(asio::use_awaitable);
+    nlohmann::json cancel = {
+        {"jsonrpc", "2.0"},
+        {"method", "$/cancelRequest"},
+        {"params", {{"id", 7}}}};
+    auto cancel_response =
+        co_await dispatcher.DispatchJson(std::move(cancel), cancel_peer);
+    REQUIRE_FALSE(cancel_response.has_value());
+
+    while (!response.has_value()) {
+      timer.expires_after(std::chrono::milliseconds(5));
+      co_await timer.async_wait(asio::use_awaitable);
+    }
+    co_return nlohmann::json::parse(*response);
+  };
+
+  SECTION("The cancelled call answers with RequestCancelled") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      register_wait(dispatcher);
+      auto response = co_await cancel_call(dispatcher, executor, 1);
+      REQUIRE(response["id"] == 7);
+      REQUIRE(
+          response["error"]["code"] ==
+          static_cast<int>(RpcErrorCode::kRequestCancelled));
+    });
+  }
+
+  SECTION("Another peer cannot cancel the call") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      register_wait(dispatcher);
+      auto response = co_await cancel_call(dispatcher, executor, 2);
+      REQUIRE(response["result"] == "finished");
+    });
+  }
+
+  SECTION("A cancel right after the request is kept until the call starts") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      // Serial, so the second call waits for its turn before registering
+      dispatcher.RegisterMethodCall(
+          "wait",
+          [](std::optional<nlohmann::json> params)
+              -> asio::awaitable<nlohmann::json> {
+            asio::steady_timer timer(
+                co_await asio::this_coro::executor,
+                std::chrono::milliseconds(params->at(0).get<int>()));
+            co_await timer.async_wait(asio::use_awaitable);
+            co_return "finished";
+          },
+          HandlerOptions{.execution = HandlerExecution::kSerial});
+
+      std::optional<std::string> first;
+      std::optional<std::string> second;
+      auto spawn_call = [&dispatcher, executor](
+                            int id, std::optional<std::string>& response) {
+        asio::co_spawn(
+            executor,
+            [&dispatcher, &response, id]() -> asio::awaitable<void> {
+              nlohmann::json call = {
+                  {"jsonrpc", "2.0"}, {"method", "wait"}, {"params", {30}},
+                  {"id", id}};
+              response = co_await dispatcher.DispatchJson(std::move(call), 1);
+            },
+            asio::detached);
+      };
+      spawn_call(6, first);
+      spawn_call(7, second);
+      nlohmann::json cancel = {
+          {"jsonrpc", "2.0"},
+          {"method", "$/cancelRequest"},
+          {"params", {{"id", 7}}}};
+      co_await dispatcher.DispatchJson(std::move(cancel), 1);
+
+      asio::steady_timer timer(executor);
+      while (!first.has_value() || !second.has_value()) {
+        timer.expires_after(std::chrono::milliseconds(5));
+        co_await timer.async_wait(asio::use_awaitable);
+      }
+      REQUIRE(nlohmann::json::parse(*first)["result"] == "finished");
+      auto response = nlohmann::json::parse(*second);
+      REQUIRE(response["id"] == 7);
+      REQUIRE(
+          response["error"]["code"] ==
+          static_cast<int>(RpcErrorCode::kRequestCancelled));
+    });
+  }
+
+  SECTION("An empty cancel method turns cancellation off") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      DispatcherOptions options;
+      options.cancel_method.clear();
+      Dispatcher dispatcher(executor, options);
+      register_wait(dispatcher);
+      auto response = co_await cancel_call(dispatcher, executor, 1);
+      REQUIRE(response["result"] == "finished");
+    });
+  }
+}
+
+TEST_CASE("Cancellable calls stay on their executor", "[Dispatcher]") {
+  // Nothing runs the dispatcher's own context, so a call that needed to pass
+  // through a strand on it would never answer
+  asio::io_context idle;
+  RunTest([&idle](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(idle.get_executor());
+    dispatcher.RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          co_return params.value_or(nlohmann::json());
+        });
+    nlohmann::json call = {
+        {"jsonrpc", "2.0"}, {"method", "echo"}, {"params", {1}}, {"id", 1}};
+    auto response = co_await dispatcher.DispatchJson(
+        std::move(call), 1, std::nullopt, nullptr, executor);
+    REQUIRE(response.has_value());
+    REQUIRE(
+        nlohmann::json::parse(*response)["result"] ==
+        nlohmann::json::parse("[1]"));
+  });
+}
+
+TEST_CASE("Method metrics", "[Dispatcher]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    dispatcher.RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          co_return params.value_or(nlohmann::json());
+        });
+    dispatcher.RegisterMethodCall(
+        "fail",
+        [](const std::optional<nlohmann::json>&)
+            -> asio::awaitable<nlohmann::json> {
+          throw std::runtime_error("boom");
+        });
+
+    co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"echo","params":[1],"id":1})");
+    co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"echo","params":[2],"id":2})");
+    co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"fail","id":3})");
+    co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"missing","id":4})");
+
+    auto metrics = dispatcher.GetMetrics();
+    REQUIRE(metrics.methods.size() == 2);
+    REQUIRE(metrics.methods["echo"].calls == 2);
+    REQUIRE(metrics.methods["echo"].errors == 0);
+    REQUIRE(metrics.methods["echo"].handler_latency.count == 2);
+    REQUIRE(metrics.methods["echo"].queue_latency.count == 2);
+    REQUIRE(metrics.methods["fail"].calls == 1);
+    REQUIRE(metrics.methods["fail"].errors == 1);
+    REQUIRE(metrics.unknown_method_calls == 1);
+
+    // Registering again keeps the counts
+    dispatcher.RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json>) -> asio::awaitable<nlohmann::json> {
+          co_return nullptr;
+        });
+    REQUIRE(dispatcher.GetMetrics().methods["echo"].calls == 2);
+  });
+}
+
+TEST_CASE("Lazy handlers", "[Dispatcher]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    REQUIRE_FALSE(dispatcher.HasLazyHandlers());
+    dispatcher.RegisterLazyMethodCall(
+        "open",
+        [](LazyParams params)
+            -> asio::awaitable<nlohmann::json> {
+          // The unread member is never parsed
+          REQUIRE(params.Raw().has_value());
+          auto uri = params.Get<std::string>("/uri");
+          if (!uri) {
+            throw std::runtime_error(uri.error().Message());
+          }
+          co_return *uri;
+        });
+    REQUIRE(dispatcher.HasLazyHandlers());
+    REQUIRE(dispatcher.WantsLazyParams("open"));
+    REQUIRE_FALSE(dispatcher.WantsLazyParams("close"));
+
+    auto response = co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"open",)"
+        R"("params":{"text":"x","uri":"a"},"id":1})");
+    REQUIRE(response.has_value());
+    REQUIRE(nlohmann::json::parse(*response)["result"] == "a");
+
+    response = co_await dispatcher.DispatchRequest(
+        R"({"jsonrpc":"2.0","method":"open","params":{"text":"x"},"id":2})");
+    REQUIRE(response.has_value());
+    auto error = nlohmann::json::parse(*response);
+    REQUIRE(error["error"]["code"] == -32603);
+
+    // A regular registration under the same name parses params again
+    dispatcher.RegisterMethodCall(
+        "open",
+        [](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> { co_return *params; });
+    REQUIRE_FALSE(dispatcher.WantsLazyParams("open"));
+  });
+}
+
+TEST_CASE("Streaming method calls", "[Dispatcher]") {
+  using jsonrpc::endpoint::ResultStream;
+
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    dispatcher.RegisterStreamingMethodCall(
+        "list",
+        [](std::optional<nlohmann::json>&&, ResultStream& stream)
+            -> asio::awaitable<void> {
+          co_await stream.Write(nlohmann::json::parse("[1, 2]"));
+          co_await stream.Write(3);
+        });
+
+    SECTION("Parts go to the sender when the call has a token") {
+      std::vector<nlohmann::json> sent;
+      ResultStream::Sender sender = [&sent](std::string message)
+          -> asio::awaitable<std::expected<void, jsonrpc::error::RpcError>> {
+        sent.push_back(nlohmann::json::parse(message));
+        co_return std::expected<void, jsonrpc::error::RpcError>{};
+      };
+      auto response = co_await dispatcher.DispatchJson(
+          nlohmann::json::parse(
+              R"({"jsonrpc":"2.0","method":"list",)"
+              R"("params":{"partialResultToken":"t"},"id":1})"),
+          0, std::nullopt, sender);
+      REQUIRE(response.has_value());
+      REQUIRE(nlohmann::json::parse(*response)["result"].empty());
+      REQUIRE(sent.size() == 2);
+      REQUIRE(sent[0]["method"] == "$/progress");
+      REQUIRE(sent[0]["params"]["token"] == "t");
+      REQUIRE(sent[0]["params"]["value"] == nlohmann::json::parse("[1, 2]"));
+      REQUIRE(sent[1]["params"]["value"] == nlohmann::json::parse("[3]"));
+    }
+
+    SECTION("Parts are collected without a sender") {
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"list",)"
+          R"("params":{"partialResultToken":"t"},"id":1})");
+      REQUIRE(response.has_value());
+      REQUIRE(
+          nlohmann::json::parse(*response)["result"] ==
+          nlohmann::json::parse("[1, 2, 3]"));
+    }
+  });
+}
+
+TEST_CASE("Response priorities", "[Dispatcher]") {
+  using jsonrpc::transport::MessagePriority;
+
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    auto handler = [](std::optional<nlohmann::json>)
+        -> asio::awaitable<nlohmann::json> { co_return nullptr; };
+    dispatcher.RegisterMethodCall("hover", handler);
+    dispatcher.RegisterMethodCall(
+        "dump", handler, {.priority = MessagePriority::kBulk});
+
+    auto call = [](const std::string& method) {
+      return nlohmann::json{
+          {"jsonrpc", "2.0"}, {"method", method}, {"id", 1}};
+    };
+    const auto unknown = dispatcher.PriorityFor(call("unknown"));
+    REQUIRE(
+        dispatcher.PriorityFor(call("hover")) == MessagePriority::kInteractive);
+    REQUIRE(dispatcher.PriorityFor(call("dump")) == MessagePriority::kBulk);
+    REQUIRE(unknown == MessagePriority::kInteractive);
+    co_return;
+  });
+}
+
+TEST_CASE("Coalesced notifications", "[Dispatcher]") {
+  using namespace std::chrono_literals;
+
+  SECTION("A burst runs the handler once with the newest params") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      std::vector<nlohmann::json> seen;
+      HandlerOptions options;
+      options.coalesce.window = 20ms;
+      dispatcher.RegisterNotification(
+          "progress",
+          [&seen](std::optional<nlohmann::json> params)
+              -> asio::awaitable<void> {
+            seen.push_back(*params);
+            co_return;
+          },
+          options);
+
+      for (int i = 0; i < 5; ++i) {
+        auto none = co_await dispatcher.DispatchRequest(
+            R"({"jsonrpc":"2.0","method":"progress","params":{"n":)" +
+            std::to_string(i) + "}}");
+        REQUIRE_FALSE(none.has_value());
+      }
+      REQUIRE(seen.empty());
+
+      asio::steady_timer timer(executor, 100ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      REQUIRE(seen.size() == 1);
+      REQUIRE(seen[0]["n"] == 4);
+      REQUIRE(dispatcher.GetMetrics().methods.at("progress").calls == 5);
+    });
+  }
+
+  SECTION("Keys keep groups apart and merge folds their params") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      std::map<std::string, int> totals;
+      HandlerOptions options;
+      options.coalesce.window = 20ms;
+      options.coalesce.key = [](const std::optional<nlohmann::json>& params) {
+        return params->at("uri").get<std::string>();
+      };
+      options.coalesce.merge = [](std::optional<nlohmann::json> pending,
+                                  std::optional<nlohmann::json> newer) {
+        (*pending)["n"] = (*pending)["n"].get<int>() + (*newer)["n"].get<int>();
+        return pending;
+      };
+      dispatcher.RegisterNotification(
+          "changed",
+          [&totals](std::optional<nlohmann::json> params)
+              -> asio::awaitable<void> {
+            totals[(*params)["uri"].get<std::string>()] +=
+                (*params)["n"].get<int>();
+            co_return;
+          },
+          options);
+
+      for (const auto* change : {
+               R"({"uri":"a","n":1})", R"({"uri":"b","n":10})",
+               R"({"uri":"a","n":2})"}) {
+        co_await dispatcher.DispatchRequest(
+            std::string(R"({"jsonrpc":"2.0","method":"changed","params":)") +
+            change + "}");
+      }
+
+      asio::steady_timer timer(executor, 100ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      REQUIRE(totals.size() == 2);
+      REQUIRE(totals["a"] == 3);
+      REQUIRE(totals["b"] == 10);
+    });
+  }
+  SECTION("The handler runs on the caller's handler executor") {
+    asio::thread_pool pool(1);
+    std::atomic<int> on_pool{0};
+    RunTest(
+        [&pool, &on_pool](
+            asio::any_io_executor executor) -> asio::awaitable<void> {
+          Dispatcher dispatcher(executor);
+          HandlerOptions options;
+          options.coalesce.window = 20ms;
+          dispatcher.RegisterNotification(
+              "progress",
+              [&pool, &on_pool](
+                  std::optional<nlohmann::json>) -> asio::awaitable<void> {
+                if (pool.get_executor().running_in_this_thread()) {
+                  ++on_pool;
+                }
+                co_return;
+              },
+              options);
+
+          co_await dispatcher.DispatchJson(
+              nlohmann::json::parse(
+                  R"({"jsonrpc":"2.0","method":"progress","params":{}})"),
+              1, std::nullopt, nullptr, pool.get_executor());
+          asio::steady_timer timer(executor, 100ms);
+          co_await timer.async_wait(asio::use_awaitable);
+        });
+    pool.join();
+    REQUIRE(on_pool == 1);
+  }
+}
+
+TEST_CASE("Idempotent method results", "[Dispatcher]") {
+  using namespace std::chrono_literals;
+
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    int runs = 0;
+    HandlerOptions options;
+    options.cache_ttl = 1min;
+    dispatcher.RegisterMethodCall(
+        "lookup",
+        [&runs, executor](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          ++runs;
+          asio::steady_timer timer(executor, 10ms);
+          co_await timer.async_wait(asio::use_awaitable);
+          co_return (*params)["name"];
+        },
+        options);
+
+    const std::string call =
+        R"({"jsonrpc":"2.0","method":"lookup","params":{"name":"a"},"id":1})";
+
+    SECTION("Repeated calls are answered from the cache") {
+      for (int i = 0; i < 3; ++i) {
+        auto response = co_await dispatcher.DispatchRequest(call);
+        REQUIRE(response.has_value());
+        REQUIRE(nlohmann::json::parse(*response)["result"] == "a");
+      }
+      REQUIRE(runs == 1);
+      const auto metrics = dispatcher.GetMetrics().methods.at("lookup");
+      REQUIRE(metrics.calls == 3);
+      REQUIRE(metrics.cache_hits == 2);
+    }
+
+    SECTION("Concurrent calls share one handler run") {
+      int answered = 0;
+      for (int i = 0; i < 4; ++i) {
+        asio::co_spawn(
+            executor,
+            [&dispatcher, &call, &answered]() -> asio::awaitable<void> {
+              auto response = co_await dispatcher.DispatchRequest(call);
+              REQUIRE(nlohmann::json::parse(*response)["result"] == "a");
+              ++answered;
+            },
+            asio::detached);
+      }
+      asio::steady_timer timer(executor, 100ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      REQUIRE(answered == 4);
+      REQUIRE(runs == 1);
+    }
+
+    SECTION("Invalidation runs the handler again") {
+      co_await dispatcher.DispatchRequest(call);
+      co_await dispatcher.InvalidateCache("lookup");
+      co_await dispatcher.DispatchRequest(call);
+      REQUIRE(runs == 2);
+    }
+  });
+}
+
+TEST_CASE("Cached serial methods keep call order", "[Dispatcher]") {
+  using namespace std::chrono_literals;
+
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    Dispatcher dispatcher(executor);
+    HandlerOptions options;
+    options.execution = HandlerExecution::kSerial;
+    options.cache_ttl = 1min;
+    dispatcher.RegisterMethodCall(
+        "lookup",
+        [executor](std::optional<nlohmann::json> params)
+            -> asio::awaitable<nlohmann::json> {
+          asio::steady_timer timer(executor, 10ms);
+          co_await timer.async_wait(asio::use_awaitable);
+          co_return (*params)["name"];
+        },
+        options);
+
+    // The third call is a hit, but only once the second has run
+    std::vector<int> answered;
+    for (int id = 1; id <= 3; ++id) {
+      auto call = fmt::format(
+          R"({{"jsonrpc":"2.0","method":"lookup","params":{{"name":"{}"}},)"
+          R"("id":{}}})",
+          id == 2 ? "b" : "a", id);
+      asio::co_spawn(
+          executor,
+          [&dispatcher, &answered, call = std::move(call),
+           id]() -> asio::awaitable<void> {
+            co_await dispatcher.DispatchRequest(call);
+            answered.push_back(id);
+          },
+          asio::detached);
+    }
+    asio::steady_timer timer(executor, 100ms);
+    co_await timer.async_wait(asio::use_awaitable);
+    REQUIRE(answered.size() == 3);
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(answered[i] == i + 1);
+    }
+    REQUIRE(dispatcher.GetMetrics().methods.at("lookup").cache_hits == 1);
+  });
+}
@@ -1,6 +1,11 @@
 #include "jsonrpc/endpoint/endpoint.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include <asio.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -10,10 +15,15 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include "jsonrpc/transport/in_process_transport.hpp"
+
 #include "../common/mock_transport.hpp"
 
 using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::error::RpcError;
+using jsonrpc::error::RpcErrorCode;
 using jsonrpc::test::MockTransport;
+using jsonrpc::transport::InProcessTransport;
 using Json = nlohmann::json;
 
 namespace {
@@ -89,3 +99,991 @@ TEST_CASE("RpcEndpoint - Basic lifecycle", "[endpoint]") {
     });
   }
 }
+
+TEST_CASE("RpcEndpoint - Request timeouts", "[endpoint]") {
+  SECTION("Unanswered call fails with timeout error") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+
+      REQUIRE(co_await endpoint->Start());
+
+      auto result = co_await endpoint->SendMethodCall(
+          "never_answered", std::nullopt, std::chrono::milliseconds(20));
+      REQUIRE_FALSE(result);
+      REQUIRE(
+          result.error().Code() == jsonrpc::error::RpcErrorCode::kTimeoutError);
+      REQUIRE_FALSE(endpoint->HasPendingRequests());
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Endpoint-wide default timeout applies") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      jsonrpc::endpoint::EndpointOptions options;
+      options.request_timeout = std::chrono::milliseconds(20);
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+
+      REQUIRE(co_await endpoint->Start());
+
+      auto result = co_await endpoint->SendMethodCall("never_answered");
+      REQUIRE_FALSE(result);
+      REQUIRE(
+          result.error().Code() == jsonrpc::error::RpcErrorCode::kTimeoutError);
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Request cancellation", "[endpoint]") {
+  // Polls until the mock has seen the expected number of messages
+  auto wait_for_sent = [](MockTransport& mock, asio::any_io_executor executor,
+                          std::size_t count) -> asio::awaitable<void> {
+    for (int i = 0; i < 100 && mock.GetSentRequests().size() < count; ++i) {
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+          .async_wait(asio::use_awaitable);
+    }
+  };
+
+  SECTION("A timed out call tells the peer to stop") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      REQUIRE(co_await endpoint->Start());
+
+      auto result = co_await endpoint->SendMethodCall(
+          "never_answered", std::nullopt, std::chrono::milliseconds(20));
+      REQUIRE_FALSE(result);
+      co_await wait_for_sent(mock, executor, 2);
+
+      REQUIRE(mock.GetSentRequests().size() == 2);
+      auto call = Json::parse(mock.GetSentRequests()[0]);
+      auto cancel = Json::parse(mock.GetSentRequests()[1]);
+      REQUIRE(cancel["method"] == "$/cancelRequest");
+      REQUIRE_FALSE(cancel.contains("id"));
+      REQUIRE(cancel["params"]["id"] == call["id"]);
+
+      REQUIRE(co_await endpoint->Shutdown());
+      co_await endpoint->WaitForHandlers();
+    });
+  }
+
+  SECTION("Cancelling the caller fails the call and notifies the peer") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      REQUIRE(co_await endpoint->Start());
+
+      asio::cancellation_signal signal;
+      std::optional<std::expected<Json, RpcError>> result;
+      asio::co_spawn(
+          executor, endpoint->SendMethodCall("slow"),
+          asio::bind_cancellation_slot(
+              signal.slot(),
+              [&result](
+                  std::exception_ptr, std::expected<Json, RpcError> value) {
+                result = std::move(value);
+              }));
+      co_await wait_for_sent(mock, executor, 1);
+      signal.emit(asio::cancellation_type::terminal);
+      co_await wait_for_sent(mock, executor, 2);
+
+      REQUIRE(result.has_value());
+      REQUIRE_FALSE(*result);
+      REQUIRE(result->error().Code() == RpcErrorCode::kRequestCancelled);
+      REQUIRE_FALSE(endpoint->HasPendingRequests());
+      auto cancel = Json::parse(mock.GetLastSentMessage());
+      REQUIRE(cancel["method"] == "$/cancelRequest");
+
+      REQUIRE(co_await endpoint->Shutdown());
+      co_await endpoint->WaitForHandlers();
+    });
+  }
+
+  SECTION("A cancel notification stops the running handler") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      endpoint->RegisterMethodCall(
+          "slow", [executor](std::optional<Json>) -> asio::awaitable<Json> {
+            co_await asio::steady_timer(executor, std::chrono::seconds(10))
+                .async_wait(asio::use_awaitable);
+            co_return true;
+          });
+      REQUIRE(co_await endpoint->Start());
+
+      const Json request = {
+          {"jsonrpc", "2.0"}, {"method", "slow"}, {"id", 5}};
+      const Json cancel = {
+          {"jsonrpc", "2.0"},
+          {"method", "$/cancelRequest"},
+          {"params", {{"id", 5}}}};
+      mock.SetMessage(request.dump());
+      mock.SetMessage(cancel.dump());
+      co_await wait_for_sent(mock, executor, 1);
+
+      REQUIRE(mock.GetSentRequests().size() == 1);
+      auto response = Json::parse(mock.GetLastSentMessage());
+      REQUIRE(response["id"] == 5);
+      REQUIRE(
+          response["error"]["code"] ==
+          static_cast<int>(RpcErrorCode::kRequestCancelled));
+
+      REQUIRE(co_await endpoint->Shutdown());
+      co_await endpoint->WaitForHandlers();
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Responses", "[endpoint]") {
+  // Sends one call and answers it with the response built from its ID
+  auto answer = [](asio::any_io_executor executor, auto make_response)
+      -> asio::awaitable<std::optional<std::expected<Json, RpcError>>> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    auto& mock = *transport;
+    auto endpoint =
+        std::make_unique<RpcEndpoint>(executor, std::move(transport));
+    REQUIRE(co_await endpoint->Start());
+
+    std::optional<std::expected<Json, RpcError>> result;
+    asio::co_spawn(
+        executor,
+        endpoint->SendMethodCall(
+            "call", std::nullopt, std::chrono::milliseconds(200)),
+        [&result](std::exception_ptr, std::expected<Json, RpcError> value) {
+          result = std::move(value);
+        });
+    for (int i = 0; i < 100 && mock.GetSentRequests().empty(); ++i) {
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+          .async_wait(asio::use_awaitable);
+    }
+    auto id = Json::parse(mock.GetSentRequests().front())["id"];
+    mock.SetMessage(make_response(id.get<int64_t>()).dump());
+    while (!result) {
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+          .async_wait(asio::use_awaitable);
+    }
+
+    REQUIRE(co_await endpoint->Shutdown());
+    co_return result;
+  };
+
+  SECTION("A string ID matches the call with that number") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto result = co_await answer(executor, [](int64_t id) {
+        return Json{
+            {"jsonrpc", "2.0"},
+            {"id", std::to_string(id)},
+            {"result", {{"value", 7}}}};
+      });
+      REQUIRE(*result);
+      REQUIRE((**result)["value"] == 7);
+    });
+  }
+
+  SECTION("A peer error fails the call with its message") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto result = co_await answer(executor, [](int64_t id) {
+        return Json{
+            {"jsonrpc", "2.0"},
+            {"id", id},
+            {"error", {{"code", -32000}, {"message", "no such file"}}}};
+      });
+      REQUIRE_FALSE(*result);
+      REQUIRE(result->error().Message() == "no such file");
+    });
+  }
+
+  SECTION("A malformed error leaves the call to time out") {
+    RunTest([&](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto result = co_await answer(executor, [](int64_t id) {
+        return Json{{"jsonrpc", "2.0"}, {"id", id}, {"error", "oops"}};
+      });
+      REQUIRE_FALSE(*result);
+      REQUIRE(result->error().Code() == RpcErrorCode::kTimeoutError);
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Pending request limit", "[endpoint]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    jsonrpc::endpoint::EndpointOptions options;
+    options.max_pending_requests = 1;
+    auto endpoint = std::make_unique<RpcEndpoint>(
+        executor, std::move(transport), options);
+
+    REQUIRE(co_await endpoint->Start());
+
+    // Occupies the only slot until it times out
+    asio::co_spawn(
+        executor,
+        [&endpoint]() -> asio::awaitable<void> {
+          co_await endpoint->SendMethodCall(
+              "never_answered", std::nullopt, std::chrono::milliseconds(50));
+        },
+        asio::detached);
+    co_await asio::post(executor, asio::use_awaitable);
+    REQUIRE(endpoint->HasPendingRequests());
+
+    auto rejected = co_await endpoint->SendMethodCall("second");
+    REQUIRE_FALSE(rejected);
+    REQUIRE(rejected.error().Message() == "Too many outstanding requests");
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(100))
+        .async_wait(asio::use_awaitable);
+    REQUIRE_FALSE(endpoint->HasPendingRequests());
+
+    REQUIRE(co_await endpoint->Shutdown());
+  });
+}
+
+namespace {
+
+// Opted in to direct serialization, so it never becomes a nlohmann::json
+struct WireParams {
+  int value = 0;
+};
+
+void WriteJson(jsonrpc::endpoint::JsonWriter& writer, const WireParams& p) {
+  writer.BeginObject();
+  writer.Field("value", p.value);
+  writer.EndObject();
+}
+
+// Answers every call in the last frame sent, echoing its method as result
+auto AnswerLastFrame(MockTransport& transport) -> std::size_t {
+  auto frame = Json::parse(transport.GetLastSentMessage());
+  auto responses = Json::array();
+  for (const auto& entry : frame) {
+    if (entry.contains("id")) {
+      responses.push_back(
+          {{"jsonrpc", "2.0"},
+           {"id", entry["id"]},
+           {"result", entry["method"]}});
+    }
+  }
+  transport.SetMessage(responses.dump());
+  return frame.size();
+}
+
+}  // namespace
+
+TEST_CASE("RpcEndpoint - Batches", "[endpoint]") {
+  SECTION("SendBatch sends one frame and splits the answers") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      REQUIRE(co_await endpoint->Start());
+
+      std::vector<jsonrpc::endpoint::BatchEntry> entries;
+      entries.push_back({.method = "first"});
+      entries.push_back({.method = "log", .is_notification = true});
+      entries.push_back({.method = "second"});
+
+      std::size_t frame_size = 0;
+      asio::co_spawn(
+          executor,
+          [&mock, &frame_size, executor]() -> asio::awaitable<void> {
+            co_await asio::steady_timer(
+                executor, std::chrono::milliseconds(20))
+                .async_wait(asio::use_awaitable);
+            frame_size = AnswerLastFrame(mock);
+          },
+          asio::detached);
+
+      auto results = co_await endpoint->SendBatch(std::move(entries));
+      REQUIRE(results);
+      REQUIRE(mock.GetSentRequests().size() == 1);
+      REQUIRE(frame_size == 3);
+      REQUIRE(results->size() == 3);
+      REQUIRE((*results)[0].value() == "first");
+      REQUIRE((*results)[1].value().is_null());
+      REQUIRE((*results)[2].value() == "second");
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("An empty batch is rejected") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::make_unique<MockTransport>(executor));
+      REQUIRE(co_await endpoint->Start());
+
+      auto results = co_await endpoint->SendBatch({});
+      REQUIRE_FALSE(results);
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Auto-batching coalesces concurrent calls") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      jsonrpc::endpoint::EndpointOptions options;
+      options.auto_batch = {
+          .enabled = true,
+          .window = std::chrono::milliseconds(5),
+          .max_entries = 8};
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      REQUIRE(co_await endpoint->Start());
+
+      std::optional<Json> other;
+      asio::co_spawn(
+          executor,
+          [&endpoint, &other]() -> asio::awaitable<void> {
+            auto result = co_await endpoint->SendMethodCall("other");
+            if (result) {
+              other = *result;
+            }
+          },
+          asio::detached);
+      asio::co_spawn(
+          executor,
+          [&mock, executor]() -> asio::awaitable<void> {
+            co_await asio::steady_timer(
+                executor, std::chrono::milliseconds(20))
+                .async_wait(asio::use_awaitable);
+            AnswerLastFrame(mock);
+          },
+          asio::detached);
+
+      auto result = co_await endpoint->SendMethodCall("mine");
+      REQUIRE(result);
+      REQUIRE(*result == "mine");
+      REQUIRE(mock.GetSentRequests().size() == 1);
+      REQUIRE(Json::parse(mock.GetLastSentMessage()).size() == 2);
+
+      co_await asio::post(executor, asio::use_awaitable);
+      REQUIRE(other == Json("other"));
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Direct serialization", "[endpoint]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    auto& mock = *transport;
+    auto endpoint =
+        std::make_unique<RpcEndpoint>(executor, std::move(transport));
+    REQUIRE(co_await endpoint->Start());
+
+    REQUIRE(co_await endpoint->SendNotification("note", WireParams{7}));
+    auto note = Json::parse(mock.GetLastSentMessage());
+    REQUIRE(note["method"] == "note");
+    REQUIRE(note["params"]["value"] == 7);
+    REQUIRE_FALSE(note.contains("id"));
+
+    asio::co_spawn(
+        executor,
+        [&mock, executor]() -> asio::awaitable<void> {
+          co_await asio::steady_timer(executor, std::chrono::milliseconds(20))
+              .async_wait(asio::use_awaitable);
+          auto call = Json::parse(mock.GetLastSentMessage());
+          const Json response = {
+              {"jsonrpc", "2.0"},
+              {"id", call["id"]},
+              {"result", call["params"]["value"].get<int>() * 2}};
+          mock.SetMessage(response.dump());
+        },
+        asio::detached);
+
+    auto result = co_await endpoint->SendMethodCall<WireParams, int>(
+        "double", WireParams{21});
+    REQUIRE(result);
+    REQUIRE(*result == 42);
+    REQUIRE(Json::parse(mock.GetLastSentMessage())["jsonrpc"] == "2.0");
+
+    REQUIRE(co_await endpoint->Shutdown());
+  });
+}
+
+TEST_CASE("RpcEndpoint - Encoding negotiation", "[endpoint]") {
+  using jsonrpc::endpoint::EndpointOptions;
+  using jsonrpc::transport::MessageEncoding;
+
+  SECTION("JSON-only transports skip the round trip") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      EndpointOptions options;
+      options.encodings = {MessageEncoding::kCbor, MessageEncoding::kJson};
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      REQUIRE(co_await endpoint->Start());
+
+      auto encoding = co_await endpoint->NegotiateEncoding();
+      REQUIRE(encoding);
+      REQUIRE(*encoding == MessageEncoding::kJson);
+      REQUIRE(mock.GetSentRequests().empty());
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Peers are answered with an encoding both sides support") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      EndpointOptions options;
+      options.encodings = {MessageEncoding::kCbor, MessageEncoding::kJson};
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      REQUIRE(co_await endpoint->Start());
+
+      const Json request = {
+          {"jsonrpc", "2.0"},
+          {"method", "$/negotiateEncoding"},
+          {"params", {{"encodings", {"cbor", "json"}}}},
+          {"id", 1}};
+      mock.SetMessage(request.dump());
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(20))
+          .async_wait(asio::use_awaitable);
+
+      // The mock cannot carry CBOR, so JSON is the only common choice
+      auto response = Json::parse(mock.GetLastSentMessage());
+      REQUIRE(response["id"] == 1);
+      REQUIRE(response["result"]["encoding"] == "json");
+      REQUIRE(endpoint->Encoding() == MessageEncoding::kJson);
+
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - In-flight handler limit", "[endpoint]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    auto& mock = *transport;
+    jsonrpc::endpoint::EndpointOptions options;
+    options.max_in_flight_handlers = 2;
+    auto endpoint = std::make_unique<RpcEndpoint>(
+        executor, std::move(transport), options);
+
+    int running = 0;
+    int max_running = 0;
+    endpoint->RegisterMethodCall(
+        "slow",
+        [&running, &max_running, executor](
+            std::optional<Json>) -> asio::awaitable<Json> {
+          max_running = std::max(max_running, ++running);
+          co_await asio::steady_timer(executor, std::chrono::milliseconds(30))
+              .async_wait(asio::use_awaitable);
+          --running;
+          co_return true;
+        });
+    REQUIRE(co_await endpoint->Start());
+
+    constexpr int kCalls = 5;
+    for (int id = 0; id < kCalls; ++id) {
+      const Json request = {
+          {"jsonrpc", "2.0"}, {"method", "slow"}, {"id", id}};
+      mock.SetMessage(request.dump());
+    }
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(15))
+        .async_wait(asio::use_awaitable);
+    REQUIRE(running == 2);
+
+    // The rest are read as earlier handlers return
+    for (int i = 0; i < 100 && mock.GetSentRequests().size() < kCalls; ++i) {
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(10))
+          .async_wait(asio::use_awaitable);
+    }
+    REQUIRE(mock.GetSentRequests().size() == kCalls);
+    REQUIRE(max_running == 2);
+
+    REQUIRE(co_await endpoint->Shutdown());
+    co_await endpoint->WaitForHandlers();
+  });
+}
+
+TEST_CASE("RpcEndpoint - Notification handlers are counted", "[endpoint]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    auto& mock = *transport;
+    jsonrpc::endpoint::EndpointOptions options;
+    options.max_in_flight_handlers = 2;
+    auto endpoint = std::make_unique<RpcEndpoint>(
+        executor, std::move(transport), options);
+
+    int running = 0;
+    int max_running = 0;
+    int finished = 0;
+    endpoint->RegisterNotification(
+        "slow",
+        [&running, &max_running, &finished,
+         executor](std::optional<Json>) -> asio::awaitable<void> {
+          max_running = std::max(max_running, ++running);
+          co_await asio::steady_timer(executor, std::chrono::milliseconds(30))
+              .async_wait(asio::use_awaitable);
+          --running;
+          ++finished;
+        });
+    REQUIRE(co_await endpoint->Start());
+
+    for (int i = 0; i < 20; ++i) {
+      mock.SetMessage(R"({"jsonrpc":"2.0","method":"slow"})");
+    }
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(15))
+        .async_wait(asio::use_awaitable);
+    REQUIRE(running == 2);
+
+    // The loop stops reading, and the two running handlers are waited for
+    REQUIRE(co_await endpoint->Shutdown());
+    co_await endpoint->WaitForHandlers();
+    REQUIRE(running == 0);
+    REQUIRE(finished == 2);
+    REQUIRE(max_running == 2);
+  });
+}
+
+TEST_CASE(
+    "RpcEndpoint - Shutdown wakes a loop waiting for a handler slot",
+    "[endpoint]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto transport = std::make_unique<MockTransport>(executor);
+    auto& mock = *transport;
+    jsonrpc::endpoint::EndpointOptions options;
+    options.max_in_flight_handlers = 1;
+    auto endpoint = std::make_unique<RpcEndpoint>(
+        executor, std::move(transport), options);
+    endpoint->RegisterMethodCall(
+        "slow", [executor](std::optional<Json>) -> asio::awaitable<Json> {
+          co_await asio::steady_timer(executor, std::chrono::milliseconds(300))
+              .async_wait(asio::use_awaitable);
+          co_return true;
+        });
+    REQUIRE(co_await endpoint->Start());
+
+    const Json request = {{"jsonrpc", "2.0"}, {"method", "slow"}, {"id", 1}};
+    mock.SetMessage(request.dump());
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(20))
+        .async_wait(asio::use_awaitable);
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(co_await endpoint->Shutdown());
+    REQUIRE(
+        std::chrono::steady_clock::now() - start <
+        std::chrono::milliseconds(200));
+    co_await endpoint->WaitForHandlers();
+  });
+}
+
+namespace {
+
+// Fails the first receives, then behaves like MockTransport
+class FlakyTransport : public MockTransport {
+ public:
+  FlakyTransport(asio::any_io_executor executor, int failures)
+      : MockTransport(std::move(executor)), failures_(failures) {
+  }
+
+  auto ReceiveMessage()
+      -> asio::awaitable<std::expected<std::string, RpcError>> override {
+    if (failures_ > 0) {
+      --failures_;
+      if (failures_ == 0 && disconnect_after_failures_) {
+        connected_ = false;
+      }
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Injected failure");
+    }
+    co_return co_await MockTransport::ReceiveMessage();
+  }
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return connected_;
+  }
+
+  void DisconnectAfterFailures() {
+    disconnect_after_failures_ = true;
+  }
+
+ private:
+  int failures_;
+  bool disconnect_after_failures_ = false;
+  bool connected_ = true;
+};
+
+}  // namespace
+
+TEST_CASE("RpcEndpoint - Receive errors", "[endpoint]") {
+  using jsonrpc::endpoint::EndpointOptions;
+
+  SECTION("Transient errors are retried with backoff") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<FlakyTransport>(executor, 5);
+      auto& mock = *transport;
+      EndpointOptions options;
+      options.receive_retry_delay = std::chrono::milliseconds(1);
+      options.max_receive_retry_delay = std::chrono::milliseconds(4);
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      endpoint->RegisterMethodCall(
+          "ping",
+          [](std::optional<Json>) -> asio::awaitable<Json> { co_return true; });
+      REQUIRE(co_await endpoint->Start());
+
+      const Json request = {{"jsonrpc", "2.0"}, {"method", "ping"}, {"id", 1}};
+      mock.SetMessage(request.dump());
+      for (int i = 0; i < 100 && mock.GetSentRequests().empty(); ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+
+      REQUIRE(mock.GetSentRequests().size() == 1);
+      REQUIRE(endpoint->GetReceiveErrorStats().transient == 5);
+      REQUIRE(endpoint->GetReceiveErrorStats().terminal == 0);
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Terminal errors end the loop") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<FlakyTransport>(executor, 3);
+      transport->DisconnectAfterFailures();
+      EndpointOptions options;
+      options.receive_retry_delay = std::chrono::milliseconds(1);
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      REQUIRE(co_await endpoint->Start());
+
+      // Resolves without Shutdown() once the transport is gone
+      REQUIRE(co_await endpoint->WaitForShutdown());
+      REQUIRE(endpoint->GetReceiveErrorStats().transient == 2);
+      REQUIRE(endpoint->GetReceiveErrorStats().terminal == 1);
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Shutdown cuts a backoff short") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<FlakyTransport>(executor, 1);
+      EndpointOptions options;
+      options.receive_retry_delay = std::chrono::milliseconds(10000);
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::move(transport), options);
+      REQUIRE(co_await endpoint->Start());
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(20))
+          .async_wait(asio::use_awaitable);
+
+      auto start = std::chrono::steady_clock::now();
+      REQUIRE(co_await endpoint->Shutdown());
+      REQUIRE(
+          std::chrono::steady_clock::now() - start <
+          std::chrono::milliseconds(1000));
+    });
+  }
+}
+
+namespace {
+
+// Behaves like MockTransport until LosePeer(), then fails every receive
+class PeerLossTransport : public MockTransport {
+ public:
+  using MockTransport::MockTransport;
+
+  auto ReceiveMessage()
+      -> asio::awaitable<std::expected<std::string, RpcError>> override {
+    auto message = co_await MockTransport::ReceiveMessage();
+    if (lost_) {
+      co_return RpcError::UnexpectedFromCode(
+          RpcErrorCode::kTransportError, "Connection closed by peer");
+    }
+    co_return message;
+  }
+
+  [[nodiscard]] auto IsConnected() const -> bool override {
+    return !lost_;
+  }
+
+  void LosePeer() {
+    lost_ = true;
+    SetMessage("");  // Wakes the pending receive
+  }
+
+ private:
+  bool lost_ = false;
+};
+
+}  // namespace
+
+TEST_CASE("RpcEndpoint - Message loop", "[endpoint]") {
+  SECTION("Requests are answered without awaiting shutdown") {
+    // The loop used to run only while WaitForShutdown() or Shutdown() was
+    // awaited, so this request went unanswered
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      endpoint->RegisterMethodCall(
+          "ping",
+          [](std::optional<Json>) -> asio::awaitable<Json> { co_return true; });
+      REQUIRE(co_await endpoint->Start());
+
+      mock.SetMessage(R"({"jsonrpc":"2.0","method":"ping","id":1})");
+      for (int i = 0; i < 100 && mock.GetSentRequests().empty(); ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+      REQUIRE(mock.GetSentRequests().size() == 1);
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("Losing the peer ends the loop and fails outstanding calls") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<PeerLossTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      REQUIRE(co_await endpoint->Start());
+
+      std::optional<std::expected<Json, RpcError>> result;
+      asio::co_spawn(
+          executor,
+          [&]() -> asio::awaitable<void> {
+            result = co_await endpoint->SendMethodCall("never_answered");
+          },
+          asio::detached);
+      for (int i = 0; i < 100 && mock.GetSentRequests().empty(); ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+      mock.LosePeer();
+
+      REQUIRE(co_await endpoint->WaitForShutdown());
+      for (int i = 0; i < 100 && !result; ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+      REQUIRE(result.has_value());
+      REQUIRE_FALSE(result->has_value());
+      REQUIRE(result->error().Code() == RpcErrorCode::kTransportError);
+      REQUIRE(endpoint->GetReceiveErrorStats().terminal == 1);
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Metrics", "[endpoint]") {
+  using jsonrpc::endpoint::EndpointMetrics;
+  using jsonrpc::endpoint::EndpointOptions;
+
+  SECTION("Traffic and method calls are counted") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto transport = std::make_unique<MockTransport>(executor);
+      auto& mock = *transport;
+      auto endpoint =
+          std::make_unique<RpcEndpoint>(executor, std::move(transport));
+      endpoint->RegisterMethodCall(
+          "ping",
+          [](std::optional<Json>) -> asio::awaitable<Json> { co_return true; });
+      REQUIRE(co_await endpoint->Start());
+
+      const Json request = {{"jsonrpc", "2.0"}, {"method", "ping"}, {"id", 1}};
+      const auto text = request.dump();
+      mock.SetMessage(text);
+      for (int i = 0; i < 100 && mock.GetSentRequests().empty(); ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+      REQUIRE(mock.GetSentRequests().size() == 1);
+
+      auto metrics = co_await endpoint->GetMetrics();
+      REQUIRE(metrics.messages_received == 1);
+      REQUIRE(metrics.bytes_received == text.size());
+      REQUIRE(metrics.messages_sent == 1);
+      REQUIRE(metrics.bytes_sent == mock.GetSentRequests()[0].size());
+      REQUIRE(metrics.pending_requests == 0);
+      REQUIRE(metrics.dispatcher.methods["ping"].calls == 1);
+      REQUIRE(metrics.dispatcher.methods["ping"].handler_latency.count == 1);
+      REQUIRE(co_await endpoint->Shutdown());
+    });
+  }
+
+  SECTION("The exporter receives snapshots until shutdown") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      auto exports = std::make_shared<int>(0);
+      EndpointOptions options;
+      options.metrics_interval = std::chrono::milliseconds(5);
+      options.metrics_exporter = [exports](const EndpointMetrics&) {
+        ++*exports;
+      };
+      auto endpoint = std::make_unique<RpcEndpoint>(
+          executor, std::make_unique<MockTransport>(executor), options);
+      REQUIRE(co_await endpoint->Start());
+
+      for (int i = 0; i < 100 && *exports < 2; ++i) {
+        co_await asio::steady_timer(executor, std::chrono::milliseconds(5))
+            .async_wait(asio::use_awaitable);
+      }
+      REQUIRE(*exports >= 2);
+      REQUIRE(co_await endpoint->Shutdown());
+
+      const auto after_shutdown = *exports;
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(20))
+          .async_wait(asio::use_awaitable);
+      REQUIRE(*exports == after_shutdown);
+    });
+  }
+}
+
+TEST_CASE("RpcEndpoint - Streaming results", "[endpoint]") {
+  using jsonrpc::endpoint::ResultStream;
+
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client_transport, server_transport] =
+        InProcessTransport::CreatePair(executor);
+    auto server =
+        std::make_unique<RpcEndpoint>(executor, std::move(server_transport));
+    server->RegisterStreamingMethodCall(
+        "search",
+        [](std::optional<Json>&&, ResultStream& stream)
+            -> asio::awaitable<void> {
+          for (int i = 0; i < 3; ++i) {
+            auto items = Json::array();
+            items.push_back(2 * i);
+            items.push_back(2 * i + 1);
+            REQUIRE(co_await stream.Write(std::move(items)));
+          }
+        });
+    REQUIRE(co_await server->Start());
+
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor, std::move(client_transport));
+    REQUIRE(client.has_value());
+
+    SECTION("Parts arrive in order ahead of the response") {
+      std::vector<Json> parts;
+      auto result = co_await (*client)->SendStreamingMethodCall(
+          "search", std::nullopt,
+          [&parts](Json part) { parts.push_back(std::move(part)); });
+      REQUIRE(result.has_value());
+      REQUIRE(*result == Json::array());
+      REQUIRE(parts.size() == 3);
+      REQUIRE(parts[0] == Json::parse("[0, 1]"));
+      REQUIRE(parts[2] == Json::parse("[4, 5]"));
+    }
+
+    SECTION("Callers without a token get every part in the response") {
+      auto result = co_await (*client)->SendMethodCall("search");
+      REQUIRE(result.has_value());
+      REQUIRE(*result == Json::parse("[0, 1, 2, 3, 4, 5]"));
+    }
+
+    SECTION("Streaming calls need object params") {
+      auto result = co_await (*client)->SendStreamingMethodCall(
+          "search", Json::parse("[1]"), nullptr);
+      REQUIRE_FALSE(result.has_value());
+      REQUIRE(
+          result.error().Code() == RpcErrorCode::kClientSerializationError);
+    }
+
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+  });
+}
+
+TEST_CASE("RpcEndpoint - Streaming results on a thread pool", "[endpoint]") {
+  using jsonrpc::endpoint::ResultStream;
+  constexpr int kCalls = 8;
+  constexpr int kParts = 5;
+
+  asio::thread_pool pool(4);
+  // Written by the callbacks without locking, which the endpoint's strand
+  // makes safe
+  std::vector<std::vector<int>> parts(kCalls);
+  std::atomic<int> inside{0};
+  std::atomic<bool> overlapped{false};
+  std::atomic<int> succeeded{0};
+
+  auto done = asio::co_spawn(
+      pool,
+      [&]() -> asio::awaitable<void> {
+        auto executor = pool.get_executor();
+        auto [client_transport, server_transport] =
+            InProcessTransport::CreatePair(executor);
+        auto server = std::make_unique<RpcEndpoint>(
+            executor, std::move(server_transport));
+        server->RegisterStreamingMethodCall(
+            "count",
+            [](std::optional<Json>&&, ResultStream& stream)
+                -> asio::awaitable<void> {
+              for (int i = 0; i < kParts; ++i) {
+                if (!co_await stream.Write(Json(i))) {
+                  co_return;
+                }
+              }
+            });
+        co_await server->Start();
+        auto client = co_await RpcEndpoint::CreateClient(
+            executor, std::move(client_transport));
+        if (!client) {
+          co_return;
+        }
+
+        std::atomic<int> finished{0};
+        for (int call = 0; call < kCalls; ++call) {
+          asio::co_spawn(
+              executor,
+              [&, call]() -> asio::awaitable<void> {
+                auto result = co_await (*client)->SendStreamingMethodCall(
+                    "count", std::nullopt, [&, call](Json part) {
+                      if (++inside > 1) {
+                        overlapped = true;
+                      }
+                      parts[call].push_back(part.get<int>());
+                      --inside;
+                    });
+                if (result) {
+                  ++succeeded;
+                }
+                ++finished;
+              },
+              asio::detached);
+        }
+        for (int i = 0; i < 200 && finished < kCalls; ++i) {
+          co_await asio::steady_timer(executor, std::chrono::milliseconds(10))
+              .async_wait(asio::use_awaitable);
+        }
+
+        co_await (*client)->Shutdown();
+        co_await server->WaitForShutdown();
+        co_await server->Shutdown();
+        co_await server->WaitForHandlers();
+      },
+      asio::use_future);
+  done.get();
+  pool.join();
+
+  REQUIRE(succeeded == kCalls);
+  REQUIRE_FALSE(overlapped);
+  for (const auto& call_parts : parts) {
+    REQUIRE(call_parts.size() == static_cast<std::size_t>(kParts));
+    for (int i = 0; i < kParts; ++i) {
+      REQUIRE(call_parts[i] == i);
+    }
+  }
+}
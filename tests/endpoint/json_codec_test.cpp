@@ -0,0 +1,84 @@
+#include "jsonrpc/endpoint/json_codec.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::DecodeMessage;
+using jsonrpc::endpoint::EncodeMessage;
+using jsonrpc::endpoint::ParseJson;
+using jsonrpc::endpoint::SerializeJson;
+using jsonrpc::transport::MessageEncoding;
+using Json = nlohmann::json;
+
+// Runs against whichever backend the library was built with
+TEST_CASE("JSON codec parses like nlohmann::json", "[JsonCodec]") {
+  SECTION("Messages keep their structure and types") {
+    const std::string text =
+        R"({"jsonrpc":"2.0","method":"m","params":[1,-2,3.5,true,null,)"
+        R"("sé",{"nested":[]}],"id":7})";
+    auto parsed = ParseJson(text);
+
+    REQUIRE_FALSE(parsed.is_discarded());
+    REQUIRE(parsed == Json::parse(text));
+    REQUIRE(parsed["params"][0].is_number_integer());
+    REQUIRE(parsed["params"][2].is_number_float());
+  }
+
+  SECTION("Integers keep their full range") {
+    const std::string text = "[" +
+                             std::to_string(
+                                 std::numeric_limits<std::int64_t>::min()) +
+                             "," +
+                             std::to_string(
+                                 std::numeric_limits<std::uint64_t>::max()) +
+                             "]";
+    auto parsed = ParseJson(text);
+
+    REQUIRE(parsed[0] == std::numeric_limits<std::int64_t>::min());
+    REQUIRE(parsed[1] == std::numeric_limits<std::uint64_t>::max());
+  }
+
+  SECTION("Invalid text yields a discarded value") {
+    REQUIRE(ParseJson("{\"unterminated\":").is_discarded());
+    REQUIRE(ParseJson("").is_discarded());
+  }
+
+  SECTION("Serialize is the inverse of Parse") {
+    const Json value = {{"a", {1, 2}}, {"b", "text"}};
+    REQUIRE(ParseJson(SerializeJson(value)) == value);
+  }
+}
+
+TEST_CASE("JSON codec encodes every wire encoding", "[JsonCodec]") {
+  const Json message = {
+      {"jsonrpc", "2.0"},
+      {"method", "m"},
+      {"params", {{"values", {1, -2, 3.5}}, {"flag", true}}},
+      {"id", 7}};
+
+  SECTION("Encoding round trips") {
+    for (auto encoding :
+         {MessageEncoding::kJson, MessageEncoding::kCbor,
+          MessageEncoding::kMsgpack}) {
+      auto encoded = EncodeMessage(message, encoding);
+      REQUIRE(DecodeMessage(encoded, encoding) == message);
+    }
+  }
+
+  SECTION("Binary encodings are smaller than JSON") {
+    auto json_size = EncodeMessage(message, MessageEncoding::kJson).size();
+    REQUIRE(EncodeMessage(message, MessageEncoding::kCbor).size() < json_size);
+    REQUIRE(
+        EncodeMessage(message, MessageEncoding::kMsgpack).size() < json_size);
+  }
+
+  SECTION("Invalid bodies yield a discarded value") {
+    REQUIRE(DecodeMessage("\xff\xff", MessageEncoding::kCbor).is_discarded());
+    REQUIRE(DecodeMessage("\xc1", MessageEncoding::kMsgpack).is_discarded());
+    REQUIRE(DecodeMessage("{", MessageEncoding::kJson).is_discarded());
+  }
+}
@@ -0,0 +1,114 @@
+#include "jsonrpc/endpoint/json_writer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::JsonWriter;
+using jsonrpc::endpoint::WireWritable;
+using Json = nlohmann::json;
+
+namespace {
+
+struct Point {
+  int x = 0;
+  int y = 0;
+  std::string label;
+};
+
+void WriteJson(JsonWriter& writer, const Point& point) {
+  writer.BeginObject();
+  writer.Field("x", point.x);
+  writer.Field("y", point.y);
+  writer.Field("label", point.label);
+  writer.EndObject();
+}
+
+}  // namespace
+
+static_assert(WireWritable<Point>);
+static_assert(!WireWritable<std::string>);
+
+TEST_CASE("JsonWriter writes scalars and containers", "[JsonWriter]") {
+  SECTION("Separators between members and elements") {
+    JsonWriter writer;
+    writer.BeginObject();
+    writer.Field("a", 1);
+    writer.Key("list");
+    writer.BeginArray();
+    writer.Value(true);
+    writer.Value(nullptr);
+    writer.Value("s");
+    writer.EndArray();
+    writer.Field("empty", Json::object());
+    writer.EndObject();
+
+    REQUIRE(writer.View() == R"({"a":1,"list":[true,null,"s"],"empty":{}})");
+  }
+
+  SECTION("Integers keep their full range") {
+    JsonWriter writer;
+    writer.BeginArray();
+    writer.Value(std::numeric_limits<std::int64_t>::min());
+    writer.Value(std::numeric_limits<std::uint64_t>::max());
+    writer.EndArray();
+
+    auto parsed = Json::parse(writer.View());
+    REQUIRE(parsed[0] == std::numeric_limits<std::int64_t>::min());
+    REQUIRE(parsed[1] == std::numeric_limits<std::uint64_t>::max());
+  }
+
+  SECTION("Doubles round-trip and stay floats") {
+    JsonWriter writer;
+    writer.BeginArray();
+    writer.Value(0.1);
+    writer.Value(2.0);
+    writer.Value(std::nan(""));
+    writer.EndArray();
+
+    auto parsed = Json::parse(writer.View());
+    REQUIRE(parsed[0].get<double>() == 0.1);
+    REQUIRE(parsed[1].is_number_float());
+    REQUIRE(parsed[2].is_null());
+  }
+
+  SECTION("Strings are escaped like nlohmann::json") {
+    const std::string text = "quote\" slash\\ tab\t newline\n bell\a ü";
+    JsonWriter writer;
+    writer.Value(text);
+
+    REQUIRE(writer.View() == Json(text).dump());
+  }
+
+  SECTION("Optional values write null when empty") {
+    JsonWriter writer;
+    writer.BeginArray();
+    writer.Value(std::optional<int>{});
+    writer.Value(std::optional<int>{3});
+    writer.EndArray();
+
+    REQUIRE(writer.View() == "[null,3]");
+  }
+}
+
+TEST_CASE("JsonWriter writes opted-in types directly", "[JsonWriter]") {
+  std::vector<Point> points{{.x = 1, .y = 2, .label = "a"}, {.x = 3}};
+  JsonWriter writer;
+  writer.BeginArray();
+  for (const auto& point : points) {
+    writer.Value(point);
+  }
+  writer.EndArray();
+
+  auto parsed = Json::parse(writer.Take());
+  REQUIRE(parsed.size() == 2);
+  REQUIRE(parsed[0] == Json{{"x", 1}, {"y", 2}, {"label", "a"}});
+  REQUIRE(parsed[1]["x"] == 3);
+  REQUIRE(writer.View().empty());
+}
@@ -0,0 +1,135 @@
+#include "jsonrpc/endpoint/lazy_params.hpp"
+
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::FindRawValue;
+using jsonrpc::endpoint::IsRawParams;
+using jsonrpc::endpoint::LazyParams;
+using jsonrpc::endpoint::ParseJsonWithLazyParams;
+using jsonrpc::error::RpcErrorCode;
+
+namespace {
+
+auto WantsOpen(std::string_view method) -> bool {
+  return method == "didOpen";
+}
+
+}  // namespace
+
+TEST_CASE("FindRawValue", "[LazyParams]") {
+  const std::string text = R"({
+    "textDocument": {"uri": "file:///a.cpp", "version": 3},
+    "tricky": "}]{[\"",
+    "a~b/c": true,
+    "items": [1, [2, 3], {"x": null}]
+  })";
+
+  SECTION("Finds nested members and elements") {
+    REQUIRE(FindRawValue(text, "/textDocument/uri") == R"("file:///a.cpp")");
+    REQUIRE(FindRawValue(text, "/textDocument/version") == "3");
+    REQUIRE(FindRawValue(text, "/items/1") == "[2, 3]");
+    REQUIRE(FindRawValue(text, "/items/1/0") == "2");
+    REQUIRE(FindRawValue(text, "/items/2/x") == "null");
+  }
+
+  SECTION("Brackets inside strings do not count") {
+    REQUIRE(FindRawValue(text, "/tricky") == R"("}]{[\"")");
+    REQUIRE(FindRawValue(text, "/items/0") == "1");
+  }
+
+  SECTION("Escaped pointer tokens match their keys") {
+    REQUIRE(FindRawValue(text, "/a~0b~1c") == "true");
+  }
+
+  SECTION("The empty pointer names the whole value") {
+    auto whole = FindRawValue(text, "");
+    REQUIRE(whole.has_value());
+    REQUIRE(nlohmann::json::parse(*whole) == nlohmann::json::parse(text));
+  }
+
+  SECTION("Missing paths and invalid pointers find nothing") {
+    REQUIRE_FALSE(FindRawValue(text, "/missing"));
+    REQUIRE_FALSE(FindRawValue(text, "/items/3"));
+    REQUIRE_FALSE(FindRawValue(text, "/items/x"));
+    REQUIRE_FALSE(FindRawValue(text, "/textDocument/uri/0"));
+    REQUIRE_FALSE(FindRawValue(text, "textDocument"));
+    REQUIRE_FALSE(FindRawValue(text, "/a~2b"));
+  }
+}
+
+TEST_CASE("ParseJsonWithLazyParams", "[LazyParams]") {
+  SECTION("Lazy methods keep their params as text") {
+    const std::string text =
+        R"({"params":{"uri":"a","text":"long"},"jsonrpc":"2.0",)"
+        R"("method":"didOpen"})";
+    auto message = ParseJsonWithLazyParams(text, WantsOpen);
+    REQUIRE(message["method"] == "didOpen");
+    REQUIRE(message["jsonrpc"] == "2.0");
+    REQUIRE(IsRawParams(message["params"]));
+
+    LazyParams params(message["params"]);
+    REQUIRE(params.Raw() == R"({"uri":"a","text":"long"})");
+  }
+
+  SECTION("Other methods are parsed whole") {
+    const std::string text =
+        R"({"jsonrpc":"2.0","method":"didClose","params":{"uri":"a"}})";
+    auto message = ParseJsonWithLazyParams(text, WantsOpen);
+    REQUIRE(message == nlohmann::json::parse(text));
+  }
+
+  SECTION("Batches and malformed text are parsed as by ParseJson") {
+    const std::string batch =
+        R"([{"jsonrpc":"2.0","method":"didOpen","params":{"uri":"a"}}])";
+    auto message = ParseJsonWithLazyParams(batch, WantsOpen);
+    REQUIRE(message == nlohmann::json::parse(batch));
+
+    auto malformed = ParseJsonWithLazyParams(
+        R"({"jsonrpc":"2.0","method":"didOpen","params":{)", WantsOpen);
+    REQUIRE(malformed.is_discarded());
+  }
+}
+
+TEST_CASE("LazyParams access", "[LazyParams]") {
+  const std::string text = R"({"uri":"a","version":3,"bad":[1,]})";
+  LazyParams raw(
+      ParseJsonWithLazyParams(
+          R"({"jsonrpc":"2.0","method":"didOpen","params":)" + text + "}",
+          WantsOpen)["params"]);
+  LazyParams dom(nlohmann::json{{"uri", "a"}, {"version", 3}});
+
+  SECTION("Reads members from raw and parsed params alike") {
+    for (const auto* params : {&raw, &dom}) {
+      REQUIRE(params->HasValue());
+      REQUIRE(params->Contains("/uri"));
+      REQUIRE_FALSE(params->Contains("/missing"));
+      REQUIRE(params->Get<std::string>("/uri") == "a");
+      REQUIRE(params->Get<int>("/version") == 3);
+    }
+  }
+
+  SECTION("Failures are invalid params") {
+    auto missing = dom.Get<int>("/missing");
+    REQUIRE_FALSE(missing.has_value());
+    REQUIRE(missing.error().Code() == RpcErrorCode::kInvalidParams);
+
+    auto wrong_type = raw.Get<int>("/uri");
+    REQUIRE_FALSE(wrong_type.has_value());
+    REQUIRE(wrong_type.error().Code() == RpcErrorCode::kInvalidParams);
+
+    // Only the member that was read has to be well formed
+    auto malformed = raw.GetJson("/bad");
+    REQUIRE_FALSE(malformed.has_value());
+    REQUIRE(malformed.error().Code() == RpcErrorCode::kInvalidParams);
+  }
+
+  SECTION("Missing params have no value") {
+    LazyParams none(std::nullopt);
+    REQUIRE_FALSE(none.HasValue());
+    REQUIRE_FALSE(none.ToJson().has_value());
+  }
+}
@@ -0,0 +1,127 @@
+#include "jsonrpc/endpoint/metrics.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::endpoint::EndpointMetrics;
+using jsonrpc::endpoint::FormatPrometheus;
+using jsonrpc::endpoint::LatencyHistogram;
+using jsonrpc::endpoint::LatencySnapshot;
+using jsonrpc::endpoint::MethodMetrics;
+using jsonrpc::endpoint::MethodMetricsSnapshot;
+using std::chrono::microseconds;
+
+TEST_CASE("LatencyHistogram buckets", "[Metrics]") {
+  SECTION("Small values get a bucket each") {
+    for (std::uint64_t micros = 0; micros < 8; ++micros) {
+      REQUIRE(LatencySnapshot::BucketFor(micros) == micros);
+      REQUIRE(LatencySnapshot::BucketUpperBound(micros) == micros);
+    }
+  }
+
+  SECTION("Every value lies within its bucket") {
+    for (std::uint64_t micros : {8ULL, 9ULL, 15ULL, 16ULL, 1000ULL, 123456ULL,
+                                 1ULL << 30}) {
+      auto bucket = LatencySnapshot::BucketFor(micros);
+      REQUIRE(micros <= LatencySnapshot::BucketUpperBound(bucket));
+      REQUIRE(micros > LatencySnapshot::BucketUpperBound(bucket - 1));
+    }
+  }
+
+  SECTION("Buckets are at most an eighth of their values wide") {
+    auto bucket = LatencySnapshot::BucketFor(1000);
+    auto lower = LatencySnapshot::BucketUpperBound(bucket - 1) + 1;
+    auto upper = LatencySnapshot::BucketUpperBound(bucket);
+    REQUIRE(upper - lower + 1 <= lower / 8);
+  }
+
+  SECTION("Huge values land in the last bucket") {
+    REQUIRE(
+        LatencySnapshot::BucketFor(~std::uint64_t{0}) ==
+        LatencySnapshot::kBucketCount - 1);
+  }
+}
+
+TEST_CASE("LatencyHistogram percentiles", "[Metrics]") {
+  LatencyHistogram histogram;
+
+  SECTION("An empty histogram reports zero") {
+    REQUIRE(histogram.Snapshot().Percentile(0.99) == microseconds(0));
+  }
+
+  SECTION("Percentiles fall within a bucket of the samples") {
+    for (int i = 1; i <= 100; ++i) {
+      histogram.Record(microseconds(i * 100));
+    }
+    auto snapshot = histogram.Snapshot();
+    REQUIRE(snapshot.count == 100);
+    REQUIRE(snapshot.sum == microseconds(505000));
+    REQUIRE(snapshot.max == microseconds(10000));
+
+    auto median = snapshot.Percentile(0.5).count();
+    REQUIRE(median >= 5000);
+    REQUIRE(median <= 5000 + 5000 / 8);
+    REQUIRE(snapshot.Percentile(1.0) == microseconds(10000));
+  }
+
+  SECTION("Negative durations count as zero") {
+    histogram.Record(std::chrono::nanoseconds(-5));
+    REQUIRE(histogram.Snapshot().buckets[0] == 1);
+  }
+}
+
+TEST_CASE("MethodMetrics sums its shards", "[Metrics]") {
+  MethodMetrics metrics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&metrics, t] {
+      for (int i = 0; i < 1000; ++i) {
+        metrics.AddCall();
+        metrics.RecordHandler(microseconds(t + 1));
+      }
+      metrics.AddError();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = metrics.Snapshot();
+  REQUIRE(snapshot.calls == 4000);
+  REQUIRE(snapshot.errors == 4);
+  REQUIRE(snapshot.cache_hits == 0);
+  REQUIRE(snapshot.handler_latency.count == 4000);
+  REQUIRE(snapshot.handler_latency.sum == microseconds(10000));
+  REQUIRE(snapshot.handler_latency.max == microseconds(4));
+  REQUIRE(snapshot.queue_latency.count == 0);
+}
+
+TEST_CASE("Prometheus text format", "[Metrics]") {
+  EndpointMetrics metrics;
+  metrics.messages_received = 3;
+  metrics.pending_requests = 2;
+  MethodMetricsSnapshot echo;
+  echo.calls = 5;
+  echo.errors = 1;
+  echo.cache_hits = 2;
+  metrics.dispatcher.methods.emplace("echo", echo);
+  metrics.dispatcher.methods.emplace("say \"hi\"", MethodMetricsSnapshot{});
+
+  auto text = FormatPrometheus(metrics, "rpc");
+
+  REQUIRE(text.contains("# TYPE rpc_messages_received_total counter\n"));
+  REQUIRE(text.contains("rpc_messages_received_total 3\n"));
+  REQUIRE(text.contains("# TYPE rpc_pending_requests gauge\n"));
+  REQUIRE(text.contains("rpc_pending_requests 2\n"));
+  REQUIRE(text.contains("rpc_method_calls_total{method=\"echo\"} 5\n"));
+  REQUIRE(text.contains("rpc_method_errors_total{method=\"echo\"} 1\n"));
+  REQUIRE(text.contains("rpc_method_cache_hits_total{method=\"echo\"} 2\n"));
+  REQUIRE(text.contains(
+      "rpc_handler_latency_seconds{method=\"echo\",quantile=\"0.99\"} 0\n"));
+  REQUIRE(text.contains("rpc_handler_latency_seconds_count{method=\"echo\"}"));
+  REQUIRE(text.contains("{method=\"say \\\"hi\\\"\"}"));
+}
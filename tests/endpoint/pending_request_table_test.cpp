@@ -0,0 +1,128 @@
+#include "jsonrpc/endpoint/pending_request_table.hpp"
+
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::endpoint::PendingRequestTable;
+
+TEST_CASE("PendingRequestTable insert and take", "[PendingRequestTable]") {
+  asio::io_context io_ctx;
+  PendingRequestTable table(4);
+
+  SECTION("Take returns the registered request once") {
+    auto request = table.Create(io_ctx.get_executor());
+    auto id = table.Insert(request);
+    REQUIRE(id.has_value());
+    REQUIRE(table.Size() == 1);
+
+    REQUIRE(table.Take(*id) == request);
+    REQUIRE(table.Take(*id) == nullptr);
+    REQUIRE(table.Empty());
+  }
+
+  SECTION("Unknown ids are ignored") {
+    REQUIRE(table.Take(-1) == nullptr);
+    REQUIRE(table.Take(3) == nullptr);
+  }
+
+  SECTION("A stale id does not match a reused slot") {
+    auto first = table.Insert(table.Create(io_ctx.get_executor()));
+    REQUIRE(table.Take(*first) != nullptr);
+
+    // Cycle through the slots until the first one is reused
+    std::optional<int64_t> reused;
+    for (std::size_t i = 0; i < table.Capacity(); ++i) {
+      auto id = table.Insert(table.Create(io_ctx.get_executor()));
+      REQUIRE(id.has_value());
+      if ((*id - *first) % static_cast<int64_t>(table.Capacity()) == 0) {
+        reused = id;
+        break;
+      }
+      REQUIRE(table.Take(*id) != nullptr);
+    }
+    REQUIRE(reused.has_value());
+    REQUIRE(table.Take(*first) == nullptr);
+    REQUIRE(table.Take(*reused) != nullptr);
+  }
+
+  SECTION("Busy slots are skipped and a full table rejects inserts") {
+    auto held = table.Insert(table.Create(io_ctx.get_executor()));
+    std::set<int64_t> ids{*held};
+    for (int i = 0; i < 3; ++i) {
+      auto id = table.Insert(table.Create(io_ctx.get_executor()));
+      REQUIRE(id.has_value());
+      ids.insert(*id);
+    }
+    REQUIRE(ids.size() == 4);
+    REQUIRE(table.Size() == 4);
+    REQUIRE_FALSE(table.Insert(table.Create(io_ctx.get_executor())));
+
+    REQUIRE(table.Take(*held) != nullptr);
+    REQUIRE(table.Insert(table.Create(io_ctx.get_executor())).has_value());
+  }
+
+  SECTION("CancelAll completes every request with the error") {
+    auto request = table.Create(io_ctx.get_executor());
+    table.Insert(request);
+    table.CancelAll(-32603, "shutting down");
+
+    REQUIRE(table.Empty());
+    REQUIRE(request->IsReady());
+    REQUIRE(request->HasError());
+  }
+}
+
+TEST_CASE(
+    "PendingRequestTable spans several segments", "[PendingRequestTable]") {
+  asio::io_context io_ctx;
+  PendingRequestTable table(4096);
+  REQUIRE(table.Capacity() == 4096);
+
+  // Ids past the first segment before any call reached them
+  REQUIRE(table.Take(3000) == nullptr);
+
+  std::vector<std::shared_ptr<jsonrpc::endpoint::PendingRequest>> requests;
+  for (int i = 0; i < 2000; ++i) {
+    requests.push_back(table.Create(io_ctx.get_executor()));
+    REQUIRE(table.Insert(requests.back()).has_value());
+  }
+  REQUIRE(table.Size() == 2000);
+  REQUIRE(table.Take(1500) == requests[1500]);
+
+  table.CancelAll(-32603, "shutting down");
+  REQUIRE(table.Empty());
+  REQUIRE(requests.front()->HasError());
+  REQUIRE(requests.back()->HasError());
+}
+
+TEST_CASE(
+    "PendingRequestTable is safe across threads", "[PendingRequestTable]") {
+  asio::io_context io_ctx;
+  PendingRequestTable table(1024);
+  constexpr int kThreads = 4;
+  constexpr int kCallsPerThread = 10000;
+
+  std::vector<std::thread> threads;
+  std::atomic<int> taken{0};
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kCallsPerThread; ++i) {
+        auto id = table.Insert(table.Create(io_ctx.get_executor()));
+        if (id && table.Take(*id) != nullptr) {
+          ++taken;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(taken == kThreads * kCallsPerThread);
+  REQUIRE(table.Empty());
+}
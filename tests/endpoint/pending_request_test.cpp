@@ -0,0 +1,75 @@
+#include "jsonrpc/endpoint/pending_request.hpp"
+
+#include <chrono>
+#include <memory>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::PendingRequest;
+
+namespace {
+
+template <typename TestFunc>
+auto RunTest(TestFunc&& test_func) {
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+
+  asio::co_spawn(
+      io_ctx,
+      [f = std::forward<TestFunc>(test_func), executor]() {
+        return f(executor);
+      },
+      asio::detached);
+
+  io_ctx.run();
+}
+
+}  // namespace
+
+TEST_CASE("PendingRequest result set before waiting", "[PendingRequest]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    PendingRequest request(executor);
+    request.SetResult({{"result", 42}});
+    REQUIRE(request.IsReady());
+
+    auto result = co_await request.GetResult();
+    REQUIRE(result["result"] == 42);
+    REQUIRE_FALSE(request.HasError());
+  });
+}
+
+TEST_CASE("PendingRequest wakes waiter without polling", "[PendingRequest]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto request = std::make_shared<PendingRequest>(executor);
+
+    asio::co_spawn(
+        executor,
+        [request]() -> asio::awaitable<void> {
+          request->SetResult({{"result", "done"}});
+          co_return;
+        },
+        asio::detached);
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = co_await request->GetResult();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(result["result"] == "done");
+    REQUIRE(elapsed < std::chrono::milliseconds(5));
+  });
+}
+
+TEST_CASE("PendingRequest keeps the first completion", "[PendingRequest]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    PendingRequest request(executor);
+    request.Cancel(-32603, "shutting down");
+    request.SetResult({{"result", 1}});
+
+    auto result = co_await request.GetResult();
+    REQUIRE(result.contains("error"));
+    REQUIRE(result["error"]["message"] == "shutting down");
+    REQUIRE(request.HasError());
+  });
+}
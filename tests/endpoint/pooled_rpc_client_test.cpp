@@ -0,0 +1,200 @@
+#include "jsonrpc/endpoint/pooled_rpc_client.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/rpc_server.hpp"
+#include "jsonrpc/transport/pipe_acceptor.hpp"
+#include "jsonrpc/transport/pipe_transport.hpp"
+
+using jsonrpc::endpoint::PooledRpcClient;
+using jsonrpc::endpoint::PoolOptions;
+using jsonrpc::endpoint::RpcServer;
+using jsonrpc::transport::PipeAcceptor;
+using jsonrpc::transport::PipeTransport;
+using Json = nlohmann::json;
+
+namespace {
+
+template <typename TestFunc>
+void RunTest(TestFunc&& test_func) {
+  spdlog::set_level(spdlog::level::warn);
+  asio::io_context io_ctx;
+  asio::co_spawn(
+      io_ctx, std::forward<TestFunc>(test_func)(io_ctx.get_executor()),
+      asio::detached);
+  io_ctx.run();
+}
+
+auto Sleep(asio::any_io_executor executor, std::chrono::milliseconds duration)
+    -> asio::awaitable<void> {
+  asio::steady_timer timer(executor, duration);
+  co_await timer.async_wait(asio::use_awaitable);
+}
+
+// Serves "slow", which answers after the given delay
+auto MakeServer(
+    asio::any_io_executor executor, const std::string& socket_path,
+    std::chrono::milliseconds delay) -> std::unique_ptr<RpcServer> {
+  auto server = std::make_unique<RpcServer>(
+      executor, std::make_unique<PipeAcceptor>(executor, socket_path));
+  server->RegisterMethodCall(
+      "slow",
+      [executor, delay](std::optional<Json>) -> asio::awaitable<Json> {
+        co_await Sleep(executor, delay);
+        co_return "done";
+      });
+  return server;
+}
+
+auto PipeFactory(std::string socket_path) -> PooledRpcClient::TransportFactory {
+  return [socket_path](asio::any_io_executor executor) {
+    return std::make_unique<PipeTransport>(executor, socket_path);
+  };
+}
+
+}  // namespace
+
+TEST_CASE("PooledRpcClient connections", "[PooledRpcClient]") {
+  SECTION("Opens every connection and serves calls") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_pool_connections";
+      auto server =
+          MakeServer(executor, socket_path, std::chrono::milliseconds(20));
+      REQUIRE(co_await server->Start());
+
+      PoolOptions options;
+      options.connections = 3;
+      PooledRpcClient pool(executor, PipeFactory(socket_path), options);
+      REQUIRE(co_await pool.Start());
+      REQUIRE(pool.ConnectedCount() == 3);
+
+      int completed = 0;
+      for (int i = 0; i < 6; ++i) {
+        asio::co_spawn(
+            executor,
+            [&pool, &completed]() -> asio::awaitable<void> {
+              auto result = co_await pool.SendMethodCall("slow");
+              REQUIRE(result);
+              ++completed;
+            },
+            asio::detached);
+      }
+      co_await Sleep(executor, std::chrono::milliseconds(200));
+      REQUIRE(completed == 6);
+      REQUIRE(server->ConnectionCount() == 3);
+
+      REQUIRE(co_await pool.Shutdown());
+      REQUIRE(co_await server->Shutdown());
+    });
+  }
+
+  SECTION("Start fails when no connection can be opened") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      PooledRpcClient pool(executor, PipeFactory("/tmp/test_pool_missing"));
+      REQUIRE_FALSE(co_await pool.Start());
+      REQUIRE(co_await pool.Shutdown());
+    });
+  }
+
+  SECTION("Start returns once enough connections are ready") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string up_path = "/tmp/test_pool_ready_up";
+      const std::string late_path = "/tmp/test_pool_ready_late";
+      std::filesystem::remove(late_path);
+      auto server = MakeServer(executor, up_path, std::chrono::milliseconds(0));
+      REQUIRE(co_await server->Start());
+
+      // The second connection keeps retrying until its server comes up
+      std::vector<PooledRpcClient::TransportFactory> factories;
+      factories.push_back(PipeFactory(up_path));
+      factories.push_back([late_path](asio::any_io_executor executor) {
+        return std::make_unique<PipeTransport>(
+            executor, late_path, false,
+            jsonrpc::transport::TransportOptions{
+                .connect_retry = {
+                    .attempts = 100,
+                    .initial_delay = std::chrono::milliseconds(5),
+                    .max_delay = std::chrono::milliseconds(5)}});
+      });
+      PoolOptions options;
+      options.connections = 2;
+      options.ready_connections = 1;
+      PooledRpcClient pool(executor, std::move(factories), options);
+      REQUIRE(co_await pool.Start());
+      REQUIRE(pool.ConnectedCount() == 1);
+      REQUIRE(co_await pool.SendMethodCall("slow"));
+
+      auto late_server =
+          MakeServer(executor, late_path, std::chrono::milliseconds(0));
+      REQUIRE(co_await late_server->Start());
+      co_await Sleep(executor, std::chrono::milliseconds(100));
+      REQUIRE(pool.ConnectedCount() == 2);
+
+      REQUIRE(co_await pool.Shutdown());
+      REQUIRE(co_await server->Shutdown());
+      REQUIRE(co_await late_server->Shutdown());
+    });
+  }
+
+  SECTION("Reconnects lazily after the server restarts") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_pool_reconnect";
+      auto server =
+          MakeServer(executor, socket_path, std::chrono::milliseconds(0));
+      REQUIRE(co_await server->Start());
+
+      PoolOptions options;
+      options.connections = 2;
+      options.reconnect_delay = std::chrono::milliseconds(0);
+      PooledRpcClient pool(executor, PipeFactory(socket_path), options);
+      REQUIRE(co_await pool.Start());
+      REQUIRE(co_await pool.SendMethodCall("slow"));
+
+      REQUIRE(co_await server->Shutdown());
+      co_await Sleep(executor, std::chrono::milliseconds(50));
+
+      server = MakeServer(executor, socket_path, std::chrono::milliseconds(0));
+      REQUIRE(co_await server->Start());
+      REQUIRE(co_await pool.SendMethodCall("slow"));
+
+      REQUIRE(co_await pool.Shutdown());
+      REQUIRE(co_await server->Shutdown());
+    });
+  }
+}
+
+TEST_CASE("PooledRpcClient drains on shutdown", "[PooledRpcClient]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    const std::string socket_path = "/tmp/test_pool_drain";
+    auto server =
+        MakeServer(executor, socket_path, std::chrono::milliseconds(100));
+    REQUIRE(co_await server->Start());
+
+    PooledRpcClient pool(executor, PipeFactory(socket_path));
+    REQUIRE(co_await pool.Start());
+
+    std::optional<bool> succeeded;
+    asio::co_spawn(
+        executor,
+        [&pool, &succeeded]() -> asio::awaitable<void> {
+          succeeded = (co_await pool.SendMethodCall("slow")).has_value();
+        },
+        asio::detached);
+    co_await Sleep(executor, std::chrono::milliseconds(10));
+
+    REQUIRE(co_await pool.Shutdown());
+    REQUIRE(succeeded == true);
+    REQUIRE_FALSE(co_await pool.SendMethodCall("slow"));
+
+    REQUIRE(co_await server->Shutdown());
+  });
+}
@@ -3,9 +3,15 @@
 #include <catch2/catch_test_macros.hpp>
 #include <nlohmann/json.hpp>
 
+#include "jsonrpc/endpoint/json_codec.hpp"
+#include "jsonrpc/endpoint/lazy_params.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
+
+using jsonrpc::endpoint::DecodeMessage;
 using jsonrpc::endpoint::Request;
 using jsonrpc::endpoint::RequestId;
 using jsonrpc::error::RpcErrorCode;
+using jsonrpc::transport::MessageEncoding;
 
 TEST_CASE("Request construction and basic properties", "[Request]") {
   SECTION("Create request with all parameters") {
@@ -118,6 +124,26 @@ TEST_CASE("Request JSON deserialization", "[Request]") {
     REQUIRE(request->GetParams()->is_array());
     REQUIRE(std::get<std::string>(request->GetId()) == "req1");
   }
+
+  SECTION("Deserialize from an rvalue moves params") {
+    nlohmann::json json = {
+        {"jsonrpc", "2.0"},
+        {"method", "test_method"},
+        {"params", {{"text", std::string(4096, 'x')}}},
+        {"id", 7}};
+    const auto* text_ptr =
+        json["params"]["text"].get_ref<const std::string&>().data();
+
+    auto request = Request::FromJson(std::move(json));
+    REQUIRE(request.has_value());
+    REQUIRE(request->GetMethod() == "test_method");
+    REQUIRE(std::get<int64_t>(request->GetId()) == 7);
+
+    auto params = request->TakeParams();
+    REQUIRE(params.has_value());
+    REQUIRE(
+        (*params)["text"].get_ref<const std::string&>().data() == text_ptr);
+  }
 }
 
 TEST_CASE("Request validation", "[Request]") {
@@ -155,3 +181,45 @@ TEST_CASE("Request validation", "[Request]") {
     REQUIRE(request.error().Code() == RpcErrorCode::kInvalidRequest);
   }
 }
+
+TEST_CASE("Request envelope", "[Request]") {
+  // The envelope is written from fragments; it must read as the DOM does
+  SECTION("Method call with an integer id") {
+    auto request = Request("sum", nlohmann::json::array({1, 2}), 42);
+    REQUIRE(request.Dump() == request.ToJson().dump());
+  }
+
+  SECTION("String id and a method that needs escaping") {
+    auto request = Request("say \"hi\"\n", nlohmann::json{{"a", 1}}, "id-\\1");
+    REQUIRE(request.Dump() == request.ToJson().dump());
+  }
+
+  SECTION("Notification without params") {
+    auto request = Request("ping");
+    REQUIRE(request.Dump() == R"({"jsonrpc":"2.0","method":"ping"})");
+  }
+}
+
+TEST_CASE("Request binary encoding", "[Request]") {
+  const auto call = Request(
+      "textDocument/hover", nlohmann::json{{"line", 42}}, RequestId{1});
+  const auto notification = Request("exit");
+
+  for (auto encoding : {MessageEncoding::kCbor, MessageEncoding::kMsgpack}) {
+    REQUIRE(DecodeMessage(call.Encode(encoding), encoding) == call.ToJson());
+    REQUIRE(
+        DecodeMessage(notification.Encode(encoding), encoding) ==
+        notification.ToJson());
+  }
+
+  SECTION("Raw params are parsed into the encoding") {
+    auto parsed = jsonrpc::endpoint::ParseJsonWithLazyParams(
+        R"({"jsonrpc":"2.0","method":"m","params":{"a":[1,2]},"id":3})",
+        [](std::string_view) { return true; });
+    auto request = Request::FromJson(std::move(parsed));
+    REQUIRE(request.has_value());
+    auto decoded = DecodeMessage(
+        request->Encode(MessageEncoding::kCbor), MessageEncoding::kCbor);
+    REQUIRE(decoded["params"] == nlohmann::json::parse(R"({"a":[1,2]})"));
+  }
+}
@@ -1,14 +1,20 @@
 #include "jsonrpc/endpoint/response.hpp"
 
+#include <memory>
+
 #include <catch2/catch_test_macros.hpp>
 #include <nlohmann/json.hpp>
 
+#include "jsonrpc/endpoint/json_codec.hpp"
 #include "jsonrpc/endpoint/types.hpp"
 #include "jsonrpc/error/error.hpp"
+#include "jsonrpc/transport/message_encoding.hpp"
 
+using jsonrpc::endpoint::DecodeMessage;
 using jsonrpc::endpoint::RequestId;
 using jsonrpc::endpoint::Response;
 using jsonrpc::error::RpcErrorCode;
+using jsonrpc::transport::MessageEncoding;
 
 TEST_CASE("Response creation and basic properties", "[Response]") {
   SECTION("Create success response with result") {
@@ -176,3 +182,59 @@ TEST_CASE("Response validation", "[Response]") {
     REQUIRE(response.error().Code() == RpcErrorCode::kInvalidRequest);
   }
 }
+
+TEST_CASE("Response envelope", "[Response]") {
+  // The envelope is written from fragments; it must read as the DOM does
+  const nlohmann::json result = {{"key", "value"}, {"list", {1, 2}}};
+
+  SECTION("Success with an id") {
+    auto response = Response::CreateSuccess(result, 7);
+    REQUIRE(response.Dump() == response.ToJson().dump());
+    REQUIRE(response.Dump().starts_with(R"({"id":7,"jsonrpc":"2.0")"));
+  }
+
+  SECTION("Success without an id") {
+    auto response = Response::CreateSuccess(result, std::nullopt);
+    REQUIRE(response.Dump() == response.ToJson().dump());
+  }
+
+  SECTION("Errors with an id, a null id and no id") {
+    auto with_id = Response::CreateError(RpcErrorCode::kInternalError, "x");
+    auto null_id = Response::CreateError(RpcErrorCode::kParseError);
+    auto no_id = Response::CreateError(
+        nlohmann::json{{"code", 1}, {"message", "m"}}, std::nullopt);
+    REQUIRE(with_id.Dump() == with_id.ToJson().dump());
+    REQUIRE(null_id.Dump() == null_id.ToJson().dump());
+    REQUIRE(no_id.Dump() == no_id.ToJson().dump());
+    REQUIRE_FALSE(no_id.ToJson().contains("id"));
+  }
+
+  SECTION("Shared results are not copied") {
+    auto shared = std::make_shared<const nlohmann::json>(result);
+    auto response = Response::CreateSuccess(shared, 1);
+    REQUIRE(&response.GetResult() == shared.get());
+  }
+
+  SECTION("Parsed responses serialize as they arrived") {
+    const auto text = R"({"id":"a","jsonrpc":"2.0","result":[1,{"b":null}]})";
+    auto response = Response::FromJson(nlohmann::json::parse(text));
+    REQUIRE(response.has_value());
+    REQUIRE(response->Dump() == text);
+  }
+}
+
+TEST_CASE("Response binary encoding", "[Response]") {
+  const nlohmann::json result = {
+      {"text", std::string(300, 'x')}, {"items", {1, 2, 3}}};
+  const auto success = Response::CreateSuccess(result, RequestId{"req"});
+  const auto error = Response::CreateError(RpcErrorCode::kMethodNotFound, 7);
+  const auto no_id = Response::CreateSuccess(result, std::nullopt);
+
+  for (auto encoding : {MessageEncoding::kCbor, MessageEncoding::kMsgpack}) {
+    REQUIRE(
+        DecodeMessage(success.Encode(encoding), encoding) == success.ToJson());
+    REQUIRE(DecodeMessage(error.Encode(encoding), encoding) == error.ToJson());
+    REQUIRE(DecodeMessage(no_id.Encode(encoding), encoding) == no_id.ToJson());
+  }
+  REQUIRE(success.Encode(MessageEncoding::kJson) == success.Dump());
+}
@@ -0,0 +1,152 @@
+#include "jsonrpc/endpoint/result_cache.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::ResultCache;
+using namespace std::chrono_literals;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+// Fills the key with result, as the call that looked it up first would
+auto Fill(
+    ResultCache& cache, const std::string& key, int result,
+    std::chrono::milliseconds ttl = 1min) -> asio::awaitable<void> {
+  auto lookup = co_await cache.Find(key);
+  REQUIRE_FALSE(lookup.hit);
+  lookup.lease.Fulfill(result, ttl);
+}
+
+}  // namespace
+
+TEST_CASE("Result cache keys", "[ResultCache]") {
+  const auto a = nlohmann::json::parse(R"({"x":1,"y":2})");
+  const auto b = nlohmann::json::parse(R"({"y":2,"x":1})");
+  REQUIRE(ResultCache::KeyOf("m", a) == ResultCache::KeyOf("m", b));
+  REQUIRE(ResultCache::KeyOf("m", a) != ResultCache::KeyOf("n", a));
+  REQUIRE(
+      ResultCache::KeyOf("m", std::nullopt) !=
+      ResultCache::KeyOf("m", nlohmann::json(nullptr)));
+}
+
+TEST_CASE("Result cache lookups", "[ResultCache]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    SECTION("A fulfilled lease is served to later lookups") {
+      ResultCache cache(executor, 16, 4);
+      co_await Fill(cache, "m", 42);
+      auto lookup = co_await cache.Find("m");
+      REQUIRE(lookup.hit);
+      REQUIRE(*lookup.hit == 42);
+    }
+
+    SECTION("Concurrent lookups wait for the first one's result") {
+      ResultCache cache(executor, 16, 4);
+      auto first = co_await cache.Find("m");
+      REQUIRE_FALSE(first.hit);
+      int waited = 0;
+      for (int i = 0; i < 3; ++i) {
+        asio::co_spawn(
+            executor,
+            [&cache, &waited]() -> asio::awaitable<void> {
+              auto lookup = co_await cache.Find("m");
+              REQUIRE(lookup.hit);
+              REQUIRE(*lookup.hit == 7);
+              ++waited;
+            },
+            asio::detached);
+      }
+      co_await asio::post(executor, asio::use_awaitable);
+      REQUIRE(waited == 0);
+
+      first.lease.Fulfill(7, 1min);
+      asio::steady_timer timer(executor, 10ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      REQUIRE(waited == 3);
+    }
+
+    SECTION("Waiters of a dropped lease run without a result") {
+      ResultCache cache(executor, 16, 4);
+      auto first = std::optional(co_await cache.Find("m"));
+      bool released = false;
+      asio::co_spawn(
+          executor,
+          [&cache, &released]() -> asio::awaitable<void> {
+            auto lookup = co_await cache.Find("m");
+            REQUIRE_FALSE(lookup.hit);
+            REQUIRE_FALSE(lookup.lease.Holds());
+            released = true;
+          },
+          asio::detached);
+      co_await asio::post(executor, asio::use_awaitable);
+      first.reset();
+      asio::steady_timer timer(executor, 10ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      REQUIRE(released);
+    }
+
+    SECTION("Results expire after their TTL") {
+      ResultCache cache(executor, 16, 4);
+      co_await Fill(cache, "m", 1, 5ms);
+      asio::steady_timer timer(executor, 20ms);
+      co_await timer.async_wait(asio::use_awaitable);
+      auto lookup = co_await cache.Find("m");
+      REQUIRE_FALSE(lookup.hit);
+      REQUIRE(lookup.lease.Holds());
+    }
+
+    SECTION("The least recently used result is evicted") {
+      // One shard, so capacity applies to all keys together
+      ResultCache cache(executor, 2, 1);
+      co_await Fill(cache, "a", 1);
+      co_await Fill(cache, "b", 2);
+      REQUIRE((co_await cache.Find("a")).hit);
+      co_await Fill(cache, "c", 3);
+      REQUIRE(co_await cache.Size() == 2);
+      REQUIRE((co_await cache.Find("a")).hit);
+      REQUIRE_FALSE((co_await cache.Find("b")).hit);
+    }
+
+    SECTION("Invalidation drops one method's results") {
+      ResultCache cache(executor, 16, 4);
+      const auto params = nlohmann::json::parse(R"({"id":1})");
+      const auto hover = ResultCache::KeyOf("hover", params);
+      const auto symbols = ResultCache::KeyOf("symbols", params);
+      co_await Fill(cache, hover, 1);
+      co_await Fill(cache, symbols, 2);
+
+      co_await cache.Invalidate("hover");
+      REQUIRE_FALSE((co_await cache.Find(hover)).hit);
+      REQUIRE((co_await cache.Find(symbols)).hit);
+
+      co_await cache.Clear();
+      REQUIRE(co_await cache.Size() == 0);
+    }
+
+    SECTION("A result computed across an invalidation is not kept") {
+      ResultCache cache(executor, 16, 4);
+      const auto key = ResultCache::KeyOf("m", std::nullopt);
+      auto running = co_await cache.Find(key);
+      co_await cache.Invalidate("m");
+      running.lease.Fulfill(1, 1min);
+      REQUIRE(co_await cache.Size() == 0);
+    }
+  });
+}
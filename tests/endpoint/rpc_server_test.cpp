@@ -0,0 +1,279 @@
+#include "jsonrpc/endpoint/rpc_server.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/transport/pipe_acceptor.hpp"
+#include "jsonrpc/transport/pipe_transport.hpp"
+#include "jsonrpc/transport/socket_acceptor.hpp"
+#include "jsonrpc/transport/socket_transport.hpp"
+
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::RpcServer;
+using jsonrpc::endpoint::ServerOptions;
+using jsonrpc::endpoint::WorkerPool;
+using jsonrpc::transport::Acceptor;
+using jsonrpc::transport::PipeAcceptor;
+using jsonrpc::transport::PipeTransport;
+using jsonrpc::transport::SocketAcceptor;
+using jsonrpc::transport::SocketTransport;
+using Json = nlohmann::json;
+
+namespace {
+
+template <typename TestFunc>
+void RunTest(TestFunc&& test_func) {
+  spdlog::set_level(spdlog::level::warn);
+  asio::io_context io_ctx;
+  asio::co_spawn(
+      io_ctx, std::forward<TestFunc>(test_func)(io_ctx.get_executor()),
+      asio::detached);
+  io_ctx.run();
+}
+
+auto Sleep(asio::any_io_executor executor, std::chrono::milliseconds duration)
+    -> asio::awaitable<void> {
+  asio::steady_timer timer(executor, duration);
+  co_await timer.async_wait(asio::use_awaitable);
+}
+
+void RegisterEcho(RpcServer& server) {
+  server.RegisterMethodCall(
+      "echo", [](std::optional<Json> params) -> asio::awaitable<Json> {
+        co_return params.value_or(Json());
+      });
+}
+
+auto Connect(asio::any_io_executor executor, const std::string& socket_path)
+    -> asio::awaitable<std::unique_ptr<RpcEndpoint>> {
+  auto client = co_await RpcEndpoint::CreateClient(
+      executor, std::make_unique<PipeTransport>(executor, socket_path));
+  REQUIRE(client);
+  co_return std::move(*client);
+}
+
+}  // namespace
+
+TEST_CASE("RpcServer sessions", "[RpcServer]") {
+  SECTION("Serves several clients with the same handlers") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_rpc_server_clients";
+      RpcServer server(
+          executor, std::make_unique<PipeAcceptor>(executor, socket_path));
+      RegisterEcho(server);
+      REQUIRE(co_await server.Start());
+
+      auto first = co_await Connect(executor, socket_path);
+      auto second = co_await Connect(executor, socket_path);
+
+      const Json first_params = {"first"};
+      const Json second_params = {"second"};
+      auto first_result = co_await first->SendMethodCall("echo", first_params);
+      auto second_result =
+          co_await second->SendMethodCall("echo", second_params);
+      REQUIRE(first_result);
+      REQUIRE(*first_result == first_params);
+      REQUIRE(second_result);
+      REQUIRE(*second_result == second_params);
+      REQUIRE(server.ConnectionCount() == 2);
+
+      // A peer that goes away ends its session
+      REQUIRE(co_await first->Shutdown());
+      co_await Sleep(executor, std::chrono::milliseconds(50));
+      REQUIRE(server.ConnectionCount() == 1);
+
+      REQUIRE(co_await server.Shutdown());
+      REQUIRE(server.ConnectionCount() == 0);
+      REQUIRE(co_await second->Shutdown());
+    });
+  }
+
+  SECTION("Connections over the limit are closed") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_rpc_server_limit";
+      ServerOptions options;
+      options.max_connections = 1;
+      RpcServer server(
+          executor, std::make_unique<PipeAcceptor>(executor, socket_path),
+          options);
+      RegisterEcho(server);
+      REQUIRE(co_await server.Start());
+
+      auto admitted = co_await Connect(executor, socket_path);
+      const Json params = {"admitted"};
+      REQUIRE(co_await admitted->SendMethodCall("echo", params));
+
+      auto rejected = co_await Connect(executor, socket_path);
+      auto result = co_await rejected->SendMethodCall(
+          "echo", params, std::chrono::milliseconds(500));
+      REQUIRE_FALSE(result);
+      REQUIRE(server.ConnectionCount() == 1);
+
+      REQUIRE(co_await rejected->Shutdown());
+      REQUIRE(co_await admitted->Shutdown());
+      REQUIRE(co_await server.Shutdown());
+    });
+  }
+
+  SECTION("Idle sessions are reaped") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_rpc_server_idle";
+      ServerOptions options;
+      options.idle_timeout = std::chrono::milliseconds(50);
+      RpcServer server(
+          executor, std::make_unique<PipeAcceptor>(executor, socket_path),
+          options);
+      RegisterEcho(server);
+      REQUIRE(co_await server.Start());
+
+      auto client = co_await Connect(executor, socket_path);
+      const Json params = {"idle"};
+      REQUIRE(co_await client->SendMethodCall("echo", params));
+      REQUIRE(server.ConnectionCount() == 1);
+
+      co_await Sleep(executor, std::chrono::milliseconds(300));
+      REQUIRE(server.ConnectionCount() == 0);
+
+      REQUIRE(co_await client->Shutdown());
+      REQUIRE(co_await server.Shutdown());
+    });
+  }
+}
+
+TEST_CASE("RpcServer shards a TCP port across acceptors", "[RpcServer]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    // Find a free port for the sharded acceptors to share
+    SocketAcceptor probe(executor, "127.0.0.1", 0);
+    REQUIRE(co_await probe.Listen());
+    auto port = probe.LocalPort();
+    co_await probe.Close();
+
+    std::vector<std::unique_ptr<Acceptor>> acceptors;
+    for (int i = 0; i < 2; ++i) {
+      acceptors.push_back(std::make_unique<SocketAcceptor>(
+          executor, "127.0.0.1", port, jsonrpc::transport::TransportOptions{},
+          true));
+    }
+    RpcServer server(executor, std::move(acceptors));
+    RegisterEcho(server);
+    REQUIRE(co_await server.Start());
+
+    std::vector<std::unique_ptr<RpcEndpoint>> clients;
+    for (int i = 0; i < 4; ++i) {
+      auto client = co_await RpcEndpoint::CreateClient(
+          executor, std::make_unique<SocketTransport>(
+                        executor, "127.0.0.1", port, false));
+      REQUIRE(client);
+      const Json params = {i};
+      auto result = co_await (*client)->SendMethodCall("echo", params);
+      REQUIRE(result);
+      REQUIRE(*result == params);
+      clients.push_back(std::move(*client));
+    }
+    REQUIRE(server.ConnectionCount() == 4);
+
+    for (auto& client : clients) {
+      REQUIRE(co_await client->Shutdown());
+    }
+    REQUIRE(co_await server.Shutdown());
+  });
+}
+
+TEST_CASE("RpcServer places sessions on a worker pool", "[RpcServer]") {
+  // Answers with the thread the handler ran on, after holding it a while
+  auto register_thread = [](RpcServer& server) {
+    server.RegisterMethodCall(
+        "thread", [](std::optional<Json>) -> asio::awaitable<Json> {
+          co_await Sleep(
+              co_await asio::this_coro::executor,
+              std::chrono::milliseconds(20));
+          co_return std::hash<std::thread::id>{}(std::this_thread::get_id());
+        });
+  };
+
+  SECTION("Each session stays on its worker") {
+    RunTest([&register_thread](
+                asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_rpc_server_workers";
+      auto workers = std::make_shared<WorkerPool>(
+          jsonrpc::endpoint::WorkerPoolOptions{.threads = 2});
+      ServerOptions options;
+      options.workers = workers;
+      RpcServer server(
+          executor, std::make_unique<PipeAcceptor>(executor, socket_path),
+          options);
+      register_thread(server);
+      REQUIRE(co_await server.Start());
+
+      auto first = co_await Connect(executor, socket_path);
+      auto second = co_await Connect(executor, socket_path);
+      auto first_thread = co_await first->SendMethodCall("thread");
+      auto second_thread = co_await second->SendMethodCall("thread");
+      REQUIRE(first_thread);
+      REQUIRE(second_thread);
+      REQUIRE(workers->Connections(0) == 1);
+      REQUIRE(workers->Connections(1) == 1);
+      REQUIRE(*first_thread != *second_thread);
+      for (int i = 0; i < 3; ++i) {
+        auto again = co_await first->SendMethodCall("thread");
+        REQUIRE(again);
+        REQUIRE(*again == *first_thread);
+      }
+
+      REQUIRE(co_await first->Shutdown());
+      REQUIRE(co_await second->Shutdown());
+      REQUIRE(co_await server.Shutdown());
+      REQUIRE(workers->Connections(0) == 0);
+    });
+  }
+
+  SECTION("Handlers past the threshold spill to the handler executor") {
+    RunTest([&register_thread](
+                asio::any_io_executor executor) -> asio::awaitable<void> {
+      const std::string socket_path = "/tmp/test_rpc_server_spill";
+      auto workers = std::make_shared<WorkerPool>(
+          jsonrpc::endpoint::WorkerPoolOptions{.threads = 1});
+      ServerOptions options;
+      options.workers = workers;
+      options.endpoint.handler_affinity.spill_threshold = 1;
+      RpcServer server(
+          executor, std::make_unique<PipeAcceptor>(executor, socket_path),
+          options);
+      register_thread(server);
+      REQUIRE(co_await server.Start());
+
+      auto client = co_await Connect(executor, socket_path);
+      std::vector<Json> threads;
+      for (int i = 0; i < 2; ++i) {
+        asio::co_spawn(
+            executor,
+            [&client, &threads]() -> asio::awaitable<void> {
+              auto result = co_await client->SendMethodCall("thread");
+              REQUIRE(result);
+              threads.push_back(*result);
+            },
+            asio::detached);
+      }
+      co_await Sleep(executor, std::chrono::milliseconds(200));
+
+      // The test's own thread runs the server's handler executor
+      const Json here =
+          std::hash<std::thread::id>{}(std::this_thread::get_id());
+      REQUIRE(threads.size() == 2);
+      REQUIRE(threads[0] != threads[1]);
+      REQUIRE((threads[0] == here || threads[1] == here));
+
+      REQUIRE(co_await client->Shutdown());
+      REQUIRE(co_await server.Shutdown());
+    });
+  }
+}
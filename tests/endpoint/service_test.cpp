@@ -0,0 +1,161 @@
+#include "jsonrpc/endpoint/service.hpp"
+
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+using jsonrpc::endpoint::Dispatcher;
+using jsonrpc::endpoint::MethodCall;
+using jsonrpc::endpoint::Notification;
+using jsonrpc::endpoint::RegisterService;
+using jsonrpc::endpoint::Service;
+using jsonrpc::endpoint::ServiceClient;
+using jsonrpc::error::RpcError;
+using jsonrpc::error::RpcErrorCode;
+using Json = nlohmann::json;
+
+namespace {
+
+struct AddParams {
+  int a = 0;
+  int b = 0;
+};
+
+struct LogParams {
+  std::string text;
+};
+
+void to_json(Json& j, const AddParams& params) {
+  j = Json{{"a", params.a}, {"b", params.b}};
+}
+
+void from_json(const Json& j, AddParams& params) {
+  j.at("a").get_to(params.a);
+  j.at("b").get_to(params.b);
+}
+
+void to_json(Json& j, const LogParams& params) {
+  j = Json{{"text", params.text}};
+}
+
+void from_json(const Json& j, LogParams& params) {
+  j.at("text").get_to(params.text);
+}
+
+using Add = MethodCall<"add", AddParams, int>;
+using Log = Notification<"log", LogParams>;
+using Calculator = Service<Add, Log>;
+
+struct CalculatorImpl {
+  static auto Handle(Add /*method*/, AddParams params)
+      -> asio::awaitable<int> {
+    co_return params.a + params.b;
+  }
+
+  auto Handle(Log /*method*/, LogParams params) -> asio::awaitable<void> {
+    last_log = std::move(params.text);
+    co_return;
+  }
+
+  std::string last_log;
+};
+
+// Records what a stub sends instead of talking to a peer
+struct RecordingCaller {
+  template <typename ParamsType, typename ResultType>
+  auto SendMethodCall(std::string method, ParamsType params)
+      -> asio::awaitable<std::expected<ResultType, RpcError>> {
+    last_method = std::move(method);
+    last_params = params;
+    co_return ResultType{};
+  }
+
+  auto SendNotification(std::string method, std::optional<Json> params)
+      -> asio::awaitable<std::expected<void, RpcError>> {
+    last_method = std::move(method);
+    last_params = std::move(params).value_or(Json{});
+    co_return std::expected<void, RpcError>{};
+  }
+
+  std::string last_method;
+  Json last_params;
+};
+
+template <typename TestFunc>
+void RunTest(TestFunc&& test_func) {
+  asio::io_context io_ctx;
+  asio::co_spawn(
+      io_ctx, std::forward<TestFunc>(test_func)(io_ctx.get_executor()),
+      asio::detached);
+  io_ctx.run();
+}
+
+}  // namespace
+
+static_assert(Calculator::kHas<Add>);
+static_assert(!Calculator::kHas<MethodCall<"sub", AddParams, int>>);
+
+TEST_CASE("Service registration", "[Service]") {
+  SECTION("Method calls reach the matching Handle overload") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      RegisterService<Calculator>(
+          dispatcher, std::make_shared<CalculatorImpl>());
+
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"add","params":{"a":2,"b":3},"id":1})");
+      REQUIRE(response.has_value());
+      REQUIRE(Json::parse(*response)["result"] == 5);
+    });
+  }
+
+  SECTION("Notifications reach the implementation") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      auto impl = std::make_shared<CalculatorImpl>();
+      RegisterService<Calculator>(dispatcher, impl);
+
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"log","params":{"text":"hi"}})");
+      REQUIRE_FALSE(response.has_value());
+      co_await asio::post(executor, asio::use_awaitable);
+      REQUIRE(impl->last_log == "hi");
+    });
+  }
+
+  SECTION("Malformed params fail the call") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      Dispatcher dispatcher(executor);
+      RegisterService<Calculator>(
+          dispatcher, std::make_shared<CalculatorImpl>());
+
+      auto response = co_await dispatcher.DispatchRequest(
+          R"({"jsonrpc":"2.0","method":"add","params":{"a":"x"},"id":1})");
+      REQUIRE(response.has_value());
+      auto error = Json::parse(*response)["error"];
+      REQUIRE(error["code"] == static_cast<int>(RpcErrorCode::kInternalError));
+    });
+  }
+}
+
+TEST_CASE("Service client stubs", "[Service]") {
+  RunTest([](asio::any_io_executor) -> asio::awaitable<void> {
+    RecordingCaller caller;
+    ServiceClient<Calculator, RecordingCaller> client(caller);
+
+    auto sum = co_await client.Call<Add>({.a = 1, .b = 2});
+    REQUIRE(sum.has_value());
+    REQUIRE(caller.last_method == "add");
+    REQUIRE(caller.last_params == Json{{"a", 1}, {"b", 2}});
+
+    auto sent = co_await client.Notify<Log>({.text = "done"});
+    REQUIRE(sent.has_value());
+    REQUIRE(caller.last_method == "log");
+    REQUIRE(caller.last_params["text"] == "done");
+  });
+}
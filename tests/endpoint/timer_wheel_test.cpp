@@ -0,0 +1,80 @@
+#include "jsonrpc/endpoint/timer_wheel.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::endpoint::TimerWheel;
+
+TEST_CASE("TimerWheel expires entries in deadline order", "[TimerWheel]") {
+  asio::io_context io_ctx;
+  auto strand = asio::make_strand(io_ctx.get_executor());
+
+  std::vector<int64_t> expired;
+  TimerWheel wheel(
+      strand, std::chrono::milliseconds(1), 8,
+      [&expired](int64_t id) { expired.push_back(id); });
+
+  asio::post(strand, [&wheel] {
+    auto now = TimerWheel::Clock::now();
+    // Beyond one revolution of the wheel
+    wheel.Schedule(3, now + std::chrono::milliseconds(30));
+    wheel.Schedule(1, now + std::chrono::milliseconds(2));
+    wheel.Schedule(2, now + std::chrono::milliseconds(10));
+  });
+
+  io_ctx.run();
+
+  REQUIRE(expired == std::vector<int64_t>{1, 2, 3});
+  REQUIRE(wheel.Size() == 0);
+}
+
+TEST_CASE("TimerWheel stop drops entries", "[TimerWheel]") {
+  asio::io_context io_ctx;
+  auto strand = asio::make_strand(io_ctx.get_executor());
+
+  std::vector<int64_t> expired;
+  TimerWheel wheel(
+      strand, std::chrono::milliseconds(1), 8,
+      [&expired](int64_t id) { expired.push_back(id); });
+
+  asio::post(strand, [&wheel] {
+    wheel.Schedule(1, TimerWheel::Clock::now() + std::chrono::seconds(10));
+    wheel.Stop();
+  });
+
+  io_ctx.run();
+
+  REQUIRE(expired.empty());
+  REQUIRE(wheel.Size() == 0);
+}
+
+TEST_CASE("TimerWheel cancel stops the timer", "[TimerWheel]") {
+  asio::io_context io_ctx;
+  auto strand = asio::make_strand(io_ctx.get_executor());
+
+  std::vector<int64_t> expired;
+  TimerWheel wheel(
+      strand, std::chrono::milliseconds(1), 8,
+      [&expired](int64_t id) { expired.push_back(id); });
+
+  asio::post(strand, [&wheel] {
+    auto now = TimerWheel::Clock::now();
+    wheel.Schedule(1, now + std::chrono::seconds(10));
+    wheel.Schedule(2, now + std::chrono::milliseconds(2));
+    wheel.Schedule(3, now + std::chrono::seconds(10));
+    wheel.Cancel(1);
+    wheel.Cancel(3);
+    wheel.Cancel(4);
+  });
+
+  // Returns once id 2 expires instead of ticking on for ten seconds
+  auto start = TimerWheel::Clock::now();
+  io_ctx.run();
+
+  REQUIRE(expired == std::vector<int64_t>{2});
+  REQUIRE(wheel.Size() == 0);
+  REQUIRE(TimerWheel::Clock::now() - start < std::chrono::seconds(5));
+}
@@ -0,0 +1,202 @@
+#include "jsonrpc/endpoint/traffic_capture.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/transport/in_process_transport.hpp"
+
+using jsonrpc::endpoint::CaptureDirection;
+using jsonrpc::endpoint::CaptureOptions;
+using jsonrpc::endpoint::EndpointOptions;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::TrafficCapture;
+using jsonrpc::transport::InProcessTransport;
+using Json = nlohmann::json;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+auto CapturePath() -> std::string {
+  return (std::filesystem::temp_directory_path() /
+          "jsonrpc_traffic_capture_test.jsonl")
+      .string();
+}
+
+auto ReadLines(const std::string& path) -> std::vector<std::string> {
+  std::ifstream file(path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(file, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+}  // namespace
+
+TEST_CASE("TrafficCapture lines", "[TrafficCapture]") {
+  SECTION("Capture records keep their fields") {
+    auto captured = TrafficCapture::ParseLine(
+        R"({"t_us":1500,"dir":"out","peer":3,"message":{"id":1,"result":2}})");
+    REQUIRE(captured.has_value());
+    REQUIRE(captured->at == std::chrono::microseconds(1500));
+    REQUIRE(captured->direction == CaptureDirection::kOutgoing);
+    REQUIRE(captured->peer == 3);
+    REQUIRE(captured->message == Json::parse(R"({"id":1,"result":2})"));
+  }
+
+  SECTION("Bare messages and batches arrive at time zero") {
+    auto message = TrafficCapture::ParseLine(
+        R"({"jsonrpc":"2.0","method":"ping","id":1})");
+    REQUIRE(message.has_value());
+    REQUIRE(message->at == std::chrono::microseconds(0));
+    REQUIRE(message->direction == CaptureDirection::kIncoming);
+
+    auto batch = TrafficCapture::ParseLine(
+        R"([{"method":"a","id":1},{"method":"b"}])");
+    REQUIRE(batch.has_value());
+    REQUIRE(batch->message.size() == 2);
+  }
+
+  SECTION("Anything else is not a message") {
+    REQUIRE_FALSE(TrafficCapture::ParseLine("not json").has_value());
+    REQUIRE_FALSE(TrafficCapture::ParseLine("[]").has_value());
+    REQUIRE_FALSE(
+        TrafficCapture::ParseLine(R"({"request_id":"user-001","title":"x"})")
+            .has_value());
+  }
+}
+
+TEST_CASE("TrafficCapture records", "[TrafficCapture]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    const auto path = CapturePath();
+
+    SECTION("Messages are written one per line") {
+      auto capture = TrafficCapture::Create(executor, path);
+      REQUIRE(capture.has_value());
+      (*capture)->Record(
+          CaptureDirection::kIncoming, 7,
+          "{\"method\":\"ping\",\n \"id\":1}");
+      (*capture)->Record(
+          CaptureDirection::kOutgoing, 7, R"({"id":1,"result":"pong"})");
+      co_await (*capture)->Flush();
+      REQUIRE((*capture)->Recorded() == 2);
+
+      auto lines = ReadLines(path);
+      REQUIRE(lines.size() == 2);
+      auto first = TrafficCapture::ParseLine(lines[0]);
+      REQUIRE(first.has_value());
+      REQUIRE(first->direction == CaptureDirection::kIncoming);
+      REQUIRE(first->peer == 7);
+      REQUIRE(first->message == Json::parse(R"({"method":"ping","id":1})"));
+      auto second = TrafficCapture::ParseLine(lines[1]);
+      REQUIRE(second.has_value());
+      REQUIRE(second->direction == CaptureDirection::kOutgoing);
+      REQUIRE(second->at >= first->at);
+    }
+
+    SECTION("Sampling keeps one message in every n") {
+      CaptureOptions options;
+      options.sample_one_in = 3;
+      options.outgoing = false;
+      auto capture = TrafficCapture::Create(executor, path, options);
+      REQUIRE(capture.has_value());
+      int sampled = 0;
+      for (int i = 0; i < 9; ++i) {
+        if ((*capture)->ShouldRecord(CaptureDirection::kIncoming)) {
+          ++sampled;
+        }
+      }
+      REQUIRE(sampled == 3);
+      REQUIRE_FALSE((*capture)->ShouldRecord(CaptureDirection::kOutgoing));
+    }
+
+    SECTION("Messages over the pending limit are dropped") {
+      CaptureOptions options;
+      options.max_pending_bytes = 100;
+      auto capture = TrafficCapture::Create(executor, path, options);
+      REQUIRE(capture.has_value());
+      (*capture)->Record(
+          CaptureDirection::kIncoming, 1, R"({"method":"small"})");
+      (*capture)->Record(
+          CaptureDirection::kIncoming, 1,
+          R"({"method":"big","params":")" + std::string(200, 'x') + "\"}");
+      co_await (*capture)->Flush();
+      REQUIRE((*capture)->Recorded() == 1);
+      REQUIRE((*capture)->Dropped() == 1);
+      REQUIRE(ReadLines(path).size() == 1);
+    }
+
+    SECTION("A file that cannot be opened fails") {
+      auto capture = TrafficCapture::Create(
+          executor, "/nonexistent/dir/capture.jsonl");
+      REQUIRE_FALSE(capture.has_value());
+    }
+
+    std::filesystem::remove(path);
+  });
+}
+
+TEST_CASE("RpcEndpoint captures its traffic", "[TrafficCapture]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    const auto path = CapturePath();
+    auto capture = TrafficCapture::Create(executor, path);
+    REQUIRE(capture.has_value());
+
+    auto [client_transport, server_transport] =
+        InProcessTransport::CreatePair(executor);
+    EndpointOptions options;
+    options.capture = *capture;
+    auto server = std::make_unique<RpcEndpoint>(
+        executor, std::move(server_transport), options);
+    server->RegisterMethodCall(
+        "echo", [](std::optional<Json> params) -> asio::awaitable<Json> {
+          co_return params.value_or(Json());
+        });
+    REQUIRE(co_await server->Start());
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor, std::move(client_transport));
+    REQUIRE(client.has_value());
+
+    auto result = co_await (*client)->SendMethodCall("echo", Json(42));
+    REQUIRE(result.has_value());
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+    co_await (*capture)->Flush();
+
+    auto lines = ReadLines(path);
+    REQUIRE(lines.size() == 2);
+    auto request = TrafficCapture::ParseLine(lines[0]);
+    REQUIRE(request.has_value());
+    REQUIRE(request->direction == CaptureDirection::kIncoming);
+    REQUIRE(request->message["method"] == "echo");
+    auto response = TrafficCapture::ParseLine(lines[1]);
+    REQUIRE(response.has_value());
+    REQUIRE(response->direction == CaptureDirection::kOutgoing);
+    REQUIRE(response->message["result"] == 42);
+
+    std::filesystem::remove(path);
+  });
+}
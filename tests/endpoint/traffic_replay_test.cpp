@@ -0,0 +1,155 @@
+#include "jsonrpc/endpoint/traffic_replay.hpp"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+#include "jsonrpc/transport/in_process_transport.hpp"
+
+using jsonrpc::endpoint::CapturedMessage;
+using jsonrpc::endpoint::ReplayOptions;
+using jsonrpc::endpoint::ResourceCounters;
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::endpoint::TrafficReplay;
+using jsonrpc::transport::InProcessTransport;
+using Json = nlohmann::json;
+using namespace std::chrono_literals;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+// Two calls of add, one of a method the server lacks and a notification,
+// between lines the replay leaves out
+constexpr auto kCapture = R"(
+{"t_us":0,"dir":"in","peer":1,"message":{"method":"add","params":[1,2],"id":1}}
+{"t_us":10,"dir":"out","peer":1,"message":{"jsonrpc":"2.0","result":3,"id":1}}
+{"jsonrpc":"2.0","method":"log","params":{"text":"hi"}}
+[{"method":"add","params":[3,4],"id":2},{"method":"missing","id":3}]
+{"jsonrpc":"2.0","result":1,"id":9}
+{"request_id":"user-001","title":"not a message"}
+)";
+
+auto LoadCapture() -> TrafficReplay {
+  std::istringstream input(kCapture);
+  return TrafficReplay::Load(input);
+}
+
+// Calls recorded 20ms apart
+auto SpacedCalls() -> TrafficReplay {
+  std::vector<CapturedMessage> messages;
+  messages.push_back(
+      {.at = 0us,
+       .message = Json::parse(R"({"method":"add","params":[1,1],"id":1})")});
+  messages.push_back(
+      {.at = 20000us,
+       .message = Json::parse(R"({"method":"add","params":[2,2],"id":2})")});
+  return TrafficReplay(std::move(messages));
+}
+
+}  // namespace
+
+TEST_CASE("TrafficReplay loads captures", "[TrafficReplay]") {
+  auto replay = LoadCapture();
+  REQUIRE(replay.Size() == 4);
+  REQUIRE(replay.Skipped() == 3);
+}
+
+TEST_CASE("TrafficReplay runs against a server", "[TrafficReplay]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client_transport, server_transport] =
+        InProcessTransport::CreatePair(executor);
+    auto server =
+        std::make_unique<RpcEndpoint>(executor, std::move(server_transport));
+    int adds = 0;
+    server->RegisterMethodCall(
+        "add", [&adds](std::optional<Json> params) -> asio::awaitable<Json> {
+          ++adds;
+          co_return params->at(0).get<int>() + params->at(1).get<int>();
+        });
+    server->RegisterNotification(
+        "log", [](std::optional<Json>) -> asio::awaitable<void> {
+          co_return;
+        });
+    REQUIRE(co_await server->Start());
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor, std::move(client_transport));
+    REQUIRE(client.has_value());
+
+    SECTION("Every message is sent and reported by method") {
+      auto replay = LoadCapture();
+      ReplayOptions options;
+      options.loops = 2;
+      auto report = co_await replay.Run(**client, options);
+      REQUIRE(adds == 4);
+      REQUIRE(report.sent == 8);
+      REQUIRE(report.errors == 2);
+      REQUIRE(report.methods.size() == 3);
+      REQUIRE(report.methods["add"].sent == 4);
+      REQUIRE(report.methods["add"].errors == 0);
+      REQUIRE(report.methods["add"].latency.count == 4);
+      REQUIRE(report.methods["missing"].errors == 2);
+      REQUIRE(report.methods["log"].sent == 2);
+      REQUIRE_FALSE(report.resources.has_value());
+    }
+
+    SECTION("Counters are split by method one message at a time") {
+      auto replay = LoadCapture();
+      std::uint64_t reads = 0;
+      ReplayOptions options;
+      options.max_in_flight = 1;
+      options.counters = [&reads] {
+        ResourceCounters counters;
+        counters.allocations = reads++;
+        return counters;
+      };
+      auto report = co_await replay.Run(**client, options);
+      REQUIRE(report.resources.has_value());
+      REQUIRE(report.methods["add"].resources.has_value());
+      REQUIRE(report.methods["add"].resources->allocations == 2);
+      REQUIRE(report.methods["log"].resources->allocations == 1);
+    }
+
+    SECTION("A rate spaces the messages out") {
+      auto replay = LoadCapture();
+      ReplayOptions options;
+      options.rate = 200;
+      auto report = co_await replay.Run(**client, options);
+      REQUIRE(report.sent == 4);
+      REQUIRE(report.elapsed >= 15ms);
+    }
+
+    SECTION("Recorded timing follows the capture, sped up") {
+      auto replay = SpacedCalls();
+      ReplayOptions options;
+      options.recorded_timing = true;
+      options.speed = 2.0;
+      auto report = co_await replay.Run(**client, options);
+      REQUIRE(report.methods["add"].sent == 2);
+      REQUIRE(report.elapsed >= 10ms);
+    }
+
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+  });
+}
@@ -0,0 +1,97 @@
+#include "jsonrpc/endpoint/worker_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using jsonrpc::endpoint::WorkerPool;
+using jsonrpc::endpoint::WorkerPoolOptions;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Runs on the worker's thread and reports which one that was
+auto ThreadOf(const asio::any_io_executor& executor) -> std::thread::id {
+  std::atomic<bool> done{false};
+  std::thread::id id;
+  asio::post(executor, [&id, &done] {
+    id = std::this_thread::get_id();
+    done = true;
+  });
+  while (!done) {
+    std::this_thread::sleep_for(1ms);
+  }
+  return id;
+}
+
+}  // namespace
+
+TEST_CASE("Worker pool CPU lists", "[WorkerPool]") {
+  REQUIRE(WorkerPool::ParseCpuList("0-3,8,10-11\n") ==
+          std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+  REQUIRE(WorkerPool::ParseCpuList("5") == std::vector<int>{5});
+  REQUIRE(WorkerPool::ParseCpuList("").empty());
+  REQUIRE(WorkerPool::ParseCpuList("x,3-1,2") == std::vector<int>{2});
+  REQUIRE_FALSE(WorkerPool::CpusByNumaNode().empty());
+}
+
+TEST_CASE("Worker pool threads", "[WorkerPool]") {
+  SECTION("Each worker runs its work on one thread of its own") {
+    WorkerPool pool(WorkerPoolOptions{.threads = 2});
+    REQUIRE(pool.Size() == 2);
+    const auto first = ThreadOf(pool.GetExecutor(0));
+    REQUIRE(ThreadOf(pool.GetExecutor(0)) == first);
+    REQUIRE(ThreadOf(pool.GetExecutor(1)) != first);
+    REQUIRE(first != std::this_thread::get_id());
+  }
+
+#ifdef __linux__
+  SECTION("Pinned workers run on their CPU") {
+    // The CPU this test runs on is one the process may use
+    const int cpu = sched_getcpu();
+    WorkerPool pool(WorkerPoolOptions{
+        .threads = 1, .pin_threads = true, .cpus = {cpu}});
+    REQUIRE(pool.Cpu(0) == cpu);
+
+    std::atomic<int> ran_on{-1};
+    asio::post(pool.GetExecutor(0), [&ran_on] { ran_on = sched_getcpu(); });
+    while (ran_on < 0) {
+      std::this_thread::sleep_for(1ms);
+    }
+    REQUIRE(ran_on == cpu);
+  }
+#endif
+}
+
+TEST_CASE("Worker pool placement", "[WorkerPool]") {
+  WorkerPool pool(WorkerPoolOptions{.threads = 3});
+
+  auto first = pool.Place();
+  auto second = pool.Place();
+  REQUIRE(first.Index() == 0);
+  REQUIRE(second.Index() == 1);
+  REQUIRE(pool.LeastLoaded() == 2);
+  {
+    auto third = pool.Place();
+    REQUIRE(third.Index() == 2);
+    REQUIRE(pool.Connections(2) == 1);
+  }
+  // Released placements free their worker for the next one
+  REQUIRE(pool.Connections(2) == 0);
+  REQUIRE(pool.Place().Index() == 2);
+
+  // Moving a placement over another releases the one it replaces
+  first = pool.Place(1);
+  REQUIRE(pool.Connections(0) == 0);
+  REQUIRE(pool.Connections(1) == 2);
+  REQUIRE(first.HandlerLoad() == second.HandlerLoad());
+  REQUIRE(first.GetExecutor() == pool.GetExecutor(1));
+}
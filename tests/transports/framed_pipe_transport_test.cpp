@@ -460,6 +460,8 @@ TEST_CASE(
     REQUIRE(
         result.error().Message().find("Invalid Content-Length header") !=
         std::string::npos);
+    // A stream that lost its framing cannot recover
+    REQUIRE_FALSE(framed_receiver->IsConnected());
 
     co_await raw_sender->Close();
     co_await framed_receiver->Close();
@@ -513,3 +515,103 @@ TEST_CASE(
     co_await framed_receiver->Close();
   });
 }
+
+TEST_CASE(
+    "FramedPipeTransport labels binary messages", "[FramedPipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    using jsonrpc::transport::MessageEncoding;
+    const std::string socket_path = "/tmp/test_framed_transport_encoding";
+    auto sender =
+        std::make_unique<FramedPipeTransport>(executor, socket_path, true);
+    auto receiver =
+        std::make_unique<FramedPipeTransport>(executor, socket_path, false);
+
+    co_await asio::experimental::make_parallel_group(
+        asio::co_spawn(
+            executor,
+            [&sender]() -> asio::awaitable<void> { co_await sender->Start(); },
+            asio::deferred),
+        asio::co_spawn(
+            executor,
+            [&receiver]() -> asio::awaitable<void> {
+              co_await receiver->Start();
+            },
+            asio::deferred))
+        .async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
+
+    REQUIRE(sender->SupportsEncoding(MessageEncoding::kCbor));
+    REQUIRE(sender->SupportsEncoding(MessageEncoding::kMsgpack));
+
+    const std::string body("\xa1\x61\x61\x00", 4);
+    REQUIRE(co_await sender->SendEncodedMessage(body, MessageEncoding::kCbor));
+    REQUIRE(co_await sender->SendMessage(R"({"id":1})"));
+
+    auto binary = co_await receiver->ReceiveMessage();
+    REQUIRE(binary.has_value());
+    REQUIRE(*binary == body);
+    REQUIRE(receiver->LastReceivedEncoding() == MessageEncoding::kCbor);
+
+    auto text = co_await receiver->ReceiveMessage();
+    REQUIRE(text.has_value());
+    REQUIRE(*text == R"({"id":1})");
+    REQUIRE(receiver->LastReceivedEncoding() == MessageEncoding::kJson);
+
+    co_await sender->Close();
+    co_await receiver->Close();
+  });
+}
+
+TEST_CASE(
+    "FramedPipeTransport compresses large messages", "[FramedPipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    using jsonrpc::transport::ContentCoding;
+    using jsonrpc::transport::TransportOptions;
+    const std::string socket_path = "/tmp/test_framed_transport_compression";
+
+    // Codecs missing from the build fall back to uncompressed bodies, so
+    // the messages arrive intact either way
+    for (auto coding : {ContentCoding::kZstd, ContentCoding::kLz4}) {
+      TransportOptions options;
+      options.compression = {.coding = coding, .min_size = 64};
+      auto sender = std::make_unique<FramedPipeTransport>(
+          executor, socket_path, true, options);
+      auto receiver = std::make_unique<FramedPipeTransport>(
+          executor, socket_path, false, options);
+
+      co_await asio::experimental::make_parallel_group(
+          asio::co_spawn(
+              executor,
+              [&sender]() -> asio::awaitable<void> {
+                co_await sender->Start();
+              },
+              asio::deferred),
+          asio::co_spawn(
+              executor,
+              [&receiver]() -> asio::awaitable<void> {
+                co_await receiver->Start();
+              },
+              asio::deferred))
+          .async_wait(asio::experimental::wait_for_all(), asio::use_awaitable);
+
+      std::string large = R"({"jsonrpc":"2.0","method":"sync","params":[)";
+      for (int i = 0; i < 2000; ++i) {
+        large += R"({"line":1,"text":"unchanged"},)";
+      }
+      large += "null]}";
+      const std::string small = R"({"jsonrpc":"2.0","method":"ping"})";
+
+      REQUIRE(co_await sender->SendMessage(large));
+      REQUIRE(co_await sender->SendMessage(small));
+
+      auto first = co_await receiver->ReceiveMessage();
+      REQUIRE(first.has_value());
+      REQUIRE(*first == large);
+      auto second = co_await receiver->ReceiveMessage();
+      REQUIRE(second.has_value());
+      REQUIRE(*second == small);
+
+      co_await sender->Close();
+      co_await receiver->Close();
+    }
+  });
+}
@@ -0,0 +1,118 @@
+#include "jsonrpc/transport/framed_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/transport/message_framer.hpp"
+
+using jsonrpc::error::RpcError;
+using jsonrpc::error::RpcErrorCode;
+using jsonrpc::transport::FramedReader;
+using jsonrpc::transport::MessageCompressor;
+using jsonrpc::transport::MessageEncoding;
+using jsonrpc::transport::MessageFramer;
+using jsonrpc::transport::MessagePool;
+using jsonrpc::transport::TransportOptions;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  asio::io_context io_ctx;
+  asio::co_spawn(io_ctx, std::forward<Func>(test_func), asio::detached);
+  io_ctx.run();
+}
+
+// Serves the stream at most chunk bytes per read, failing once it runs out
+struct FakeStream {
+  std::string data;
+  std::size_t chunk;
+  std::size_t offset = 0;
+  std::size_t reads = 0;
+
+  auto ReadSome() -> FramedReader::ReadSome {
+    return [this](asio::mutable_buffer buffer)
+               -> asio::awaitable<std::expected<std::size_t, RpcError>> {
+      ++reads;
+      if (offset == data.size()) {
+        co_return RpcError::UnexpectedFromCode(
+            RpcErrorCode::kTransportError, "Connection closed by peer");
+      }
+      auto size =
+          std::min(std::min(buffer.size(), chunk), data.size() - offset);
+      std::memcpy(buffer.data(), data.data() + offset, size);
+      offset += size;
+      co_return size;
+    };
+  }
+};
+
+auto SmallReads() -> TransportOptions {
+  TransportOptions options;
+  options.min_read_buffer_size = 64;
+  options.max_read_buffer_size = 64;
+  return options;
+}
+
+}  // namespace
+
+TEST_CASE("FramedReader", "[FramedReader]") {
+  MessagePool pool;
+  MessageCompressor compressor;
+  FramedReader reader(SmallReads(), pool, compressor, spdlog::default_logger());
+
+  SECTION("Messages split across reads are put together") {
+    RunTest([&]() -> asio::awaitable<void> {
+      FakeStream stream{
+          .data = MessageFramer::Frame(R"({"id":1})") +
+                  MessageFramer::Frame(
+                      "\xa1\x62id\x02", MessageFramer::kCborContentType),
+          .chunk = 5};
+      auto first = co_await reader.Receive(stream.ReadSome());
+      REQUIRE(first.has_value());
+      REQUIRE(*first == R"({"id":1})");
+      REQUIRE(reader.LastEncoding() == MessageEncoding::kJson);
+
+      auto second = co_await reader.Receive(stream.ReadSome());
+      REQUIRE(second.has_value());
+      REQUIRE(*second == "\xa1\x62id\x02");
+      REQUIRE(reader.LastEncoding() == MessageEncoding::kCbor);
+    });
+  }
+
+  SECTION("A large body is read straight into the message") {
+    RunTest([&]() -> asio::awaitable<void> {
+      const std::string body(4096, 'x');
+      FakeStream stream{.data = MessageFramer::Frame(body), .chunk = 4096};
+      auto message = co_await reader.Receive(stream.ReadSome());
+      REQUIRE(message.has_value());
+      REQUIRE(*message == body);
+      // Through the 64 byte buffer this would take dozens of reads
+      REQUIRE(stream.reads <= 3);
+    });
+  }
+
+  SECTION("Bad framing marks the reader corrupt") {
+    RunTest([&]() -> asio::awaitable<void> {
+      FakeStream stream{
+          .data = "Content-Length: nope\r\n\r\n{}", .chunk = 64};
+      auto message = co_await reader.Receive(stream.ReadSome());
+      REQUIRE_FALSE(message.has_value());
+      REQUIRE(reader.IsCorrupt());
+    });
+  }
+
+  SECTION("A read error is not corruption") {
+    RunTest([&]() -> asio::awaitable<void> {
+      FakeStream stream{.data = "Content-Length: 10\r\n\r\n{}", .chunk = 64};
+      auto message = co_await reader.Receive(stream.ReadSome());
+      REQUIRE_FALSE(message.has_value());
+      REQUIRE_FALSE(reader.IsCorrupt());
+    });
+  }
+}
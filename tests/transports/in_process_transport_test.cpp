@@ -0,0 +1,162 @@
+#include "jsonrpc/transport/in_process_transport.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::transport::InProcessTransport;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  spdlog::set_level(spdlog::level::debug);
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+}  // namespace
+
+TEST_CASE("InProcessTransport delivers in order", "[InProcessTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client, server] = InProcessTransport::CreatePair(executor);
+    REQUIRE(co_await client->Start());
+    REQUIRE(co_await server->Start());
+
+    REQUIRE(co_await client->SendMessage("first"));
+    REQUIRE(co_await client->SendMessage("second"));
+    REQUIRE(co_await server->SendMessage("reply"));
+
+    auto first = co_await server->ReceiveMessage();
+    REQUIRE(first.has_value());
+    REQUIRE(*first == "first");
+    auto second = co_await server->ReceiveMessage();
+    REQUIRE(second.has_value());
+    REQUIRE(*second == "second");
+    auto reply = co_await client->ReceiveMessage();
+    REQUIRE(reply.has_value());
+    REQUIRE(*reply == "reply");
+
+    co_await client->Close();
+    co_await server->Close();
+  });
+}
+
+TEST_CASE("InProcessTransport close", "[InProcessTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client, server] = InProcessTransport::CreatePair(executor);
+    REQUIRE(co_await client->Start());
+    REQUIRE(co_await server->Start());
+
+    SECTION("The peer reads what was sent, then sees the link closed") {
+      REQUIRE(co_await client->SendMessage("last words"));
+      co_await client->Close();
+      REQUIRE_FALSE(client->IsConnected());
+      REQUIRE_FALSE(server->IsConnected());
+
+      auto message = co_await server->ReceiveMessage();
+      REQUIRE(message.has_value());
+      REQUIRE(*message == "last words");
+      REQUIRE_FALSE((co_await server->ReceiveMessage()).has_value());
+      REQUIRE_FALSE((co_await server->SendMessage("too late")).has_value());
+    }
+
+    SECTION("A waiting receive wakes up") {
+      asio::co_spawn(
+          executor,
+          [&client = client]() -> asio::awaitable<void> {
+            co_await client->Close();
+          },
+          asio::detached);
+      REQUIRE_FALSE((co_await server->ReceiveMessage()).has_value());
+      REQUIRE_FALSE(server->IsConnected());
+    }
+
+    SECTION("Sending on a closed end fails") {
+      co_await client->Close();
+      REQUIRE_FALSE((co_await client->SendMessage("nope")).has_value());
+      REQUIRE_FALSE((co_await client->Flush()).has_value());
+    }
+
+    co_await server->Close();
+  });
+}
+
+TEST_CASE("InProcessTransport backpressure", "[InProcessTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client, server] = InProcessTransport::CreatePair(executor, 1);
+    REQUIRE(co_await client->Start());
+    REQUIRE(co_await server->Start());
+
+    REQUIRE(co_await client->SendMessage("fits"));
+
+    // The second send waits for the receiver to make room
+    bool second_sent = false;
+    asio::co_spawn(
+        executor,
+        [&client = client, &second_sent]() -> asio::awaitable<void> {
+          auto sent = co_await client->SendMessage("waits");
+          second_sent = sent.has_value();
+        },
+        asio::detached);
+    co_await asio::post(executor, asio::use_awaitable);
+    REQUIRE_FALSE(second_sent);
+
+    auto first = co_await server->ReceiveMessage();
+    REQUIRE(first.has_value());
+    auto second = co_await server->ReceiveMessage();
+    REQUIRE(second.has_value());
+    REQUIRE(*second == "waits");
+    for (int i = 0; i < 10 && !second_sent; ++i) {
+      co_await asio::post(executor, asio::use_awaitable);
+    }
+    REQUIRE(second_sent);
+
+    co_await client->Close();
+    co_await server->Close();
+  });
+}
+
+TEST_CASE(
+    "InProcessTransport connects two endpoints", "[InProcessTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [client_transport, server_transport] =
+        InProcessTransport::CreatePair(executor);
+
+    auto server =
+        std::make_unique<RpcEndpoint>(executor, std::move(server_transport));
+    server->RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json>&& params)
+            -> asio::awaitable<nlohmann::json> { co_return *params; });
+    REQUIRE(co_await server->Start());
+
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor, std::move(client_transport));
+    REQUIRE(client.has_value());
+
+    nlohmann::json params = {{"text", "hello"}};
+    auto result = co_await (*client)->SendMethodCall("echo", params);
+    REQUIRE(result.has_value());
+    REQUIRE(*result == params);
+
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+  });
+}
@@ -0,0 +1,93 @@
+#include "jsonrpc/transport/line_framer.hpp"
+
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::LineFramer;
+
+TEST_CASE("LineFramer basic functionality", "[LineFramer]") {
+  LineFramer framer;
+
+  SECTION("Frame and deframe single message") {
+    std::string original = R"({"method":"test"})";
+    std::string framed = LineFramer::Frame(original);
+    REQUIRE(framed == original + "\n");
+
+    auto result = framer.TryDeframe(framed);
+    REQUIRE(result.complete);
+    REQUIRE(result.message == original);
+    REQUIRE(result.consumed_bytes == framed.size());
+  }
+
+  SECTION("Partial line returns incomplete") {
+    auto result = framer.TryDeframe(R"({"method":)");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error.empty());
+  }
+
+  SECTION("Coalesced messages are split") {
+    std::string framed = "{\"id\":1}\n{\"id\":2}\n";
+
+    auto result1 = framer.TryDeframe(framed);
+    REQUIRE(result1.complete);
+    REQUIRE(result1.message == R"({"id":1})");
+
+    auto rest = std::string_view(framed).substr(result1.consumed_bytes);
+    auto result2 = framer.TryDeframe(rest);
+    REQUIRE(result2.complete);
+    REQUIRE(result2.message == R"({"id":2})");
+  }
+
+  SECTION("CRLF terminators are stripped") {
+    auto result = framer.TryDeframe("{}\r\n");
+    REQUIRE(result.complete);
+    REQUIRE(result.message == "{}");
+    REQUIRE(result.consumed_bytes == 4);
+  }
+
+  SECTION("Blank lines are returned as empty messages") {
+    auto result = framer.TryDeframe("\n{}\n");
+    REQUIRE(result.complete);
+    REQUIRE(result.message.empty());
+    REQUIRE(result.consumed_bytes == 1);
+  }
+}
+
+TEST_CASE("LineFramer incremental deframing", "[LineFramer]") {
+  SECTION("Buffer growing one byte at a time") {
+    LineFramer framer;
+    std::string framed = LineFramer::Frame(std::string(4096, 'x'));
+
+    for (std::size_t size = 1; size < framed.size(); ++size) {
+      auto result = framer.TryDeframe(std::string_view(framed).substr(0, size));
+      REQUIRE_FALSE(result.complete);
+    }
+
+    auto result = framer.TryDeframe(framed);
+    REQUIRE(result.complete);
+    REQUIRE(result.message.size() == 4096);
+  }
+
+  SECTION("Unterminated message over the limit is rejected") {
+    LineFramer framer(8);
+    auto result = framer.TryDeframe("0123456789");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error == "Message exceeds maximum size");
+  }
+
+  SECTION("Complete message over the limit is rejected") {
+    LineFramer framer(8);
+    auto result = framer.TryDeframe("0123456789\n");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error == "Message exceeds maximum size");
+  }
+
+  SECTION("Message at the limit is accepted") {
+    LineFramer framer(8);
+    auto result = framer.TryDeframe("01234567\n");
+    REQUIRE(result.complete);
+    REQUIRE(result.message == "01234567");
+  }
+}
@@ -0,0 +1,107 @@
+#include "jsonrpc/transport/message_compressor.hpp"
+
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::CompressionOptions;
+using jsonrpc::transport::ContentCoding;
+using jsonrpc::transport::MessageCompressor;
+
+namespace {
+
+// Compressible, like the document sync traffic the feature is for
+auto RepetitiveBody(std::size_t size) -> std::string {
+  std::string body;
+  while (body.size() < size) {
+    body += R"({"uri":"file:///src/main.cpp","line":42,"severity":1},)";
+  }
+  body.resize(size);
+  return body;
+}
+
+}  // namespace
+
+TEST_CASE("MessageCompressor round trips", "[MessageCompressor]") {
+  MessageCompressor compressor;
+  const auto body = RepetitiveBody(64 * 1024);
+
+  for (auto coding : {ContentCoding::kZstd, ContentCoding::kLz4}) {
+    if (!MessageCompressor::IsAvailable(coding)) {
+      auto compressed = compressor.Compress(body, coding);
+      REQUIRE_FALSE(compressed);
+      REQUIRE(compressed.error().Message().find("not built in") !=
+              std::string::npos);
+      continue;
+    }
+
+    // Repeated calls reuse the contexts
+    for (int round = 0; round < 3; ++round) {
+      auto compressed = compressor.Compress(body, coding);
+      REQUIRE(compressed);
+      REQUIRE(compressed->size() < body.size() / 4);
+      auto restored =
+          compressor.Decompress(*compressed, coding, body.size());
+      REQUIRE(restored);
+      REQUIRE(*restored == body);
+    }
+
+    auto compressed = compressor.Compress(body, coding);
+    REQUIRE(compressed);
+    SECTION("Decompressed size is bounded") {
+      REQUIRE_FALSE(
+          compressor.Decompress(*compressed, coding, body.size() - 1));
+    }
+    SECTION("Corrupt bodies fail, and the context recovers") {
+      REQUIRE_FALSE(compressor.Decompress(
+          compressed->substr(0, compressed->size() / 2), coding,
+          body.size()));
+      REQUIRE_FALSE(compressor.Decompress("garbage", coding, body.size()));
+      auto restored =
+          compressor.Decompress(*compressed, coding, body.size());
+      REQUIRE(restored);
+      REQUIRE(*restored == body);
+    }
+  }
+}
+
+TEST_CASE("MessageCompressor thresholds", "[MessageCompressor]") {
+  MessageCompressor compressor;
+
+  SECTION("Identity passes bodies through") {
+    REQUIRE(MessageCompressor::IsAvailable(ContentCoding::kIdentity));
+    auto restored =
+        compressor.Decompress("{}", ContentCoding::kIdentity, 1024);
+    REQUIRE(restored);
+    REQUIRE(*restored == "{}");
+    REQUIRE_FALSE(compressor.Decompress("{}", ContentCoding::kIdentity, 1));
+  }
+
+  for (auto coding : {ContentCoding::kZstd, ContentCoding::kLz4}) {
+    const CompressionOptions options{.coding = coding, .min_size = 1024};
+
+    SECTION("Small bodies stay uncompressed") {
+      auto body = RepetitiveBody(options.min_size - 1);
+      const auto original = body;
+      REQUIRE(
+          compressor.CompressIfWorthwhile(body, options) ==
+          ContentCoding::kIdentity);
+      REQUIRE(body == original);
+    }
+
+    SECTION("Large bodies are compressed when the codec is built in") {
+      auto body = RepetitiveBody(4 * options.min_size);
+      const auto original = body;
+      auto applied = compressor.CompressIfWorthwhile(body, options);
+      if (MessageCompressor::IsAvailable(coding)) {
+        REQUIRE(applied == coding);
+        REQUIRE(body.size() < original.size());
+        REQUIRE(*compressor.Decompress(body, coding, original.size()) ==
+                original);
+      } else {
+        REQUIRE(applied == ContentCoding::kIdentity);
+        REQUIRE(body == original);
+      }
+    }
+  }
+}
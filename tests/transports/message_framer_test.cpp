@@ -1,6 +1,7 @@
 #include "jsonrpc/transport/message_framer.hpp"
 
 #include <string>
+#include <string_view>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -41,8 +42,158 @@ TEST_CASE("MessageFramer basic functionality") {
     REQUIRE(result1.message == msg1);
 
     // Second message
-    auto result2 = framer.TryDeframe(framed.substr(result1.consumed_bytes));
+    auto rest = std::string_view(framed).substr(result1.consumed_bytes);
+    auto result2 = framer.TryDeframe(rest);
     REQUIRE(result2.complete);
     REQUIRE(result2.message == msg2);
   }
 }
+
+TEST_CASE("MessageFramer incremental deframing") {
+  MessageFramer framer;
+
+  SECTION("Message view points into the buffer") {
+    std::string framed = MessageFramer::Frame(R"({"id":1})");
+
+    auto result = framer.TryDeframe(framed);
+    REQUIRE(result.complete);
+    REQUIRE(result.message.data() >= framed.data());
+    REQUIRE(result.message.data() < framed.data() + framed.size());
+    REQUIRE(result.consumed_bytes == framed.size());
+  }
+
+  SECTION("Buffer growing one byte at a time") {
+    std::string original = R"({"method":"grow","params":[1,2,3]})";
+    std::string framed = MessageFramer::Frame(original);
+
+    for (std::size_t size = 1; size < framed.size(); ++size) {
+      auto result = framer.TryDeframe(std::string_view(framed).substr(0, size));
+      REQUIRE_FALSE(result.complete);
+      REQUIRE(result.error.empty());
+    }
+
+    auto result = framer.TryDeframe(framed);
+    REQUIRE(result.complete);
+    REQUIRE(result.message == original);
+  }
+
+  SECTION("Body size is known once headers are parsed") {
+    std::string framed = MessageFramer::Frame(std::string(100, 'x'));
+    auto header_size = framed.size() - 100;
+
+    auto result = framer.TryDeframe(std::string_view(framed).substr(0, 50));
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(framer.ExpectedBodySize() == std::nullopt);
+
+    result = framer.TryDeframe(
+        std::string_view(framed).substr(0, header_size + 10));
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(framer.ExpectedBodySize() == 100);
+    REQUIRE(framer.HeaderSize() == header_size);
+  }
+
+  SECTION("Header names are case-insensitive and values are trimmed") {
+    std::string framed = "content-length:   4 \r\n\r\ntest";
+
+    auto result = framer.TryDeframe(framed);
+    REQUIRE(result.complete);
+    REQUIRE(result.message == "test");
+  }
+
+  SECTION("Invalid Content-Length is reported") {
+    auto result = framer.TryDeframe("Content-Length: 12abc\r\n\r\n");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error == "Invalid Content-Length header");
+  }
+
+  SECTION("Missing Content-Length is reported") {
+    auto result = framer.TryDeframe("Content-Type: text/plain\r\n\r\n");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error == "Missing Content-Length header");
+  }
+}
+
+TEST_CASE("MessageFramer content types") {
+  using jsonrpc::transport::MessageEncoding;
+  MessageFramer framer;
+
+  SECTION("Frames without Content-Type are JSON") {
+    auto result = framer.TryDeframe("Content-Length: 2\r\n\r\n{}");
+    REQUIRE(result.complete);
+    REQUIRE(result.encoding == MessageEncoding::kJson);
+  }
+
+  SECTION("Binary content types are recognized") {
+    for (auto encoding : {MessageEncoding::kCbor, MessageEncoding::kMsgpack}) {
+      std::string framed = MessageFramer::Frame(
+          "\xa0", MessageFramer::ContentTypeFor(encoding));
+
+      auto result = framer.TryDeframe(framed);
+      REQUIRE(result.complete);
+      REQUIRE(result.encoding == encoding);
+      REQUIRE(result.message == "\xa0");
+    }
+  }
+
+  SECTION("Parameters and case do not matter") {
+    auto result = framer.TryDeframe(
+        "Content-Length: 1\r\nContent-Type: Application/CBOR; x=y\r\n\r\n"
+        "\xa0");
+    REQUIRE(result.complete);
+    REQUIRE(result.encoding == MessageEncoding::kCbor);
+  }
+
+  SECTION("The encoding does not leak into the next frame") {
+    std::string framed =
+        MessageFramer::Frame("\xa0", MessageFramer::kCborContentType) +
+        MessageFramer::Frame("{}");
+
+    auto first = framer.TryDeframe(framed);
+    REQUIRE(first.encoding == MessageEncoding::kCbor);
+    auto second = framer.TryDeframe(
+        std::string_view(framed).substr(first.consumed_bytes));
+    REQUIRE(second.complete);
+    REQUIRE(second.encoding == MessageEncoding::kJson);
+  }
+}
+
+TEST_CASE("MessageFramer content encodings") {
+  using jsonrpc::transport::ContentCoding;
+  MessageFramer framer;
+
+  SECTION("Frames without Content-Encoding are uncompressed") {
+    auto result = framer.TryDeframe(MessageFramer::Frame("{}"));
+    REQUIRE(result.complete);
+    REQUIRE(result.coding == ContentCoding::kIdentity);
+  }
+
+  SECTION("FrameHeader names the coding") {
+    for (auto coding : {ContentCoding::kZstd, ContentCoding::kLz4}) {
+      std::string framed = MessageFramer::FrameHeader(
+                               2, MessageFramer::kDefaultContentType, coding) +
+                           "xy";
+
+      auto result = framer.TryDeframe(framed);
+      REQUIRE(result.complete);
+      REQUIRE(result.coding == coding);
+      REQUIRE(result.message == "xy");
+    }
+  }
+
+  SECTION("Tokens are case-insensitive and identity is accepted") {
+    auto result = framer.TryDeframe(
+        "Content-Length: 2\r\nContent-Encoding:  ZSTD \r\n\r\nxy");
+    REQUIRE(result.coding == ContentCoding::kZstd);
+    result = framer.TryDeframe(
+        "Content-Length: 2\r\nContent-Encoding: identity\r\n\r\nxy");
+    REQUIRE(result.complete);
+    REQUIRE(result.coding == ContentCoding::kIdentity);
+  }
+
+  SECTION("Unknown codings are reported") {
+    auto result = framer.TryDeframe(
+        "Content-Length: 2\r\nContent-Encoding: br\r\n\r\nxy");
+    REQUIRE_FALSE(result.complete);
+    REQUIRE(result.error == "Unsupported Content-Encoding header");
+  }
+}
@@ -0,0 +1,48 @@
+#include "jsonrpc/transport/message_pool.hpp"
+
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::MessagePool;
+
+TEST_CASE("MessagePool recycles message storage", "[MessagePool]") {
+  MessagePool pool;
+  const std::string body(1000, 'x');
+
+  SECTION("A released message's storage holds the next one") {
+    auto first = pool.Acquire(body);
+    const auto* storage = first.data();
+    pool.Release(std::move(first));
+    REQUIRE(pool.Size() == 1);
+
+    auto second = pool.Acquire(std::string(500, 'y'));
+    REQUIRE(second.data() == storage);
+    REQUIRE(second == std::string(500, 'y'));
+    REQUIRE(pool.Size() == 0);
+  }
+
+  SECTION("Sized acquires return a string of that size") {
+    pool.Release(pool.Acquire(body));
+    auto message = pool.Acquire(std::size_t{200});
+    REQUIRE(message.size() == 200);
+  }
+
+  SECTION("Small and oversized strings are not pooled") {
+    pool.Release(std::string("short"));
+    pool.Release(std::string(MessagePool::kMaxPooledCapacity + 1, 'z'));
+    REQUIRE(pool.Size() == 0);
+  }
+
+  SECTION("The pool keeps a bounded number of strings") {
+    for (std::size_t i = 0; i < MessagePool::kMaxPooled + 2; ++i) {
+      pool.Release(std::string(body));
+    }
+    REQUIRE(pool.Size() == MessagePool::kMaxPooled);
+  }
+
+  SECTION("An empty pool hands out fresh strings") {
+    auto message = pool.Acquire(body);
+    REQUIRE(message == body);
+  }
+}
@@ -1,5 +1,7 @@
 #include "jsonrpc/transport/pipe_transport.hpp"
 
+#include <filesystem>
+
 #include <asio.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
@@ -133,3 +135,249 @@ TEST_CASE("PipeTransport throws on invalid socket path", "[PipeTransport]") {
     }
   });
 }
+
+TEST_CASE(
+    "PipeTransport newline-delimited framing keeps message boundaries",
+    "[PipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    std::string socket_path = "/tmp/test_socket_newline";
+    jsonrpc::transport::TransportOptions options{
+        .framing = jsonrpc::transport::Framing::kNewlineDelimited};
+    std::string large(200 * 1024, 'x');
+
+    asio::co_spawn(
+        executor,
+        [executor, socket_path, options, large]() -> asio::awaitable<void> {
+          jsonrpc::transport::PipeTransport server_transport(
+              executor, socket_path, true, options);
+          REQUIRE(co_await server_transport.Start());
+
+          // Larger than one read and coalesced with its neighbours
+          auto first = co_await server_transport.ReceiveMessage();
+          REQUIRE(first == R"({"id":1})");
+          auto second = co_await server_transport.ReceiveMessage();
+          REQUIRE(second == large);
+          auto third = co_await server_transport.ReceiveMessage();
+          REQUIRE(third == R"({"id":3})");
+
+          co_await server_transport.Close();
+        },
+        asio::detached);
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(50))
+        .async_wait(asio::use_awaitable);
+
+    jsonrpc::transport::PipeTransport client_transport(
+        executor, socket_path, false, options);
+    REQUIRE(co_await client_transport.Start());
+    co_await client_transport.SendMessage(R"({"id":1})");
+    co_await client_transport.SendMessage(large);
+    co_await client_transport.SendMessage(R"({"id":3})");
+    co_await client_transport.Flush();
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(200))
+        .async_wait(asio::use_awaitable);
+    co_await client_transport.Close();
+  });
+}
+
+TEST_CASE(
+    "PipeTransport rejects newline-delimited messages over the limit",
+    "[PipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    std::string socket_path = "/tmp/test_socket_newline_limit";
+    jsonrpc::transport::TransportOptions options{
+        .framing = jsonrpc::transport::Framing::kNewlineDelimited,
+        .max_message_size = 1024};
+
+    asio::co_spawn(
+        executor,
+        [executor, socket_path, options]() -> asio::awaitable<void> {
+          jsonrpc::transport::PipeTransport server_transport(
+              executor, socket_path, true, options);
+          REQUIRE(co_await server_transport.Start());
+
+          auto received = co_await server_transport.ReceiveMessage();
+          REQUIRE_FALSE(received.has_value());
+
+          co_await server_transport.Close();
+        },
+        asio::detached);
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(50))
+        .async_wait(asio::use_awaitable);
+
+    jsonrpc::transport::PipeTransport client_transport(
+        executor, socket_path, false, options);
+    REQUIRE(co_await client_transport.Start());
+    co_await client_transport.SendMessage(std::string(4096, 'x'));
+    co_await client_transport.Flush();
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(200))
+        .async_wait(asio::use_awaitable);
+    co_await client_transport.Close();
+  });
+}
+
+TEST_CASE(
+    "PipeTransport read size grows with large payloads", "[PipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    std::string socket_path = "/tmp/test_socket_adaptive";
+    const std::size_t payload_size = 1024 * 1024;
+
+    asio::co_spawn(
+        executor,
+        [executor, socket_path, payload_size]() -> asio::awaitable<void> {
+          jsonrpc::transport::PipeTransport server_transport(
+              executor, socket_path, true);
+          REQUIRE(co_await server_transport.Start());
+
+          std::size_t received = 0;
+          std::size_t reads = 0;
+          while (received < payload_size) {
+            auto chunk = co_await server_transport.ReceiveMessage();
+            REQUIRE(chunk.has_value());
+            received += chunk->size();
+            ++reads;
+          }
+
+          // A fixed 1 KB buffer would need over a thousand reads
+          REQUIRE(received == payload_size);
+          REQUIRE(reads < 100);
+
+          co_await server_transport.Close();
+        },
+        asio::detached);
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(50))
+        .async_wait(asio::use_awaitable);
+
+    jsonrpc::transport::PipeTransport client_transport(
+        executor, socket_path, false);
+    REQUIRE(co_await client_transport.Start());
+    co_await client_transport.SendMessage(std::string(payload_size, 'x'));
+    co_await client_transport.Flush();
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(200))
+        .async_wait(asio::use_awaitable);
+    co_await client_transport.Close();
+  });
+}
+
+TEST_CASE(
+    "PipeTransport corks small messages into one write", "[PipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    std::string socket_path = "/tmp/test_socket_cork";
+
+    asio::co_spawn(
+        executor,
+        [executor, socket_path]() -> asio::awaitable<void> {
+          jsonrpc::transport::PipeTransport server_transport(
+              executor, socket_path, true);
+          REQUIRE(co_await server_transport.Start());
+
+          // All ten messages arrive together from a single write
+          auto received = co_await server_transport.ReceiveMessage();
+          REQUIRE(received == "0123456789");
+
+          co_await server_transport.Close();
+        },
+        asio::detached);
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(50))
+        .async_wait(asio::use_awaitable);
+
+    jsonrpc::transport::PipeTransport client_transport(
+        executor, socket_path, false,
+        jsonrpc::transport::TransportOptions{
+            .cork_delay = std::chrono::milliseconds(20)});
+    REQUIRE(co_await client_transport.Start());
+    for (int i = 0; i < 10; ++i) {
+      co_await client_transport.SendMessage(std::to_string(i));
+    }
+    co_await client_transport.Flush();
+
+    co_await asio::steady_timer(executor, std::chrono::milliseconds(200))
+        .async_wait(asio::use_awaitable);
+    co_await client_transport.Close();
+  });
+}
+
+TEST_CASE("PipeTransport listens before a client connects", "[PipeTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    std::string socket_path = "/tmp/test_socket_listen";
+
+    jsonrpc::transport::PipeTransport server_transport(
+        executor, socket_path, true);
+    REQUIRE(co_await server_transport.Listen());
+    REQUIRE(std::filesystem::exists(socket_path));
+    // Listening again is a no-op
+    REQUIRE(co_await server_transport.Listen());
+
+    // The client connects before the server starts accepting
+    jsonrpc::transport::PipeTransport client_transport(
+        executor, socket_path, false);
+    REQUIRE(co_await client_transport.Start());
+    co_await client_transport.SendMessage("early");
+
+    REQUIRE(co_await server_transport.Start());
+    auto received = co_await server_transport.ReceiveMessage();
+    REQUIRE(received == "early");
+
+    co_await client_transport.Close();
+    co_await server_transport.Close();
+  });
+}
+
+TEST_CASE("PipeTransport retries its connect", "[PipeTransport]") {
+  SECTION("Connects once the server comes up") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      std::string socket_path = "/tmp/test_socket_retry";
+      std::filesystem::remove(socket_path);
+
+      asio::co_spawn(
+          executor,
+          [executor, socket_path]() -> asio::awaitable<void> {
+            co_await asio::steady_timer(
+                executor, std::chrono::milliseconds(50))
+                .async_wait(asio::use_awaitable);
+            jsonrpc::transport::PipeTransport server_transport(
+                executor, socket_path, true);
+            REQUIRE(co_await server_transport.Start());
+            auto received = co_await server_transport.ReceiveMessage();
+            REQUIRE(received == "late");
+            co_await server_transport.Close();
+          },
+          asio::detached);
+
+      jsonrpc::transport::PipeTransport client_transport(
+          executor, socket_path, false,
+          jsonrpc::transport::TransportOptions{
+              .connect_retry = {
+                  .attempts = 50,
+                  .initial_delay = std::chrono::milliseconds(5),
+                  .max_delay = std::chrono::milliseconds(10)}});
+      REQUIRE(co_await client_transport.Start());
+      co_await client_transport.SendMessage("late");
+      co_await client_transport.Flush();
+
+      co_await asio::steady_timer(executor, std::chrono::milliseconds(50))
+          .async_wait(asio::use_awaitable);
+      co_await client_transport.Close();
+    });
+  }
+
+  SECTION("Fails after the last attempt") {
+    RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+      jsonrpc::transport::PipeTransport client_transport(
+          executor, "/tmp/test_socket_retry_missing", false,
+          jsonrpc::transport::TransportOptions{
+              .connect_retry = {
+                  .attempts = 3,
+                  .initial_delay = std::chrono::milliseconds(1)}});
+      auto result = co_await client_transport.Start();
+      REQUIRE_FALSE(result);
+      co_await client_transport.Close();
+    });
+  }
+}
@@ -0,0 +1,133 @@
+#include "jsonrpc/transport/read_buffer.hpp"
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::AdaptiveReadSize;
+using jsonrpc::transport::ReadBuffer;
+
+namespace {
+
+void Append(ReadBuffer& buffer, std::string_view data) {
+  auto space = buffer.Prepare(data.size());
+  std::memcpy(space.data(), data.data(), data.size());
+  buffer.Commit(data.size());
+}
+
+}  // namespace
+
+TEST_CASE("ReadBuffer basic functionality", "[ReadBuffer]") {
+  ReadBuffer buffer;
+
+  SECTION("Committed bytes are readable") {
+    Append(buffer, "hello");
+    REQUIRE(buffer.Size() == 5);
+    REQUIRE(buffer.Data() == "hello");
+  }
+
+  SECTION("Prepare returns at least the requested space") {
+    auto space = buffer.Prepare(128);
+    REQUIRE(space.size() >= 128);
+    REQUIRE(buffer.Empty());
+  }
+
+  SECTION("Consume drops bytes from the front") {
+    Append(buffer, "hello world");
+    buffer.Consume(6);
+    REQUIRE(buffer.Data() == "world");
+    buffer.Consume(100);
+    REQUIRE(buffer.Empty());
+  }
+}
+
+TEST_CASE("ReadBuffer storage reuse", "[ReadBuffer]") {
+  SECTION("Draining the buffer reuses storage from the front") {
+    ReadBuffer buffer(64);
+    Append(buffer, std::string(48, 'a'));
+    buffer.Consume(48);
+
+    Append(buffer, std::string(48, 'b'));
+    REQUIRE(buffer.Capacity() == 64);
+    REQUIRE(buffer.Data() == std::string(48, 'b'));
+  }
+
+  SECTION("Unread bytes are compacted before growing") {
+    ReadBuffer buffer(64);
+    Append(buffer, std::string(40, 'a') + "keep");
+    buffer.Consume(40);
+
+    Append(buffer, std::string(40, 'c'));
+    REQUIRE(buffer.Capacity() == 64);
+    REQUIRE(buffer.Data() == "keep" + std::string(40, 'c'));
+  }
+
+  SECTION("Buffer grows when the data does not fit") {
+    ReadBuffer buffer(16);
+    Append(buffer, std::string(12, 'a'));
+    Append(buffer, std::string(12, 'b'));
+    REQUIRE(buffer.Capacity() >= 24);
+    REQUIRE(buffer.Data() == std::string(12, 'a') + std::string(12, 'b'));
+  }
+}
+
+TEST_CASE("ReadBuffer releases idle memory", "[ReadBuffer]") {
+  ReadBuffer buffer(1024);
+
+  SECTION("Empty buffer shrinks") {
+    buffer.ShrinkTo(64);
+    REQUIRE(buffer.Capacity() == 64);
+  }
+
+  SECTION("Buffer holding data keeps its storage") {
+    Append(buffer, "pending");
+    buffer.ShrinkTo(64);
+    REQUIRE(buffer.Capacity() == 1024);
+    REQUIRE(buffer.Data() == "pending");
+  }
+}
+
+TEST_CASE("AdaptiveReadSize", "[ReadBuffer]") {
+  AdaptiveReadSize size(4096, 1024 * 1024);
+
+  SECTION("Starts at the minimum") {
+    REQUIRE(size.Next() == 4096);
+  }
+
+  SECTION("Full reads grow toward the maximum") {
+    for (int i = 0; i < 20; ++i) {
+      size.Record(size.Next());
+    }
+    REQUIRE(size.Next() == 1024 * 1024);
+  }
+
+  SECTION("Short reads shrink back to the minimum") {
+    for (int i = 0; i < 8; ++i) {
+      size.Record(size.Next());
+    }
+    REQUIRE(size.Next() == 1024 * 1024);
+
+    for (int i = 0; i < 1000; ++i) {
+      size.Record(10);
+    }
+    REQUIRE(size.Next() == 4096);
+  }
+
+  SECTION("Occasional short reads do not shrink") {
+    size.Record(size.Next());
+    auto grown = size.Next();
+    for (int i = 0; i < 100; ++i) {
+      size.Record(10);
+      size.Record(grown / 2);
+    }
+    REQUIRE(size.Next() == grown);
+  }
+
+  SECTION("Maximum below minimum is raised to the minimum") {
+    AdaptiveReadSize fixed(8192, 1024);
+    fixed.Record(8192);
+    REQUIRE(fixed.Next() == 8192);
+  }
+}
@@ -0,0 +1,309 @@
+#include "jsonrpc/transport/send_queue.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::kMaxBulkWriteBatchSize;
+using jsonrpc::transport::MessagePriority;
+using jsonrpc::transport::OutgoingMessage;
+using jsonrpc::transport::SendHints;
+using jsonrpc::transport::SendQueue;
+using jsonrpc::transport::SendQueueLimits;
+
+namespace {
+
+auto Flatten(const std::vector<asio::const_buffer>& buffers) -> std::string {
+  std::string out;
+  for (const auto& buffer : buffers) {
+    out.append(static_cast<const char*>(buffer.data()), buffer.size());
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST_CASE("SendQueue batching", "[SendQueue]") {
+  asio::io_context io_ctx;
+  SendQueue queue(io_ctx.get_executor());
+
+  SECTION("Batch gathers all queued messages in order") {
+    queue.Push({.body = "one"});
+    queue.Push({.body = "two"});
+    queue.Push({.body = "three"});
+    REQUIRE(queue.Size() == 3);
+    REQUIRE(queue.Bytes() == 11);
+
+    auto batch = queue.TakeBatch();
+    REQUIRE(batch.Count() == 3);
+    REQUIRE(batch.Bytes() == 11);
+    REQUIRE(Flatten(batch.Buffers()) == "onetwothree");
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.Bytes() == 0);
+  }
+
+  SECTION("Header and trailer are separate buffers") {
+    queue.Push({.header = "H:", .body = "body", .trailer = "\n"});
+
+    auto batch = queue.TakeBatch();
+    REQUIRE(batch.Buffers().size() == 3);
+    REQUIRE(Flatten(batch.Buffers()) == "H:body\n");
+  }
+
+  SECTION("Batch stops at the byte limit") {
+    queue.Push({.body = std::string(60, 'a')});
+    queue.Push({.body = std::string(60, 'b')});
+
+    auto first = queue.TakeBatch(100);
+    REQUIRE(first.Count() == 1);
+    REQUIRE(queue.Size() == 1);
+
+    auto second = queue.TakeBatch(100);
+    REQUIRE(Flatten(second.Buffers()) == std::string(60, 'b'));
+  }
+
+  SECTION("Oversized message is still taken alone") {
+    queue.Push({.body = std::string(500, 'a')});
+
+    auto batch = queue.TakeBatch(100);
+    REQUIRE(batch.Count() == 1);
+    REQUIRE(batch.Bytes() == 500);
+  }
+
+  SECTION("Buffers survive moving the batch") {
+    queue.Push({.body = "short"});
+    queue.Push({.body = std::string(1000, 'x')});
+
+    auto batch = queue.TakeBatch();
+    auto moved = std::move(batch);
+    REQUIRE(Flatten(moved.Buffers()) == "short" + std::string(1000, 'x'));
+  }
+
+  SECTION("Clear drops queued messages") {
+    queue.Push({.body = "pending"});
+    queue.Clear();
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.Bytes() == 0);
+  }
+}
+
+TEST_CASE("SendQueue priorities", "[SendQueue]") {
+  asio::io_context io_ctx;
+  SendQueue queue(io_ctx.get_executor());
+  const SendHints bulk{.priority = MessagePriority::kBulk};
+
+  SECTION("Interactive messages overtake queued bulk ones") {
+    queue.Push({.body = "log1", .hints = bulk});
+    queue.Push({.body = "log2", .hints = bulk});
+    queue.Push({.body = "reply"});
+    REQUIRE(queue.Stats().queued_bulk_messages == 2);
+
+    auto batch = queue.TakeBatch();
+    REQUIRE(batch.Count() == 3);
+    REQUIRE(Flatten(batch.Buffers()) == "replylog1log2");
+  }
+
+  SECTION("Bulk bytes per batch are capped") {
+    const std::string chunk(kMaxBulkWriteBatchSize / 2, 'b');
+    for (int i = 0; i < 3; ++i) {
+      queue.Push({.body = chunk, .hints = bulk});
+    }
+    auto first = queue.TakeBatch();
+    REQUIRE(first.Count() == 2);
+
+    // Queued while the bulk batch is written, so it goes out next
+    queue.Push({.body = "reply"});
+    auto second = queue.TakeBatch();
+    REQUIRE(second.Count() == 2);
+    REQUIRE(Flatten(second.Buffers()).starts_with("reply"));
+    REQUIRE(queue.Empty());
+  }
+
+  SECTION("A bulk message larger than the cap still goes out whole") {
+    const std::string large(2 * kMaxBulkWriteBatchSize, 'b');
+    queue.Push({.body = large, .hints = bulk});
+    auto batch = queue.TakeBatch();
+    REQUIRE(batch.Count() == 1);
+    REQUIRE(batch.Bytes() == large.size());
+  }
+}
+
+TEST_CASE("SendQueue replace keys", "[SendQueue]") {
+  asio::io_context io_ctx;
+  SendQueue queue(io_ctx.get_executor());
+  const SendHints cursor{.replace_key = "cursor"};
+
+  SECTION("A queued message is replaced in its place") {
+    queue.Push({.body = "cursor 1", .hints = cursor});
+    queue.Push({.body = "edit"});
+    queue.Push({.body = "cursor 22", .hints = cursor});
+    REQUIRE(queue.Size() == 2);
+    REQUIRE(queue.Bytes() == 13);
+    REQUIRE(queue.Stats().replaced_messages == 1);
+
+    auto batch = queue.TakeBatch();
+    REQUIRE(Flatten(batch.Buffers()) == "cursor 22edit");
+  }
+
+  SECTION("Messages already taken for writing are not replaced") {
+    queue.Push({.body = "cursor 1", .hints = cursor});
+    auto in_flight = queue.TakeBatch();
+    queue.Push({.body = "cursor 2", .hints = cursor});
+    queue.Push({.body = "cursor 3", .hints = cursor});
+    REQUIRE(queue.Size() == 1);
+
+    auto batch = queue.TakeBatch();
+    REQUIRE(Flatten(batch.Buffers()) == "cursor 3");
+  }
+
+  SECTION("Clear forgets the keys") {
+    queue.Push({.body = "cursor 1", .hints = cursor});
+    queue.Clear();
+    queue.Push({.body = "cursor 2", .hints = cursor});
+    REQUIRE(queue.Size() == 1);
+    REQUIRE(Flatten(queue.TakeBatch().Buffers()) == "cursor 2");
+  }
+}
+
+TEST_CASE("SendQueue watermarks", "[SendQueue]") {
+  asio::io_context io_ctx;
+
+  SECTION("Full from high watermark until drained to low watermark") {
+    SendQueue queue(
+        io_ctx.get_executor(),
+        SendQueueLimits{
+            .high_watermark_bytes = 100, .low_watermark_bytes = 50});
+
+    queue.Push({.body = std::string(50, 'a')});
+    REQUIRE_FALSE(queue.IsFull());
+    queue.Push({.body = std::string(50, 'b')});
+    REQUIRE(queue.IsFull());
+
+    // Still above the low watermark after taking one message
+    queue.Push({.body = std::string(50, 'c')});
+    queue.TakeBatch(50);
+    REQUIRE(queue.IsFull());
+
+    queue.TakeBatch(50);
+    REQUIRE_FALSE(queue.IsFull());
+  }
+
+  SECTION("Message count watermark") {
+    SendQueue queue(
+        io_ctx.get_executor(),
+        SendQueueLimits{
+            .high_watermark_bytes = 0,
+            .high_watermark_messages = 2,
+            .low_watermark_messages = 0});
+
+    queue.Push({.body = "1"});
+    queue.Push({.body = "2"});
+    REQUIRE(queue.IsFull());
+    queue.TakeBatch();
+    REQUIRE_FALSE(queue.IsFull());
+  }
+
+  SECTION("Waiters resume once the queue drains") {
+    SendQueue queue(
+        io_ctx.get_executor(),
+        SendQueueLimits{.high_watermark_bytes = 10, .low_watermark_bytes = 0});
+    queue.Push({.body = std::string(10, 'x')});
+    REQUIRE(queue.IsFull());
+
+    int resumed = 0;
+    for (int i = 0; i < 2; ++i) {
+      asio::co_spawn(
+          io_ctx,
+          [&]() -> asio::awaitable<void> {
+            co_await queue.WaitForRoom();
+            ++resumed;
+          },
+          asio::detached);
+    }
+    io_ctx.poll();
+    REQUIRE(resumed == 0);
+    REQUIRE(queue.Stats().blocked_senders == 2);
+
+    queue.TakeBatch();
+    io_ctx.poll();
+    REQUIRE(resumed == 2);
+    REQUIRE(queue.Stats().blocked_senders == 0);
+  }
+
+  SECTION("Stats track queued, written and failed messages") {
+    SendQueue queue(io_ctx.get_executor());
+    queue.Push({.body = "hello"});
+    queue.Push({.body = "world"});
+    REQUIRE(queue.Stats().queued_messages == 2);
+    REQUIRE(queue.Stats().peak_queued_bytes == 10);
+
+    queue.RecordWrite(queue.TakeBatch(5), {});
+    queue.RecordWrite(
+        queue.TakeBatch(), std::make_error_code(std::errc::broken_pipe));
+
+    auto stats = queue.Stats();
+    REQUIRE(stats.queued_messages == 0);
+    REQUIRE(stats.sent_messages == 1);
+    REQUIRE(stats.sent_bytes == 5);
+    REQUIRE(stats.failed_messages == 1);
+  }
+}
+
+TEST_CASE("SendQueue drain notification", "[SendQueue]") {
+  asio::io_context io_ctx;
+  SendQueue queue(io_ctx.get_executor());
+
+  std::optional<bool> drained;
+  auto wait = [&](auto deadline) {
+    asio::co_spawn(
+        io_ctx,
+        [&, deadline]() -> asio::awaitable<void> {
+          drained = co_await queue.WaitForDrain(deadline);
+        },
+        asio::detached);
+  };
+
+  SECTION("Empty queue is drained immediately") {
+    wait(std::nullopt);
+    io_ctx.poll();
+    REQUIRE(drained == true);
+  }
+
+  SECTION("Waiter resumes once the in-flight batch is written") {
+    queue.Push({.body = "data"});
+    wait(std::nullopt);
+    io_ctx.poll();
+    REQUIRE_FALSE(drained.has_value());
+
+    auto batch = queue.TakeBatch();
+    io_ctx.poll();
+    REQUIRE_FALSE(drained.has_value());
+
+    queue.RecordWrite(batch, {});
+    io_ctx.poll();
+    REQUIRE(drained == true);
+  }
+
+  SECTION("Waiter gives up at the deadline") {
+    queue.Push({.body = "data"});
+    wait(std::optional(
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(5)));
+    io_ctx.run_for(std::chrono::milliseconds(50));
+    REQUIRE(drained == false);
+  }
+
+  SECTION("Clear wakes waiters while a write is in flight") {
+    queue.Push({.body = "one"});
+    auto batch = queue.TakeBatch();
+    queue.Push({.body = "two"});
+    wait(std::nullopt);
+    io_ctx.poll();
+
+    queue.Clear();
+    io_ctx.poll();
+    REQUIRE(drained == false);
+  }
+}
@@ -0,0 +1,178 @@
+#include "jsonrpc/transport/shm_ring.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+using jsonrpc::transport::ShmRing;
+
+namespace {
+
+constexpr std::size_t kCapacity = 64;
+
+// Cache-line aligned memory for one ring, standing in for a mapping
+struct RingMemory {
+  explicit RingMemory(std::size_t capacity)
+      : size(ShmRing::RequiredSize(capacity)),
+        bytes(new(std::align_val_t{ShmRing::kCacheLine}) std::byte[size]) {
+  }
+
+  RingMemory(const RingMemory&) = delete;
+  RingMemory(RingMemory&&) = delete;
+  auto operator=(const RingMemory&) -> RingMemory& = delete;
+  auto operator=(RingMemory&&) -> RingMemory& = delete;
+
+  ~RingMemory() {
+    ::operator delete[](bytes, std::align_val_t{ShmRing::kCacheLine});
+  }
+
+  auto Span() -> std::span<std::byte> {
+    return {bytes, size};
+  }
+
+  std::size_t size;
+  std::byte* bytes;
+};
+
+auto Pop(ShmRing& ring) -> std::string {
+  auto size = ring.NextSize();
+  REQUIRE(size.has_value());
+  REQUIRE(size->has_value());
+  std::string message(**size, '\0');
+  ring.Pop(message);
+  return message;
+}
+
+}  // namespace
+
+TEST_CASE("ShmRing passes messages in order", "[ShmRing]") {
+  RingMemory memory(kCapacity);
+  auto producer = ShmRing::Create(memory.Span());
+  auto consumer = ShmRing::Attach(memory.Span());
+
+  REQUIRE(consumer.NextSize().value() == std::nullopt);
+  REQUIRE(producer.TryPush("first"));
+  REQUIRE(producer.TryPush(""));
+  REQUIRE(producer.TryPush("third"));
+
+  REQUIRE(Pop(consumer) == "first");
+  REQUIRE(Pop(consumer).empty());
+  REQUIRE(Pop(consumer) == "third");
+  REQUIRE(consumer.NextSize().value() == std::nullopt);
+}
+
+TEST_CASE("ShmRing capacity", "[ShmRing]") {
+  RingMemory memory(kCapacity);
+  auto ring = ShmRing::Create(memory.Span());
+
+  SECTION("A message as large as the ring fits when it is empty") {
+    std::string largest(ring.MaxMessageSize(), 'x');
+    REQUIRE(ring.TryPush(largest));
+    REQUIRE_FALSE(ring.TryPush(""));
+    REQUIRE(Pop(ring) == largest);
+  }
+
+  SECTION("Larger messages never fit") {
+    REQUIRE_FALSE(ring.TryPush(std::string(ring.MaxMessageSize() + 1, 'x')));
+  }
+
+  SECTION("Messages wrap around the end of the data area") {
+    std::string message(20, 'a');
+    for (char fill = 'a'; fill < 'z'; ++fill) {
+      message.assign(20, fill);
+      REQUIRE(ring.TryPush(message));
+      REQUIRE(ring.TryPush(message));
+      REQUIRE(Pop(ring) == message);
+      REQUIRE(Pop(ring) == message);
+    }
+  }
+}
+
+TEST_CASE("ShmRing rejects a corrupt header", "[ShmRing]") {
+  RingMemory memory(kCapacity);
+  auto ring = ShmRing::Create(memory.Span());
+  REQUIRE(ring.TryPush("0123456789"));
+  auto* data = memory.bytes + sizeof(ShmRing::Header);
+
+  SECTION("A length beyond the published bytes") {
+    const std::uint32_t length = 11;
+    std::memcpy(data, &length, sizeof(length));
+    REQUIRE_FALSE(ring.NextSize().has_value());
+  }
+
+  SECTION("A length of gigabytes") {
+    const std::uint32_t length = 0xffffffff;
+    std::memcpy(data, &length, sizeof(length));
+    REQUIRE_FALSE(ring.NextSize().has_value());
+  }
+
+  SECTION("A tail beyond the capacity") {
+    auto& header = *reinterpret_cast<ShmRing::Header*>(memory.bytes);
+    header.tail.store(kCapacity + 1);
+    REQUIRE_FALSE(ring.NextSize().has_value());
+  }
+
+  SECTION("A tail short of a length prefix") {
+    auto& header = *reinterpret_cast<ShmRing::Header*>(memory.bytes);
+    header.tail.store(ShmRing::kLengthSize - 1);
+    REQUIRE_FALSE(ring.NextSize().has_value());
+  }
+}
+
+TEST_CASE("ShmRing wakeups", "[ShmRing]") {
+  RingMemory memory(kCapacity);
+  auto ring = ShmRing::Create(memory.Span());
+
+  SECTION("The producer wakes a sleeping consumer once") {
+    REQUIRE_FALSE(ring.ShouldWakeReader());
+    REQUIRE(ring.PrepareToSleep());
+    REQUIRE(ring.TryPush("wake up"));
+    REQUIRE(ring.ShouldWakeReader());
+    REQUIRE_FALSE(ring.ShouldWakeReader());
+  }
+
+  SECTION("A consumer does not sleep on a message") {
+    REQUIRE(ring.TryPush("already here"));
+    REQUIRE_FALSE(ring.PrepareToSleep());
+    REQUIRE_FALSE(ring.ShouldWakeReader());
+  }
+
+  SECTION("Closing is seen by the other side") {
+    REQUIRE_FALSE(ring.IsWriterClosed());
+    ring.CloseWriter();
+    REQUIRE(ring.IsWriterClosed());
+    ring.CloseReader();
+    REQUIRE(ring.IsReaderClosed());
+  }
+}
+
+TEST_CASE("ShmRing across threads", "[ShmRing]") {
+  constexpr int kMessages = 10000;
+  RingMemory memory(1024);
+  auto producer = ShmRing::Create(memory.Span());
+  auto consumer = ShmRing::Attach(memory.Span());
+
+  std::thread writer([&producer] {
+    for (int i = 0; i < kMessages; ++i) {
+      auto message = std::to_string(i);
+      while (!producer.TryPush(message)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  bool in_order = true;
+  for (int i = 0; i < kMessages; ++i) {
+    while (!consumer.NextSize().value()) {
+      std::this_thread::yield();
+    }
+    in_order = in_order && Pop(consumer) == std::to_string(i);
+  }
+  writer.join();
+  REQUIRE(in_order);
+}
@@ -0,0 +1,159 @@
+#include "jsonrpc/transport/shm_transport.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::transport::ShmTransport;
+using jsonrpc::transport::ShmTransportOptions;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  spdlog::set_level(spdlog::level::debug);
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+}  // namespace
+
+TEST_CASE("ShmTransport exchanges messages", "[ShmTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto server =
+        std::make_unique<ShmTransport>(executor, "jsonrpc_shm_test", true);
+    auto client =
+        std::make_unique<ShmTransport>(executor, "jsonrpc_shm_test", false);
+    REQUIRE(co_await server->Start());
+    REQUIRE(co_await client->Start());
+
+    REQUIRE(co_await client->SendMessage("ping"));
+    auto ping = co_await server->ReceiveMessage();
+    REQUIRE(ping.has_value());
+    REQUIRE(*ping == "ping");
+
+    // Sleeps on the doorbell until the send below rings it
+    asio::co_spawn(
+        executor,
+        [&server]() -> asio::awaitable<void> {
+          asio::steady_timer delay(server->GetExecutor());
+          delay.expires_after(std::chrono::milliseconds(20));
+          co_await delay.async_wait(asio::use_awaitable);
+          co_await server->SendMessage("pong");
+        },
+        asio::detached);
+    auto pong = co_await client->ReceiveMessage();
+    REQUIRE(pong.has_value());
+    REQUIRE(*pong == "pong");
+
+    co_await client->Close();
+    co_await server->Close();
+  });
+}
+
+TEST_CASE("ShmTransport setup and close", "[ShmTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    SECTION("A client needs a server") {
+      ShmTransport client(executor, "jsonrpc_shm_test_absent", false);
+      REQUIRE_FALSE((co_await client.Start()).has_value());
+    }
+
+    SECTION("Messages larger than the ring are rejected") {
+      ShmTransportOptions options;
+      options.ring_capacity = 1024;
+      ShmTransport server(executor, "jsonrpc_shm_test_small", true, options);
+      ShmTransport client(executor, "jsonrpc_shm_test_small", false);
+      REQUIRE(co_await server.Start());
+      REQUIRE(co_await client.Start());
+
+      REQUIRE(co_await client.SendMessage(std::string(1000, 'x')));
+      REQUIRE_FALSE(
+          (co_await client.SendMessage(std::string(2048, 'x'))).has_value());
+
+      co_await client.Close();
+      co_await server.Close();
+    }
+
+    SECTION("An incoming message over the maximum ends the transport") {
+      ShmTransportOptions options;
+      options.max_message_size = 100;
+      ShmTransport server(executor, "jsonrpc_shm_test_max", true, options);
+      ShmTransport client(executor, "jsonrpc_shm_test_max", false);
+      REQUIRE(co_await server.Start());
+      REQUIRE(co_await client.Start());
+
+      REQUIRE(co_await client.SendMessage(std::string(500, 'x')));
+      REQUIRE_FALSE((co_await server.ReceiveMessage()).has_value());
+      REQUIRE_FALSE(server.IsConnected());
+      REQUIRE_FALSE((co_await server.ReceiveMessage()).has_value());
+      REQUIRE_FALSE((co_await client.SendMessage("more")).has_value());
+      REQUIRE_FALSE(
+          (co_await server.SendMessage(std::string(500, 'x'))).has_value());
+
+      co_await client.Close();
+      co_await server.Close();
+    }
+
+    SECTION("The peer drains what was sent, then sees the close") {
+      ShmTransport server(executor, "jsonrpc_shm_test_close", true);
+      ShmTransport client(executor, "jsonrpc_shm_test_close", false);
+      REQUIRE(co_await server.Start());
+      REQUIRE(co_await client.Start());
+
+      REQUIRE(co_await client.SendMessage("last words"));
+      co_await client.Close();
+
+      auto message = co_await server.ReceiveMessage();
+      REQUIRE(message.has_value());
+      REQUIRE(*message == "last words");
+      REQUIRE_FALSE((co_await server.ReceiveMessage()).has_value());
+      REQUIRE_FALSE(server.IsConnected());
+      REQUIRE_FALSE((co_await server.SendMessage("too late")).has_value());
+
+      co_await server.Close();
+    }
+  });
+}
+
+TEST_CASE("ShmTransport connects two endpoints", "[ShmTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto server = std::make_unique<RpcEndpoint>(
+        executor,
+        std::make_unique<ShmTransport>(executor, "jsonrpc_shm_test_rpc", true));
+    server->RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json>&& params)
+            -> asio::awaitable<nlohmann::json> { co_return *params; });
+    REQUIRE(co_await server->Start());
+
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor,
+        std::make_unique<ShmTransport>(
+            executor, "jsonrpc_shm_test_rpc", false));
+    REQUIRE(client.has_value());
+
+    nlohmann::json params = {{"text", "hello"}};
+    auto result = co_await (*client)->SendMethodCall("echo", params);
+    REQUIRE(result.has_value());
+    REQUIRE(*result == params);
+
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+  });
+}
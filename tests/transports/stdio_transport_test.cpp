@@ -0,0 +1,129 @@
+#include "jsonrpc/transport/stdio_transport.hpp"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unistd.h>
+
+#include <asio.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "jsonrpc/endpoint/endpoint.hpp"
+
+using jsonrpc::endpoint::RpcEndpoint;
+using jsonrpc::transport::StdioTransport;
+using jsonrpc::transport::TransportOptions;
+
+namespace {
+
+template <typename Func>
+void RunTest(Func&& test_func) {
+  spdlog::set_level(spdlog::level::debug);
+  asio::io_context io_ctx;
+  auto executor = io_ctx.get_executor();
+  asio::co_spawn(
+      executor,
+      [test_func = std::forward<Func>(test_func), executor]() {
+        return test_func(executor);
+      },
+      asio::detached);
+  io_ctx.run();
+}
+
+// Two transports wired back to back through a pipe in each direction, as
+// a language server and the editor that spawned it would be
+auto CreatePair(asio::any_io_executor executor, TransportOptions options = {})
+    -> std::pair<
+        std::unique_ptr<StdioTransport>, std::unique_ptr<StdioTransport>> {
+  std::array<int, 2> to_server{};
+  std::array<int, 2> to_client{};
+  REQUIRE(::pipe(to_server.data()) == 0);
+  REQUIRE(::pipe(to_client.data()) == 0);
+  auto server = std::make_unique<StdioTransport>(
+      executor, to_server[0], to_client[1], options);
+  auto client = std::make_unique<StdioTransport>(
+      executor, to_client[0], to_server[1], options);
+  return {std::move(server), std::move(client)};
+}
+
+}  // namespace
+
+TEST_CASE("StdioTransport exchanges messages", "[StdioTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [server, client] = CreatePair(executor);
+    REQUIRE(co_await server->Start());
+    REQUIRE(co_await client->Start());
+
+    SECTION("Messages queued together arrive in order") {
+      for (int i = 0; i < 10; ++i) {
+        REQUIRE(co_await client->SendMessage("message " + std::to_string(i)));
+      }
+      for (int i = 0; i < 10; ++i) {
+        auto message = co_await server->ReceiveMessage();
+        REQUIRE(message.has_value());
+        REQUIRE(*message == "message " + std::to_string(i));
+      }
+    }
+
+    SECTION("Bodies larger than the read buffer arrive whole") {
+      TransportOptions options;
+      options.min_read_buffer_size = 1024;
+      options.max_read_buffer_size = 4096;
+      auto [small_server, small_client] = CreatePair(executor, options);
+      REQUIRE(co_await small_server->Start());
+      REQUIRE(co_await small_client->Start());
+
+      // Larger than the pipe buffer too, so the write completes in parts
+      const std::string document(256 * 1024, 'x');
+      REQUIRE(co_await small_client->SendMessage(document));
+      auto message = co_await small_server->ReceiveMessage();
+      REQUIRE(message.has_value());
+      REQUIRE(*message == document);
+      REQUIRE(co_await small_client->Flush());
+    }
+
+    SECTION("Closing one end disconnects the other") {
+      REQUIRE(co_await client->SendMessage("last words"));
+      REQUIRE(co_await client->Flush());
+      co_await client->Close();
+
+      auto message = co_await server->ReceiveMessage();
+      REQUIRE(message.has_value());
+      REQUIRE(*message == "last words");
+      REQUIRE_FALSE((co_await server->ReceiveMessage()).has_value());
+      REQUIRE_FALSE(server->IsConnected());
+    }
+
+    co_await client->Close();
+    co_await server->Close();
+  });
+}
+
+TEST_CASE("StdioTransport connects two endpoints", "[StdioTransport]") {
+  RunTest([](asio::any_io_executor executor) -> asio::awaitable<void> {
+    auto [server_transport, client_transport] = CreatePair(executor);
+    auto server =
+        std::make_unique<RpcEndpoint>(executor, std::move(server_transport));
+    server->RegisterMethodCall(
+        "echo",
+        [](std::optional<nlohmann::json>&& params)
+            -> asio::awaitable<nlohmann::json> { co_return *params; });
+    REQUIRE(co_await server->Start());
+
+    auto client = co_await RpcEndpoint::CreateClient(
+        executor, std::move(client_transport));
+    REQUIRE(client.has_value());
+
+    nlohmann::json params = {{"text", "hello"}};
+    auto result = co_await (*client)->SendMethodCall("echo", params);
+    REQUIRE(result.has_value());
+    REQUIRE(*result == params);
+
+    co_await (*client)->Shutdown();
+    co_await server->WaitForShutdown();
+    co_await server->Shutdown();
+  });
+}